@@ -0,0 +1,184 @@
+#define _POSIX_C_SOURCE 200112L  // For posix_memalign()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "arena.h"
+
+// =============================================================================
+// INTERNAL STRUCTURES
+// =============================================================================
+
+struct ArenaBlock {
+    ArenaBlock* previous;   // Block filled before this one (NULL for the first)
+    size_t size;            // Usable bytes behind the header
+    size_t used;            // Bytes handed out (or taken by the Arena header)
+};
+
+// Block and Arena headers rounded so the memory behind them stays aligned
+#define ROUND_UP(value, alignment) (((value) + (alignment) - 1) / (alignment) * (alignment))
+#define BLOCK_HEADER ROUND_UP(sizeof(ArenaBlock), ARENA_BLOCK_ALIGNMENT)
+#define ARENA_HEADER ROUND_UP(sizeof(Arena), ARENA_BLOCK_ALIGNMENT)
+
+static char* block_data(ArenaBlock* block) {
+    return (char*)block + BLOCK_HEADER;
+}
+
+static ArenaBlock* block_create(size_t size) {
+    if (size > SIZE_MAX - BLOCK_HEADER) {
+        return NULL;
+    }
+    void* memory = NULL;
+    if (posix_memalign(&memory, ARENA_BLOCK_ALIGNMENT, BLOCK_HEADER + size) != 0) {
+        return NULL;
+    }
+    memset(memory, 0, BLOCK_HEADER + size);
+    
+    ArenaBlock* block = (ArenaBlock*)memory;
+    block->previous = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+Arena* arena_create(size_t initial_size) {
+    if (initial_size == 0) {
+        initial_size = ARENA_DEFAULT_BLOCK_SIZE;
+    }
+    if (initial_size > SIZE_MAX - ARENA_HEADER) {
+        fprintf(stderr, "Error: Arena size %zu too large\n", initial_size);
+        return NULL;
+    }
+    
+    ArenaBlock* block = block_create(ARENA_HEADER + initial_size);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate arena (%zu bytes)\n", initial_size);
+        return NULL;
+    }
+    
+    Arena* arena = (Arena*)block_data(block);
+    block->used = ARENA_HEADER;
+    arena->block = block;
+    arena->next_block_size = initial_size + initial_size / 2;
+    arena->blocks = 1;
+    arena->allocations = 0;
+    arena->requested_bytes = 0;
+    arena->used_bytes = 0;
+    arena->reserved_bytes = BLOCK_HEADER + block->size;
+    return arena;
+}
+
+void* arena_alloc_aligned(Arena* arena, size_t size, size_t alignment) {
+    if (arena == NULL || alignment == 0 || (alignment & (alignment - 1)) != 0
+        || alignment > ARENA_BLOCK_ALIGNMENT) {
+        fprintf(stderr, "Error: Invalid arguments passed to arena_alloc_aligned\n");
+        return NULL;
+    }
+    
+    // A zero-byte request still takes a byte, so its pointer is unique
+    if (size == 0) {
+        size = 1;
+    }
+    
+    ArenaBlock* block = arena->block;
+    size_t offset = ROUND_UP(block->used, alignment);
+    if (offset > block->size || size > block->size - offset) {
+        // The rest of the current block is abandoned; new blocks grow 1.5x
+        size_t block_size = size > arena->next_block_size ? size : arena->next_block_size;
+        ArenaBlock* next = block_create(block_size);
+        if (next == NULL) {
+            fprintf(stderr, "Error: Failed to grow arena by %zu bytes\n", block_size);
+            return NULL;
+        }
+        next->previous = block;
+        arena->block = block = next;
+        arena->next_block_size = block_size + block_size / 2;
+        arena->blocks++;
+        arena->reserved_bytes += BLOCK_HEADER + block_size;
+        offset = 0;
+    }
+    
+    arena->allocations++;
+    arena->requested_bytes += size;
+    arena->used_bytes += offset - block->used + size;
+    block->used = offset + size;
+    return block_data(block) + offset;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    return arena_alloc_aligned(arena, size, ARENA_DEFAULT_ALIGNMENT);
+}
+
+char* arena_strdup(Arena* arena, const char* text) {
+    if (text == NULL) {
+        return NULL;
+    }
+    size_t length = strlen(text) + 1;
+    char* copy = (char*)arena_alloc_aligned(arena, length, 1);
+    if (copy != NULL) {
+        memcpy(copy, text, length);
+    }
+    return copy;
+}
+
+void arena_reset(Arena* arena) {
+    if (arena == NULL) return;
+    
+    ArenaBlock* block = arena->block;
+    while (block->previous != NULL) {
+        ArenaBlock* previous = block->previous;
+        free(block);
+        block = previous;
+    }
+    
+    // Only the first block is left: clear what was handed out of it
+    memset(block_data(block) + ARENA_HEADER, 0, block->used - ARENA_HEADER);
+    block->used = ARENA_HEADER;
+    arena->block = block;
+    // Growth starts over too, or every reset-and-refill cycle would ask for bigger blocks
+    arena->next_block_size = (block->size - ARENA_HEADER) + (block->size - ARENA_HEADER) / 2;
+    arena->blocks = 1;
+    arena->allocations = 0;
+    arena->requested_bytes = 0;
+    arena->used_bytes = 0;
+    arena->reserved_bytes = BLOCK_HEADER + block->size;
+}
+
+void arena_destroy(Arena* arena) {
+    if (arena == NULL) return;
+    
+    // The Arena lives in the first block, which is freed last
+    ArenaBlock* block = arena->block;
+    while (block != NULL) {
+        ArenaBlock* previous = block->previous;
+        free(block);
+        block = previous;
+    }
+}
+
+void arena_stats(const Arena* arena, ArenaStats* stats) {
+    if (arena == NULL || stats == NULL) return;
+    
+    stats->blocks = arena->blocks;
+    stats->allocations = arena->allocations;
+    stats->requested_bytes = arena->requested_bytes;
+    stats->used_bytes = arena->used_bytes;
+    stats->reserved_bytes = arena->reserved_bytes;
+}
+
+void arena_print_stats(const Arena* arena, const char* title) {
+    if (arena == NULL) {
+        printf("Error: NULL arena in arena_print_stats\n");
+        return;
+    }
+    
+    printf("ARENA USAGE (%s):\n", title != NULL ? title : "arena");
+    printf("Blocks: %zu, %zu bytes reserved\n", arena->blocks, arena->reserved_bytes);
+    printf("Allocations: %zu, %zu bytes requested, %zu bytes used (%.2f%% of reserved)\n",
+           arena->allocations, arena->requested_bytes, arena->used_bytes,
+           arena->reserved_bytes > 0 ? 100.0 * arena->used_bytes / arena->reserved_bytes : 0.0);
+}
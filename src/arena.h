@@ -0,0 +1,116 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// =============================================================================
+// ARENA (REGION) ALLOCATOR
+// =============================================================================
+//
+// Objects that live and die together (a model and its matrices, the nodes and
+// tables of a network) are bump-allocated from large zero-filled blocks and
+// released all at once by arena_destroy. Allocation never fails halfway
+// through an object graph in a way that needs unwinding: on error the caller
+// destroys the arena. The Arena structure itself lives in its first block,
+// so a whole arena is a handful of malloc calls however many objects it holds.
+//
+// When a block is full a new one is chained in, at least 1.5x the size of the
+// previous block, so N small allocations cost O(log N) mallocs.
+
+// Alignment of every block; arena_alloc_aligned accepts up to this
+#define ARENA_BLOCK_ALIGNMENT 64
+
+// Alignment of arena_alloc: enough for any scalar or pointer type
+#define ARENA_DEFAULT_ALIGNMENT 16
+
+// Block size used when arena_create is given 0
+#define ARENA_DEFAULT_BLOCK_SIZE 4096
+
+typedef struct ArenaBlock ArenaBlock;
+
+/**
+ * Region allocator state (allocated inside the arena's first block)
+ */
+typedef struct {
+    ArenaBlock* block;          // Block being filled (the others are chained behind it)
+    size_t next_block_size;     // Minimum size of the next block
+    size_t blocks;              // Blocks obtained from malloc
+    size_t allocations;         // arena_alloc calls served
+    size_t requested_bytes;     // Bytes asked for by those calls
+    size_t used_bytes;          // Bytes consumed, including alignment padding
+    size_t reserved_bytes;      // Bytes of all blocks, including headers
+} Arena;
+
+/**
+ * Usage of an arena, for capacity planning
+ * reserved - used is the memory held but not handed out (block tails, the
+ * Arena header); used - requested is alignment padding.
+ */
+typedef struct {
+    size_t blocks;
+    size_t allocations;
+    size_t requested_bytes;
+    size_t used_bytes;
+    size_t reserved_bytes;
+} ArenaStats;
+
+/**
+ * Create an arena
+ * @param initial_size Usable bytes of the first block (0 = ARENA_DEFAULT_BLOCK_SIZE);
+ *        sizing it for everything the arena will hold makes the arena one allocation
+ * @return Arena or NULL on allocation failure
+ */
+Arena* arena_create(size_t initial_size);
+
+/**
+ * Allocate zero-filled memory aligned to ARENA_DEFAULT_ALIGNMENT
+ * @param arena Arena
+ * @param size Number of bytes (0 is treated as 1, so the pointer is unique)
+ * @return Memory valid until arena_reset / arena_destroy, or NULL on failure
+ */
+void* arena_alloc(Arena* arena, size_t size);
+
+/**
+ * Allocate zero-filled memory with a given alignment
+ * @param arena Arena
+ * @param size Number of bytes (0 is treated as 1, so the pointer is unique)
+ * @param alignment Power of two ≤ ARENA_BLOCK_ALIGNMENT
+ * @return Memory valid until arena_reset / arena_destroy, or NULL on failure
+ */
+void* arena_alloc_aligned(Arena* arena, size_t size, size_t alignment);
+
+/**
+ * Copy a string into the arena
+ * @param arena Arena
+ * @param text NUL-terminated string
+ * @return The copy, or NULL on failure
+ */
+char* arena_strdup(Arena* arena, const char* text);
+
+/**
+ * Release everything allocated so far but keep the first block for reuse
+ * @param arena Arena
+ */
+void arena_reset(Arena* arena);
+
+/**
+ * Release the arena and everything allocated from it
+ * @param arena Arena (may be NULL)
+ */
+void arena_destroy(Arena* arena);
+
+/**
+ * Read the usage counters of an arena
+ * @param arena Arena
+ * @param stats Receives the counters
+ */
+void arena_stats(const Arena* arena, ArenaStats* stats);
+
+/**
+ * Print the usage counters of an arena
+ * @param arena Arena
+ * @param title Label printed before the counters
+ */
+void arena_print_stats(const Arena* arena, const char* title);
+
+#endif // ARENA_H
@@ -1,4 +1,8 @@
+#include <math.h>
 #include "bayesian.h"
+#include "bayesian_red.h"
+#include "bayesian_eliminacion.h"
+#include "bayesian_arbol.h"
 
 int run_bayesian_network_example(void){
     int n, i,nd, conx;
@@ -9,10 +13,25 @@ int run_bayesian_network_example(void){
 
     printf("ingrese la cantidad de variables:");
     scanf("%d",&n);
+    if(n <= 0){
+        printf("\n!!!!!!!! la cantidad de variables debe ser positiva !!!!!!!!!!\n");
+        return -1;
+    }
+
+    // Toda la red (nodos, hijos y tablas) vive en una arena que se libera al final
+    Arena *memoria = arena_create((size_t)n * (2 * sizeof(struct nodo) + sizeof(struct probabilidad)));
+    if(memoria == NULL){
+        return -1;
+    }
+
     printf("\ningrese los nombres de las variables:\n");
     for(i=0;i < n;i++){
         scanf("%s", nombre);
-        nodo = crear_nodo(i, nombre);
+        nodo = crear_nodo(memoria, i, nombre);
+        if(nodo == NULL){
+            arena_destroy(memoria);
+            return -1;
+        }
         insertar_nodo(&lista, nodo);
     }
 
@@ -28,14 +47,22 @@ int run_bayesian_network_example(void){
         if(nd != -1){
             printf("  -> hijo:");
             scanf("%s", hijo);
-            nodo = crear_nodo(0, hijo);
+            nodo = crear_nodo(memoria, 0, hijo);
+            if(nodo == NULL){
+                arena_destroy(memoria);
+                return -1;
+            }
             conx = insertar_hijos(&lista, nodo, nd);
             printf("\ningrese las probabilidades si es verdadero o falso(de 0 a 1):");
             printf("\nV::si %s entonces %s:", padre, hijo);
             scanf("%f", &v);
             printf("F::no %s entonces %s:", padre, hijo);
             scanf("%f", &f);
-            struct probabilidad *nueva_prob = crear_nodo_probabilidad(hijo, v, f);
+            struct probabilidad *nueva_prob = crear_nodo_probabilidad(memoria, hijo, v, f);
+            if(nueva_prob == NULL){
+                arena_destroy(memoria);
+                return -1;
+            }
             insertar_probabilidad(&lista, nd, nueva_prob);
             
             if(conx == 0){
@@ -53,6 +80,53 @@ int run_bayesian_network_example(void){
     imprimir_lista(lista);
     imprimir_como_grafo(lista);
 
+    // La misma red en forma indexada (arreglos, tabla hash y CSR)
+    RedBayesiana *red = red_desde_lista(lista);
+    if(red != NULL){
+        red_imprimir(red);
+        red_imprimir_tablas(red);
+
+        // Marginales sin evidencia por eliminación de variables
+        Eliminacion *motor = eliminacion_crear(red, ORDEN_MIN_RELLENO);
+        if(motor != NULL){
+            printf("\nProbabilidades marginales P(verdadero):\n");
+            for(i = 0; i < red->num_nodos; i++){
+                double marginal[2];
+                if(eliminacion_consultar(motor, i, NULL, marginal, NULL) == 0){
+                    printf("  %-14s %.6f\n", red_nombre(red, i), marginal[1]);
+                }
+            }
+            eliminacion_destruir(motor);
+        }
+
+        // Árbol de uniones: una calibración da todas las marginales con evidencia
+        ArbolUniones *arbol = arbol_crear(red, 0);
+        int *evidencia = (int *)malloc((size_t)red->num_nodos * sizeof(int));
+        if(arbol != NULL && evidencia != NULL && red->num_nodos > 0){
+            double log_evidencia;
+            arbol_imprimir(arbol);
+            for(i = 0; i < red->num_nodos; i++){
+                evidencia[i] = -1;
+            }
+            evidencia[red->num_nodos - 1] = 1;
+            if(arbol_calibrar(arbol, evidencia, &log_evidencia) == 0){
+                printf("\nProbabilidades P(verdadero | %s = verdadero), P(evidencia) = %.6f:\n",
+                       red_nombre(red, red->num_nodos - 1), exp(log_evidencia));
+                for(i = 0; i < red->num_nodos; i++){
+                    double marginal[2];
+                    if(arbol_marginal(arbol, i, marginal) == 0){
+                        printf("  %-14s %.6f\n", red_nombre(red, i), marginal[1]);
+                    }
+                }
+            }
+        }
+        free(evidencia);
+        arbol_destruir(arbol);
+        red_destruir(red);
+    }
+    arena_print_stats(memoria, "red bayesiana");
+
+    arena_destroy(memoria);
     return 0;
 }
 
@@ -96,9 +170,9 @@ int buscar_padre(struct nodo **lista,char *nombre){
 }
 
 
-struct nodo * crear_nodo (int id, char *name){
+struct nodo * crear_nodo (Arena *memoria, int id, char *name){
     struct nodo *nodo= NULL;
-    nodo =(struct nodo *) malloc (sizeof (struct nodo));
+    nodo =(struct nodo *) arena_alloc (memoria, sizeof (struct nodo));
   
     if (NULL != nodo){
       nodo-> id= id;
@@ -164,9 +238,9 @@ void imprimir_conexiones(struct nodo *lista) {
     }
 }
 
-struct probabilidad *crear_nodo_probabilidad(char *hijo, float v, float f) {
+struct probabilidad *crear_nodo_probabilidad(Arena *memoria, char *hijo, float v, float f) {
     struct probabilidad *nuevo = NULL;
-    nuevo = (struct probabilidad *)malloc(sizeof(struct probabilidad));
+    nuevo = (struct probabilidad *)arena_alloc(memoria, sizeof(struct probabilidad));
     
     if (nuevo != NULL) {
         strcpy(nuevo->nombre_hijo, hijo);  
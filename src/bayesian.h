@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include "arena.h"
 
 struct nodo {
     int id;
@@ -21,13 +22,15 @@ struct probabilidad {
 };
 
 // Function declarations for Bayesian network functionality
-struct nodo * crear_nodo (int id, char *name);
+// Nodes and probability entries are allocated from an arena: the whole
+// network is released at once with arena_destroy
+struct nodo * crear_nodo (Arena *memoria, int id, char *name);
 void insertar_nodo (struct nodo **lista, struct nodo *nodo);
 void imprimir_lista(struct nodo *lista);
 int buscar_padre(struct nodo **lista,char *nombre);
 int insertar_hijos(struct nodo **lista,struct nodo *hijo, int padre);
 void imprimir_conexiones(struct nodo *lista);
-struct probabilidad *crear_nodo_probabilidad(char *hijo, float v, float f);
+struct probabilidad *crear_nodo_probabilidad(Arena *memoria, char *hijo, float v, float f);
 void insertar_probabilidad(struct nodo **lista, int id_padre, struct probabilidad *nuevo);
 void imprimir_tablas_probabilidad(struct nodo *lista);
 void imprimir_como_grafo(struct nodo *lista);
@@ -0,0 +1,882 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "bayesian_arbol.h"
+#include "bayesian_eliminacion.h"
+
+// Con num_hilos = 0, los árboles con menos entradas que esto se calibran en
+// un solo hilo: despertar a los hilos costaría más que los mensajes
+#define ENTRADAS_MINIMAS_PARALELO 65536.0
+
+// =============================================================================
+// ESTRUCTURAS INTERNAS
+// =============================================================================
+
+// Clique del árbol con su potencial y el separador con su padre. Las
+// variables van ordenadas por id y la última es contigua en el potencial.
+struct Clique {
+    int num_variables;
+    int *variables;
+    size_t *pasos;
+    size_t tamano;
+    double *base;                // Producto de las tablas asignadas
+    double *potencial;           // Potencial de la última calibración
+    double log_constante;        // log de la normalización al recoger
+    
+    int padre;                   // -1 en las raíces
+    int num_hijos;
+    int *hijos;
+    
+    int num_separador;           // Variables compartidas con el padre
+    int *separador_variables;
+    size_t tamano_separador;
+    double *separador;           // Mensaje al padre; tras distribuir, marginal del separador
+    double *cociente;            // Mensaje del padre dividido por el anterior
+    unsigned *hacia_padre;       // tamano: entrada del separador de cada entrada propia
+    unsigned *desde_padre;       // Tamaño del padre: entrada del separador de cada entrada del padre
+};
+
+// Subárbol del calendario con el coste de recorrerlo
+typedef struct {
+    double costo;
+    int raiz;
+} Subarbol;
+
+typedef enum {
+    FASE_RECOGER = 0,
+    FASE_DISTRIBUIR
+} Fase;
+
+typedef struct {
+    ArbolUniones *arbol;
+    int hilo;
+} Trabajo;
+
+// Hilos 1..num_hilos-1, creados con el árbol. Cada fase incrementa ronda y
+// despierta a todos con inicio; el último en terminar avisa con fin.
+struct Cuadrilla {
+    pthread_mutex_t cerrojo;
+    pthread_cond_t inicio;
+    pthread_cond_t fin;
+    unsigned ronda;              // Fases anunciadas hasta ahora
+    Fase fase;                   // Fase de la ronda en curso
+    int pendientes;              // Hilos que aún no terminan la ronda
+    int cerrar;                  // 1 cuando arbol_destruir pide que terminen
+    int num_iniciados;
+    int *iniciado;               // 1 si el hilo h se creó; si no, lo hace el que llama
+    pthread_t *ids;
+    Trabajo *trabajos;
+};
+
+static int comparar_enteros(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int comparar_subarboles(const void *a, const void *b) {
+    const Subarbol *x = (const Subarbol *)a, *y = (const Subarbol *)b;
+    if (x->costo != y->costo) return x->costo < y->costo ? 1 : -1;
+    return (x->raiz > y->raiz) - (x->raiz < y->raiz);
+}
+
+static int empujar(int **arreglo, size_t *usados, size_t *capacidad, int valor) {
+    if (*usados == *capacidad) {
+        size_t nueva = *capacidad + *capacidad / 2 + 16;
+        int *crecido = (int *)realloc(*arreglo, nueva * sizeof(int));
+        if (crecido == NULL) return 0;
+        *arreglo = crecido;
+        *capacidad = nueva;
+    }
+    (*arreglo)[(*usados)++] = valor;
+    return 1;
+}
+
+// Índice de cada entrada del clique c en la tabla sobre un subconjunto de sus
+// variables (ordenado por id, con la última contigua)
+static void mapear(const int *estados, const Clique *c, const int *sub, int num_sub,
+                   size_t *paso, int *estado, unsigned *mapa) {
+    size_t paso_sub = 1;
+    int j = num_sub - 1;
+    for (int k = c->num_variables - 1; k >= 0; k--) {
+        paso[k] = 0;
+        if (j >= 0 && sub[j] == c->variables[k]) {
+            paso[k] = paso_sub;
+            paso_sub *= (size_t)estados[sub[j]];
+            j--;
+        }
+        estado[k] = 0;
+    }
+    
+    size_t indice = 0;
+    for (size_t i = 0; i < c->tamano; i++) {
+        mapa[i] = (unsigned)indice;
+        for (int k = c->num_variables - 1; k >= 0; k--) {
+            indice += paso[k];
+            if (++estado[k] < estados[c->variables[k]]) break;
+            indice -= paso[k] * (size_t)estados[c->variables[k]];
+            estado[k] = 0;
+        }
+    }
+}
+
+// Multiplicar la tabla de v en el potencial base de c
+static void multiplicar_tabla(const RedBayesiana *red, Clique *c, int v, size_t *paso, int *estado) {
+    const double *tabla = red->tablas + red->inicio_tabla[v];
+    for (int k = 0; k < c->num_variables; k++) {
+        int u = c->variables[k];
+        paso[k] = 0;
+        if (u == v) paso[k] = 1;
+        for (int j = red->inicio_padres[v]; j < red->inicio_padres[v + 1]; j++) {
+            if (red->padres[j] == u) paso[k] = red->pasos[j];
+        }
+        estado[k] = 0;
+    }
+    
+    size_t indice = 0;
+    for (size_t i = 0; i < c->tamano; i++) {
+        c->base[i] *= tabla[indice];
+        for (int k = c->num_variables - 1; k >= 0; k--) {
+            indice += paso[k];
+            if (++estado[k] < red->estados[c->variables[k]]) break;
+            indice -= paso[k] * (size_t)red->estados[c->variables[k]];
+            estado[k] = 0;
+        }
+    }
+}
+
+// =============================================================================
+// COMPILACIÓN
+// =============================================================================
+
+// Cliques del grafo triangulado por el orden: N⁺(x) son los vecinos de x
+// posteriores a x tras eliminar las anteriores (sus vecinos morales
+// posteriores más los N⁺ de sus hijos en el árbol de eliminación) y el clique
+// de x es {x} ∪ N⁺(x). Si un hijo c tiene N⁺(c) = {x} ∪ N⁺(x), el clique de x
+// está contenido en el de c y se absorbe. Devuelve el número de cliques; rep[x]
+// es el clique que contiene a {x} ∪ N⁺(x) y las aristas del árbol unen rep[x]
+// con rep[padre de x] con separador N⁺(x).
+static int triangular(const RedBayesiana *red, const int *orden, const int *posicion,
+                      int **conjunto, size_t *capacidad, size_t *inicio, int *longitud,
+                      int *padre_elim, int *primer_hijo, int *siguiente, int *rep,
+                      int *creador, int *marca) {
+    int V = red->num_nodos;
+    size_t usados = 0;
+    int sello = 0;
+    int num_cliques = 0;
+    
+    for (int v = 0; v < V; v++) {
+        primer_hijo[v] = -1;
+        marca[v] = 0;
+    }
+    
+    for (int p = 0; p < V; p++) {
+        int x = orden[p];
+        int s = ++sello;
+        marca[x] = s;
+        inicio[x] = usados;
+        
+        // Vecinos morales posteriores: padres, hijos y demás padres de los hijos
+        for (int k = red->inicio_padres[x]; k < red->inicio_padres[x + 1]; k++) {
+            int u = red->padres[k];
+            if (posicion[u] > p && marca[u] != s) {
+                marca[u] = s;
+                if (!empujar(conjunto, &usados, capacidad, u)) return -1;
+            }
+        }
+        for (int h = red->inicio_hijos[x]; h < red->inicio_hijos[x + 1]; h++) {
+            int c = red->hijos[h];
+            if (posicion[c] > p && marca[c] != s) {
+                marca[c] = s;
+                if (!empujar(conjunto, &usados, capacidad, c)) return -1;
+            }
+            for (int k = red->inicio_padres[c]; k < red->inicio_padres[c + 1]; k++) {
+                int u = red->padres[k];
+                if (posicion[u] > p && marca[u] != s) {
+                    marca[u] = s;
+                    if (!empujar(conjunto, &usados, capacidad, u)) return -1;
+                }
+            }
+        }
+        // Aristas de relleno heredadas de los hijos ya eliminados
+        for (int c = primer_hijo[x]; c >= 0; c = siguiente[c]) {
+            for (int i = 0; i < longitud[c]; i++) {
+                int u = (*conjunto)[inicio[c] + (size_t)i];
+                if (marca[u] != s) {
+                    marca[u] = s;
+                    if (!empujar(conjunto, &usados, capacidad, u)) return -1;
+                }
+            }
+        }
+        longitud[x] = (int)(usados - inicio[x]);
+        
+        padre_elim[x] = -1;
+        siguiente[x] = -1;
+        for (int i = 0; i < longitud[x]; i++) {
+            int u = (*conjunto)[inicio[x] + (size_t)i];
+            if (padre_elim[x] < 0 || posicion[u] < posicion[padre_elim[x]]) padre_elim[x] = u;
+        }
+        if (padre_elim[x] >= 0) {
+            siguiente[x] = primer_hijo[padre_elim[x]];
+            primer_hijo[padre_elim[x]] = x;
+        }
+        
+        rep[x] = -1;
+        for (int c = primer_hijo[x]; c >= 0; c = siguiente[c]) {
+            if (longitud[c] == longitud[x] + 1) {
+                rep[x] = rep[c];
+                break;
+            }
+        }
+        if (rep[x] < 0) {
+            creador[num_cliques] = x;
+            rep[x] = num_cliques++;
+        }
+    }
+    return num_cliques;
+}
+
+// Reservar en la arena las variables, pasos y potenciales de los cliques
+static int reservar_cliques(ArbolUniones *arbol, const int *conjunto, const size_t *inicio,
+                            const int *longitud, const int *creador) {
+    const RedBayesiana *red = arbol->red;
+    Arena *memoria = arbol->memoria;
+    
+    for (int k = 0; k < arbol->num_cliques; k++) {
+        Clique *c = &arbol->cliques[k];
+        int x = creador[k];
+        int n = longitud[x] + 1;
+        c->num_variables = n;
+        c->variables = (int *)arena_alloc(memoria, (size_t)n * sizeof(int));
+        c->pasos = (size_t *)arena_alloc(memoria, (size_t)n * sizeof(size_t));
+        if (c->variables == NULL || c->pasos == NULL) return 0;
+        c->variables[0] = x;
+        memcpy(c->variables + 1, conjunto + inicio[x], (size_t)longitud[x] * sizeof(int));
+        qsort(c->variables, (size_t)n, sizeof(int), comparar_enteros);
+        
+        size_t tamano = 1;
+        for (int j = n - 1; j >= 0; j--) {
+            size_t e = (size_t)red->estados[c->variables[j]];
+            c->pasos[j] = tamano;
+            if (tamano > (SIZE_MAX / sizeof(double)) / e || tamano * e > UINT_MAX) {
+                fprintf(stderr, "Error: El clique de '%s' es demasiado grande para el árbol de uniones\n",
+                        red->nombres[x]);
+                return 0;
+            }
+            tamano *= e;
+        }
+        c->tamano = tamano;
+        c->base = (double *)arena_alloc_aligned(memoria, tamano * sizeof(double), 64);
+        c->potencial = (double *)arena_alloc_aligned(memoria, tamano * sizeof(double), 64);
+        c->hacia_padre = (unsigned *)arena_alloc(memoria, tamano * sizeof(unsigned));
+        if (c->base == NULL || c->potencial == NULL || c->hacia_padre == NULL) return 0;
+        c->padre = -1;
+        c->num_hijos = 0;
+        arbol->entradas += (double)tamano;
+        if (n - 1 > arbol->ancho) arbol->ancho = n - 1;
+    }
+    return 1;
+}
+
+// Unir los cliques por sus separadores y precalcular los índices de los mensajes
+static int unir_cliques(ArbolUniones *arbol, const int *conjunto, const size_t *inicio,
+                        const int *longitud, const int *padre_elim, const int *rep,
+                        size_t *paso, int *estado) {
+    const RedBayesiana *red = arbol->red;
+    Arena *memoria = arbol->memoria;
+    int V = red->num_nodos;
+    
+    for (int x = 0; x < V; x++) {
+        int m = padre_elim[x];
+        if (m < 0 || rep[m] == rep[x]) continue;
+        Clique *c = &arbol->cliques[rep[x]];
+        c->padre = rep[m];
+        c->num_separador = longitud[x];
+        c->separador_variables = (int *)arena_alloc(memoria, (size_t)longitud[x] * sizeof(int));
+        if (c->separador_variables == NULL) return 0;
+        memcpy(c->separador_variables, conjunto + inicio[x], (size_t)longitud[x] * sizeof(int));
+        qsort(c->separador_variables, (size_t)longitud[x], sizeof(int), comparar_enteros);
+        arbol->cliques[rep[m]].num_hijos++;
+    }
+    
+    for (int k = 0; k < arbol->num_cliques; k++) {
+        Clique *c = &arbol->cliques[k];
+        c->hijos = (int *)arena_alloc(memoria, (size_t)c->num_hijos * sizeof(int) + 1);
+        if (c->hijos == NULL) return 0;
+        c->num_hijos = 0;
+    }
+    for (int k = 0; k < arbol->num_cliques; k++) {
+        Clique *c = &arbol->cliques[k];
+        if (c->padre < 0) continue;
+        Clique *p = &arbol->cliques[c->padre];
+        p->hijos[p->num_hijos++] = k;
+        
+        size_t tamano = 1;
+        for (int j = 0; j < c->num_separador; j++) tamano *= (size_t)red->estados[c->separador_variables[j]];
+        c->tamano_separador = tamano;
+        c->separador = (double *)arena_alloc_aligned(memoria, tamano * sizeof(double), 64);
+        c->cociente = (double *)arena_alloc_aligned(memoria, tamano * sizeof(double), 64);
+        c->desde_padre = (unsigned *)arena_alloc(memoria, p->tamano * sizeof(unsigned));
+        if (c->separador == NULL || c->cociente == NULL || c->desde_padre == NULL) return 0;
+        mapear(red->estados, c, c->separador_variables, c->num_separador, paso, estado, c->hacia_padre);
+        mapear(red->estados, p, c->separador_variables, c->num_separador, paso, estado, c->desde_padre);
+    }
+    return 1;
+}
+
+// Asignar cada tabla al clique del primer miembro eliminado de su familia y
+// cada variable al menor clique que la contiene
+static void asignar_tablas(ArbolUniones *arbol, const int *posicion, const int *rep) {
+    const RedBayesiana *red = arbol->red;
+    for (int v = 0; v < red->num_nodos; v++) {
+        int primero = v;
+        for (int k = red->inicio_padres[v]; k < red->inicio_padres[v + 1]; k++) {
+            if (posicion[red->padres[k]] < posicion[primero]) primero = red->padres[k];
+        }
+        arbol->clique_tabla[v] = rep[primero];
+    }
+    
+    for (int v = 0; v < red->num_nodos; v++) arbol->clique_de[v] = -1;
+    for (int k = 0; k < arbol->num_cliques; k++) {
+        const Clique *c = &arbol->cliques[k];
+        for (int j = 0; j < c->num_variables; j++) {
+            int u = c->variables[j];
+            if (arbol->clique_de[u] < 0 || c->tamano < arbol->cliques[arbol->clique_de[u]].tamano) {
+                arbol->clique_de[u] = k;
+            }
+        }
+    }
+}
+
+// Cortar los subárboles más caros hasta tener unos cuantos por hilo y
+// repartirlos entre los hilos de mayor a menor coste
+static int planificar(ArbolUniones *arbol, int hilos) {
+    int K = arbol->num_cliques;
+    Arena *memoria = arbol->memoria;
+    size_t n = (size_t)K + 1;
+    double *costo = (double *)malloc(n * sizeof(double));
+    int *pila = (int *)malloc(n * sizeof(int));
+    int *recorrido = (int *)arena_alloc(memoria, n * sizeof(int));
+    int *cima = (int *)arena_alloc(memoria, n * sizeof(int));
+    Subarbol *tareas = (Subarbol *)malloc(n * sizeof(Subarbol));
+    if (costo == NULL || pila == NULL || recorrido == NULL || cima == NULL || tareas == NULL) {
+        free(costo); free(pila); free(tareas);
+        return 0;
+    }
+    
+    // Coste de cada subárbol: sus cliques en preorden, acumulado al revés
+    int num_tareas = 0, usados = 0;
+    double total = 0.0;
+    for (int k = 0; k < K; k++) {
+        if (arbol->cliques[k].padre >= 0) continue;
+        int tope = 0;
+        pila[tope++] = k;
+        while (tope > 0) {
+            int c = pila[--tope];
+            recorrido[usados++] = c;
+            for (int h = 0; h < arbol->cliques[c].num_hijos; h++) pila[tope++] = arbol->cliques[c].hijos[h];
+        }
+        tareas[num_tareas].raiz = k;
+        num_tareas++;
+    }
+    for (int i = K - 1; i >= 0; i--) {
+        const Clique *c = &arbol->cliques[recorrido[i]];
+        costo[recorrido[i]] = (double)c->tamano * (2.0 + c->num_hijos);
+        for (int h = 0; h < c->num_hijos; h++) costo[recorrido[i]] += costo[c->hijos[h]];
+        if (c->padre < 0) total += costo[recorrido[i]];
+    }
+    for (int t = 0; t < num_tareas; t++) tareas[t].costo = costo[tareas[t].raiz];
+    
+    // Partir el subárbol más caro mientras su raíz no cargue demasiado el
+    // tramo secuencial
+    int num_cima = 0;
+    double costo_cima = 0.0;
+    while (hilos > 1 && num_tareas < 4 * hilos) {
+        int mayor = 0;
+        for (int t = 1; t < num_tareas; t++) {
+            if (tareas[t].costo > tareas[mayor].costo) mayor = t;
+        }
+        const Clique *c = &arbol->cliques[tareas[mayor].raiz];
+        double propio = tareas[mayor].costo;
+        for (int h = 0; h < c->num_hijos; h++) propio -= costo[c->hijos[h]];
+        if (c->num_hijos == 0 || tareas[mayor].costo <= total / (2.0 * hilos)
+            || costo_cima + propio > total / (2.0 * hilos)) {
+            break;
+        }
+        costo_cima += propio;
+        cima[num_cima++] = tareas[mayor].raiz;
+        tareas[mayor] = tareas[--num_tareas];
+        for (int h = 0; h < c->num_hijos; h++) {
+            tareas[num_tareas].raiz = c->hijos[h];
+            tareas[num_tareas].costo = costo[c->hijos[h]];
+            num_tareas++;
+        }
+    }
+    qsort(tareas, (size_t)num_tareas, sizeof(Subarbol), comparar_subarboles);
+    if (hilos > num_tareas) hilos = num_tareas > 0 ? num_tareas : 1;
+    
+    arbol->num_hilos = hilos;
+    arbol->num_subarboles = num_tareas;
+    arbol->num_cima = num_cima;
+    arbol->cima = cima;
+    arbol->recorrido = recorrido;
+    arbol->subarbol_inicio = (int *)arena_alloc(memoria, (size_t)(num_tareas + 1) * sizeof(int));
+    arbol->hilo_inicio = (int *)arena_alloc(memoria, (size_t)(hilos + 1) * sizeof(int));
+    arbol->subarboles_hilo = (int *)arena_alloc(memoria, (size_t)num_tareas * sizeof(int) + 1);
+    int *hilo_de = (int *)malloc((size_t)num_tareas * sizeof(int) + 1);
+    int *siguiente = (int *)malloc((size_t)hilos * sizeof(int));
+    double *carga = (double *)calloc((size_t)hilos, sizeof(double));
+    int ok = arbol->subarbol_inicio != NULL && arbol->hilo_inicio != NULL
+             && arbol->subarboles_hilo != NULL && hilo_de != NULL && siguiente != NULL && carga != NULL;
+    
+    // Recorrido de cada subárbol: preorden invertido (hijos antes que padres)
+    usados = 0;
+    for (int t = 0; ok && t < num_tareas; t++) {
+        arbol->subarbol_inicio[t] = usados;
+        int desde = usados, tope = 0;
+        pila[tope++] = tareas[t].raiz;
+        while (tope > 0) {
+            int c = pila[--tope];
+            recorrido[usados++] = c;
+            for (int h = 0; h < arbol->cliques[c].num_hijos; h++) pila[tope++] = arbol->cliques[c].hijos[h];
+        }
+        for (int i = desde, j = usados - 1; i < j; i++, j--) {
+            int tmp = recorrido[i];
+            recorrido[i] = recorrido[j];
+            recorrido[j] = tmp;
+        }
+        
+        int menos = 0;
+        for (int h = 1; h < hilos; h++) {
+            if (carga[h] < carga[menos]) menos = h;
+        }
+        carga[menos] += tareas[t].costo;
+        hilo_de[t] = menos;
+    }
+    if (ok) {
+        arbol->subarbol_inicio[num_tareas] = usados;
+        for (int h = 0; h <= hilos; h++) arbol->hilo_inicio[h] = 0;
+        for (int t = 0; t < num_tareas; t++) arbol->hilo_inicio[hilo_de[t] + 1]++;
+        for (int h = 0; h < hilos; h++) arbol->hilo_inicio[h + 1] += arbol->hilo_inicio[h];
+        for (int h = 0; h < hilos; h++) siguiente[h] = arbol->hilo_inicio[h];
+        for (int t = 0; t < num_tareas; t++) arbol->subarboles_hilo[siguiente[hilo_de[t]]++] = t;
+    }
+    
+    free(costo);
+    free(pila);
+    free(tareas);
+    free(hilo_de);
+    free(siguiente);
+    free(carga);
+    return ok;
+}
+
+static void *atender(void *argumento);
+
+// Arrancar los hilos de trabajo persistentes del árbol (ninguno con un solo
+// hilo). Un hilo que no se pueda crear no es un error: su parte de cada fase
+// la hace el hilo que llama.
+static int crear_cuadrilla(ArbolUniones *arbol) {
+    int hilos = arbol->num_hilos;
+    if (hilos <= 1) return 1;
+    
+    Cuadrilla *cuadrilla = (Cuadrilla *)arena_alloc(arbol->memoria, sizeof(Cuadrilla));
+    if (cuadrilla == NULL) return 0;
+    cuadrilla->iniciado = (int *)arena_alloc(arbol->memoria, (size_t)hilos * sizeof(int));
+    cuadrilla->ids = (pthread_t *)arena_alloc(arbol->memoria, (size_t)hilos * sizeof(pthread_t));
+    cuadrilla->trabajos = (Trabajo *)arena_alloc(arbol->memoria, (size_t)hilos * sizeof(Trabajo));
+    if (cuadrilla->iniciado == NULL || cuadrilla->ids == NULL || cuadrilla->trabajos == NULL) return 0;
+    
+    if (pthread_mutex_init(&cuadrilla->cerrojo, NULL) != 0) return 0;
+    if (pthread_cond_init(&cuadrilla->inicio, NULL) != 0) {
+        pthread_mutex_destroy(&cuadrilla->cerrojo);
+        return 0;
+    }
+    if (pthread_cond_init(&cuadrilla->fin, NULL) != 0) {
+        pthread_cond_destroy(&cuadrilla->inicio);
+        pthread_mutex_destroy(&cuadrilla->cerrojo);
+        return 0;
+    }
+    cuadrilla->ronda = 0;
+    cuadrilla->pendientes = 0;
+    cuadrilla->cerrar = 0;
+    cuadrilla->num_iniciados = 0;
+    arbol->cuadrilla = cuadrilla;
+    
+    for (int h = 1; h < hilos; h++) {
+        cuadrilla->trabajos[h].arbol = arbol;
+        cuadrilla->trabajos[h].hilo = h;
+        cuadrilla->iniciado[h] = pthread_create(&cuadrilla->ids[h], NULL, atender, &cuadrilla->trabajos[h]) == 0;
+        cuadrilla->num_iniciados += cuadrilla->iniciado[h];
+    }
+    return 1;
+}
+
+ArbolUniones *arbol_crear(const RedBayesiana *red, int num_hilos) {
+    if (red == NULL || !red->compilada) {
+        fprintf(stderr, "Error: La red no está compilada\n");
+        return NULL;
+    }
+    
+    ArbolUniones *arbol = (ArbolUniones *)calloc(1, sizeof(ArbolUniones));
+    if (arbol == NULL) {
+        fprintf(stderr, "Error: Sin memoria para el árbol de uniones\n");
+        return NULL;
+    }
+    arbol->red = red;
+    arbol->version = red->version;
+    arbol->num_variables = red->num_nodos;
+    arbol->memoria = arena_create(0);
+    
+    int V = red->num_nodos;
+    size_t n = (size_t)V + 1;
+    int *orden = (int *)malloc(n * sizeof(int));
+    int *posicion = (int *)malloc(n * sizeof(int));
+    size_t *inicio = (size_t *)malloc(n * sizeof(size_t));
+    int *longitud = (int *)malloc(n * sizeof(int));
+    int *padre_elim = (int *)malloc(n * sizeof(int));
+    int *primer_hijo = (int *)malloc(n * sizeof(int));
+    int *siguiente = (int *)malloc(n * sizeof(int));
+    int *rep = (int *)malloc(n * sizeof(int));
+    int *creador = (int *)malloc(n * sizeof(int));
+    int *marca = (int *)malloc(n * sizeof(int));
+    size_t *paso = (size_t *)malloc(n * sizeof(size_t));
+    int *conjunto = NULL;
+    size_t capacidad = 0;
+    int ok = arbol->memoria != NULL && orden != NULL && posicion != NULL && inicio != NULL
+             && longitud != NULL && padre_elim != NULL && primer_hijo != NULL && siguiente != NULL
+             && rep != NULL && creador != NULL && marca != NULL && paso != NULL;
+    
+    ok = ok && red_orden_eliminacion(red, ORDEN_MIN_RELLENO, orden, NULL, NULL);
+    if (ok) {
+        for (int p = 0; p < V; p++) posicion[orden[p]] = p;
+        arbol->num_cliques = triangular(red, orden, posicion, &conjunto, &capacidad, inicio, longitud,
+                                        padre_elim, primer_hijo, siguiente, rep, creador, marca);
+        ok = arbol->num_cliques >= 0;
+    }
+    if (ok) {
+        arbol->cliques = (Clique *)arena_alloc(arbol->memoria, (size_t)arbol->num_cliques * sizeof(Clique) + 1);
+        arbol->clique_de = (int *)arena_alloc(arbol->memoria, n * sizeof(int));
+        arbol->clique_tabla = (int *)arena_alloc(arbol->memoria, n * sizeof(int));
+        ok = arbol->cliques != NULL && arbol->clique_de != NULL && arbol->clique_tabla != NULL;
+    }
+    ok = ok && reservar_cliques(arbol, conjunto, inicio, longitud, creador);
+    ok = ok && unir_cliques(arbol, conjunto, inicio, longitud, padre_elim, rep, paso, marca);
+    if (ok) asignar_tablas(arbol, posicion, rep);
+    ok = ok && arbol_cargar_tablas(arbol);
+    
+    if (ok) {
+        int hilos = num_hilos;
+        if (hilos <= 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            hilos = cpus > 0 ? (int)cpus : 1;
+            if (arbol->entradas < ENTRADAS_MINIMAS_PARALELO) hilos = 1;
+        }
+        ok = planificar(arbol, hilos);
+    }
+    ok = ok && crear_cuadrilla(arbol);
+    
+    free(orden);
+    free(posicion);
+    free(inicio);
+    free(longitud);
+    free(padre_elim);
+    free(primer_hijo);
+    free(siguiente);
+    free(rep);
+    free(creador);
+    free(marca);
+    free(paso);
+    free(conjunto);
+    if (!ok) {
+        fprintf(stderr, "Error: No se pudo compilar el árbol de uniones\n");
+        arbol_destruir(arbol);
+        return NULL;
+    }
+    return arbol;
+}
+
+int arbol_cargar_tablas(ArbolUniones *arbol) {
+    if (arbol == NULL) return 0;
+    
+    const RedBayesiana *red = arbol->red;
+    if (!red->compilada || red->version != arbol->version) {
+        fprintf(stderr, "Error: La red cambió; hay que volver a crear el árbol de uniones\n");
+        return 0;
+    }
+    size_t n = (size_t)arbol->num_variables + 1;
+    size_t *paso = (size_t *)malloc(n * sizeof(size_t));
+    int *estado = (int *)malloc(n * sizeof(int));
+    if (paso == NULL || estado == NULL) {
+        fprintf(stderr, "Error: Sin memoria para cargar las tablas\n");
+        free(paso);
+        free(estado);
+        return 0;
+    }
+    
+    for (int k = 0; k < arbol->num_cliques; k++) {
+        Clique *c = &arbol->cliques[k];
+        for (size_t i = 0; i < c->tamano; i++) c->base[i] = 1.0;
+    }
+    for (int v = 0; v < arbol->num_variables; v++) {
+        multiplicar_tabla(red, &arbol->cliques[arbol->clique_tabla[v]], v, paso, estado);
+    }
+    arbol->calibrado = 0;
+    free(paso);
+    free(estado);
+    return 1;
+}
+
+void arbol_destruir(ArbolUniones *arbol) {
+    if (arbol == NULL) return;
+    
+    Cuadrilla *cuadrilla = arbol->cuadrilla;
+    if (cuadrilla != NULL) {
+        pthread_mutex_lock(&cuadrilla->cerrojo);
+        cuadrilla->cerrar = 1;
+        pthread_cond_broadcast(&cuadrilla->inicio);
+        pthread_mutex_unlock(&cuadrilla->cerrojo);
+        for (int h = 1; h < arbol->num_hilos; h++) {
+            if (cuadrilla->iniciado[h]) pthread_join(cuadrilla->ids[h], NULL);
+        }
+        pthread_cond_destroy(&cuadrilla->fin);
+        pthread_cond_destroy(&cuadrilla->inicio);
+        pthread_mutex_destroy(&cuadrilla->cerrojo);
+    }
+    arena_destroy(arbol->memoria);
+    free(arbol);
+}
+
+// =============================================================================
+// CALIBRACIÓN
+// =============================================================================
+
+// Poner a cero las entradas de c en las que la variable j no vale e
+static void anular(Clique *c, int j, int estados, int e) {
+    size_t paso = c->pasos[j];
+    size_t bloque = paso * (size_t)estados;
+    for (size_t inicio = 0; inicio < c->tamano; inicio += bloque) {
+        memset(c->potencial + inicio, 0, (size_t)e * paso * sizeof(double));
+        memset(c->potencial + inicio + (size_t)(e + 1) * paso, 0,
+               (size_t)(estados - e - 1) * paso * sizeof(double));
+    }
+}
+
+// Potencial base con la evidencia por los mensajes de los hijos; lo normaliza
+// y deja su mensaje al padre en el separador
+static void recoger(ArbolUniones *arbol, int k) {
+    Clique *c = &arbol->cliques[k];
+    const int *evidencia = arbol->evidencia;
+    double *restrict potencial = c->potencial;
+    size_t tamano = c->tamano;
+    
+    memcpy(potencial, c->base, tamano * sizeof(double));
+    for (int j = 0; evidencia != NULL && j < c->num_variables; j++) {
+        int u = c->variables[j];
+        if (evidencia[u] >= 0 && arbol->clique_de[u] == k) {
+            anular(c, j, arbol->red->estados[u], evidencia[u]);
+        }
+    }
+    for (int h = 0; h < c->num_hijos; h++) {
+        const Clique *hijo = &arbol->cliques[c->hijos[h]];
+        const double *restrict mensaje = hijo->separador;
+        const unsigned *restrict indice = hijo->desde_padre;
+        for (size_t i = 0; i < tamano; i++) potencial[i] *= mensaje[indice[i]];
+    }
+    
+    double suma = 0.0;
+    for (size_t i = 0; i < tamano; i++) suma += potencial[i];
+    if (suma > 0.0) {
+        double inversa = 1.0 / suma;
+        for (size_t i = 0; i < tamano; i++) potencial[i] *= inversa;
+        c->log_constante = log(suma);
+    } else {
+        c->log_constante = -INFINITY;
+    }
+    
+    if (c->padre >= 0) {
+        double *restrict separador = c->separador;
+        const unsigned *restrict indice = c->hacia_padre;
+        memset(separador, 0, c->tamano_separador * sizeof(double));
+        for (size_t i = 0; i < tamano; i++) separador[indice[i]] += potencial[i];
+    }
+}
+
+// Absorber la marginal del separador según el padre ya calibrado
+static void distribuir(ArbolUniones *arbol, int k) {
+    Clique *c = &arbol->cliques[k];
+    if (c->padre < 0) return;
+    
+    const Clique *p = &arbol->cliques[c->padre];
+    double *restrict cociente = c->cociente;
+    double *restrict separador = c->separador;
+    const unsigned *restrict indice = c->desde_padre;
+    memset(cociente, 0, c->tamano_separador * sizeof(double));
+    for (size_t i = 0; i < p->tamano; i++) cociente[indice[i]] += p->potencial[i];
+    for (size_t s = 0; s < c->tamano_separador; s++) {
+        double nuevo = cociente[s];
+        cociente[s] = separador[s] > 0.0 ? nuevo / separador[s] : 0.0;
+        separador[s] = nuevo;
+    }
+    
+    double *restrict potencial = c->potencial;
+    indice = c->hacia_padre;
+    for (size_t i = 0; i < c->tamano; i++) potencial[i] *= cociente[indice[i]];
+}
+
+// Subárboles de un hilo en la fase indicada
+static void trabajar(ArbolUniones *arbol, int hilo, Fase fase) {
+    for (int i = arbol->hilo_inicio[hilo]; i < arbol->hilo_inicio[hilo + 1]; i++) {
+        int t = arbol->subarboles_hilo[i];
+        int desde = arbol->subarbol_inicio[t], hasta = arbol->subarbol_inicio[t + 1];
+        if (fase == FASE_RECOGER) {
+            for (int r = desde; r < hasta; r++) recoger(arbol, arbol->recorrido[r]);
+        } else {
+            for (int r = hasta - 1; r >= desde; r--) distribuir(arbol, arbol->recorrido[r]);
+        }
+    }
+}
+
+// Bucle de un hilo de la cuadrilla: esperar una ronda, hacer su parte y avisar
+static void *atender(void *argumento) {
+    Trabajo *trabajo = (Trabajo *)argumento;
+    Cuadrilla *cuadrilla = trabajo->arbol->cuadrilla;
+    unsigned vista = 0;
+    
+    pthread_mutex_lock(&cuadrilla->cerrojo);
+    while (1) {
+        while (cuadrilla->ronda == vista && !cuadrilla->cerrar) {
+            pthread_cond_wait(&cuadrilla->inicio, &cuadrilla->cerrojo);
+        }
+        if (cuadrilla->cerrar) break;
+        vista = cuadrilla->ronda;
+        Fase fase = cuadrilla->fase;
+        pthread_mutex_unlock(&cuadrilla->cerrojo);
+        
+        trabajar(trabajo->arbol, trabajo->hilo, fase);
+        
+        pthread_mutex_lock(&cuadrilla->cerrojo);
+        if (--cuadrilla->pendientes == 0) pthread_cond_signal(&cuadrilla->fin);
+    }
+    pthread_mutex_unlock(&cuadrilla->cerrojo);
+    return NULL;
+}
+
+// Una fase en todos los hilos: el hilo 0 es el que llama, que también hace la
+// parte de los hilos que no se pudieron crear, y espera a los demás
+static void ejecutar_fase(ArbolUniones *arbol, Fase fase) {
+    Cuadrilla *cuadrilla = arbol->cuadrilla;
+    if (cuadrilla == NULL || cuadrilla->num_iniciados == 0) {
+        for (int h = 0; h < arbol->num_hilos; h++) trabajar(arbol, h, fase);
+        return;
+    }
+    
+    pthread_mutex_lock(&cuadrilla->cerrojo);
+    cuadrilla->fase = fase;
+    cuadrilla->pendientes = cuadrilla->num_iniciados;
+    cuadrilla->ronda++;
+    pthread_cond_broadcast(&cuadrilla->inicio);
+    pthread_mutex_unlock(&cuadrilla->cerrojo);
+    
+    trabajar(arbol, 0, fase);
+    for (int h = 1; h < arbol->num_hilos; h++) {
+        if (!cuadrilla->iniciado[h]) trabajar(arbol, h, fase);
+    }
+    
+    pthread_mutex_lock(&cuadrilla->cerrojo);
+    while (cuadrilla->pendientes > 0) {
+        pthread_cond_wait(&cuadrilla->fin, &cuadrilla->cerrojo);
+    }
+    pthread_mutex_unlock(&cuadrilla->cerrojo);
+}
+
+int arbol_calibrar(ArbolUniones *arbol, const int *evidencia, double *log_evidencia) {
+    if (arbol == NULL) return -1;
+    
+    const RedBayesiana *red = arbol->red;
+    arbol->calibrado = 0;
+    if (!red->compilada || red->version != arbol->version) {
+        fprintf(stderr, "Error: La red cambió; hay que volver a crear el árbol de uniones\n");
+        return -1;
+    }
+    for (int v = 0; evidencia != NULL && v < arbol->num_variables; v++) {
+        if (evidencia[v] < -1 || evidencia[v] >= red->estados[v]) {
+            fprintf(stderr, "Error: Estado observado no válido para '%s'\n", red->nombres[v]);
+            return -1;
+        }
+    }
+    
+    arbol->evidencia = evidencia;
+    ejecutar_fase(arbol, FASE_RECOGER);
+    for (int i = arbol->num_cima - 1; i >= 0; i--) recoger(arbol, arbol->cima[i]);
+    arbol->evidencia = NULL;
+    
+    double log_total = 0.0;
+    for (int k = 0; k < arbol->num_cliques; k++) log_total += arbol->cliques[k].log_constante;
+    if (isinf(log_total)) {
+        fprintf(stderr, "Error: La evidencia es imposible (P = 0)\n");
+        return -1;
+    }
+    
+    for (int i = 0; i < arbol->num_cima; i++) distribuir(arbol, arbol->cima[i]);
+    ejecutar_fase(arbol, FASE_DISTRIBUIR);
+    
+    arbol->log_evidencia = log_total;
+    arbol->calibrado = 1;
+    if (log_evidencia != NULL) *log_evidencia = log_total;
+    return 0;
+}
+
+int arbol_marginal(const ArbolUniones *arbol, int v, double *distribucion) {
+    if (arbol == NULL || !arbol->calibrado || v < 0 || v >= arbol->num_variables
+        || distribucion == NULL) {
+        return -1;
+    }
+    
+    const Clique *c = &arbol->cliques[arbol->clique_de[v]];
+    int j = 0;
+    while (c->variables[j] != v) j++;
+    int estados = arbol->red->estados[v];
+    size_t paso = c->pasos[j];
+    size_t bloque = paso * (size_t)estados;
+    
+    double total = 0.0;
+    for (int s = 0; s < estados; s++) {
+        double suma = 0.0;
+        for (size_t inicio = (size_t)s * paso; inicio < c->tamano; inicio += bloque) {
+            for (size_t i = 0; i < paso; i++) suma += c->potencial[inicio + i];
+        }
+        distribucion[s] = suma;
+        total += suma;
+    }
+    for (int s = 0; s < estados; s++) distribucion[s] /= total;
+    return 0;
+}
+
+void arbol_imprimir(const ArbolUniones *arbol) {
+    if (arbol == NULL) return;
+    
+    const RedBayesiana *red = arbol->red;
+    printf("Árbol de uniones: %d cliques, ancho %d, %.0f entradas\n",
+           arbol->num_cliques, arbol->ancho, arbol->entradas);
+    for (int k = 0; k < arbol->num_cliques; k++) {
+        const Clique *c = &arbol->cliques[k];
+        printf("  C%d {", k);
+        for (int j = 0; j < c->num_variables; j++) {
+            printf("%s%s", j > 0 ? ", " : "", red->nombres[c->variables[j]]);
+        }
+        printf("}");
+        if (c->padre >= 0) {
+            printf(" -> C%d por {", c->padre);
+            for (int j = 0; j < c->num_separador; j++) {
+                printf("%s%s", j > 0 ? ", " : "", red->nombres[c->separador_variables[j]]);
+            }
+            printf("}");
+        }
+        printf("\n");
+    }
+    printf("Calendario: %d subárboles en %d hilos, %d cliques por encima de ellos\n",
+           arbol->num_subarboles, arbol->num_hilos, arbol->num_cima);
+}
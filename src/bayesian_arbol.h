@@ -0,0 +1,125 @@
+#ifndef BAYESIAN_ARBOL_H
+#define BAYESIAN_ARBOL_H
+
+#include "bayesian_red.h"
+
+// =============================================================================
+// ÁRBOL DE UNIONES (JUNCTION TREE)
+// =============================================================================
+//
+// Para muchas consultas sobre la misma red con distinta evidencia. La red se
+// compila una vez: el orden de mínimo relleno de red_orden_eliminacion da los
+// cliques del grafo triangulado (cada variable con sus vecinos posteriores,
+// quitando los que caben en otro), que se unen en un bosque por sus
+// separadores. Cada tabla de probabilidad condicional se multiplica en el
+// primer clique que contiene a su familia y los productos se guardan como
+// potenciales base. También se precalcula, para cada entrada de cada clique,
+// el índice de la entrada del separador con su padre y con cada hijo, de modo
+// que marginalizar y absorber mensajes son recorridos lineales sin aritmética
+// de pasos.
+//
+// arbol_calibrar copia los potenciales base, pone a cero las entradas
+// incompatibles con la evidencia y pasa mensajes en dos fases (Hugin):
+// recoger, de las hojas a las raíces, y distribuir, de las raíces a las
+// hojas. Después cada clique es la marginal conjunta de sus variables con la
+// evidencia, y todas las marginales de una variable salen de la misma
+// calibración. Los potenciales se normalizan al recoger y los logaritmos de
+// las constantes dan log P(evidencia) sin desbordes.
+//
+// Los subárboles disjuntos no dependen entre sí: al compilar se cortan los
+// subárboles más caros (por tamaño de sus tablas) hasta tener varios por
+// hilo y se reparten entre los hilos de mayor a menor coste. Cada fase corre
+// los subárboles en paralelo y los cliques que quedan por encima de los
+// cortes en el hilo que llama (después de recoger los subárboles y antes de
+// distribuir hacia ellos). Cada clique solo escribe en su potencial y en su
+// separador con el padre, así que no hace falta sincronizar dentro de una
+// fase. Los hilos se crean una vez en arbol_crear y esperan cada fase en una
+// variable de condición; arbol_destruir los termina.
+
+typedef struct Clique Clique;
+typedef struct Cuadrilla Cuadrilla;
+
+/**
+ * Árbol de uniones compilado de una red
+ * Todo vive en la arena del árbol; la red no se modifica.
+ */
+typedef struct {
+    const RedBayesiana *red;
+    unsigned version;            // Versión de la red con la que se compiló
+    int num_variables;
+    int num_cliques;
+    Clique *cliques;
+    int *clique_de;              // clique_de[v]: menor clique que contiene a v
+    int *clique_tabla;           // Clique en el que se multiplica la tabla de v
+    int ancho;                   // Variables del mayor clique menos 1
+    double entradas;             // Entradas de todos los potenciales
+    
+    // Calendario paralelo
+    int num_hilos;
+    int num_subarboles;
+    int *subarbol_inicio;        // num_subarboles + 1 rangos de recorrido
+    int *recorrido;              // Cliques de cada subárbol en post-orden (hijos antes que padres)
+    int *hilo_inicio;            // num_hilos + 1 rangos de subarboles_hilo
+    int *subarboles_hilo;        // Subárboles asignados a cada hilo
+    int num_cima;
+    int *cima;                   // Cliques sobre los cortes, de arriba abajo
+    Cuadrilla *cuadrilla;        // Hilos de trabajo persistentes (NULL con un solo hilo)
+    
+    const int *evidencia;        // Evidencia de la calibración en curso
+    int calibrado;               // 1 si los potenciales corresponden a la última evidencia
+    double log_evidencia;
+    Arena *memoria;
+} ArbolUniones;
+
+/**
+ * Compilar el árbol de uniones de una red
+ * @param red Red compilada con sus tablas; debe seguir existiendo mientras se use el árbol
+ *        y no volver a compilarse
+ * @param num_hilos Hilos para calibrar (0 = procesadores disponibles)
+ * @return Árbol o NULL si la red no está compilada, un clique es demasiado
+ *         grande o falta memoria
+ */
+ArbolUniones *arbol_crear(const RedBayesiana *red, int num_hilos);
+
+/**
+ * Volver a multiplicar las tablas de la red en los potenciales base
+ * Los potenciales copian las tablas al crear el árbol; tras red_fijar_tabla o
+ * red_fijar_fila basta con esto (la estructura no cambia).
+ * @param arbol Árbol
+ * @return 1 si se cargaron, 0 si la red se volvió a compilar o falta memoria
+ */
+int arbol_cargar_tablas(ArbolUniones *arbol);
+
+/**
+ * Liberar un árbol
+ * @param arbol Árbol (puede ser NULL)
+ */
+void arbol_destruir(ArbolUniones *arbol);
+
+/**
+ * Calibrar el árbol con una evidencia
+ * @param arbol Árbol
+ * @param evidencia Estado observado de cada variable indexado por id, -1 si no se
+ *        observa; NULL si no hay evidencia
+ * @param log_evidencia Recibe log P(evidencia) (puede ser NULL)
+ * @return 0 si se calibró, -1 si la evidencia no es válida o es imposible, o
+ *         la red cambió desde arbol_crear
+ */
+int arbol_calibrar(ArbolUniones *arbol, const int *evidencia, double *log_evidencia);
+
+/**
+ * Distribución a posteriori de una variable tras arbol_calibrar (O(tamaño de su clique))
+ * @param arbol Árbol calibrado
+ * @param v Variable
+ * @param distribucion Recibe estados[v] probabilidades P(v | evidencia)
+ * @return 0 si se calculó, -1 si el árbol no está calibrado o v no es válida
+ */
+int arbol_marginal(const ArbolUniones *arbol, int v, double *distribucion);
+
+/**
+ * Imprimir los cliques, sus separadores y el calendario paralelo
+ * @param arbol Árbol
+ */
+void arbol_imprimir(const ArbolUniones *arbol);
+
+#endif // BAYESIAN_ARBOL_H
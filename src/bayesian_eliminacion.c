@@ -0,0 +1,582 @@
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include "bayesian_eliminacion.h"
+
+// =============================================================================
+// ESTRUCTURAS INTERNAS
+// =============================================================================
+
+// Tabla sobre un conjunto de variables. Las de la red son vistas de sus
+// tablas de probabilidad condicional (con la evidencia aplicada); las que
+// crea la eliminación están en la arena, con la última variable contigua.
+struct Factor {
+    int num_variables;
+    int *variables;
+    size_t *pasos;               // Paso de cada variable en valores
+    const double *valores;
+    Factor *siguiente;           // Siguiente factor de la misma cubeta
+};
+
+// Entrada del montículo de candidatos a eliminar; queda obsoleta si el nodo
+// se elimina o se vuelve a puntuar
+typedef struct {
+    double clave;
+    double desempate;
+    int nodo;
+    unsigned sello;
+} Candidato;
+
+// Sello nuevo para marcar nodos sin limpiar el arreglo de marcas
+static int nuevo_sello(int *marca, int num_marcas, int *sello) {
+    if (*sello == INT_MAX) {
+        memset(marca, 0, (size_t)num_marcas * sizeof(int));
+        *sello = 0;
+    }
+    return ++*sello;
+}
+
+// =============================================================================
+// ORDEN DE ELIMINACIÓN
+// =============================================================================
+
+static int agregar_vecino(int **vecinos, int *grado, int *capacidad, int u, int w) {
+    if (grado[u] == capacidad[u]) {
+        int nueva = capacidad[u] + capacidad[u] / 2;
+        if (nueva < 4) nueva = 4;
+        int *crecido = (int *)realloc(vecinos[u], (size_t)nueva * sizeof(int));
+        if (crecido == NULL) return 0;
+        vecinos[u] = crecido;
+        capacidad[u] = nueva;
+    }
+    vecinos[u][grado[u]++] = w;
+    return 1;
+}
+
+static int candidato_menor(const Candidato *a, const Candidato *b) {
+    if (a->clave != b->clave) return a->clave < b->clave;
+    if (a->desempate != b->desempate) return a->desempate < b->desempate;
+    return a->nodo < b->nodo;
+}
+
+static int monticulo_insertar(Candidato **monticulo, int *tamano, int *capacidad, Candidato nuevo) {
+    if (*tamano == *capacidad) {
+        int nueva = *capacidad + *capacidad / 2 + 16;
+        Candidato *crecido = (Candidato *)realloc(*monticulo, (size_t)nueva * sizeof(Candidato));
+        if (crecido == NULL) return 0;
+        *monticulo = crecido;
+        *capacidad = nueva;
+    }
+    Candidato *m = *monticulo;
+    int i = (*tamano)++;
+    while (i > 0 && candidato_menor(&nuevo, &m[(i - 1) / 2])) {
+        m[i] = m[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    m[i] = nuevo;
+    return 1;
+}
+
+static Candidato monticulo_extraer(Candidato *m, int *tamano) {
+    Candidato primero = m[0];
+    Candidato ultimo = m[--*tamano];
+    int i = 0;
+    for (;;) {
+        int hijo = 2 * i + 1;
+        if (hijo >= *tamano) break;
+        if (hijo + 1 < *tamano && candidato_menor(&m[hijo + 1], &m[hijo])) hijo++;
+        if (!candidato_menor(&m[hijo], &ultimo)) break;
+        m[i] = m[hijo];
+        i = hijo;
+    }
+    if (*tamano > 0) m[i] = ultimo;
+    return primero;
+}
+
+// Relleno (pares de vecinos no adyacentes) y log del tamaño del factor que
+// crearía eliminar v
+static void puntuar(int v, int *const *vecinos, const int *grado, const int *estados,
+                    int *marca, int num_marcas, int *sello, double *relleno, double *peso) {
+    const int *n = vecinos[v];
+    int d = grado[v];
+    double log_tamano = log((double)estados[v]);
+    long long faltan = 0;
+    
+    for (int i = 0; i < d; i++) {
+        log_tamano += log((double)estados[n[i]]);
+        int s = nuevo_sello(marca, num_marcas, sello);
+        for (int k = 0; k < grado[n[i]]; k++) marca[vecinos[n[i]][k]] = s;
+        for (int j = i + 1; j < d; j++) {
+            if (marca[n[j]] != s) faltan++;
+        }
+    }
+    *relleno = (double)faltan;
+    *peso = log_tamano;
+}
+
+int red_orden_eliminacion(const RedBayesiana *red, HeuristicaOrden heuristica, int *orden,
+                          int *ancho, double *entradas_max) {
+    if (red == NULL || !red->compilada || orden == NULL) {
+        fprintf(stderr, "Error: Argumentos no válidos en red_orden_eliminacion\n");
+        return 0;
+    }
+    
+    int V = red->num_nodos;
+    size_t n = (size_t)V + 1;
+    int **vecinos = (int **)calloc(n, sizeof(int *));
+    int *grado = (int *)calloc(n, sizeof(int));
+    int *capacidad = (int *)calloc(n, sizeof(int));
+    int *marca = (int *)calloc(n, sizeof(int));
+    unsigned *sello_nodo = (unsigned *)calloc(n, sizeof(unsigned));
+    char *eliminado = (char *)calloc(n, 1);
+    Candidato *monticulo = NULL;
+    int tamano = 0, capacidad_monticulo = 0;
+    int sello = 0;
+    int ok = vecinos != NULL && grado != NULL && capacidad != NULL && marca != NULL
+             && sello_nodo != NULL && eliminado != NULL;
+    
+    // Grafo moral: padres, hijos y demás padres de cada hijo
+    for (int v = 0; ok && v < V; v++) {
+        int s = nuevo_sello(marca, V, &sello);
+        marca[v] = s;
+        for (int k = red->inicio_padres[v]; ok && k < red->inicio_padres[v + 1]; k++) {
+            int p = red->padres[k];
+            if (marca[p] != s) {
+                marca[p] = s;
+                ok = agregar_vecino(vecinos, grado, capacidad, v, p);
+            }
+        }
+        for (int h = red->inicio_hijos[v]; ok && h < red->inicio_hijos[v + 1]; h++) {
+            int c = red->hijos[h];
+            if (marca[c] != s) {
+                marca[c] = s;
+                ok = agregar_vecino(vecinos, grado, capacidad, v, c);
+            }
+            for (int k = red->inicio_padres[c]; ok && k < red->inicio_padres[c + 1]; k++) {
+                int p = red->padres[k];
+                if (marca[p] != s) {
+                    marca[p] = s;
+                    ok = agregar_vecino(vecinos, grado, capacidad, v, p);
+                }
+            }
+        }
+    }
+    
+    for (int v = 0; ok && v < V; v++) {
+        Candidato c = {0.0, 0.0, v, 0};
+        double relleno, peso;
+        puntuar(v, vecinos, grado, red->estados, marca, V, &sello, &relleno, &peso);
+        c.clave = heuristica == ORDEN_MIN_PESO ? peso : relleno;
+        c.desempate = heuristica == ORDEN_MIN_PESO ? relleno : peso;
+        ok = monticulo_insertar(&monticulo, &tamano, &capacidad_monticulo, c);
+    }
+    
+    int ancho_max = 0;
+    double entradas = 0.0;
+    for (int paso = 0; ok && paso < V; paso++) {
+        Candidato c;
+        do {
+            c = monticulo_extraer(monticulo, &tamano);
+        } while (eliminado[c.nodo] || c.sello != sello_nodo[c.nodo]);
+        
+        int x = c.nodo;
+        int d = grado[x];
+        const int *n_x = vecinos[x];
+        orden[paso] = x;
+        eliminado[x] = 1;
+        
+        double tabla = (double)red->estados[x];
+        for (int i = 0; i < d; i++) tabla *= red->estados[n_x[i]];
+        if (d > ancho_max) ancho_max = d;
+        if (tabla > entradas) entradas = tabla;
+        
+        // Unir los vecinos de x entre sí
+        for (int i = 0; ok && i < d; i++) {
+            int a = n_x[i];
+            int s = nuevo_sello(marca, V, &sello);
+            for (int k = 0; k < grado[a]; k++) marca[vecinos[a][k]] = s;
+            for (int j = i + 1; ok && j < d; j++) {
+                int b = n_x[j];
+                if (marca[b] != s) {
+                    ok = agregar_vecino(vecinos, grado, capacidad, a, b)
+                         && agregar_vecino(vecinos, grado, capacidad, b, a);
+                }
+            }
+        }
+        
+        // Quitar x de sus vecinos y volver a puntuarlos (las puntuaciones de
+        // los demás nodos solo pueden bajar: el heurístico es el voraz usual)
+        for (int i = 0; ok && i < d; i++) {
+            int a = n_x[i];
+            for (int k = 0; k < grado[a]; k++) {
+                if (vecinos[a][k] == x) {
+                    vecinos[a][k] = vecinos[a][--grado[a]];
+                    break;
+                }
+            }
+        }
+        for (int i = 0; ok && i < d; i++) {
+            int a = n_x[i];
+            double relleno, peso;
+            puntuar(a, vecinos, grado, red->estados, marca, V, &sello, &relleno, &peso);
+            Candidato nuevo = {heuristica == ORDEN_MIN_PESO ? peso : relleno,
+                               heuristica == ORDEN_MIN_PESO ? relleno : peso, a, ++sello_nodo[a]};
+            ok = monticulo_insertar(&monticulo, &tamano, &capacidad_monticulo, nuevo);
+        }
+    }
+    
+    if (vecinos != NULL) {
+        for (int v = 0; v < V; v++) free(vecinos[v]);
+    }
+    free(vecinos);
+    free(grado);
+    free(capacidad);
+    free(marca);
+    free(sello_nodo);
+    free(eliminado);
+    free(monticulo);
+    if (!ok) {
+        fprintf(stderr, "Error: Sin memoria para el orden de eliminación\n");
+        return 0;
+    }
+    if (ancho != NULL) *ancho = ancho_max;
+    if (entradas_max != NULL) *entradas_max = entradas;
+    return 1;
+}
+
+// =============================================================================
+// MOTOR
+// =============================================================================
+
+// Crecer los búferes hasta V variables y recalcular el orden si la red cambió
+static int preparar(Eliminacion *motor) {
+    const RedBayesiana *red = motor->red;
+    if (!red->compilada) {
+        fprintf(stderr, "Error: La red no está compilada\n");
+        return 0;
+    }
+    if (motor->orden != NULL && motor->version == red->version) return 1;
+    
+    int V = red->num_nodos;
+    if (motor->orden == NULL || V > motor->capacidad) {
+        size_t n = (size_t)V + 1;
+        int *orden = (int *)realloc(motor->orden, n * sizeof(int));
+        if (orden != NULL) motor->orden = orden;
+        int *posicion = (int *)realloc(motor->posicion, n * sizeof(int));
+        if (posicion != NULL) motor->posicion = posicion;
+        int *relevante = (int *)realloc(motor->relevante, n * sizeof(int));
+        if (relevante != NULL) motor->relevante = relevante;
+        int *pila = (int *)realloc(motor->pila, n * sizeof(int));
+        if (pila != NULL) motor->pila = pila;
+        int *marca = (int *)realloc(motor->marca, n * sizeof(int));
+        if (marca != NULL) motor->marca = marca;
+        Factor **cubetas = (Factor **)realloc(motor->cubetas, n * sizeof(Factor *));
+        if (cubetas != NULL) motor->cubetas = cubetas;
+        if (orden == NULL || posicion == NULL || relevante == NULL || pila == NULL || marca == NULL
+            || cubetas == NULL) {
+            fprintf(stderr, "Error: Sin memoria para el motor de eliminación\n");
+            return 0;
+        }
+        memset(motor->relevante, 0, n * sizeof(int));
+        memset(motor->marca, 0, n * sizeof(int));
+        motor->sello_consulta = 0;
+        motor->sello = 0;
+        motor->capacidad = V;
+    }
+    
+    if (!red_orden_eliminacion(red, motor->heuristica, motor->orden, &motor->ancho, &motor->entradas_max)) {
+        return 0;
+    }
+    for (int p = 0; p < V; p++) motor->posicion[motor->orden[p]] = p;
+    motor->version = red->version;
+    motor->calculos_orden++;
+    return 1;
+}
+
+Eliminacion *eliminacion_crear(const RedBayesiana *red, HeuristicaOrden heuristica) {
+    if (red == NULL) return NULL;
+    
+    Eliminacion *motor = (Eliminacion *)calloc(1, sizeof(Eliminacion));
+    if (motor == NULL) {
+        fprintf(stderr, "Error: Sin memoria para el motor de eliminación\n");
+        return NULL;
+    }
+    motor->red = red;
+    motor->heuristica = heuristica;
+    motor->memoria = arena_create(0);
+    if (motor->memoria == NULL || !preparar(motor)) {
+        eliminacion_destruir(motor);
+        return NULL;
+    }
+    return motor;
+}
+
+void eliminacion_destruir(Eliminacion *motor) {
+    if (motor == NULL) return;
+    
+    free(motor->orden);
+    free(motor->posicion);
+    free(motor->relevante);
+    free(motor->pila);
+    free(motor->marca);
+    free(motor->cubetas);
+    arena_destroy(motor->memoria);
+    free(motor);
+}
+
+// =============================================================================
+// FACTORES
+// =============================================================================
+
+// Poner un factor en la cubeta de su primera variable a eliminar; la consulta
+// va a la última cubeta y los factores sin variables son constantes
+static void colocar(Eliminacion *motor, Factor *f, int consulta, double *log_constante) {
+    if (f->num_variables == 0) {
+        *log_constante += log(f->valores[0]);
+        return;
+    }
+    
+    int cubeta = motor->red->num_nodos;
+    for (int i = 0; i < f->num_variables; i++) {
+        int v = f->variables[i];
+        if (v != consulta && motor->posicion[v] < cubeta) cubeta = motor->posicion[v];
+    }
+    f->siguiente = motor->cubetas[cubeta];
+    motor->cubetas[cubeta] = f;
+}
+
+// Multiplicar la lista de factores y sumar la variable x (ninguna si x < 0)
+// en un solo recorrido: el resultado se escribe en orden y x es el índice más
+// interno, así que cada entrada es una suma corta de productos
+static Factor *multiplicar_y_sumar(Eliminacion *motor, Factor *lista, int x, double *log_constante) {
+    const RedBayesiana *red = motor->red;
+    Arena *memoria = motor->memoria;
+    
+    int n = 0, total = 0;
+    for (Factor *f = lista; f != NULL; f = f->siguiente) {
+        n++;
+        total += f->num_variables;
+    }
+    const double **valores = (const double **)arena_alloc(memoria, (size_t)n * sizeof(double *));
+    int *variables = (int *)arena_alloc(memoria, (size_t)total * sizeof(int));
+    size_t *indices = (size_t *)arena_alloc(memoria, (size_t)n * sizeof(size_t));
+    if (valores == NULL || variables == NULL || indices == NULL) return NULL;
+    
+    // Alcance del resultado: la unión de los alcances sin x, por id creciente
+    int s = nuevo_sello(motor->marca, red->num_nodos, &motor->sello);
+    int nv = 0;
+    for (Factor *f = lista; f != NULL; f = f->siguiente) {
+        for (int i = 0; i < f->num_variables; i++) {
+            int v = f->variables[i];
+            if (v != x && motor->marca[v] != s) {
+                motor->marca[v] = s;
+                int j = nv++;
+                while (j > 0 && variables[j - 1] > v) {
+                    variables[j] = variables[j - 1];
+                    j--;
+                }
+                variables[j] = v;
+            }
+        }
+    }
+    
+    Factor *resultado = (Factor *)arena_alloc(memoria, sizeof(Factor));
+    size_t *pasos_resultado = (size_t *)arena_alloc(memoria, (size_t)(nv > 0 ? nv : 1) * sizeof(size_t));
+    // pasos[k * (nv + 1) + l]: paso de la variable l del resultado en el factor k; l = nv es x
+    size_t *pasos = (size_t *)arena_alloc(memoria, (size_t)n * (nv + 1) * sizeof(size_t));
+    int *asignacion = (int *)arena_alloc(memoria, (size_t)(nv > 0 ? nv : 1) * sizeof(int));
+    if (resultado == NULL || pasos_resultado == NULL || pasos == NULL || asignacion == NULL) return NULL;
+    
+    size_t tamano = 1;
+    for (int l = nv - 1; l >= 0; l--) {
+        size_t estados = (size_t)red->estados[variables[l]];
+        pasos_resultado[l] = tamano;
+        if (tamano > SIZE_MAX / sizeof(double) / estados) {
+            fprintf(stderr, "Error: Factor demasiado grande al eliminar variables\n");
+            return NULL;
+        }
+        tamano *= estados;
+    }
+    double *tabla = (double *)arena_alloc_aligned(memoria, tamano * sizeof(double), ARENA_BLOCK_ALIGNMENT);
+    if (tabla == NULL) return NULL;
+    
+    // La pila no se usa durante la eliminación: sirve de mapa variable -> l
+    for (int l = 0; l < nv; l++) motor->pila[variables[l]] = l;
+    if (x >= 0) motor->pila[x] = nv;
+    int k = 0;
+    for (Factor *f = lista; f != NULL; f = f->siguiente, k++) {
+        size_t *fila = pasos + (size_t)k * (nv + 1);
+        memset(fila, 0, (size_t)(nv + 1) * sizeof(size_t));
+        for (int i = 0; i < f->num_variables; i++) fila[motor->pila[f->variables[i]]] = f->pasos[i];
+        valores[k] = f->valores;
+        indices[k] = 0;
+    }
+    
+    int estados_x = x >= 0 ? red->estados[x] : 1;
+    double maximo = 0.0;
+    memset(asignacion, 0, (size_t)(nv > 0 ? nv : 1) * sizeof(int));
+    for (size_t i = 0; i < tamano; i++) {
+        double suma = 0.0;
+        for (int e = 0; e < estados_x; e++) {
+            double producto = 1.0;
+            for (int f = 0; f < n; f++) {
+                producto *= valores[f][indices[f] + (size_t)e * pasos[(size_t)f * (nv + 1) + nv]];
+            }
+            suma += producto;
+        }
+        tabla[i] = suma;
+        if (suma > maximo) maximo = suma;
+        
+        // Siguiente asignación (la última variable varía más rápido)
+        for (int l = nv - 1; l >= 0; l--) {
+            int estados = red->estados[variables[l]];
+            if (++asignacion[l] < estados) {
+                for (int f = 0; f < n; f++) indices[f] += pasos[(size_t)f * (nv + 1) + l];
+                break;
+            }
+            asignacion[l] = 0;
+            for (int f = 0; f < n; f++) indices[f] -= (size_t)(estados - 1) * pasos[(size_t)f * (nv + 1) + l];
+        }
+    }
+    
+    // Reescalar por el máximo y llevar su logaritmo a la constante
+    if (maximo > 0.0) {
+        double inverso = 1.0 / maximo;
+        for (size_t i = 0; i < tamano; i++) tabla[i] *= inverso;
+        *log_constante += log(maximo);
+    } else {
+        *log_constante = -INFINITY;
+    }
+    
+    resultado->num_variables = nv;
+    resultado->variables = variables;
+    resultado->pasos = pasos_resultado;
+    resultado->valores = tabla;
+    resultado->siguiente = NULL;
+    return resultado;
+}
+
+// Vista de la tabla de v con la evidencia aplicada
+static Factor *factor_de_tabla(Eliminacion *motor, int v, const int *evidencia) {
+    const RedBayesiana *red = motor->red;
+    int padres = red->inicio_padres[v + 1] - red->inicio_padres[v];
+    Factor *f = (Factor *)arena_alloc(motor->memoria, sizeof(Factor));
+    int *variables = (int *)arena_alloc(motor->memoria, (size_t)(padres + 1) * sizeof(int));
+    size_t *pasos = (size_t *)arena_alloc(motor->memoria, (size_t)(padres + 1) * sizeof(size_t));
+    if (f == NULL || variables == NULL || pasos == NULL) return NULL;
+    
+    const double *valores = red->tablas + red->inicio_tabla[v];
+    int n = 0;
+    for (int k = red->inicio_padres[v]; k <= red->inicio_padres[v + 1]; k++) {
+        // La última posición es la propia v, con paso 1
+        int u = k < red->inicio_padres[v + 1] ? red->padres[k] : v;
+        size_t paso = k < red->inicio_padres[v + 1] ? red->pasos[k] : 1;
+        if (evidencia != NULL && evidencia[u] >= 0) {
+            valores += (size_t)evidencia[u] * paso;
+        } else {
+            variables[n] = u;
+            pasos[n] = paso;
+            n++;
+        }
+    }
+    f->num_variables = n;
+    f->variables = variables;
+    f->pasos = pasos;
+    f->valores = valores;
+    f->siguiente = NULL;
+    return f;
+}
+
+// =============================================================================
+// CONSULTAS
+// =============================================================================
+
+int eliminacion_consultar(Eliminacion *motor, int consulta, const int *evidencia,
+                          double *distribucion, double *log_evidencia) {
+    if (motor == NULL || distribucion == NULL || !preparar(motor)) {
+        fprintf(stderr, "Error: Argumentos no válidos en eliminacion_consultar\n");
+        return -1;
+    }
+    const RedBayesiana *red = motor->red;
+    int V = red->num_nodos;
+    if (consulta < 0 || consulta >= V) {
+        fprintf(stderr, "Error: Variable de consulta no válida (%d)\n", consulta);
+        return -1;
+    }
+    for (int v = 0; evidencia != NULL && v < V; v++) {
+        if (evidencia[v] >= red->estados[v]) {
+            fprintf(stderr, "Error: Estado observado no válido para '%s'\n", red->nombres[v]);
+            return -1;
+        }
+    }
+    arena_reset(motor->memoria);
+    
+    // Solo influyen la consulta, la evidencia y sus antepasados
+    int s = nuevo_sello(motor->relevante, V, &motor->sello_consulta);
+    int tope = 0;
+    motor->relevante[consulta] = s;
+    motor->pila[tope++] = consulta;
+    for (int v = 0; evidencia != NULL && v < V; v++) {
+        if (evidencia[v] >= 0 && motor->relevante[v] != s) {
+            motor->relevante[v] = s;
+            motor->pila[tope++] = v;
+        }
+    }
+    while (tope > 0) {
+        int v = motor->pila[--tope];
+        for (int k = red->inicio_padres[v]; k < red->inicio_padres[v + 1]; k++) {
+            int p = red->padres[k];
+            if (motor->relevante[p] != s) {
+                motor->relevante[p] = s;
+                motor->pila[tope++] = p;
+            }
+        }
+    }
+    
+    for (int p = 0; p <= V; p++) motor->cubetas[p] = NULL;
+    double log_constante = 0.0;
+    for (int v = 0; v < V; v++) {
+        if (motor->relevante[v] != s) continue;
+        Factor *f = factor_de_tabla(motor, v, evidencia);
+        if (f == NULL) {
+            fprintf(stderr, "Error: Sin memoria para los factores de la consulta\n");
+            return -1;
+        }
+        colocar(motor, f, consulta, &log_constante);
+    }
+    
+    // Eliminar por cubetas en el orden guardado
+    for (int p = 0; p < V; p++) {
+        if (motor->cubetas[p] == NULL) continue;
+        Factor *f = multiplicar_y_sumar(motor, motor->cubetas[p], motor->orden[p], &log_constante);
+        if (f == NULL) {
+            fprintf(stderr, "Error: Sin memoria al eliminar '%s'\n", red->nombres[motor->orden[p]]);
+            return -1;
+        }
+        colocar(motor, f, consulta, &log_constante);
+    }
+    
+    // La última cubeta contiene los factores sobre la consulta
+    int estados = red->estados[consulta];
+    double suma = 1.0;
+    if (evidencia != NULL && evidencia[consulta] >= 0) {
+        for (int e = 0; e < estados; e++) distribucion[e] = e == evidencia[consulta] ? 1.0 : 0.0;
+    } else {
+        Factor *f = multiplicar_y_sumar(motor, motor->cubetas[V], -1, &log_constante);
+        if (f == NULL) {
+            fprintf(stderr, "Error: Sin memoria al combinar los factores de la consulta\n");
+            return -1;
+        }
+        suma = 0.0;
+        for (int e = 0; e < estados; e++) suma += f->valores[(size_t)e * f->pasos[0]];
+        for (int e = 0; e < estados; e++) distribucion[e] = f->valores[(size_t)e * f->pasos[0]] / suma;
+    }
+    
+    double log_p = log_constante + log(suma);
+    if (log_evidencia != NULL) *log_evidencia = log_p;
+    if (!(suma > 0.0) || isinf(log_p) || isnan(log_p)) {
+        fprintf(stderr, "Error: La evidencia tiene probabilidad 0\n");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#ifndef BAYESIAN_ELIMINACION_H
+#define BAYESIAN_ELIMINACION_H
+
+#include "bayesian_red.h"
+
+// =============================================================================
+// INFERENCIA EXACTA POR ELIMINACIÓN DE VARIABLES
+// =============================================================================
+//
+// Calcula P(consulta | evidencia) sobre una red compilada. Cada tabla de
+// probabilidad condicional se usa como factor sin copiarla: la evidencia solo
+// desplaza el inicio y quita variables del factor. Se descartan las variables
+// que no son antepasadas de la consulta ni de la evidencia (no influyen) y el
+// resto se elimina por cubetas: los factores que contienen a la variable X se
+// multiplican y X se suma en un solo recorrido, con X como índice más interno,
+// escribiendo el resultado de forma contigua en la arena del motor, que se
+// vacía en cada consulta. Los resultados se reescalan por su máximo para que
+// P(evidencia) no se desborde por abajo en redes grandes.
+//
+// El orden de eliminación se calcula una vez por red con una heurística
+// voraz sobre el grafo moral (mínimo relleno o mínimo peso) y se guarda en el
+// motor; solo se recalcula si la red se vuelve a compilar.
+
+/**
+ * Heurísticas del orden de eliminación
+ */
+typedef enum {
+    ORDEN_MIN_RELLENO = 0,   // Menos aristas nuevas entre los vecinos (desempate: peso)
+    ORDEN_MIN_PESO           // Menor tabla del factor creado (desempate: relleno)
+} HeuristicaOrden;
+
+typedef struct Factor Factor;
+
+/**
+ * Motor de eliminación de variables para una red
+ */
+typedef struct {
+    const RedBayesiana *red;
+    HeuristicaOrden heuristica;
+    unsigned version;            // Versión de la red para la que se calculó el orden
+    int *orden;                  // Orden de eliminación de todas las variables
+    int *posicion;               // posicion[v]: índice de v en orden
+    int ancho;                   // Ancho inducido del orden (vecinos máximos al eliminar)
+    double entradas_max;         // Mayor tabla que puede crear el orden
+    int calculos_orden;          // Veces que se ha calculado el orden
+    
+    int capacidad;               // Variables para las que hay búferes
+    int *relevante;              // sello_consulta si v es la consulta, evidencia o un antepasado
+    int sello_consulta;
+    int *pila;
+    int *marca;                  // Sellos para unir el alcance de los factores
+    int sello;
+    Factor **cubetas;            // capacidad + 1 listas de factores por posición de eliminación
+    Arena *memoria;              // Factores de la consulta en curso
+} Eliminacion;
+
+/**
+ * Calcular un orden de eliminación voraz sobre el grafo moral de la red
+ * @param red Red compilada
+ * @param heuristica ORDEN_MIN_RELLENO u ORDEN_MIN_PESO
+ * @param orden Recibe las num_nodos variables en orden de eliminación
+ * @param ancho Recibe el ancho inducido (puede ser NULL)
+ * @param entradas_max Recibe el tamaño de la mayor tabla creada (puede ser NULL)
+ * @return 1 si se calculó, 0 si la red no está compilada o falta memoria
+ */
+int red_orden_eliminacion(const RedBayesiana *red, HeuristicaOrden heuristica, int *orden,
+                          int *ancho, double *entradas_max);
+
+/**
+ * Crear un motor de eliminación y calcular su orden
+ * @param red Red compilada; debe seguir existiendo mientras se use el motor
+ * @param heuristica Heurística del orden
+ * @return Motor o NULL si la red no está compilada o falta memoria
+ */
+Eliminacion *eliminacion_crear(const RedBayesiana *red, HeuristicaOrden heuristica);
+
+/**
+ * Liberar un motor
+ * @param motor Motor (puede ser NULL)
+ */
+void eliminacion_destruir(Eliminacion *motor);
+
+/**
+ * Distribución a posteriori de una variable
+ * @param motor Motor
+ * @param consulta Variable consultada
+ * @param evidencia Estado observado de cada variable indexado por id, -1 si no se
+ *        observa; NULL si no hay evidencia
+ * @param distribucion Recibe estados[consulta] probabilidades P(consulta | evidencia)
+ * @param log_evidencia Recibe log P(evidencia) (puede ser NULL)
+ * @return 0 si se calculó, -1 si los argumentos no son válidos, la evidencia es
+ *         imposible o falta memoria
+ */
+int eliminacion_consultar(Eliminacion *motor, int consulta, const int *evidencia,
+                          double *distribucion, double *log_evidencia);
+
+#endif // BAYESIAN_ELIMINACION_H
@@ -0,0 +1,545 @@
+#include <stdint.h>
+#include <math.h>
+#include "bayesian_red.h"
+
+// Tolerancia al comprobar que una fila de una tabla suma 1
+#define TOLERANCIA_FILA 1e-6
+
+// =============================================================================
+// ESTRUCTURAS INTERNAS
+// =============================================================================
+
+// Hash FNV-1a de un nombre
+static unsigned hash_nombre(const char *nombre) {
+    unsigned hash = 2166136261u;
+    for (; *nombre != '\0'; nombre++) {
+        hash ^= (unsigned char)*nombre;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Crecer un arreglo de enteros 1.5x (o hasta minimo); 1 si hay espacio
+static int crecer_enteros(int **arreglo, int *capacidad, int minimo) {
+    if (minimo <= *capacidad) return 1;
+    
+    long long nueva = (long long)*capacidad + *capacidad / 2;
+    if (nueva < minimo) nueva = minimo;
+    if (nueva < 16) nueva = 16;
+    if (nueva > 2147483647LL) nueva = 2147483647LL;
+    int *crecido = (int *)realloc(*arreglo, (size_t)nueva * sizeof(int));
+    if (crecido == NULL) return 0;
+    *arreglo = crecido;
+    *capacidad = (int)nueva;
+    return 1;
+}
+
+// Rehacer la tabla hash con al menos 2 ranuras por nodo (carga ≤ 50%)
+static int rehacer_tabla(RedBayesiana *red, int nodos) {
+    unsigned tamano = 2;
+    while (tamano < 2u * (unsigned)nodos) tamano <<= 1;
+    if (red->ranuras != NULL && tamano <= red->mascara + 1) return 1;
+    
+    int *ranuras = (int *)malloc(tamano * sizeof(int));
+    if (ranuras == NULL) return 0;
+    for (unsigned r = 0; r < tamano; r++) ranuras[r] = -1;
+    
+    unsigned mascara = tamano - 1;
+    for (int id = 0; id < red->num_nodos; id++) {
+        unsigned r = hash_nombre(red->nombres[id]) & mascara;
+        while (ranuras[r] >= 0) r = (r + 1) & mascara;
+        ranuras[r] = id;
+    }
+    free(red->ranuras);
+    red->ranuras = ranuras;
+    red->mascara = mascara;
+    return 1;
+}
+
+// =============================================================================
+// CONSTRUCCIÓN
+// =============================================================================
+
+RedBayesiana *red_crear(int nodos_previstos) {
+    if (nodos_previstos < 0) nodos_previstos = 0;
+    
+    RedBayesiana *red = (RedBayesiana *)calloc(1, sizeof(RedBayesiana));
+    if (red == NULL) {
+        fprintf(stderr, "Error: Sin memoria para la red bayesiana\n");
+        return NULL;
+    }
+    // Nombres de hasta 16 caracteres caben en el primer bloque de la arena
+    red->memoria = arena_create((size_t)nodos_previstos * 16);
+    red->capacidad_nodos = nodos_previstos > 0 ? nodos_previstos : 16;
+    red->nombres = (char **)malloc((size_t)red->capacidad_nodos * sizeof(char *));
+    red->estados = (int *)malloc((size_t)red->capacidad_nodos * sizeof(int));
+    if (red->memoria == NULL || red->nombres == NULL || red->estados == NULL
+        || !rehacer_tabla(red, red->capacidad_nodos)) {
+        fprintf(stderr, "Error: Sin memoria para la red bayesiana\n");
+        red_destruir(red);
+        return NULL;
+    }
+    return red;
+}
+
+void red_destruir(RedBayesiana *red) {
+    if (red == NULL) return;
+    
+    free(red->nombres);
+    free(red->estados);
+    free(red->ranuras);
+    free(red->arista_padre);
+    free(red->arista_hijo);
+    free(red->inicio_padres);  // Bloque de la adyacencia CSR
+    free(red->inicio_tabla);   // Bloque de inicio_tabla y pasos
+    free(red->tablas);
+    arena_destroy(red->memoria);
+    free(red);
+}
+
+int red_buscar(const RedBayesiana *red, const char *nombre) {
+    if (red == NULL || nombre == NULL) return -1;
+    
+    unsigned r = hash_nombre(nombre) & red->mascara;
+    while (red->ranuras[r] >= 0) {
+        if (strcmp(red->nombres[red->ranuras[r]], nombre) == 0) {
+            return red->ranuras[r];
+        }
+        r = (r + 1) & red->mascara;
+    }
+    return -1;
+}
+
+const char *red_nombre(const RedBayesiana *red, int id) {
+    if (red == NULL || id < 0 || id >= red->num_nodos) return NULL;
+    return red->nombres[id];
+}
+
+int red_agregar_nodo(RedBayesiana *red, const char *nombre) {
+    if (red == NULL || nombre == NULL || nombre[0] == '\0' || strpbrk(nombre, " \t\r\n") != NULL) {
+        fprintf(stderr, "Error: Nombre de variable no válido\n");
+        return -1;
+    }
+    if (red_buscar(red, nombre) >= 0) {
+        fprintf(stderr, "Error: La variable '%s' ya existe\n", nombre);
+        return -1;
+    }
+    if (red->num_nodos == 2147483647) {
+        fprintf(stderr, "Error: Demasiadas variables\n");
+        return -1;
+    }
+    
+    int id = red->num_nodos;
+    if (id == red->capacidad_nodos) {
+        int capacidad = red->capacidad_nodos + red->capacidad_nodos / 2;
+        if (capacidad <= id) capacidad = 2147483647;
+        char **nombres = (char **)realloc(red->nombres, (size_t)capacidad * sizeof(char *));
+        if (nombres != NULL) red->nombres = nombres;
+        int *estados = nombres != NULL ? (int *)realloc(red->estados, (size_t)capacidad * sizeof(int)) : NULL;
+        if (estados == NULL) {
+            fprintf(stderr, "Error: Sin memoria para la variable '%s'\n", nombre);
+            return -1;
+        }
+        red->estados = estados;
+        red->capacidad_nodos = capacidad;
+    }
+    char *copia = arena_strdup(red->memoria, nombre);
+    if (copia == NULL || !rehacer_tabla(red, id + 1)) {
+        fprintf(stderr, "Error: Sin memoria para la variable '%s'\n", nombre);
+        return -1;
+    }
+    
+    red->nombres[id] = copia;
+    red->estados[id] = 2;
+    red->num_nodos = id + 1;
+    unsigned r = hash_nombre(copia) & red->mascara;
+    while (red->ranuras[r] >= 0) r = (r + 1) & red->mascara;
+    red->ranuras[r] = id;
+    red->compilada = 0;
+    return id;
+}
+
+int red_agregar_arista(RedBayesiana *red, int padre, int hijo) {
+    if (red == NULL || padre < 0 || padre >= red->num_nodos || hijo < 0 || hijo >= red->num_nodos
+        || padre == hijo) {
+        fprintf(stderr, "Error: Arista no válida (%d -> %d)\n", padre, hijo);
+        return 0;
+    }
+    
+    int capacidad = red->capacidad_aristas;
+    if (!crecer_enteros(&red->arista_padre, &capacidad, red->num_aristas + 1)
+        || !crecer_enteros(&red->arista_hijo, &red->capacidad_aristas, red->num_aristas + 1)) {
+        fprintf(stderr, "Error: Sin memoria para la arista %d -> %d\n", padre, hijo);
+        return 0;
+    }
+    red->arista_padre[red->num_aristas] = padre;
+    red->arista_hijo[red->num_aristas] = hijo;
+    red->num_aristas++;
+    red->compilada = 0;
+    return 1;
+}
+
+int red_fijar_estados(RedBayesiana *red, int id, int estados) {
+    if (red == NULL || id < 0 || id >= red->num_nodos || estados < 2) {
+        fprintf(stderr, "Error: Número de estados no válido\n");
+        return 0;
+    }
+    if (red->estados[id] != estados) {
+        red->estados[id] = estados;
+        red->compilada = 0;
+    }
+    return 1;
+}
+
+// =============================================================================
+// COMPILACIÓN (CSR, ORDEN TOPOLÓGICO Y TABLAS)
+// =============================================================================
+
+// Agrupar las aristas por clave (ordenación por conteo estable):
+// valores[inicio[v]..inicio[v+1]) recibe, en orden de inserción, el otro
+// extremo de cada arista cuya clave es v, o su índice si otros es NULL
+static void agrupar_aristas(const int *claves, const int *otros, int num_aristas, int num_nodos,
+                            int *inicio, int *valores) {
+    memset(inicio, 0, (size_t)(num_nodos + 1) * sizeof(int));
+    for (int e = 0; e < num_aristas; e++) inicio[claves[e] + 1]++;
+    for (int v = 0; v < num_nodos; v++) inicio[v + 1] += inicio[v];
+    
+    // inicio[v] avanza mientras se llena y se restaura al final
+    for (int e = 0; e < num_aristas; e++) valores[inicio[claves[e]]++] = otros != NULL ? otros[e] : e;
+    for (int v = num_nodos; v > 0; v--) inicio[v] = inicio[v - 1];
+    inicio[0] = 0;
+}
+
+// Reservar las tablas de la adyacencia ya compilada, calcular los pasos de
+// cada padre y llenarlas con distribuciones uniformes
+static int construir_tablas(RedBayesiana *red) {
+    int V = red->num_nodos;
+    int E = red->num_aristas;
+    size_t *bloque = (size_t *)malloc(((size_t)V + 1 + (size_t)E) * sizeof(size_t));
+    if (bloque == NULL) {
+        fprintf(stderr, "Error: Sin memoria para las tablas de la red\n");
+        return 0;
+    }
+    size_t *inicio_tabla = bloque;
+    size_t *pasos = bloque + V + 1;
+    
+    // El último padre tiene el paso más corto: el número de estados del hijo
+    size_t total = 0;
+    for (int v = 0; v < V; v++) {
+        size_t paso = (size_t)red->estados[v];
+        for (int k = red->inicio_padres[v + 1] - 1; k >= red->inicio_padres[v]; k--) {
+            pasos[k] = paso;
+            size_t estados_padre = (size_t)red->estados[red->padres[k]];
+            if (paso > SIZE_MAX / sizeof(double) / estados_padre) {
+                paso = 0;
+                break;
+            }
+            paso *= estados_padre;
+        }
+        if (paso == 0 || total > SIZE_MAX / sizeof(double) - paso) {
+            fprintf(stderr, "Error: La tabla de '%s' es demasiado grande\n", red->nombres[v]);
+            free(bloque);
+            return 0;
+        }
+        inicio_tabla[v] = total;
+        total += paso;
+    }
+    inicio_tabla[V] = total;
+    
+    double *tablas = (double *)malloc((total > 0 ? total : 1) * sizeof(double));
+    if (tablas == NULL) {
+        fprintf(stderr, "Error: Sin memoria para las tablas de la red (%zu valores)\n", total);
+        free(bloque);
+        return 0;
+    }
+    for (int v = 0; v < V; v++) {
+        double uniforme = 1.0 / red->estados[v];
+        for (size_t i = inicio_tabla[v]; i < inicio_tabla[v + 1]; i++) tablas[i] = uniforme;
+    }
+    
+    free(red->inicio_tabla);
+    free(red->tablas);
+    red->inicio_tabla = inicio_tabla;
+    red->pasos = pasos;
+    red->tablas = tablas;
+    return 1;
+}
+
+int red_compilar(RedBayesiana *red) {
+    if (red == NULL) return 0;
+    if (red->compilada) return 1;
+    
+    int V = red->num_nodos;
+    int E = red->num_aristas;
+    
+    // Un solo bloque: [inicio_padres | inicio_hijos | padres | hijos | orden]
+    size_t enteros = 2 * ((size_t)V + 1) + 2 * (size_t)E + (size_t)V;
+    int *bloque = (int *)malloc(enteros * sizeof(int));
+    int *visto = (int *)malloc((size_t)(V > 0 ? V : 1) * sizeof(int));
+    if (bloque == NULL || visto == NULL) {
+        fprintf(stderr, "Error: Sin memoria para compilar la red\n");
+        free(bloque);
+        free(visto);
+        return 0;
+    }
+    int *inicio_padres = bloque;
+    int *inicio_hijos = inicio_padres + V + 1;
+    int *padres = inicio_hijos + V + 1;
+    int *hijos = padres + E;
+    int *orden = hijos + E;
+    
+    // Quitar aristas repetidas conservando la primera: con los índices de las
+    // aristas agrupados por hijo, un padre repetido aparece dos veces en el
+    // mismo grupo. hijos[] sirve de marca de arista repetida.
+    agrupar_aristas(red->arista_hijo, NULL, E, V, inicio_padres, padres);
+    for (int v = 0; v < V; v++) visto[v] = -1;
+    for (int v = 0; v < V; v++) {
+        for (int k = inicio_padres[v]; k < inicio_padres[v + 1]; k++) {
+            int e = padres[k];
+            hijos[e] = visto[red->arista_padre[e]] == v;
+            visto[red->arista_padre[e]] = v;
+        }
+    }
+    int unicas = 0;
+    for (int e = 0; e < E; e++) {
+        if (!hijos[e]) {
+            red->arista_padre[unicas] = red->arista_padre[e];
+            red->arista_hijo[unicas] = red->arista_hijo[e];
+            unicas++;
+        }
+    }
+    red->num_aristas = E = unicas;
+    hijos = padres + E;
+    orden = hijos + E;
+    agrupar_aristas(red->arista_hijo, red->arista_padre, E, V, inicio_padres, padres);
+    agrupar_aristas(red->arista_padre, red->arista_hijo, E, V, inicio_hijos, hijos);
+    
+    // Orden topológico (Kahn): visto[v] cuenta los padres de v aún sin colocar
+    int colocados = 0;
+    for (int v = 0; v < V; v++) {
+        visto[v] = inicio_padres[v + 1] - inicio_padres[v];
+        if (visto[v] == 0) orden[colocados++] = v;
+    }
+    for (int k = 0; k < colocados; k++) {
+        int v = orden[k];
+        for (int h = inicio_hijos[v]; h < inicio_hijos[v + 1]; h++) {
+            if (--visto[hijos[h]] == 0) orden[colocados++] = hijos[h];
+        }
+    }
+    free(visto);
+    if (colocados < V) {
+        fprintf(stderr, "Error: La red tiene un ciclo (%d variables en él o después de él)\n", V - colocados);
+        free(bloque);
+        return 0;
+    }
+    
+    free(red->inicio_padres);
+    red->inicio_padres = inicio_padres;
+    red->padres = padres;
+    red->inicio_hijos = inicio_hijos;
+    red->hijos = hijos;
+    red->orden = orden;
+    red->compilada = construir_tablas(red);
+    red->version++;
+    return red->compilada;
+}
+
+const int *red_padres(const RedBayesiana *red, int id, int *cantidad) {
+    if (red == NULL || !red->compilada || id < 0 || id >= red->num_nodos) return NULL;
+    if (cantidad != NULL) *cantidad = red->inicio_padres[id + 1] - red->inicio_padres[id];
+    return red->padres + red->inicio_padres[id];
+}
+
+const int *red_hijos(const RedBayesiana *red, int id, int *cantidad) {
+    if (red == NULL || !red->compilada || id < 0 || id >= red->num_nodos) return NULL;
+    if (cantidad != NULL) *cantidad = red->inicio_hijos[id + 1] - red->inicio_hijos[id];
+    return red->hijos + red->inicio_hijos[id];
+}
+
+// =============================================================================
+// TABLAS DE PROBABILIDAD CONDICIONAL
+// =============================================================================
+
+const double *red_tabla(const RedBayesiana *red, int id, size_t *filas) {
+    if (red == NULL || !red->compilada || id < 0 || id >= red->num_nodos) return NULL;
+    if (filas != NULL) {
+        *filas = (red->inicio_tabla[id + 1] - red->inicio_tabla[id]) / (size_t)red->estados[id];
+    }
+    return red->tablas + red->inicio_tabla[id];
+}
+
+// 1 si valores[0..estados) es una distribución
+static int es_distribucion(const double *valores, int estados) {
+    double suma = 0.0;
+    for (int s = 0; s < estados; s++) {
+        if (!(valores[s] >= 0.0 && valores[s] <= 1.0)) return 0;
+        suma += valores[s];
+    }
+    return fabs(suma - 1.0) <= TOLERANCIA_FILA;
+}
+
+int red_fijar_tabla(RedBayesiana *red, int id, const double *valores) {
+    size_t filas;
+    const double *tabla = red_tabla(red, id, &filas);
+    if (tabla == NULL || valores == NULL) {
+        fprintf(stderr, "Error: Argumentos no válidos en red_fijar_tabla\n");
+        return 0;
+    }
+    
+    int estados = red->estados[id];
+    for (size_t f = 0; f < filas; f++) {
+        if (!es_distribucion(valores + f * estados, estados)) {
+            fprintf(stderr, "Error: La fila %zu de la tabla de '%s' no suma 1\n", f, red->nombres[id]);
+            return 0;
+        }
+    }
+    memcpy(red->tablas + red->inicio_tabla[id], valores, filas * estados * sizeof(double));
+    return 1;
+}
+
+int red_fijar_fila(RedBayesiana *red, int id, const int *estados_padres, const double *probabilidades) {
+    if (red_tabla(red, id, NULL) == NULL || probabilidades == NULL) {
+        fprintf(stderr, "Error: Argumentos no válidos en red_fijar_fila\n");
+        return 0;
+    }
+    
+    size_t indice = red->inicio_tabla[id];
+    for (int k = red->inicio_padres[id]; k < red->inicio_padres[id + 1]; k++) {
+        int estado = estados_padres != NULL ? estados_padres[k - red->inicio_padres[id]] : -1;
+        if (estado < 0 || estado >= red->estados[red->padres[k]]) {
+            fprintf(stderr, "Error: Estado no válido del padre '%s'\n", red->nombres[red->padres[k]]);
+            return 0;
+        }
+        indice += (size_t)estado * red->pasos[k];
+    }
+    if (!es_distribucion(probabilidades, red->estados[id])) {
+        fprintf(stderr, "Error: La fila de la tabla de '%s' no suma 1\n", red->nombres[id]);
+        return 0;
+    }
+    memcpy(red->tablas + indice, probabilidades, (size_t)red->estados[id] * sizeof(double));
+    return 1;
+}
+
+double red_probabilidad(const RedBayesiana *red, int id, const int *asignacion) {
+    if (red == NULL || !red->compilada || id < 0 || id >= red->num_nodos || asignacion == NULL) return -1.0;
+    
+    size_t indice = red->inicio_tabla[id] + (size_t)asignacion[id];
+    for (int k = red->inicio_padres[id]; k < red->inicio_padres[id + 1]; k++) {
+        indice += (size_t)asignacion[red->padres[k]] * red->pasos[k];
+    }
+    return red->tablas[indice];
+}
+
+double red_probabilidad_conjunta(const RedBayesiana *red, const int *asignacion) {
+    if (red == NULL || !red->compilada || asignacion == NULL) return -1.0;
+    
+    double producto = 1.0;
+    for (int v = 0; v < red->num_nodos; v++) {
+        producto *= red_probabilidad(red, v, asignacion);
+    }
+    return producto;
+}
+
+// =============================================================================
+// CONVERSIÓN E IMPRESIÓN
+// =============================================================================
+
+RedBayesiana *red_desde_lista(struct nodo *lista) {
+    int nodos = 0;
+    for (struct nodo *actual = lista; actual != NULL; actual = actual->sig) nodos++;
+    
+    RedBayesiana *red = red_crear(nodos);
+    if (red == NULL) return NULL;
+    
+    for (struct nodo *actual = lista; actual != NULL; actual = actual->sig) {
+        if (red_agregar_nodo(red, actual->name) < 0) {
+            red_destruir(red);
+            return NULL;
+        }
+    }
+    for (struct nodo *actual = lista; actual != NULL; actual = actual->sig) {
+        int padre = red_buscar(red, actual->name);
+        for (struct nodo *hijo = actual->hijos; hijo != NULL; hijo = hijo->sig) {
+            int id = red_buscar(red, hijo->name);
+            if (id < 0) id = red_agregar_nodo(red, hijo->name);
+            if (id < 0 || !red_agregar_arista(red, padre, id)) {
+                red_destruir(red);
+                return NULL;
+            }
+        }
+    }
+    if (!red_compilar(red)) {
+        red_destruir(red);
+        return NULL;
+    }
+    
+    // Cada entrada (hijo, v, f) de la tabla de un padre da P(hijo | padre) y
+    // P(hijo | no padre): basta para la tabla completa si es el único padre
+    for (struct nodo *actual = lista; actual != NULL; actual = actual->sig) {
+        int padre = red_buscar(red, actual->name);
+        for (struct probabilidad *p = actual->tabla; p != NULL; p = p->sig) {
+            int hijo = red_buscar(red, p->nombre_hijo);
+            int cantidad = 0;
+            if (hijo < 0 || red_padres(red, hijo, &cantidad) == NULL || cantidad != 1) continue;
+            
+            double tabla[4] = {1.0 - p->prob_f, p->prob_f, 1.0 - p->prob_v, p->prob_v};
+            if (red->padres[red->inicio_padres[hijo]] == padre && !red_fijar_tabla(red, hijo, tabla)) {
+                printf("La tabla de '%s' queda uniforme\n", p->nombre_hijo);
+            }
+        }
+    }
+    return red;
+}
+
+void red_imprimir(const RedBayesiana *red) {
+    if (red == NULL || !red->compilada) {
+        printf("Error: Red no compilada\n");
+        return;
+    }
+    
+    printf("\nRed indexada: %d variables, %d aristas\n", red->num_nodos, red->num_aristas);
+    printf("Orden topológico:");
+    for (int k = 0; k < red->num_nodos; k++) printf(" %s", red->nombres[red->orden[k]]);
+    printf("\n");
+    for (int v = 0; v < red->num_nodos; v++) {
+        int cantidad;
+        const int *padres = red_padres(red, v, &cantidad);
+        printf("  %d [%s] padres:", v, red->nombres[v]);
+        if (cantidad == 0) printf(" (ninguno)");
+        for (int k = 0; k < cantidad; k++) printf(" %s", red->nombres[padres[k]]);
+        printf("\n");
+    }
+}
+
+void red_imprimir_tablas(const RedBayesiana *red) {
+    if (red == NULL || !red->compilada) {
+        printf("Error: Red no compilada\n");
+        return;
+    }
+    
+    for (int v = 0; v < red->num_nodos; v++) {
+        size_t filas;
+        const double *tabla = red_tabla(red, v, &filas);
+        int cantidad;
+        const int *padres = red_padres(red, v, &cantidad);
+        
+        printf("\nP(%s", red->nombres[v]);
+        for (int k = 0; k < cantidad; k++) printf("%s%s", k == 0 ? " | " : ", ", red->nombres[padres[k]]);
+        printf("):\n");
+        for (size_t f = 0; f < filas; f++) {
+            // Estados de los padres de la fila f (el último varía más rápido)
+            printf("  ");
+            size_t resto = f;
+            for (int k = 0; k < cantidad; k++) {
+                size_t paso = red->pasos[red->inicio_padres[v] + k] / (size_t)red->estados[v];
+                printf("%s=%zu ", red->nombres[padres[k]], resto / paso);
+                resto %= paso;
+            }
+            printf("%s", cantidad > 0 ? "->" : "");
+            for (int e = 0; e < red->estados[v]; e++) {
+                printf(" %.6f", tabla[f * red->estados[v] + e]);
+            }
+            printf("\n");
+        }
+    }
+}
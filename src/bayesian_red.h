@@ -0,0 +1,209 @@
+#ifndef BAYESIAN_RED_H
+#define BAYESIAN_RED_H
+
+#include "bayesian.h"
+
+// =============================================================================
+// RED BAYESIANA INDEXADA
+// =============================================================================
+//
+// Representación compacta de la red para construir y recorrer grafos grandes:
+// los nodos son índices 0..num_nodos-1 en arreglos, los nombres se buscan en
+// O(1) en una tabla hash de direccionamiento abierto (FNV-1a) y las aristas se
+// guardan como pares (padre, hijo) hasta red_compilar, que en O(V + E) quita
+// las repetidas, calcula un orden topológico y deja padres e hijos de cada
+// nodo en arreglos CSR contiguos. La lista enlazada de bayesian.h sigue
+// disponible para el ejemplo interactivo; red_desde_lista la convierte.
+//
+// Cada variable tiene un número de estados (2 por defecto: 0 = falso,
+// 1 = verdadero) y, tras compilar, una tabla de probabilidad condicional
+// P(v | padres) completa. Todas las tablas están seguidas en un arreglo de
+// double; la de v tiene una fila por configuración de sus padres (en el orden
+// de red_padres, el último padre varía más rápido) y una columna por estado
+// de v. El índice de una entrada es aritmético:
+//     inicio_tabla[v] + Σₖ estado(padreₖ) · pasos[inicio_padres[v] + k] + estado(v)
+// donde los pasos ya incluyen el número de estados de v.
+
+/**
+ * Red bayesiana indexada
+ * Los nombres viven en la arena de la red; los demás arreglos crecen 1.5x.
+ * padres/hijos/orden y las tablas solo son válidos con compilada = 1.
+ */
+typedef struct {
+    int num_nodos;
+    int capacidad_nodos;
+    char **nombres;              // nombres[id]
+    int *estados;                // Número de estados de cada variable
+    int *ranuras;                // Tabla hash: id o -1 (mascara + 1 ranuras)
+    unsigned mascara;
+    
+    int num_aristas;             // Aristas añadidas (únicas tras red_compilar)
+    int capacidad_aristas;
+    int *arista_padre;           // En orden de inserción
+    int *arista_hijo;
+    
+    int compilada;               // 1 si la adyacencia CSR refleja todas las aristas
+    unsigned version;            // Cambia en cada compilación (invalida lo calculado a partir de la red)
+    int *inicio_padres;          // num_nodos + 1: padres de v en padres[inicio_padres[v]..inicio_padres[v+1])
+    int *padres;                 // num_aristas, en orden de inserción para cada hijo
+    int *inicio_hijos;           // num_nodos + 1
+    int *hijos;                  // num_aristas, en orden de inserción para cada padre
+    int *orden;                  // num_nodos: orden topológico (padres antes que hijos)
+    
+    double *tablas;              // Tablas de probabilidad condicional, una tras otra
+    size_t *inicio_tabla;        // num_nodos + 1: tabla de v en tablas[inicio_tabla[v]..inicio_tabla[v+1])
+    size_t *pasos;               // num_aristas, paralelo a padres: paso de cada padre en su tabla
+    
+    Arena *memoria;              // Nombres
+} RedBayesiana;
+
+/**
+ * Crear una red vacía
+ * @param nodos_previstos Nodos para los que reservar espacio (0 = pocos); la red crece si hay más
+ * @return Red o NULL si falta memoria
+ */
+RedBayesiana *red_crear(int nodos_previstos);
+
+/**
+ * Liberar una red y todo lo que contiene
+ * @param red Red (puede ser NULL)
+ */
+void red_destruir(RedBayesiana *red);
+
+/**
+ * Añadir una variable
+ * @param red Red
+ * @param nombre Nombre único, no vacío y sin espacios
+ * @return Índice del nodo, o -1 si el nombre no es válido, ya existe o falta memoria
+ */
+int red_agregar_nodo(RedBayesiana *red, const char *nombre);
+
+/**
+ * Índice de la variable llamada nombre (O(1))
+ * @return Índice, o -1 si no existe
+ */
+int red_buscar(const RedBayesiana *red, const char *nombre);
+
+/**
+ * Nombre del nodo id
+ * @return Nombre, o NULL si id no es válido
+ */
+const char *red_nombre(const RedBayesiana *red, int id);
+
+/**
+ * Añadir la arista padre -> hijo (O(1) amortizado)
+ * Las aristas repetidas se descartan en red_compilar.
+ * @param red Red
+ * @param padre Índice del padre
+ * @param hijo Índice del hijo (distinto del padre)
+ * @return 1 si se añadió, 0 si los índices no son válidos o falta memoria
+ */
+int red_agregar_arista(RedBayesiana *red, int padre, int hijo);
+
+/**
+ * Fijar el número de estados de una variable
+ * Cambia la forma de su tabla y de las de sus hijos: hay que volver a compilar.
+ * @param red Red
+ * @param id Variable
+ * @param estados Número de estados (≥ 2)
+ * @return 1 si se fijó, 0 si los argumentos no son válidos
+ */
+int red_fijar_estados(RedBayesiana *red, int id, int estados);
+
+/**
+ * Construir la adyacencia CSR, el orden topológico y las tablas en O(V + E + tablas)
+ * Hay que volver a llamarla después de añadir nodos, aristas o cambiar estados;
+ * las tablas empiezan uniformes cada vez que se compila.
+ * @param red Red
+ * @return 1 si se compiló, 0 si el grafo tiene un ciclo, una tabla es demasiado
+ *         grande o falta memoria
+ */
+int red_compilar(RedBayesiana *red);
+
+/**
+ * Padres de un nodo en una red compilada
+ * @param red Red compilada
+ * @param id Nodo
+ * @param cantidad Recibe el número de padres
+ * @return Índices de los padres (cantidad), o NULL si la red no está compilada o id no es válido
+ */
+const int *red_padres(const RedBayesiana *red, int id, int *cantidad);
+
+/**
+ * Hijos de un nodo en una red compilada
+ * @param red Red compilada
+ * @param id Nodo
+ * @param cantidad Recibe el número de hijos
+ * @return Índices de los hijos (cantidad), o NULL si la red no está compilada o id no es válido
+ */
+const int *red_hijos(const RedBayesiana *red, int id, int *cantidad);
+
+/**
+ * Tabla de probabilidad condicional de una variable
+ * @param red Red compilada
+ * @param id Variable
+ * @param filas Recibe el número de configuraciones de los padres (puede ser NULL)
+ * @return filas × estados[id] probabilidades, o NULL si la red no está compilada
+ */
+const double *red_tabla(const RedBayesiana *red, int id, size_t *filas);
+
+/**
+ * Sustituir la tabla completa de una variable
+ * @param red Red compilada
+ * @param id Variable
+ * @param valores filas × estados[id] probabilidades en el orden de red_tabla;
+ *        cada fila debe sumar 1
+ * @return 1 si se fijó, 0 si la red no está compilada o una fila no es una distribución
+ */
+int red_fijar_tabla(RedBayesiana *red, int id, const double *valores);
+
+/**
+ * Fijar la fila de una configuración de los padres
+ * @param red Red compilada
+ * @param id Variable
+ * @param estados_padres Estado de cada padre, en el orden de red_padres (NULL si no tiene)
+ * @param probabilidades estados[id] valores que suman 1
+ * @return 1 si se fijó, 0 si los argumentos no son válidos
+ */
+int red_fijar_fila(RedBayesiana *red, int id, const int *estados_padres, const double *probabilidades);
+
+/**
+ * P(v = asignacion[v] | padres de v según asignacion)
+ * @param red Red compilada
+ * @param id Variable v
+ * @param asignacion Estado de cada variable, indexado por id (solo se leen v y sus padres)
+ * @return La probabilidad, o -1 si la red no está compilada
+ */
+double red_probabilidad(const RedBayesiana *red, int id, const int *asignacion);
+
+/**
+ * Probabilidad conjunta de una asignación completa: Πᵥ P(v | padres de v)
+ * @param red Red compilada
+ * @param asignacion Estado de cada variable, indexado por id
+ * @return La probabilidad, o -1 si la red no está compilada
+ */
+double red_probabilidad_conjunta(const RedBayesiana *red, const int *asignacion);
+
+/**
+ * Convertir la lista enlazada del ejemplo en una red compilada
+ * Los hijos que no estén en la lista se añaden como variables nuevas. Todas
+ * las variables son binarias; las tablas de los hijos con un único padre se
+ * toman de las probabilidades V/F de la lista y las demás quedan uniformes.
+ * @param lista Lista de nodos (insertar_nodo / insertar_hijos)
+ * @return Red compilada, o NULL si hay un ciclo o falta memoria
+ */
+RedBayesiana *red_desde_lista(struct nodo *lista);
+
+/**
+ * Imprimir nodos, padres e hijos de una red compilada
+ * @param red Red
+ */
+void red_imprimir(const RedBayesiana *red);
+
+/**
+ * Imprimir las tablas de probabilidad condicional de una red compilada
+ * @param red Red
+ */
+void red_imprimir_tablas(const RedBayesiana *red);
+
+#endif // BAYESIAN_RED_H
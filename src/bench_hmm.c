@@ -0,0 +1,589 @@
+#define _POSIX_C_SOURCE 200112L  // For clock_gettime() and getrusage()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "hmm.h"
+#include "hmm_kernels.h"
+#include "hmm_stream.h"
+#include "hmm_posterior.h"
+#include "hmm_beam.h"
+#include "hmm_parallel.h"
+#include "hmm_nbest.h"
+
+// =============================================================================
+// HMM DECODING BENCHMARK
+// =============================================================================
+//
+// Times every decoder on synthetic dense models over a grid of state counts N,
+// alphabet sizes M and sequence lengths T, optionally for every kernel variant,
+// and writes one CSV line (or JSON object) per configuration:
+//
+//     ./bench_hmm                                  full default grid, CSV
+//     ./bench_hmm --quick --format json            small grid, JSON
+//     ./bench_hmm --states 3,64 --lengths 1000 --isa all --label gcc12-O3
+//     ./bench_hmm --states 2,3,4,8 --decoders viterbi_log,viterbi_log_generic
+//
+// Reported per configuration: median and minimum wall time over the timed
+// repetitions, ns per (state·step) = time / (N·T), ns per transition
+// = time / (N²·T), library allocations and bytes per decode (hmm_allocation_stats)
+// and the peak resident set size of the process so far.
+
+#define MAX_GRID 32
+
+typedef struct {
+    HMM* hmm;
+    const int* observations;
+    int T;
+    ViterbiWorkspace* viterbi_workspace;
+    PosteriorWorkspace* posterior_workspace;
+    ViterbiStream* stream;
+    BeamWorkspace* beam_workspace;
+    NBestWorkspace* nbest_workspace;
+    int* nbest_paths;          // NBEST_K x T, allocated on first use
+    int* committed;
+    int* path;
+} BenchState;
+
+typedef struct {
+    const char* name;
+    int (*run)(BenchState* state);   // One decode; returns 0 on success
+} BenchDecoder;
+
+typedef struct {
+    int states[MAX_GRID], num_states;
+    int symbols[MAX_GRID], num_symbols;
+    long lengths[MAX_GRID], num_lengths;
+    const char* decoders;      // Comma list of decoder names, or "all"
+    const char* isa;           // Kernel variant, "all" or NULL (active)
+    const char* label;         // Free-form build label copied to every record
+    const char* output;        // Output file, NULL = stdout
+    int json;
+    int warmup;
+    int repetitions;
+    double max_work;           // Skip configurations with N²·T above this
+    double max_memory;         // Skip configurations needing more bytes than this
+} BenchOptions;
+
+// =============================================================================
+// DECODERS
+// =============================================================================
+
+#define BEAM_WIDTH 32
+#define BEAM_MARGIN 20.0
+#define NBEST_K 10
+
+static int run_viterbi(BenchState* state) {
+    ViterbiResult* result = viterbi_algorithm(state->hmm, (int*)state->observations);
+    if (result == NULL) return -1;
+    free_viterbi_result(result);
+    return 0;
+}
+
+static int run_viterbi_log(BenchState* state) {
+    ViterbiResult* result = viterbi_algorithm_log(state->hmm, (int*)state->observations);
+    if (result == NULL) return -1;
+    free_viterbi_result(result);
+    return 0;
+}
+
+// Same decoders with the fixed-size recursions (N = 2, 3, 4, 8) turned off
+static int run_viterbi_generic(BenchState* state) {
+    hmm_fixed_recursions_enable(0);
+    int status = run_viterbi(state);
+    hmm_fixed_recursions_enable(1);
+    return status;
+}
+
+static int run_viterbi_log_generic(BenchState* state) {
+    hmm_fixed_recursions_enable(0);
+    int status = run_viterbi_log(state);
+    hmm_fixed_recursions_enable(1);
+    return status;
+}
+
+static int run_viterbi_decode(BenchState* state) {
+    return viterbi_decode(state->hmm, state->observations, state->T, VITERBI_MODE_LOG,
+                          state->viterbi_workspace) != NULL ? 0 : -1;
+}
+
+// viterbi_decode with float parameters (compare with viterbi_decode)
+static int run_decode_precision(BenchState* state, HmmPrecision precision) {
+    if (!hmm_set_precision(state->hmm, precision)) return -1;
+    int status = run_viterbi_decode(state);
+    hmm_set_precision(state->hmm, HMM_PRECISION_DOUBLE);
+    return status;
+}
+
+static int run_viterbi_mixed(BenchState* state) {
+    return run_decode_precision(state, HMM_PRECISION_MIXED);
+}
+
+static int run_viterbi_float(BenchState* state) {
+    return run_decode_precision(state, HMM_PRECISION_FLOAT);
+}
+
+static int run_stream(BenchState* state) {
+    for (int t = 0; t < state->T; t++) {
+        if (viterbi_stream_push(state->stream, state->observations[t], state->committed) < 0) return -1;
+    }
+    viterbi_stream_flush(state->stream, state->committed);
+    return 0;
+}
+
+static int run_forward_backward(BenchState* state) {
+    return hmm_forward_backward(state->hmm, state->observations, state->T,
+                                state->posterior_workspace) != NULL ? 0 : -1;
+}
+
+static int run_beam(BenchState* state) {
+    BeamOptions options = beam_default_options();
+    options.beam_width = BEAM_WIDTH;
+    options.log_margin = BEAM_MARGIN;
+    return viterbi_beam(state->hmm, state->observations, state->T, &options,
+                        state->beam_workspace, state->path, NULL, NULL);
+}
+
+static int run_parallel(BenchState* state) {
+    return viterbi_parallel(state->hmm, state->observations, state->T, 0, state->path, NULL, NULL);
+}
+
+static int run_nbest(BenchState* state) {
+    if (state->nbest_paths == NULL) {
+        state->nbest_paths = (int*)malloc((size_t)NBEST_K * state->T * sizeof(int));
+        if (state->nbest_paths == NULL) return -1;
+    }
+    int found;
+    return viterbi_nbest(state->hmm, state->observations, state->T, NBEST_K,
+                         state->nbest_workspace, state->nbest_paths, NULL, &found);
+}
+
+// New decoders are benchmarked by adding a line here
+static const BenchDecoder DECODERS[] = {
+    {"viterbi",          run_viterbi},
+    {"viterbi_log",      run_viterbi_log},
+    {"viterbi_generic",  run_viterbi_generic},
+    {"viterbi_log_generic", run_viterbi_log_generic},
+    {"viterbi_decode",   run_viterbi_decode},
+    {"viterbi_mixed",    run_viterbi_mixed},
+    {"viterbi_float",    run_viterbi_float},
+    {"stream",           run_stream},
+    {"forward_backward", run_forward_backward},
+    {"beam",             run_beam},
+    {"parallel",         run_parallel},
+    {"nbest",            run_nbest},
+};
+
+#define DECODER_COUNT ((int)(sizeof(DECODERS) / sizeof(DECODERS[0])))
+#define STREAM_LAG 64
+
+// Bytes of working memory a decoder needs for (N, T)
+static double decoder_memory(const BenchDecoder* decoder, int N, long T) {
+    if (strcmp(decoder->name, "stream") == 0) {
+        return (double)(STREAM_LAG + 4) * N * sizeof(int) + 2.0 * N * sizeof(double);
+    }
+    if (strcmp(decoder->name, "forward_backward") == 0) {
+        return 3.0 * T * N * sizeof(double) + (double)T * (sizeof(double) + sizeof(int));
+    }
+    if (strcmp(decoder->name, "beam") == 0) {
+        return 2.0 * T * (N < BEAM_WIDTH ? N : BEAM_WIDTH) * sizeof(int) + (double)T * (sizeof(long long) + sizeof(int))
+               + (3.0 * sizeof(double) + 3.0 * sizeof(int)) * N;
+    }
+    if (strcmp(decoder->name, "parallel") == 0) {
+        return (double)T * N * (N <= 256 ? 1 : (N <= 65536 ? 2 : 4));
+    }
+    if (strcmp(decoder->name, "nbest") == 0) {
+        return (double)T * NBEST_K * (N * sizeof(unsigned int) + sizeof(int));
+    }
+    return (double)T * N * (sizeof(double) + sizeof(int)) + (double)T * sizeof(int);
+}
+
+// =============================================================================
+// SYNTHETIC DATA
+// =============================================================================
+
+static unsigned long long rng_state = 0x9e3779b97f4a7c15ull;
+
+// xorshift64*: fast and reproducible, good enough for synthetic data
+static unsigned long long next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dull;
+}
+
+static double next_uniform(void) {
+    return (double)(next_random() >> 11) / 9007199254740992.0;
+}
+
+static HMM* synthetic_hmm(int N, int M, int T) {
+    HMM* hmm = allocate_hmm(N, M, T);
+    if (hmm == NULL) return NULL;
+    
+    for (int i = 0; i < N; i++) {
+        double row_sum = 0.0;
+        for (int j = 0; j < N; j++) row_sum += (HMM_A(hmm, i, j) = 0.05 + next_uniform());
+        for (int j = 0; j < N; j++) HMM_A(hmm, i, j) /= row_sum;
+        
+        row_sum = 0.0;
+        for (int k = 0; k < M; k++) row_sum += (HMM_B(hmm, i, k) = 0.05 + next_uniform());
+        for (int k = 0; k < M; k++) HMM_B(hmm, i, k) /= row_sum;
+        
+        hmm->initial[i] = 1.0 / N;
+    }
+    hmm_prepare(hmm);
+    return hmm;
+}
+
+// =============================================================================
+// MEASUREMENT
+// =============================================================================
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Peak resident set size of the process in KiB (Linux reports ru_maxrss in KiB)
+static long peak_rss_kib(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return usage.ru_maxrss;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void write_record(FILE* out, const BenchOptions* options, int* first, const char* isa,
+                         const char* decoder, int N, int M, long T, int repetitions,
+                         double median, double minimum, double allocations, double bytes, long rss) {
+    double state_steps = (double)N * T;
+    if (options->json) {
+        fprintf(out, "%s\n  {\"label\": \"%s\", \"isa\": \"%s\", \"decoder\": \"%s\", "
+                     "\"N\": %d, \"M\": %d, \"T\": %ld, \"repetitions\": %d, "
+                     "\"median_s\": %.9g, \"min_s\": %.9g, \"ns_per_state_step\": %.6g, "
+                     "\"ns_per_transition\": %.6g, \"allocations_per_run\": %.6g, "
+                     "\"bytes_per_run\": %.6g, \"peak_rss_kib\": %ld}",
+                *first ? "[" : ",", options->label, isa, decoder, N, M, T, repetitions,
+                median, minimum, median * 1e9 / state_steps, median * 1e9 / (state_steps * N),
+                allocations, bytes, rss);
+    } else {
+        if (*first) {
+            fprintf(out, "label,isa,decoder,N,M,T,repetitions,median_s,min_s,ns_per_state_step,"
+                         "ns_per_transition,allocations_per_run,bytes_per_run,peak_rss_kib\n");
+        }
+        fprintf(out, "%s,%s,%s,%d,%d,%ld,%d,%.9g,%.9g,%.6g,%.6g,%.6g,%.6g,%ld\n",
+                options->label, isa, decoder, N, M, T, repetitions, median, minimum,
+                median * 1e9 / state_steps, median * 1e9 / (state_steps * N),
+                allocations, bytes, rss);
+    }
+    *first = 0;
+    fflush(out);
+}
+
+// Warm up, then time the repetitions of one decoder on one configuration
+static int bench_decoder(FILE* out, const BenchOptions* options, int* first, const BenchDecoder* decoder,
+                         BenchState* state, int N, int M, long T) {
+    double* times = (double*)malloc((size_t)options->repetitions * sizeof(double));
+    if (times == NULL) return -1;
+    
+    for (int w = 0; w < options->warmup; w++) {
+        if (decoder->run(state) != 0) {
+            free(times);
+            return -1;
+        }
+    }
+    
+    unsigned long long count_before, bytes_before, count_after, bytes_after;
+    hmm_allocation_stats(&count_before, &bytes_before);
+    for (int r = 0; r < options->repetitions; r++) {
+        double start = now_seconds();
+        if (decoder->run(state) != 0) {
+            free(times);
+            return -1;
+        }
+        times[r] = now_seconds() - start;
+    }
+    hmm_allocation_stats(&count_after, &bytes_after);
+    
+    qsort(times, (size_t)options->repetitions, sizeof(double), compare_doubles);
+    double median = times[options->repetitions / 2];
+    if (options->repetitions % 2 == 0) {
+        median = 0.5 * (times[options->repetitions / 2 - 1] + median);
+    }
+    
+    write_record(out, options, first, hmm_kernels_isa(), decoder->name, N, M, T, options->repetitions,
+                 median, times[0],
+                 (double)(count_after - count_before) / options->repetitions,
+                 (double)(bytes_after - bytes_before) / options->repetitions,
+                 peak_rss_kib());
+    free(times);
+    return 0;
+}
+
+static int decoder_selected(const BenchOptions* options, const char* name) {
+    if (strcmp(options->decoders, "all") == 0) return 1;
+    
+    size_t length = strlen(name);
+    const char* p = options->decoders;
+    while (p != NULL && *p != '\0') {
+        if (strncmp(p, name, length) == 0 && (p[length] == ',' || p[length] == '\0')) return 1;
+        p = strchr(p, ',');
+        if (p != NULL) p++;
+    }
+    return 0;
+}
+
+// One (N, M, T) point for every selected decoder
+static int bench_configuration(FILE* out, const BenchOptions* options, int* first, int N, int M, long T) {
+    double work = (double)N * N * T;
+    if (work > options->max_work) {
+        fprintf(stderr, "skip N=%d M=%d T=%ld: %.3g transitions > --max-work\n", N, M, T, work);
+        return 0;
+    }
+    
+    BenchState state;
+    memset(&state, 0, sizeof(state));
+    state.T = (int)T;
+    state.hmm = synthetic_hmm(N, M, (int)T);
+    int* observations = (int*)malloc((size_t)T * sizeof(int));
+    state.viterbi_workspace = viterbi_workspace_create(1, N);
+    state.posterior_workspace = posterior_workspace_create(1, N);
+    state.stream = viterbi_stream_create(state.hmm, STREAM_LAG);
+    state.committed = (int*)malloc((size_t)(STREAM_LAG + 1) * sizeof(int));
+    state.beam_workspace = beam_workspace_create(1, N);
+    state.nbest_workspace = nbest_workspace_create(1, N, NBEST_K);
+    state.path = (int*)malloc((size_t)T * sizeof(int));
+    
+    int status = 0;
+    if (state.hmm == NULL || observations == NULL || state.viterbi_workspace == NULL
+        || state.posterior_workspace == NULL || state.stream == NULL || state.committed == NULL
+        || state.beam_workspace == NULL || state.nbest_workspace == NULL || state.path == NULL) {
+        fprintf(stderr, "Error: Failed to allocate benchmark data for N=%d M=%d T=%ld\n", N, M, T);
+        status = -1;
+    } else {
+        for (long t = 0; t < T; t++) {
+            observations[t] = (int)(next_random() % (unsigned long long)M);
+        }
+        state.observations = observations;
+        
+        // A failing decoder is reported and skipped; the others still run
+        for (int d = 0; d < DECODER_COUNT; d++) {
+            const BenchDecoder* decoder = &DECODERS[d];
+            if (!decoder_selected(options, decoder->name)) continue;
+            if (decoder_memory(decoder, N, T) > options->max_memory) {
+                fprintf(stderr, "skip %s N=%d M=%d T=%ld: needs more than --max-memory\n",
+                        decoder->name, N, M, T);
+                continue;
+            }
+            fprintf(stderr, "%-16s %-6s N=%-5d M=%-4d T=%ld\n", decoder->name, hmm_kernels_isa(), N, M, T);
+            if (bench_decoder(out, options, first, decoder, &state, N, M, T) != 0) {
+                fprintf(stderr, "Error: %s failed on N=%d M=%d T=%ld\n", decoder->name, N, M, T);
+                status = -1;
+            }
+        }
+    }
+    
+    free(state.path);
+    free(state.nbest_paths);
+    nbest_workspace_free(state.nbest_workspace);
+    beam_workspace_free(state.beam_workspace);
+    free(state.committed);
+    viterbi_stream_free(state.stream);
+    posterior_workspace_free(state.posterior_workspace);
+    viterbi_workspace_free(state.viterbi_workspace);
+    free(observations);
+    free_hmm(state.hmm);
+    return status;
+}
+
+// =============================================================================
+// COMMAND LINE
+// =============================================================================
+
+static int parse_int_list(const char* text, int* values, int max) {
+    int count = 0;
+    char* end;
+    while (*text != '\0' && count < max) {
+        double value = strtod(text, &end);   // Accepts 1e6 as well as 1000000
+        if (end == text || value < 1) return -1;
+        values[count++] = (int)value;
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return -1;
+    }
+    return count;
+}
+
+static int parse_long_list(const char* text, long* values, int max) {
+    int count = 0;
+    char* end;
+    while (*text != '\0' && count < max) {
+        double value = strtod(text, &end);
+        if (end == text || value < 1) return -1;
+        values[count++] = (long)value;
+        text = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return -1;
+    }
+    return count;
+}
+
+static void print_usage(const char* program) {
+    fprintf(stderr,
+            "Uso: %s [opciones]\n"
+            "  --states LIST      Numeros de estados N (por defecto 3,16,64,256,1024,4096)\n"
+            "  --symbols LIST     Tamanos de alfabeto M (por defecto 3)\n"
+            "  --lengths LIST     Longitudes T (por defecto 10,1000,1e5,1e7)\n"
+            "  --decoders LIST    viterbi,viterbi_log,viterbi_decode,stream,forward_backward,beam,\n"
+            "                     parallel,viterbi_generic,viterbi_log_generic,viterbi_mixed,\n"
+            "                     viterbi_float,nbest\n"
+            "                     (por defecto all)\n"
+            "  --isa NAME         Variante de nucleos: avx512|avx|sse2|scalar|all (por defecto la activa)\n"
+            "  --warmup N         Ejecuciones de calentamiento (por defecto 1)\n"
+            "  --repetitions N    Ejecuciones medidas (por defecto 5)\n"
+            "  --max-work X       Omitir configuraciones con N*N*T > X (por defecto 2e10)\n"
+            "  --max-memory X     Omitir decodificadores que necesiten mas de X bytes (por defecto 2e9)\n"
+            "  --quick            Rejilla reducida: N=3,64,512  T=1000,1e5\n"
+            "  --format csv|json  Formato de salida (por defecto csv)\n"
+            "  --output FILE      Escribir resultados en FILE (por defecto stdout)\n"
+            "  --label TEXT       Etiqueta de la compilacion copiada en cada registro\n",
+            program);
+}
+
+static int parse_options(int argc, char** argv, BenchOptions* options) {
+    const int default_states[] = {3, 16, 64, 256, 1024, 4096};
+    const long default_lengths[] = {10, 1000, 100000, 10000000};
+    
+    memset(options, 0, sizeof(*options));
+    options->num_states = 6;
+    memcpy(options->states, default_states, sizeof(default_states));
+    options->num_symbols = 1;
+    options->symbols[0] = 3;
+    options->num_lengths = 4;
+    memcpy(options->lengths, default_lengths, sizeof(default_lengths));
+    options->decoders = "all";
+    options->label = "default";
+    options->warmup = 1;
+    options->repetitions = 5;
+    options->max_work = 2e10;
+    options->max_memory = 2e9;
+    
+    for (int a = 1; a < argc; a++) {
+        const char* arg = argv[a];
+        const char* value = (a + 1 < argc) ? argv[a + 1] : NULL;
+        int takes_value = 1;
+        
+        if (strcmp(arg, "--quick") == 0) {
+            const int quick_states[] = {3, 64, 512};
+            options->num_states = 3;
+            memcpy(options->states, quick_states, sizeof(quick_states));
+            options->num_lengths = 2;
+            options->lengths[0] = 1000;
+            options->lengths[1] = 100000;
+            takes_value = 0;
+        } else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage(argv[0]);
+            exit(0);
+        } else if (value == NULL) {
+            fprintf(stderr, "Error: Missing value for %s\n", arg);
+            return -1;
+        } else if (strcmp(arg, "--states") == 0) {
+            if ((options->num_states = parse_int_list(value, options->states, MAX_GRID)) <= 0) return -1;
+        } else if (strcmp(arg, "--symbols") == 0) {
+            if ((options->num_symbols = parse_int_list(value, options->symbols, MAX_GRID)) <= 0) return -1;
+        } else if (strcmp(arg, "--lengths") == 0) {
+            if ((options->num_lengths = parse_long_list(value, options->lengths, MAX_GRID)) <= 0) return -1;
+        } else if (strcmp(arg, "--decoders") == 0) {
+            options->decoders = value;
+        } else if (strcmp(arg, "--isa") == 0) {
+            options->isa = value;
+        } else if (strcmp(arg, "--warmup") == 0) {
+            options->warmup = atoi(value);
+        } else if (strcmp(arg, "--repetitions") == 0) {
+            options->repetitions = atoi(value);
+        } else if (strcmp(arg, "--max-work") == 0) {
+            options->max_work = strtod(value, NULL);
+        } else if (strcmp(arg, "--max-memory") == 0) {
+            options->max_memory = strtod(value, NULL);
+        } else if (strcmp(arg, "--format") == 0) {
+            options->json = strcmp(value, "json") == 0;
+        } else if (strcmp(arg, "--output") == 0) {
+            options->output = value;
+        } else if (strcmp(arg, "--label") == 0) {
+            options->label = value;
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", arg);
+            return -1;
+        }
+        
+        if (takes_value) a++;
+    }
+    
+    if (options->warmup < 0 || options->repetitions < 1) {
+        fprintf(stderr, "Error: --warmup must be >= 0 and --repetitions >= 1\n");
+        return -1;
+    }
+    for (int l = 0; l < options->num_lengths; l++) {
+        if (options->lengths[l] > 2147483647L) {
+            fprintf(stderr, "Error: T=%ld does not fit in an int\n", options->lengths[l]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (parse_options(argc, argv, &options) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    FILE* out = stdout;
+    if (options.output != NULL && (out = fopen(options.output, "w")) == NULL) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", options.output);
+        return 1;
+    }
+    
+    // Kernel variants to run: the active one, a named one, or every available one
+    const char* variants[] = {"avx512", "avx", "sse2", "scalar"};
+    const char* selected[4];
+    int num_selected = 0;
+    if (options.isa == NULL) {
+        selected[num_selected++] = hmm_kernels_isa();
+    } else if (strcmp(options.isa, "all") == 0) {
+        for (int v = 0; v < 4; v++) {
+            if (hmm_kernels_find(variants[v]) != NULL) selected[num_selected++] = variants[v];
+        }
+    } else if (hmm_kernels_find(options.isa) != NULL) {
+        selected[num_selected++] = options.isa;
+    } else {
+        fprintf(stderr, "Error: Kernel variant '%s' is not available on this CPU\n", options.isa);
+        return 1;
+    }
+    
+    int first = 1;
+    int failures = 0;
+    for (int v = 0; v < num_selected; v++) {
+        hmm_kernels_select(selected[v]);
+        for (int n = 0; n < options.num_states; n++) {
+            for (int m = 0; m < options.num_symbols; m++) {
+                for (int l = 0; l < options.num_lengths; l++) {
+                    failures += bench_configuration(out, &options, &first, options.states[n],
+                                                    options.symbols[m], options.lengths[l]) != 0;
+                }
+            }
+        }
+    }
+    
+    if (options.json) {
+        fprintf(out, first ? "[]\n" : "\n]\n");
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return failures == 0 ? 0 : 1;
+}
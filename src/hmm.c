@@ -1,13 +1,52 @@
+#define _POSIX_C_SOURCE 200112L  // For posix_memalign() and munmap()
+#include <sys/mman.h>
 #include "hmm.h"
-
-// Global arrays for state and observation names (for verbose output)
-const char* STATE_NAMES[3] = {"SUNNY", "CLOUDY", "RAINY"};
-const char* OBSERVATION_NAMES[3] = {"UMBRELLA", "SUNGLASSES", "STAY_HOME"};
+#include "hmm_kernels.h"
+#include "hmm_profile.h"
 
 // =============================================================================
 // MEMORY MANAGEMENT FUNCTIONS
 // =============================================================================
 
+// Allocation counters for hmm_allocation_stats (updated from any thread)
+static unsigned long long allocation_count = 0;
+static unsigned long long allocation_bytes = 0;
+
+#if defined(__GNUC__)
+#define COUNTER_ADD(counter, value) __atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED)
+#define COUNTER_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#else
+#define COUNTER_ADD(counter, value) ((counter) += (value))
+#define COUNTER_LOAD(counter) (counter)
+#endif
+
+void* hmm_aligned_calloc(size_t size) {
+    void* block = NULL;
+    if (size == 0 || posix_memalign(&block, HMM_ALIGNMENT, size) != 0) {
+        return NULL;
+    }
+    memset(block, 0, size);
+    HMM_PROFILE_COUNT(HMM_COUNTER_ALLOCATIONS, 1);
+    COUNTER_ADD(allocation_count, 1);
+    COUNTER_ADD(allocation_bytes, (unsigned long long)size);
+    return block;
+}
+
+void hmm_allocation_stats(unsigned long long* count, unsigned long long* bytes) {
+    if (count != NULL) *count = COUNTER_LOAD(allocation_count);
+    if (bytes != NULL) *bytes = COUNTER_LOAD(allocation_bytes);
+}
+
+int hmm_padded_stride(int count, size_t element_size) {
+    int per_line = (int)(HMM_ALIGNMENT / element_size);
+    return (count + per_line - 1) / per_line * per_line;
+}
+
+// Size of a structure header rounded up so the arrays behind it stay aligned
+static size_t aligned_header_size(size_t size) {
+    return (size + HMM_ALIGNMENT - 1) / HMM_ALIGNMENT * HMM_ALIGNMENT;
+}
+
 HMM* allocate_hmm(int N, int M, int T) {
     // Validate input parameters
     if (N <= 0 || M <= 0 || T <= 0) {
@@ -15,89 +54,56 @@ HMM* allocate_hmm(int N, int M, int T) {
         return NULL;
     }
     
-    // Allocate main HMM structure
-    HMM* hmm = (HMM*)malloc(sizeof(HMM));
-    if (hmm == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for HMM structure\n");
+    int transition_stride = hmm_padded_stride(N, sizeof(double));
+    int emission_stride = hmm_padded_stride(M, sizeof(double));
+    int vector_stride = hmm_padded_stride(N, sizeof(double));
+    
+    // Layout of the single block (every array starts on a cache line):
+    // [HMM | A | Aᵀ | log Aᵀ | B | Bᵀ | log Bᵀ | π | log π]
+    size_t transition_size = (size_t)N * transition_stride;
+    size_t emission_size = (size_t)N * emission_stride;
+    size_t symbol_size = (size_t)M * transition_stride;
+    size_t header = aligned_header_size(sizeof(HMM));
+    size_t total = header + sizeof(double) * (3 * transition_size + emission_size + 2 * symbol_size
+                                              + 2 * (size_t)vector_stride);
+    
+    Arena* arena = arena_create(total);
+    char* block = arena != NULL ? (char*)arena_alloc_aligned(arena, total, HMM_ALIGNMENT) : NULL;
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for HMM structure (%zu bytes)\n", total);
+        arena_destroy(arena);
         return NULL;
     }
     
+    HMM* hmm = (HMM*)block;
+    double* data = (double*)(block + header);
+    
     // Initialize dimensions
     hmm->num_states = N;
     hmm->num_observations = M;
     hmm->sequence_length = T;
-    
-    // Allocate transition matrix A (NxN)
-    hmm->transition = (double**)malloc(N * sizeof(double*));
-    if (hmm->transition == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for transition matrix\n");
-        free(hmm);
-        return NULL;
-    }
-    
-    for (int i = 0; i < N; i++) {
-        hmm->transition[i] = (double*)malloc(N * sizeof(double));
-        if (hmm->transition[i] == NULL) {
-            fprintf(stderr, "Error: Failed to allocate memory for transition matrix row %d\n", i);
-            // Free previously allocated rows
-            for (int j = 0; j < i; j++) {
-                free(hmm->transition[j]);
-            }
-            free(hmm->transition);
-            free(hmm);
-            return NULL;
-        }
-    }
-    
-    // Allocate emission matrix B (NxM)
-    hmm->emission = (double**)malloc(N * sizeof(double*));
-    if (hmm->emission == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for emission matrix\n");
-        // Free transition matrix
-        for (int i = 0; i < N; i++) {
-            free(hmm->transition[i]);
-        }
-        free(hmm->transition);
-        free(hmm);
-        return NULL;
-    }
-    
-    for (int i = 0; i < N; i++) {
-        hmm->emission[i] = (double*)malloc(M * sizeof(double));
-        if (hmm->emission[i] == NULL) {
-            fprintf(stderr, "Error: Failed to allocate memory for emission matrix row %d\n", i);
-            // Free previously allocated rows
-            for (int j = 0; j < i; j++) {
-                free(hmm->emission[j]);
-            }
-            free(hmm->emission);
-            // Free transition matrix
-            for (int i = 0; i < N; i++) {
-                free(hmm->transition[i]);
-            }
-            free(hmm->transition);
-            free(hmm);
-            return NULL;
-        }
-    }
-    
-    // Allocate initial probability vector π (Nx1)
-    hmm->initial = (double*)malloc(N * sizeof(double));
-    if (hmm->initial == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for initial probabilities\n");
-        // Free emission matrix
-        for (int i = 0; i < N; i++) {
-            free(hmm->emission[i]);
-        }
-        free(hmm->emission);
-        // Free transition matrix
-        for (int i = 0; i < N; i++) {
-            free(hmm->transition[i]);
-        }
-        free(hmm->transition);
-        free(hmm);
-        return NULL;
-    }
+    hmm->transition_stride = transition_stride;
+    hmm->emission_stride = emission_stride;
+    hmm->prepared = 0;
+    hmm->precision = HMM_PRECISION_DOUBLE;
+    hmm->float_stride = 0;
+    hmm->log_transition_t_f = NULL;
+    hmm->log_emission_t_f = NULL;
+    hmm->log_initial_f = NULL;
+    hmm->dictionary = NULL;
+    hmm->mapping = NULL;
+    hmm->mapping_size = 0;
+    hmm->arena = arena;
+    
+    // Carve the matrices out of the block
+    hmm->transition = data;        data += transition_size;
+    hmm->transition_t = data;      data += transition_size;
+    hmm->log_transition_t = data;  data += transition_size;
+    hmm->emission = data;          data += emission_size;
+    hmm->emission_t = data;        data += symbol_size;
+    hmm->log_emission_t = data;    data += symbol_size;
+    hmm->initial = data;           data += vector_stride;
+    hmm->log_initial = data;
     
     return hmm;
 }
@@ -105,33 +111,12 @@ HMM* allocate_hmm(int N, int M, int T) {
 void free_hmm(HMM* hmm) {
     if (hmm == NULL) return;
     
-    // Free transition matrix
-    if (hmm->transition != NULL) {
-        for (int i = 0; i < hmm->num_states; i++) {
-            if (hmm->transition[i] != NULL) {
-                free(hmm->transition[i]);
-            }
-        }
-        free(hmm->transition);
+    // Structure, matrices, float copies and names all live in the arena,
+    // unless the matrices live in a mapped binary model file
+    if (hmm->mapping != NULL) {
+        munmap(hmm->mapping, hmm->mapping_size);
     }
-    
-    // Free emission matrix
-    if (hmm->emission != NULL) {
-        for (int i = 0; i < hmm->num_states; i++) {
-            if (hmm->emission[i] != NULL) {
-                free(hmm->emission[i]);
-            }
-        }
-        free(hmm->emission);
-    }
-    
-    // Free initial probabilities
-    if (hmm->initial != NULL) {
-        free(hmm->initial);
-    }
-    
-    // Free main structure
-    free(hmm);
+    arena_destroy(hmm->arena);
 }
 
 ViterbiResult* allocate_viterbi_result(int T, int N) {
@@ -141,154 +126,190 @@ ViterbiResult* allocate_viterbi_result(int T, int N) {
         return NULL;
     }
     
-    // Allocate main ViterbiResult structure
-    ViterbiResult* result = (ViterbiResult*)malloc(sizeof(ViterbiResult));
-    if (result == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for ViterbiResult structure\n");
-        return NULL;
-    }
+    int delta_stride = hmm_padded_stride(N, sizeof(double));
+    int psi_stride = hmm_padded_stride(N, sizeof(int));
     
-    // Initialize probability
-    result->probability = 0.0;
+    // Layout of the single block: [ViterbiResult | δ (TxN) | ψ (TxN) | path (T)]
+    size_t header = aligned_header_size(sizeof(ViterbiResult));
+    size_t delta_bytes = sizeof(double) * (size_t)T * delta_stride;
+    size_t psi_bytes = sizeof(int) * (size_t)T * psi_stride;
+    size_t total = header + delta_bytes + psi_bytes + sizeof(int) * (size_t)T;
     
-    // Allocate delta matrix δ (TxN)
-    result->delta = (double**)malloc(T * sizeof(double*));
-    if (result->delta == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for delta matrix\n");
-        free(result);
+    char* block = (char*)hmm_aligned_calloc(total);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for ViterbiResult (%zu bytes)\n", total);
         return NULL;
     }
     
-    for (int t = 0; t < T; t++) {
-        result->delta[t] = (double*)malloc(N * sizeof(double));
-        if (result->delta[t] == NULL) {
-            fprintf(stderr, "Error: Failed to allocate memory for delta matrix row %d\n", t);
-            // Free previously allocated rows
-            for (int i = 0; i < t; i++) {
-                free(result->delta[i]);
-            }
-            free(result->delta);
-            free(result);
-            return NULL;
-        }
-    }
+    ViterbiResult* result = (ViterbiResult*)block;
+    result->T = T;
+    result->N = N;
+    result->delta_stride = delta_stride;
+    result->psi_stride = psi_stride;
+    result->delta = (double*)(block + header);
+    result->psi = (int*)(block + header + delta_bytes);
+    result->path = (int*)(block + header + delta_bytes + psi_bytes);
     
-    // Allocate psi matrix ψ (TxN)
-    result->psi = (int**)malloc(T * sizeof(int*));
-    if (result->psi == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for psi matrix\n");
-        // Free delta matrix
-        for (int t = 0; t < T; t++) {
-            free(result->delta[t]);
-        }
-        free(result->delta);
-        free(result);
-        return NULL;
-    }
+    // Initialize probability
+    result->probability = 0.0;
+    result->log_probability = -INFINITY;
+    result->log_domain = 0;
     
-    for (int t = 0; t < T; t++) {
-        result->psi[t] = (int*)malloc(N * sizeof(int));
-        if (result->psi[t] == NULL) {
-            fprintf(stderr, "Error: Failed to allocate memory for psi matrix row %d\n", t);
-            // Free previously allocated rows
-            for (int i = 0; i < t; i++) {
-                free(result->psi[i]);
-            }
-            free(result->psi);
-            // Free delta matrix
-            for (int t = 0; t < T; t++) {
-                free(result->delta[t]);
-            }
-            free(result->delta);
-            free(result);
-            return NULL;
-        }
+    return result;
+}
+
+void free_viterbi_result(ViterbiResult* result) {
+    // Structure, matrices and path share one allocation
+    free(result);
+}
+
+void free_viterbi_result_enhanced(ViterbiResult* result, int T) {
+    (void)T;
+    free_viterbi_result(result);
+}
+
+ViterbiWorkspace* viterbi_workspace_create(int max_T, int N) {
+    ViterbiWorkspace* workspace = (ViterbiWorkspace*)malloc(sizeof(ViterbiWorkspace));
+    if (workspace == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for ViterbiWorkspace\n");
+        return NULL;
     }
     
-    // Allocate path array (Tx1)
-    result->path = (int*)malloc(T * sizeof(int));
-    if (result->path == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for path array\n");
-        // Free psi matrix
-        for (int t = 0; t < T; t++) {
-            free(result->psi[t]);
-        }
-        free(result->psi);
-        // Free delta matrix
-        for (int t = 0; t < T; t++) {
-            free(result->delta[t]);
-        }
-        free(result->delta);
-        free(result);
+    workspace->result = allocate_viterbi_result(max_T, N);
+    if (workspace->result == NULL) {
+        free(workspace);
         return NULL;
     }
+    workspace->max_T = max_T;
+    workspace->N = N;
+    workspace->result->T = 0;
     
-    return result;
+    return workspace;
 }
 
-void free_viterbi_result(ViterbiResult* result) {
-    if (result == NULL) return;
+int viterbi_workspace_reserve(ViterbiWorkspace* workspace, int T, int N) {
+    if (workspace == NULL) {
+        fprintf(stderr, "Error: NULL workspace passed to viterbi_workspace_reserve\n");
+        return 0;
+    }
     
-    // Free delta matrix
-    if (result->delta != NULL) {
-        // Note: We need to know T to free properly, but it's not stored in the structure
-        // This assumes the caller will manage the dimensions properly
-        // In a production system, we might want to store T and N in the structure
-        free(result->delta);
+    if (T <= workspace->max_T && N == workspace->N) {
+        return 1; // Steady state: buffers already large enough
     }
     
-    // Free psi matrix
-    if (result->psi != NULL) {
-        free(result->psi);
+    // Grow geometrically so a slowly increasing T does not reallocate every call
+    int new_T = T;
+    if (N == workspace->N && T < workspace->max_T + workspace->max_T / 2) {
+        new_T = workspace->max_T + workspace->max_T / 2;
     }
     
-    // Free path array
-    if (result->path != NULL) {
-        free(result->path);
+    ViterbiResult* grown = allocate_viterbi_result(new_T, N);
+    if (grown == NULL) {
+        return 0; // Old buffers stay valid
     }
     
-    // Free main structure
-    free(result);
+    free_viterbi_result(workspace->result);
+    workspace->result = grown;
+    workspace->max_T = new_T;
+    workspace->N = N;
+    workspace->result->T = 0;
+    
+    return 1;
 }
 
-// Enhanced free function that properly deallocates matrices
-void free_viterbi_result_enhanced(ViterbiResult* result, int T) {
-    if (result == NULL) return;
+void viterbi_workspace_reset(ViterbiWorkspace* workspace) {
+    if (workspace == NULL) return;
     
-    // Free delta matrix
-    if (result->delta != NULL) {
-        for (int t = 0; t < T; t++) {
-            if (result->delta[t] != NULL) {
-                free(result->delta[t]);
+    ViterbiResult* result = workspace->result;
+    result->T = 0;
+    result->probability = 0.0;
+    result->log_probability = -INFINITY;
+    result->log_domain = 0;
+}
+
+void viterbi_workspace_free(ViterbiWorkspace* workspace) {
+    if (workspace == NULL) return;
+    
+    free_viterbi_result(workspace->result);
+    free(workspace);
+}
+
+// =============================================================================
+// FILE I/O FUNCTIONS
+// =============================================================================
+
+// Longest state or symbol name accepted in a model file
+#define NAME_MAX_LENGTH 255
+
+// Consume `keyword` if it is the next token of the file; otherwise leave the
+// file position unchanged
+static int read_keyword(FILE* file, const char* keyword) {
+    long position = ftell(file);
+    char token[16];
+    if (fscanf(file, "%15s", token) == 1 && strcmp(token, keyword) == 0) {
+        return 1;
+    }
+    fseek(file, position, SEEK_SET);
+    return 0;
+}
+
+// Read `count` whitespace-separated names into one malloc'd block: the pointer
+// array followed by the strings (free the array only). NULL on failure.
+static char** read_names(FILE* file, int count, const char* kind) {
+    size_t capacity = 16 * (size_t)count;
+    size_t used = 0;
+    size_t* offsets = (size_t*)malloc((size_t)count * sizeof(size_t));
+    char* text = (char*)malloc(capacity);
+    char token[NAME_MAX_LENGTH + 1];
+    char** names = NULL;
+    
+    int ok = offsets != NULL && text != NULL;
+    for (int i = 0; ok && i < count; i++) {
+        if (fscanf(file, "%255s", token) != 1) {
+            fprintf(stderr, "Error: Failed to read %s name %d\n", kind, i);
+            ok = 0;
+            break;
+        }
+        size_t length = strlen(token) + 1;
+        if (used + length > capacity) {
+            capacity = 2 * capacity + length;
+            char* grown = (char*)realloc(text, capacity);
+            if (grown == NULL) {
+                ok = 0;
+                break;
             }
+            text = grown;
         }
-        free(result->delta);
-    }
-    
-    // Free psi matrix
-    if (result->psi != NULL) {
-        for (int t = 0; t < T; t++) {
-            if (result->psi[t] != NULL) {
-                free(result->psi[t]);
+        memcpy(text + used, token, length);
+        offsets[i] = used;
+        used += length;
+    }
+    
+    if (ok) {
+        names = (char**)malloc((size_t)count * sizeof(char*) + used);
+        if (names != NULL) {
+            char* copy = (char*)(names + count);
+            memcpy(copy, text, used);
+            for (int i = 0; i < count; i++) {
+                names[i] = copy + offsets[i];
             }
         }
-        free(result->psi);
     }
-    
-    // Free path array
-    if (result->path != NULL) {
-        free(result->path);
+    if (names == NULL && ok) {
+        fprintf(stderr, "Error: Failed to allocate memory for %d %s names\n", count, kind);
     }
     
-    // Free main structure
-    free(result);
+    free(offsets);
+    free(text);
+    return names;
 }
 
-// =============================================================================
-// FILE I/O FUNCTIONS
-// =============================================================================
-
-HMM* load_hmm(char* filename) {
+HMM* load_hmm_with_observations(char* filename, int** observations) {
+    if (observations != NULL) {
+        *observations = NULL;
+    }
+    HMM_PROFILE_BEGIN_CALL(mark);
+    
     FILE* file = fopen(filename, "r");
     if (file == NULL) {
         fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
@@ -316,8 +337,28 @@ HMM* load_hmm(char* filename) {
         return NULL;
     }
     
+    // Optional dictionaries: "states: name ..." and "symbols: name ..."
+    char** state_names = NULL;
+    char** symbol_names = NULL;
+    int names_ok = 1;
+    if (read_keyword(file, "states:")) {
+        state_names = read_names(file, N, "state");
+        names_ok = state_names != NULL;
+    }
+    if (names_ok && read_keyword(file, "symbols:")) {
+        symbol_names = read_names(file, M, "symbol");
+        names_ok = symbol_names != NULL;
+    }
+    
     // Allocate HMM structure
-    HMM* hmm = allocate_hmm(N, M, T);
+    HMM* hmm = names_ok ? allocate_hmm(N, M, T) : NULL;
+    if (hmm != NULL && (state_names != NULL || symbol_names != NULL)
+        && !hmm_set_names(hmm, (const char* const*)state_names, (const char* const*)symbol_names)) {
+        free_hmm(hmm);
+        hmm = NULL;
+    }
+    free(state_names);
+    free(symbol_names);
     if (hmm == NULL) {
         fclose(file);
         return NULL;
@@ -326,7 +367,7 @@ HMM* load_hmm(char* filename) {
     // Read transition matrix A (NxN)
     for (int i = 0; i < N; i++) {
         for (int j = 0; j < N; j++) {
-            if (fscanf(file, "%lf", &hmm->transition[i][j]) != 1) {
+            if (fscanf(file, "%lf", &HMM_A(hmm, i, j)) != 1) {
                 fprintf(stderr, "Error: Failed to read transition matrix element [%d][%d]\n", i, j);
                 free_hmm(hmm);
                 fclose(file);
@@ -338,7 +379,7 @@ HMM* load_hmm(char* filename) {
     // Read emission matrix B (NxM)
     for (int i = 0; i < N; i++) {
         for (int j = 0; j < M; j++) {
-            if (fscanf(file, "%lf", &hmm->emission[i][j]) != 1) {
+            if (fscanf(file, "%lf", &HMM_B(hmm, i, j)) != 1) {
                 fprintf(stderr, "Error: Failed to read emission matrix element [%d][%d]\n", i, j);
                 free_hmm(hmm);
                 fclose(file);
@@ -357,42 +398,148 @@ HMM* load_hmm(char* filename) {
         }
     }
     
+    // Observation sequence (T symbols) right after π, in the same pass
+    if (observations != NULL) {
+        int* sequence = (int*)malloc((size_t)T * sizeof(int));
+        if (sequence == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory for observations\n");
+            free_hmm(hmm);
+            fclose(file);
+            return NULL;
+        }
+        for (int t = 0; t < T; t++) {
+            if (fscanf(file, "%d", &sequence[t]) != 1) {
+                fprintf(stderr, "Error: Failed to read observation %d\n", t);
+                free(sequence);
+                free_hmm(hmm);
+                fclose(file);
+                return NULL;
+            }
+        }
+        *observations = sequence;
+    }
+    
     fclose(file);
     
     // Validate loaded HMM
     if (!validate_hmm(hmm)) {
         fprintf(stderr, "Error: Loaded HMM failed validation\n");
+        if (observations != NULL) {
+            free(*observations);
+            *observations = NULL;
+        }
         free_hmm(hmm);
         return NULL;
     }
     
+    // Precompute Aᵀ, log Aᵀ, log B, log π once per model
+    hmm_prepare(hmm);
+    
+    HMM_PROFILE_PHASE(HMM_PHASE_LOAD, mark);
+    HMM_PROFILE_END_CALL();
     return hmm;
 }
 
-// =============================================================================
-// CORE ALGORITHM FUNCTIONS
-// =============================================================================
+HMM* load_hmm(char* filename) {
+    return load_hmm_with_observations(filename, NULL);
+}
 
-ViterbiResult* viterbi_algorithm(HMM* hmm, int* observations) {
-    if (hmm == NULL || observations == NULL) {
-        fprintf(stderr, "Error: NULL pointer passed to viterbi_algorithm\n");
-        return NULL;
+int save_hmm(const HMM* hmm, const char* filename, const int* observations) {
+    if (hmm == NULL || filename == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to save_hmm\n");
+        return -1;
     }
     
-    // Validate observations
-    if (!validate_observations(observations, hmm->sequence_length)) {
-        fprintf(stderr, "Error: Invalid observation sequence\n");
-        return NULL;
+    FILE* file = fopen(filename, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        return -1;
     }
     
     int N = hmm->num_states;
-    int T = hmm->sequence_length;
+    int M = hmm->num_observations;
     
-    // Allocate result structure
-    ViterbiResult* result = allocate_viterbi_result(T, N);
-    if (result == NULL) {
-        return NULL;
+    // Dimensions
+    fprintf(file, "%d\n%d\n%d\n", N, M, hmm->sequence_length);
+    
+    // Names, if the model has them
+    if (hmm_state_name(hmm, 0) != NULL) {
+        fprintf(file, "states:");
+        for (int i = 0; i < N; i++) fprintf(file, " %s", hmm_state_name(hmm, i));
+        fprintf(file, "\n");
     }
+    if (hmm_symbol_name(hmm, 0) != NULL) {
+        fprintf(file, "symbols:");
+        for (int k = 0; k < M; k++) fprintf(file, " %s", hmm_symbol_name(hmm, k));
+        fprintf(file, "\n");
+    }
+    
+    // Transition matrix A (NxN), one row per line
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            fprintf(file, "%.17g%c", HMM_A(hmm, i, j), j < N-1 ? ' ' : '\n');
+        }
+    }
+    
+    // Emission matrix B (NxM)
+    for (int i = 0; i < N; i++) {
+        for (int k = 0; k < M; k++) {
+            fprintf(file, "%.17g%c", HMM_B(hmm, i, k), k < M-1 ? ' ' : '\n');
+        }
+    }
+    
+    // Initial probabilities π
+    for (int i = 0; i < N; i++) {
+        fprintf(file, "%.17g%c", hmm->initial[i], i < N-1 ? ' ' : '\n');
+    }
+    
+    // Observation sequence
+    if (observations != NULL) {
+        for (int t = 0; t < hmm->sequence_length; t++) {
+            fprintf(file, "%d%c", observations[t], t < hmm->sequence_length-1 ? ' ' : '\n');
+        }
+    }
+    
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Error: Failed to write file '%s'\n", filename);
+        return -1;
+    }
+    return 0;
+}
+
+// =============================================================================
+// CORE ALGORITHM FUNCTIONS
+// =============================================================================
+
+// Operands of a fixed-size recursion into result (Aᵀ/Bᵀ or their logs)
+static HmmRecursionArgs recursion_args(const HMM* hmm, const double* transition_t, const double* emission_t,
+                                       const int* observations, int T, ViterbiResult* result) {
+    HmmRecursionArgs args;
+    args.transition_t = transition_t;
+    args.emission_t = emission_t;
+    args.stride = hmm->transition_stride;
+    args.observations = observations;
+    args.T = T;
+    args.delta = result->delta;
+    args.delta_stride = result->delta_stride;
+    args.psi = result->psi;
+    args.psi_stride = result->psi_stride;
+    return args;
+}
+
+#ifdef HMM_INSTRUMENTATION
+// Bytes a decode streams through: every step reads N columns of A and one of
+// B (parameter_bytes per entry) and writes one row of δ and ψ
+static unsigned long long decode_bytes(int N, int T, size_t parameter_bytes) {
+    return (unsigned long long)T * N * ((N + 1) * parameter_bytes + sizeof(double) + sizeof(int));
+}
+#endif
+
+// Linear-domain recursion into a result sized for at least T steps
+static void viterbi_run_linear(const HMM* hmm, const int* observations, int T, ViterbiResult* result) {
+    int N = hmm->num_states;
+    result->T = T;
+    HMM_PROFILE_MARK(mark);
     
     // ==========================================================================
     // PHASE 1: INITIALIZATION (t=1)
@@ -400,12 +547,15 @@ ViterbiResult* viterbi_algorithm(HMM* hmm, int* observations) {
     // ψ₁(i) = 0
     // ==========================================================================
     
+    // B(·,oₜ) for every state is one contiguous row of Bᵀ
+    const double* emission = HMM_B_COLUMN(hmm, observations[0]);
     for (int i = 0; i < N; i++) {
         // δ₁(i) = π(i) × B(i, o₁)
-        result->delta[0][i] = hmm->initial[i] * hmm->emission[i][observations[0]];
+        VITERBI_DELTA(result, 0, i) = hmm->initial[i] * emission[i];
         // ψ₁(i) = 0 (no previous state for first time step)
-        result->psi[0][i] = 0;
+        VITERBI_PSI(result, 0, i) = 0;
     }
+    HMM_PROFILE_PHASE(HMM_PHASE_INITIALIZATION, mark);
     
     // ==========================================================================
     // PHASE 2: RECURSION (t=2 to T)
@@ -413,29 +563,35 @@ ViterbiResult* viterbi_algorithm(HMM* hmm, int* observations) {
     // ψₜ(i) = argmax[δₜ₋₁(j) × A(j,i)]
     // ==========================================================================
     
-    for (int t = 1; t < T; t++) {
-        for (int i = 0; i < N; i++) {
-            // Find maximum over all previous states j
-            double max_prob = -1.0;
-            int best_prev_state = 0;
+    // Tiny models run a recursion specialized for their N (hmm_kernels.h)
+    HmmRecursionKernel fixed = hmm_fixed_recursion(N, 0);
+    if (fixed != NULL) {
+        HmmRecursionArgs args = recursion_args(hmm, hmm->transition_t, hmm->emission_t,
+                                               observations, T, result);
+        fixed(&args);
+    } else {
+        // Kernel variant chosen at startup from CPUID (hmm_kernels.h)
+        HmmMaxKernel max_product = hmm_kernels()->max_product;
+        
+        for (int t = 1; t < T; t++) {
+            const double* prev_delta = VITERBI_DELTA_ROW(result, t-1);
+            emission = HMM_B_COLUMN(hmm, observations[t]);
             
-            for (int j = 0; j < N; j++) {
-                // Calculate δₜ₋₁(j) × A(j,i)
-                double prob = result->delta[t-1][j] * hmm->transition[j][i];
+            for (int i = 0; i < N; i++) {
+                // Find maximum over all previous states j of δₜ₋₁(j) × A(j,i);
+                // column A(·,i) is contiguous in the transposed copy (SIMD kernel)
+                int best_prev_state;
+                double max_prob = max_product(prev_delta, HMM_A_COLUMN(hmm, i), N, &best_prev_state);
                 
-                if (prob > max_prob) {
-                    max_prob = prob;
-                    best_prev_state = j;
-                }
+                // δₜ(i) = max[δₜ₋₁(j) × A(j,i)] × B(i,oₜ)
+                VITERBI_DELTA(result, t, i) = max_prob * emission[i];
+                
+                // ψₜ(i) = argmax[δₜ₋₁(j) × A(j,i)]
+                VITERBI_PSI(result, t, i) = best_prev_state;
             }
-            
-            // δₜ(i) = max[δₜ₋₁(j) × A(j,i)] × B(i,oₜ)
-            result->delta[t][i] = max_prob * hmm->emission[i][observations[t]];
-            
-            // ψₜ(i) = argmax[δₜ₋₁(j) × A(j,i)]
-            result->psi[t][i] = best_prev_state;
         }
     }
+    HMM_PROFILE_PHASE(HMM_PHASE_RECURSION, mark);
     
     // ==========================================================================
     // PHASE 3: TERMINATION
@@ -447,14 +603,210 @@ ViterbiResult* viterbi_algorithm(HMM* hmm, int* observations) {
     int best_final_state = 0;
     
     for (int i = 0; i < N; i++) {
-        if (result->delta[T-1][i] > max_final_prob) {
-            max_final_prob = result->delta[T-1][i];
+        if (VITERBI_DELTA(result, T-1, i) > max_final_prob) {
+            max_final_prob = VITERBI_DELTA(result, T-1, i);
             best_final_state = i;
         }
     }
     
     result->probability = max_final_prob;
+    result->log_probability = log(max_final_prob);
+    result->log_domain = 0;
+    result->path[T-1] = best_final_state;
+    HMM_PROFILE_PHASE(HMM_PHASE_TERMINATION, mark);
+    
+    // ==========================================================================
+    // PHASE 4: BACKTRACKING
+    // q*ₜ = ψₜ₊₁(q*ₜ₊₁) for t = T-1 down to 1
+    // ==========================================================================
+    
+    for (int t = T-2; t >= 0; t--) {
+        result->path[t] = VITERBI_PSI(result, t+1, result->path[t+1]);
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_BACKTRACKING, mark);
+    HMM_PROFILE_COUNT(HMM_COUNTER_CELLS, (long long)N * T);
+    HMM_PROFILE_COUNT(HMM_COUNTER_TRANSITIONS, (long long)N * N * (T - 1));
+    HMM_PROFILE_COUNT(HMM_COUNTER_BYTES, decode_bytes(N, T, sizeof(double)));
+}
+
+// Log-domain phases 1 and 2 in double precision
+static void viterbi_recursion_log(const HMM* hmm, const int* observations, int T, ViterbiResult* result) {
+    int N = hmm->num_states;
+    HMM_PROFILE_MARK(mark);
+    
+    // ==========================================================================
+    // PHASE 1: INITIALIZATION (t=1)
+    // log δ₁(i) = log π(i) + log B(i, o₁)
+    // ==========================================================================
+    
+    const double* log_emission = HMM_LOG_B_COLUMN(hmm, observations[0]);
+    for (int i = 0; i < N; i++) {
+        VITERBI_DELTA(result, 0, i) = hmm->log_initial[i] + log_emission[i];
+        VITERBI_PSI(result, 0, i) = 0;
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_INITIALIZATION, mark);
+    
+    // ==========================================================================
+    // PHASE 2: RECURSION (t=2 to T)
+    // log δₜ(i) = max[log δₜ₋₁(j) + log A(j,i)] + log B(i,oₜ)
+    // ψₜ(i) = argmax[log δₜ₋₁(j) + log A(j,i)]
+    // ==========================================================================
+    
+    // Tiny models run a recursion specialized for their N (hmm_kernels.h)
+    HmmRecursionKernel fixed = hmm_fixed_recursion(N, 1);
+    if (fixed != NULL) {
+        HmmRecursionArgs args = recursion_args(hmm, hmm->log_transition_t, hmm->log_emission_t,
+                                               observations, T, result);
+        fixed(&args);
+    } else {
+        HmmMaxKernel max_sum = hmm_kernels()->max_sum;
+        
+        for (int t = 1; t < T; t++) {
+            const double* prev_delta = VITERBI_DELTA_ROW(result, t-1);
+            log_emission = HMM_LOG_B_COLUMN(hmm, observations[t]);
+            
+            for (int i = 0; i < N; i++) {
+                // max over j of log δₜ₋₁(j) + log A(j,i); if every predecessor is
+                // impossible the result is -INFINITY and the argmax stays at state 0
+                int best_prev_state;
+                double max_score = max_sum(prev_delta, HMM_LOG_A_COLUMN(hmm, i), N, &best_prev_state);
+                
+                VITERBI_DELTA(result, t, i) = max_score + log_emission[i];
+                VITERBI_PSI(result, t, i) = best_prev_state;
+            }
+        }
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_RECURSION, mark);
+}
+
+// Phases 1 and 2 with float log A / log B / log π and double log δ
+static void viterbi_recursion_mixed(const HMM* hmm, const int* observations, int T, ViterbiResult* result) {
+    int N = hmm->num_states;
+    HmmMaxKernelMixed max_sum = hmm_kernels()->max_sum_mixed;
+    HMM_PROFILE_MARK(mark);
+    
+    const float* log_emission = HMM_LOG_B_COLUMN_F(hmm, observations[0]);
+    for (int i = 0; i < N; i++) {
+        VITERBI_DELTA(result, 0, i) = (double)hmm->log_initial_f[i] + (double)log_emission[i];
+        VITERBI_PSI(result, 0, i) = 0;
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_INITIALIZATION, mark);
+    
+    for (int t = 1; t < T; t++) {
+        const double* prev_delta = VITERBI_DELTA_ROW(result, t-1);
+        log_emission = HMM_LOG_B_COLUMN_F(hmm, observations[t]);
+        
+        for (int i = 0; i < N; i++) {
+            int best_prev_state;
+            double max_score = max_sum(prev_delta, HMM_LOG_A_COLUMN_F(hmm, i), N, &best_prev_state);
+            
+            VITERBI_DELTA(result, t, i) = max_score + (double)log_emission[i];
+            VITERBI_PSI(result, t, i) = best_prev_state;
+        }
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_RECURSION, mark);
+}
+
+// Subtract the maximum of a float log δ row (if any state is reachable)
+static float renormalize_row(float* row, int N) {
+    float top = -INFINITY;
+    for (int i = 0; i < N; i++) {
+        if (row[i] > top) top = row[i];
+    }
+    if (top == -INFINITY) return 0.0f;
+    
+    for (int i = 0; i < N; i++) {
+        row[i] -= top;
+    }
+    return top;
+}
+
+// Widen a float row stored at the start of a δ row into log δ = value + offset.
+// Going down from i = N-1 never overwrites a float that is still to be read
+// (double i covers floats 2i and 2i+1); memcpy keeps the two views of the
+// same bytes well-defined.
+static void widen_row(double* row, int N, double offset) {
+    unsigned char* bytes = (unsigned char*)row;
+    for (int i = N - 1; i >= 0; i--) {
+        float value;
+        memcpy(&value, bytes + (size_t)i * sizeof(float), sizeof(float));
+        double widened = (double)value + offset;
+        memcpy(bytes + (size_t)i * sizeof(double), &widened, sizeof(double));
+    }
+}
+
+// Phases 1 and 2 entirely in float. Each step's float log δ lives in the first
+// half of its own δ row and is widened in place once the next step has read
+// it. The row maximum is subtracted after every step and accumulated in
+// double, so the float values stay small however long the sequence is.
+static void viterbi_recursion_float(const HMM* hmm, const int* observations, int T, ViterbiResult* result) {
+    int N = hmm->num_states;
+    HmmMaxKernelFloat max_sum = hmm_kernels()->max_sum_float;
+    HMM_PROFILE_MARK(mark);
+    
+    float* prev_delta = (float*)VITERBI_DELTA_ROW(result, 0);
+    const float* log_emission = HMM_LOG_B_COLUMN_F(hmm, observations[0]);
+    for (int i = 0; i < N; i++) {
+        prev_delta[i] = hmm->log_initial_f[i] + log_emission[i];
+        VITERBI_PSI(result, 0, i) = 0;
+    }
+    double offset = renormalize_row(prev_delta, N);
+    HMM_PROFILE_PHASE(HMM_PHASE_INITIALIZATION, mark);
+    
+    for (int t = 1; t < T; t++) {
+        float* delta = (float*)VITERBI_DELTA_ROW(result, t);
+        log_emission = HMM_LOG_B_COLUMN_F(hmm, observations[t]);
+        
+        for (int i = 0; i < N; i++) {
+            int best_prev_state;
+            float max_score = max_sum(prev_delta, HMM_LOG_A_COLUMN_F(hmm, i), N, &best_prev_state);
+            
+            delta[i] = max_score + log_emission[i];
+            VITERBI_PSI(result, t, i) = best_prev_state;
+        }
+        
+        float shift = renormalize_row(delta, N);
+        widen_row(VITERBI_DELTA_ROW(result, t-1), N, offset);
+        offset += shift;
+        prev_delta = delta;
+    }
+    widen_row(VITERBI_DELTA_ROW(result, T-1), N, offset);
+    HMM_PROFILE_PHASE(HMM_PHASE_RECURSION, mark);
+}
+
+// Log-domain recursion into a result sized for at least T steps
+static void viterbi_run_log(const HMM* hmm, const int* observations, int T, ViterbiResult* result) {
+    int N = hmm->num_states;
+    result->T = T;
+    
+    // Phases 1 and 2 in the precision selected for the model
+    switch (hmm->precision) {
+        case HMM_PRECISION_MIXED: viterbi_recursion_mixed(hmm, observations, T, result); break;
+        case HMM_PRECISION_FLOAT: viterbi_recursion_float(hmm, observations, T, result); break;
+        default: viterbi_recursion_log(hmm, observations, T, result); break;
+    }
+    HMM_PROFILE_MARK(mark);
+    
+    // ==========================================================================
+    // PHASE 3: TERMINATION
+    // log P* = max[log δₜ(i)]
+    // ==========================================================================
+    
+    double max_final_score = -INFINITY;
+    int best_final_state = 0;
+    
+    for (int i = 0; i < N; i++) {
+        if (VITERBI_DELTA(result, T-1, i) > max_final_score) {
+            max_final_score = VITERBI_DELTA(result, T-1, i);
+            best_final_state = i;
+        }
+    }
+    
+    result->log_probability = max_final_score;
+    result->probability = exp(max_final_score);
+    result->log_domain = 1;
     result->path[T-1] = best_final_state;
+    HMM_PROFILE_PHASE(HMM_PHASE_TERMINATION, mark);
     
     // ==========================================================================
     // PHASE 4: BACKTRACKING
@@ -462,16 +814,148 @@ ViterbiResult* viterbi_algorithm(HMM* hmm, int* observations) {
     // ==========================================================================
     
     for (int t = T-2; t >= 0; t--) {
-        result->path[t] = result->psi[t+1][result->path[t+1]];
+        result->path[t] = VITERBI_PSI(result, t+1, result->path[t+1]);
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_BACKTRACKING, mark);
+    HMM_PROFILE_COUNT(HMM_COUNTER_CELLS, (long long)N * T);
+    HMM_PROFILE_COUNT(HMM_COUNTER_TRANSITIONS, (long long)N * N * (T - 1));
+    HMM_PROFILE_COUNT(HMM_COUNTER_BYTES, decode_bytes(N, T, hmm->precision == HMM_PRECISION_DOUBLE
+                                                            ? sizeof(double) : sizeof(float)));
+}
+
+ViterbiResult* viterbi_algorithm(HMM* hmm, int* observations) {
+    if (hmm == NULL || observations == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to viterbi_algorithm\n");
+        return NULL;
+    }
+    HMM_PROFILE_BEGIN_CALL(mark);
+    
+    // Validate observations
+    if (!validate_observations(observations, hmm->sequence_length, hmm->num_observations)) {
+        fprintf(stderr, "Error: Invalid observation sequence\n");
+        return NULL;
+    }
+    
+    // Aᵀ is a derived layout; hand-built models get it here
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    // Allocate result structure
+    ViterbiResult* result = allocate_viterbi_result(hmm->sequence_length, hmm->num_states);
+    if (result == NULL) {
+        return NULL;
+    }
+    
+    HMM_PROFILE_PHASE(HMM_PHASE_SETUP, mark);
+    viterbi_run_linear(hmm, observations, hmm->sequence_length, result);
+    HMM_PROFILE_END_CALL();
+    return result;
+}
+
+ViterbiResult* viterbi_algorithm_log(HMM* hmm, int* observations) {
+    if (hmm == NULL || observations == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to viterbi_algorithm_log\n");
+        return NULL;
+    }
+    HMM_PROFILE_BEGIN_CALL(mark);
+    
+    // Validate observations
+    if (!validate_observations(observations, hmm->sequence_length, hmm->num_observations)) {
+        fprintf(stderr, "Error: Invalid observation sequence\n");
+        return NULL;
+    }
+    
+    // Log parameters are normally prepared by load_hmm; hand-built models get them here
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
     }
     
+    // Allocate result structure
+    ViterbiResult* result = allocate_viterbi_result(hmm->sequence_length, hmm->num_states);
+    if (result == NULL) {
+        return NULL;
+    }
+    
+    HMM_PROFILE_PHASE(HMM_PHASE_SETUP, mark);
+    viterbi_run_log(hmm, observations, hmm->sequence_length, result);
+    HMM_PROFILE_END_CALL();
     return result;
 }
 
+const ViterbiResult* viterbi_decode(HMM* hmm, const int* observations, int T,
+                                    ViterbiMode mode, ViterbiWorkspace* workspace) {
+    if (hmm == NULL || observations == NULL || workspace == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to viterbi_decode\n");
+        return NULL;
+    }
+    if (T <= 0) {
+        fprintf(stderr, "Error: Invalid sequence length %d passed to viterbi_decode\n", T);
+        return NULL;
+    }
+    HMM_PROFILE_BEGIN_CALL(mark);
+    
+    // Validate observations
+    if (!validate_observations((int*)observations, T, hmm->num_observations)) {
+        fprintf(stderr, "Error: Invalid observation sequence\n");
+        return NULL;
+    }
+    
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    // Only allocates when T or N exceed what the workspace already holds
+    if (!viterbi_workspace_reserve(workspace, T, hmm->num_states)) {
+        return NULL;
+    }
+    
+    HMM_PROFILE_PHASE(HMM_PHASE_SETUP, mark);
+    if (mode == VITERBI_MODE_LOG) {
+        viterbi_run_log(hmm, observations, T, workspace->result);
+    } else {
+        viterbi_run_linear(hmm, observations, T, workspace->result);
+    }
+    HMM_PROFILE_END_CALL();
+    return workspace->result;
+}
+
 // =============================================================================
 // OUTPUT AND DEBUGGING FUNCTIONS
 // =============================================================================
 
+// Display name of state i: the model's own, or "S<i>" written into buffer (16 bytes)
+static const char* state_label(const HMM* hmm, int i, char* buffer) {
+    const char* name = hmm_state_name(hmm, i);
+    if (name != NULL) return name;
+    snprintf(buffer, 16, "S%d", i);
+    return buffer;
+}
+
+// Display name of symbol k, like state_label ("O<k>" if unnamed)
+static const char* symbol_label(const HMM* hmm, int k, char* buffer) {
+    const char* name = hmm_symbol_name(hmm, k);
+    if (name != NULL) return name;
+    snprintf(buffer, 16, "O%d", k);
+    return buffer;
+}
+
+// Print n as subscript digits (δ₁, δ₁₂, ...)
+static void print_subscript(int n) {
+    if (n >= 10) print_subscript(n / 10);
+    printf("\xE2\x82%c", 0x80 + n % 10);
+}
+
+// Column header with one label per state, aligned with "%.3f   " cells
+static void print_state_header(const HMM* hmm) {
+    char state[16];
+    printf("        ");
+    for (int i = 0; i < hmm->num_states; i++) {
+        printf("%-7s ", state_label(hmm, i, state));
+    }
+    printf("\n");
+}
+
 void print_step_by_step(ViterbiResult* result, HMM* hmm, int* observations, int verbose) {
     if (result == NULL || hmm == NULL || observations == NULL) {
         printf("Error: NULL pointer in print_step_by_step\n");
@@ -479,17 +963,25 @@ void print_step_by_step(ViterbiResult* result, HMM* hmm, int* observations, int
     }
     
     int N = hmm->num_states;
+    int M = hmm->num_observations;
     int T = hmm->sequence_length;
+    char state[16], symbol[16];
     
     printf("VITERBI ALGORITHM - WEATHER PREDICTION\n");
     printf("=====================================\n\n");
     
     printf("INPUT PARAMETERS:\n");
-    printf("States: SUNNY(0), CLOUDY(1), RAINY(2)\n");
-    printf("Observations: UMBRELLA(0), SUNGLASSES(1), STAY_HOME(2)\n");
+    printf("States: ");
+    for (int i = 0; i < N; i++) {
+        printf("%s(%d)%s", state_label(hmm, i, state), i, i < N-1 ? ", " : "\n");
+    }
+    printf("Observations: ");
+    for (int k = 0; k < M; k++) {
+        printf("%s(%d)%s", symbol_label(hmm, k, symbol), k, k < M-1 ? ", " : "\n");
+    }
     printf("Sequence: [");
     for (int t = 0; t < T; t++) {
-        printf("%s", OBSERVATION_NAMES[observations[t]]);
+        printf("%s", symbol_label(hmm, observations[t], symbol));
         if (t < T-1) printf(", ");
     }
     printf("]\n\n");
@@ -497,11 +989,11 @@ void print_step_by_step(ViterbiResult* result, HMM* hmm, int* observations, int
     if (verbose) {
         // Print transition matrix
         printf("TRANSITION MATRIX A:\n");
-        printf("        SUNNY   CLOUDY  RAINY\n");
+        print_state_header(hmm);
         for (int i = 0; i < N; i++) {
-            printf("%-7s ", STATE_NAMES[i]);
+            printf("%-7s ", state_label(hmm, i, state));
             for (int j = 0; j < N; j++) {
-                printf("%.3f   ", hmm->transition[i][j]);
+                printf("%.3f   ", HMM_A(hmm, i, j));
             }
             printf("\n");
         }
@@ -509,63 +1001,68 @@ void print_step_by_step(ViterbiResult* result, HMM* hmm, int* observations, int
         
         // Print emission matrix
         printf("EMISSION MATRIX B:\n");
-        printf("        UMBRELLA SUNGLASSES STAY_HOME\n");
+        printf("        ");
+        for (int k = 0; k < M; k++) {
+            printf("%-8s ", symbol_label(hmm, k, symbol));
+        }
+        printf("\n");
         for (int i = 0; i < N; i++) {
-            printf("%-7s ", STATE_NAMES[i]);
-            for (int j = 0; j < hmm->num_observations; j++) {
-                printf("%.3f    ", hmm->emission[i][j]);
+            printf("%-7s ", state_label(hmm, i, state));
+            for (int j = 0; j < M; j++) {
+                printf("%.3f    ", HMM_B(hmm, i, j));
             }
             printf("\n");
         }
         printf("\n");
         
         // Print initialization step
-        printf("INITIALIZATION (t=1, obs=%s):\n", OBSERVATION_NAMES[observations[0]]);
+        printf("INITIALIZATION (t=1, obs=%s):\n", symbol_label(hmm, observations[0], symbol));
         for (int i = 0; i < N; i++) {
+            const char* name = state_label(hmm, i, state);
             printf("δ₁(%s)  = π(%s)  × B(%s,%s)  = %.3f × %.3f = %.3f\n",
-                   STATE_NAMES[i], STATE_NAMES[i], STATE_NAMES[i], 
-                   OBSERVATION_NAMES[observations[0]],
-                   hmm->initial[i], hmm->emission[i][observations[0]], 
-                   result->delta[0][i]);
+                   name, name, name, 
+                   symbol_label(hmm, observations[0], symbol),
+                   hmm->initial[i], HMM_B(hmm, i, observations[0]), 
+                   VITERBI_DELTA(result, 0, i));
         }
         printf("\n");
         
         // Print delta matrix for first step
         printf("DELTA MATRIX (t=1):\n");
-        printf("        SUNNY   CLOUDY  RAINY\n");
+        print_state_header(hmm);
         printf("t=1     ");
         for (int i = 0; i < N; i++) {
-            printf("%.3f   ", result->delta[0][i]);
+            printf("%.3f   ", VITERBI_DELTA(result, 0, i));
         }
         printf("\n\n");
         
         // Print recursion steps
         printf("RECURSION:\n");
         for (int t = 1; t < T; t++) {
-            printf("t=%d, observation=%s(%d):\n", t+1, OBSERVATION_NAMES[observations[t]], observations[t]);
+            printf("t=%d, observation=%s(%d):\n", t+1, symbol_label(hmm, observations[t], symbol), observations[t]);
             
             for (int i = 0; i < N; i++) {
-                printf("For %s:  max{", STATE_NAMES[i]);
+                printf("For %s:  max{", state_label(hmm, i, state));
                 for (int j = 0; j < N; j++) {
-                    printf("%.3f×%.1f", result->delta[t-1][j], hmm->transition[j][i]);
+                    printf("%.3f×%.1f", VITERBI_DELTA(result, t-1, j), HMM_A(hmm, j, i));
                     if (j < N-1) printf(", ");
                 }
                 
                 // Find the maximum for display
                 double max_transition = -1.0;
                 for (int j = 0; j < N; j++) {
-                    double prob = result->delta[t-1][j] * hmm->transition[j][i];
+                    double prob = VITERBI_DELTA(result, t-1, j) * HMM_A(hmm, j, i);
                     if (prob > max_transition) {
                         max_transition = prob;
                     }
                 }
                 
-                printf("} × %.1f = max{", hmm->emission[i][observations[t]]);
+                printf("} × %.1f = max{", HMM_B(hmm, i, observations[t]));
                 for (int j = 0; j < N; j++) {
-                    printf("%.3f", result->delta[t-1][j] * hmm->transition[j][i]);
+                    printf("%.3f", VITERBI_DELTA(result, t-1, j) * HMM_A(hmm, j, i));
                     if (j < N-1) printf(", ");
                 }
-                printf("} × %.1f = %.3f\n", hmm->emission[i][observations[t]], result->delta[t][i]);
+                printf("} × %.1f = %.3f\n", HMM_B(hmm, i, observations[t]), VITERBI_DELTA(result, t, i));
             }
             printf("\n");
         }
@@ -573,21 +1070,23 @@ void print_step_by_step(ViterbiResult* result, HMM* hmm, int* observations, int
         // Print termination
         printf("TERMINATION:\n");
         for (int i = 0; i < N; i++) {
-            printf("δ₇(%s)  = %.6f\n", STATE_NAMES[i], result->delta[T-1][i]);
+            printf("δ");
+            print_subscript(T);
+            printf("(%s)  = %.6f\n", state_label(hmm, i, state), VITERBI_DELTA(result, T-1, i));
         }
         printf("Maximum probability: %.6f\n", result->probability);
-        printf("Optimal final state: %s\n\n", STATE_NAMES[result->path[T-1]]);
+        printf("Optimal final state: %s\n\n", state_label(hmm, result->path[T-1], state));
         
         // Print backtracking
         printf("BACKTRACKING:\n");
         for (int t = T-1; t >= 0; t--) {
-            printf("t=%d: state = %s\n", t+1, STATE_NAMES[result->path[t]]);
+            printf("t=%d: state = %s\n", t+1, state_label(hmm, result->path[t], state));
         }
         printf("\n");
     }
 }
 
-void print_matrices_formatted(double** matrix, int rows, int cols, char* title) {
+void print_matrices_formatted(const double* matrix, int rows, int cols, int stride, char* title) {
     if (matrix == NULL || title == NULL) {
         printf("Error: NULL pointer in print_matrices_formatted\n");
         return;
@@ -595,8 +1094,9 @@ void print_matrices_formatted(double** matrix, int rows, int cols, char* title)
     
     printf("%s:\n", title);
     for (int i = 0; i < rows; i++) {
+        const double* row = matrix + (size_t)i * stride;
         for (int j = 0; j < cols; j++) {
-            printf("%.6f  ", matrix[i][j]);
+            printf("%.6f  ", row[j]);
         }
         printf("\n");
     }
@@ -604,6 +1104,10 @@ void print_matrices_formatted(double** matrix, int rows, int cols, char* title)
 }
 
 void print_final_results(ViterbiResult* result) {
+    print_final_results_named(result, NULL);
+}
+
+void print_final_results_named(ViterbiResult* result, const HMM* hmm) {
     if (result == NULL) {
         printf("Error: NULL result in print_final_results\n");
         return;
@@ -612,9 +1116,7 @@ void print_final_results(ViterbiResult* result) {
     printf("FINAL RESULTS:\n");
     printf("Optimal state sequence: [");
     
-    // We need to know T, but it's not stored in result structure
-    // For the weather example, we know T=7
-    int T = 7; // This should ideally be passed as parameter
+    int T = result->T;
     
     for (int t = 0; t < T; t++) {
         printf("%d", result->path[t]);
@@ -622,40 +1124,22 @@ void print_final_results(ViterbiResult* result) {
     }
     printf("]\n");
     
-    printf("Translation: [");
-    for (int t = 0; t < T; t++) {
-        printf("%s", STATE_NAMES[result->path[t]]);
-        if (t < T-1) printf(", ");
+    // Only models with a state dictionary get a translation
+    if (hmm != NULL && hmm->dictionary != NULL && hmm->dictionary->state_names != NULL) {
+        printf("Translation: [");
+        for (int t = 0; t < T; t++) {
+            printf("%s", hmm_state_name(hmm, result->path[t]));
+            if (t < T-1) printf(", ");
+        }
+        printf("]\n");
     }
-    printf("]\n");
     
     printf("Maximum probability: %.10f\n", result->probability);
 }
 
-// Enhanced version that takes sequence length as parameter
 void print_final_results_enhanced(ViterbiResult* result, int T) {
-    if (result == NULL) {
-        printf("Error: NULL result in print_final_results\n");
-        return;
-    }
-    
-    printf("FINAL RESULTS:\n");
-    printf("Optimal state sequence: [");
-    
-    for (int t = 0; t < T; t++) {
-        printf("%d", result->path[t]);
-        if (t < T-1) printf(", ");
-    }
-    printf("]\n");
-    
-    printf("Translation: [");
-    for (int t = 0; t < T; t++) {
-        printf("%s", STATE_NAMES[result->path[t]]);
-        if (t < T-1) printf(", ");
-    }
-    printf("]\n");
-    
-    printf("Maximum probability: %.10f\n", result->probability);
+    (void)T;
+    print_final_results(result);
 }
 
 // =============================================================================
@@ -680,12 +1164,12 @@ int validate_hmm(HMM* hmm) {
     for (int i = 0; i < hmm->num_states; i++) {
         double row_sum = 0.0;
         for (int j = 0; j < hmm->num_states; j++) {
-            if (hmm->transition[i][j] < 0.0 || hmm->transition[i][j] > 1.0) {
+            if (HMM_A(hmm, i, j) < 0.0 || HMM_A(hmm, i, j) > 1.0) {
                 fprintf(stderr, "Validation error: Transition probability [%d][%d] = %.6f is not in [0,1]\n", 
-                        i, j, hmm->transition[i][j]);
+                        i, j, HMM_A(hmm, i, j));
                 return 0;
             }
-            row_sum += hmm->transition[i][j];
+            row_sum += HMM_A(hmm, i, j);
         }
         if (fabs(row_sum - 1.0) > TOLERANCE) {
             fprintf(stderr, "Validation error: Transition matrix row %d sums to %.6f instead of 1.0\n", 
@@ -698,12 +1182,12 @@ int validate_hmm(HMM* hmm) {
     for (int i = 0; i < hmm->num_states; i++) {
         double row_sum = 0.0;
         for (int j = 0; j < hmm->num_observations; j++) {
-            if (hmm->emission[i][j] < 0.0 || hmm->emission[i][j] > 1.0) {
+            if (HMM_B(hmm, i, j) < 0.0 || HMM_B(hmm, i, j) > 1.0) {
                 fprintf(stderr, "Validation error: Emission probability [%d][%d] = %.6f is not in [0,1]\n", 
-                        i, j, hmm->emission[i][j]);
+                        i, j, HMM_B(hmm, i, j));
                 return 0;
             }
-            row_sum += hmm->emission[i][j];
+            row_sum += HMM_B(hmm, i, j);
         }
         if (fabs(row_sum - 1.0) > TOLERANCE) {
             fprintf(stderr, "Validation error: Emission matrix row %d sums to %.6f instead of 1.0\n", 
@@ -730,16 +1214,105 @@ int validate_hmm(HMM* hmm) {
     return 1; // All validations passed
 }
 
-int validate_observations(int* observations, int length) {
+// Round the log parameters to the float copies (reduced precision only)
+static void fill_float_copies(HMM* hmm) {
+    if (hmm->log_transition_t_f == NULL) return;
+    
+    int N = hmm->num_states;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            HMM_LOG_A_COLUMN_F(hmm, i)[j] = (float)HMM_LOG_A_COLUMN(hmm, i)[j];
+        }
+        hmm->log_initial_f[i] = (float)hmm->log_initial[i];
+    }
+    for (int k = 0; k < hmm->num_observations; k++) {
+        for (int i = 0; i < N; i++) {
+            HMM_LOG_B_COLUMN_F(hmm, k)[i] = (float)HMM_LOG_B_COLUMN(hmm, k)[i];
+        }
+    }
+}
+
+int hmm_prepare(HMM* hmm) {
+    if (hmm == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to hmm_prepare\n");
+        return 0;
+    }
+    
+    int N = hmm->num_states;
+    int M = hmm->num_observations;
+    
+    // Aᵀ and log Aᵀ: row i holds column A(·,i), the predecessors of state i,
+    // so the recursion max over j reads one contiguous vector.
+    // Bᵀ and log Bᵀ: row k holds B(·,k), the emission of symbol k by every
+    // state, so each time step reads its emissions as one contiguous vector.
+    // log(0) = -INFINITY, so impossible transitions never win a max
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            HMM_A_COLUMN(hmm, j)[i] = HMM_A(hmm, i, j);
+            HMM_LOG_A(hmm, i, j) = log(HMM_A(hmm, i, j));
+        }
+        for (int k = 0; k < M; k++) {
+            HMM_B_COLUMN(hmm, k)[i] = HMM_B(hmm, i, k);
+            HMM_LOG_B(hmm, i, k) = log(HMM_B(hmm, i, k));
+        }
+        hmm->log_initial[i] = log(hmm->initial[i]);
+    }
+    
+    hmm->prepared = 1;
+    fill_float_copies(hmm);
+    return 1;
+}
+
+int hmm_set_precision(HMM* hmm, HmmPrecision precision) {
+    if (hmm == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to hmm_set_precision\n");
+        return 0;
+    }
+    if (precision != HMM_PRECISION_DOUBLE && precision != HMM_PRECISION_MIXED
+        && precision != HMM_PRECISION_FLOAT) {
+        fprintf(stderr, "Error: Invalid precision %d\n", (int)precision);
+        return 0;
+    }
+    
+    // Float copies in one aligned block: [log Aᵀ | log Bᵀ | log π]. Once
+    // allocated they are kept (and refreshed by hmm_prepare) until free_hmm,
+    // so switching precision back and forth costs nothing.
+    if (precision != HMM_PRECISION_DOUBLE && hmm->log_transition_t_f == NULL) {
+        int N = hmm->num_states;
+        int stride = hmm_padded_stride(N, sizeof(float));
+        size_t transition_size = (size_t)N * stride;
+        size_t symbol_size = (size_t)hmm->num_observations * stride;
+        size_t total = (transition_size + symbol_size + stride) * sizeof(float);
+        
+        float* block = (float*)arena_alloc_aligned(hmm->arena, total, HMM_ALIGNMENT);
+        if (block == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory for float parameters (%zu bytes)\n", total);
+            return 0;
+        }
+        hmm->float_stride = stride;
+        hmm->log_transition_t_f = block;
+        hmm->log_emission_t_f = block + transition_size;
+        hmm->log_initial_f = block + transition_size + symbol_size;
+        fill_float_copies(hmm);
+    }
+    
+    hmm->precision = precision;
+    if (!hmm->prepared) {
+        return hmm_prepare(hmm);
+    }
+    return 1;
+}
+
+int validate_observations(int* observations, int length, int num_symbols) {
     if (observations == NULL) {
         fprintf(stderr, "Validation error: Observations array is NULL\n");
         return 0;
     }
     
     for (int t = 0; t < length; t++) {
-        if (observations[t] < 0 || observations[t] > 2) {
-            fprintf(stderr, "Validation error: Observation [%d] = %d is not a valid symbol (0, 1, or 2)\n", 
-                    t, observations[t]);
+        if (observations[t] < 0 || observations[t] >= num_symbols) {
+            fprintf(stderr, "Validation error: Observation [%d] = %d is not a valid symbol (0 to %d)\n", 
+                    t, observations[t], num_symbols - 1);
             return 0;
         }
     }
@@ -747,70 +1320,202 @@ int validate_observations(int* observations, int length) {
     return 1; // All observations are valid
 }
 
-int run_weather_prediction_example(int verbose) {
-    printf("=== HMM WEATHER PREDICTION EXAMPLE ===\n\n");
+// =============================================================================
+// STATE AND SYMBOL NAMES
+// =============================================================================
+
+// FNV-1a hash of a name
+static unsigned hash_name(const char* name) {
+    unsigned hash = 2166136261u;
+    for (; *name != '\0'; name++) {
+        hash ^= (unsigned char)*name;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Mask of the smallest power-of-two table with at most 50% load
+static unsigned name_table_mask(int count) {
+    unsigned size = 2;
+    while (size < 2u * (unsigned)count) size <<= 1;
+    return size - 1;
+}
+
+// Fill an open-addressing table with names[0..count); 0 on an invalid or duplicate name
+static int build_name_table(char** names, int count, int* slots, unsigned mask, const char* kind) {
+    for (unsigned slot = 0; slot <= mask; slot++) {
+        slots[slot] = -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (names[i][0] == '\0' || strpbrk(names[i], " \t\r\n") != NULL) {
+            fprintf(stderr, "Error: Invalid %s name '%s' (empty or contains whitespace)\n", kind, names[i]);
+            return 0;
+        }
+        unsigned slot = hash_name(names[i]) & mask;
+        while (slots[slot] >= 0) {
+            if (strcmp(names[slots[slot]], names[i]) == 0) {
+                fprintf(stderr, "Error: Duplicate %s name '%s'\n", kind, names[i]);
+                return 0;
+            }
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = i;
+    }
+    return 1;
+}
+
+static int find_name(char** names, const int* slots, unsigned mask, const char* name) {
+    if (names == NULL || name == NULL) return -1;
     
-    // Load HMM from file
-    HMM* hmm = load_hmm("clima_ejemplo.txt");
+    unsigned slot = hash_name(name) & mask;
+    while (slots[slot] >= 0) {
+        if (strcmp(names[slots[slot]], name) == 0) {
+            return slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// Copy `count` names into the dictionary block at *text; returns the pointer array
+static char** copy_names(const char* const* names, int count, char** pointers, char** text) {
+    for (int i = 0; i < count; i++) {
+        size_t length = strlen(names[i]) + 1;
+        memcpy(*text, names[i], length);
+        pointers[i] = *text;
+        *text += length;
+    }
+    return pointers;
+}
+
+int hmm_set_names(HMM* hmm, const char* const* state_names, const char* const* symbol_names) {
     if (hmm == NULL) {
-        printf("Failed to load HMM from file. Make sure 'clima_ejemplo.txt' exists.\n");
-        return -1;
+        fprintf(stderr, "Error: NULL pointer passed to hmm_set_names\n");
+        return 0;
     }
     
-    printf("Successfully loaded HMM with %d states, %d observations, sequence length %d\n\n", 
-           hmm->num_states, hmm->num_observations, hmm->sequence_length);
-    
-    // Read observation sequence from file (already loaded in hmm structure)
-    // For this implementation, we'll read the observations separately
-    FILE* file = fopen("clima_ejemplo.txt", "r");
-    if (file == NULL) {
-        printf("Error: Cannot reopen file to read observations\n");
-        free_hmm(hmm);
-        return -1;
+    int N = hmm->num_states;
+    int M = hmm->num_observations;
+    if (state_names == NULL && symbol_names == NULL) {
+        hmm->dictionary = NULL;
+        return 1;
+    }
+    
+    // Layout of the single block:
+    // [HmmDictionary | state pointers | symbol pointers | state slots | symbol slots | strings]
+    int num_state_names = state_names != NULL ? N : 0;
+    int num_symbol_names = symbol_names != NULL ? M : 0;
+    unsigned state_mask = state_names != NULL ? name_table_mask(N) : 0;
+    unsigned symbol_mask = symbol_names != NULL ? name_table_mask(M) : 0;
+    size_t text_bytes = 0;
+    for (int i = 0; i < num_state_names; i++) text_bytes += strlen(state_names[i]) + 1;
+    for (int k = 0; k < num_symbol_names; k++) text_bytes += strlen(symbol_names[k]) + 1;
+    size_t total = sizeof(HmmDictionary)
+                 + sizeof(char*) * ((size_t)num_state_names + num_symbol_names)
+                 + sizeof(int) * ((state_names != NULL ? (size_t)state_mask + 1 : 0)
+                                  + (symbol_names != NULL ? (size_t)symbol_mask + 1 : 0))
+                 + text_bytes;
+    
+    char* block = (char*)arena_alloc(hmm->arena, total);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for HMM dictionary (%zu bytes)\n", total);
+        return 0;
     }
     
-    // Skip the parameters we already read
-    int dummy;
-    double dummy_double;
+    HmmDictionary* dictionary = (HmmDictionary*)block;
+    char** pointers = (char**)(block + sizeof(HmmDictionary));
+    int* slots = (int*)(pointers + num_state_names + num_symbol_names);
+    char* text = (char*)(slots + (state_names != NULL ? state_mask + 1 : 0)
+                               + (symbol_names != NULL ? symbol_mask + 1 : 0));
     
-    // Skip N, M, T
-    fscanf(file, "%d %d %d", &dummy, &dummy, &dummy);
+    dictionary->num_states = N;
+    dictionary->num_symbols = M;
+    dictionary->state_mask = state_mask;
+    dictionary->symbol_mask = symbol_mask;
+    dictionary->state_names = NULL;
+    dictionary->symbol_names = NULL;
+    dictionary->state_slots = NULL;
+    dictionary->symbol_slots = NULL;
     
-    // Skip transition matrix (3x3)
-    for (int i = 0; i < 9; i++) {
-        fscanf(file, "%lf", &dummy_double);
+    int ok = 1;
+    if (state_names != NULL) {
+        dictionary->state_names = copy_names(state_names, N, pointers, &text);
+        dictionary->state_slots = slots;
+        slots += state_mask + 1;
+        ok = build_name_table(dictionary->state_names, N, dictionary->state_slots, state_mask, "state");
     }
-    
-    // Skip emission matrix (3x3)
-    for (int i = 0; i < 9; i++) {
-        fscanf(file, "%lf", &dummy_double);
+    if (ok && symbol_names != NULL) {
+        dictionary->symbol_names = copy_names(symbol_names, M, pointers + num_state_names, &text);
+        dictionary->symbol_slots = slots;
+        ok = build_name_table(dictionary->symbol_names, M, dictionary->symbol_slots, symbol_mask, "symbol");
+    }
+    if (!ok) {
+        return 0;  // The rejected block stays in the arena until free_hmm
     }
     
-    // Skip initial probabilities (3)
-    for (int i = 0; i < 3; i++) {
-        fscanf(file, "%lf", &dummy_double);
+    hmm->dictionary = dictionary;
+    return 1;
+}
+
+const char* hmm_state_name(const HMM* hmm, int i) {
+    if (hmm == NULL || hmm->dictionary == NULL || hmm->dictionary->state_names == NULL
+        || i < 0 || i >= hmm->num_states) {
+        return NULL;
+    }
+    return hmm->dictionary->state_names[i];
+}
+
+const char* hmm_symbol_name(const HMM* hmm, int k) {
+    if (hmm == NULL || hmm->dictionary == NULL || hmm->dictionary->symbol_names == NULL
+        || k < 0 || k >= hmm->num_observations) {
+        return NULL;
     }
+    return hmm->dictionary->symbol_names[k];
+}
+
+int hmm_state_index(const HMM* hmm, const char* name) {
+    if (hmm == NULL || hmm->dictionary == NULL) return -1;
     
-    // Read observation sequence
-    int* observations = (int*)malloc(hmm->sequence_length * sizeof(int));
-    if (observations == NULL) {
-        printf("Error: Failed to allocate memory for observations\n");
-        free_hmm(hmm);
-        fclose(file);
+    const HmmDictionary* dictionary = hmm->dictionary;
+    return find_name(dictionary->state_names, dictionary->state_slots, dictionary->state_mask, name);
+}
+
+int hmm_symbol_index(const HMM* hmm, const char* name) {
+    if (hmm == NULL || hmm->dictionary == NULL) return -1;
+    
+    const HmmDictionary* dictionary = hmm->dictionary;
+    return find_name(dictionary->symbol_names, dictionary->symbol_slots, dictionary->symbol_mask, name);
+}
+
+int hmm_encode_symbols(const HMM* hmm, const char* const* tokens, int count, int* observations) {
+    if (hmm == NULL || tokens == NULL || observations == NULL || count < 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to hmm_encode_symbols\n");
         return -1;
     }
     
-    for (int t = 0; t < hmm->sequence_length; t++) {
-        if (fscanf(file, "%d", &observations[t]) != 1) {
-            printf("Error: Failed to read observation %d\n", t);
-            free(observations);
-            free_hmm(hmm);
-            fclose(file);
+    for (int t = 0; t < count; t++) {
+        observations[t] = hmm_symbol_index(hmm, tokens[t]);
+        if (observations[t] < 0) {
+            fprintf(stderr, "Error: Unknown observation symbol '%s' at position %d\n", tokens[t], t);
             return -1;
         }
     }
+    return 0;
+}
+
+int run_weather_prediction_example(int verbose) {
+    printf("=== HMM WEATHER PREDICTION EXAMPLE ===\n\n");
     
-    fclose(file);
+    // Load HMM and its observation sequence from file in one pass
+    int* observations = NULL;
+    HMM* hmm = load_hmm_with_observations("clima_ejemplo.txt", &observations);
+    if (hmm == NULL) {
+        printf("Failed to load HMM from file. Make sure 'clima_ejemplo.txt' exists.\n");
+        return -1;
+    }
+    
+    printf("Successfully loaded HMM with %d states, %d observations, sequence length %d\n\n", 
+           hmm->num_states, hmm->num_observations, hmm->sequence_length);
     
     // Execute Viterbi algorithm
     ViterbiResult* result = viterbi_algorithm(hmm, observations);
@@ -823,7 +1528,7 @@ int run_weather_prediction_example(int verbose) {
     
     // Print results
     print_step_by_step(result, hmm, observations, verbose);
-    print_final_results_enhanced(result, hmm->sequence_length);
+    print_final_results_named(result, hmm);
     
     // Clean up memory
     free_viterbi_result_enhanced(result, hmm->sequence_length);
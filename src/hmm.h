@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include "arena.h"
 
 // State and observation definitions for weather prediction
 #define SUNNY 0
@@ -15,40 +16,156 @@
 #define SUNGLASSES 1
 #define STAY_HOME 2
 
-// State and observation names for verbose output
-extern const char* STATE_NAMES[3];
-extern const char* OBSERVATION_NAMES[3];
+// Every matrix row starts on a cache line; strides are padded accordingly
+#define HMM_ALIGNMENT 64
+
+// State and symbol names of a model (defined below)
+typedef struct HmmDictionary HmmDictionary;
+
+/**
+ * Arithmetic used by log-domain Viterbi decoding (hmm_set_precision)
+ */
+typedef enum {
+    HMM_PRECISION_DOUBLE = 0, // log A, log B, log π and log δ in double (default)
+    HMM_PRECISION_MIXED = 1,  // float log A / log B / log π, double log δ
+    HMM_PRECISION_FLOAT = 2   // float parameters and float log δ, renormalized every step
+} HmmPrecision;
 
 /**
  * Hidden Markov Model structure
  * Contains all parameters needed for HMM operations
+ * 
+ * All matrices are stored flat and row-major inside a single cache-line-aligned
+ * allocation. Element (i,j) of a matrix lives at matrix[i * stride + j]; use the
+ * HMM_A / HMM_B accessors below instead of indexing by hand.
+ * 
+ * transition_t, emission_t and the log arrays are derived copies refreshed by
+ * hmm_prepare(); call it again after modifying transition, emission or initial.
+ * The emission copies are symbol-major (row k holds B(·,k) for every state), so
+ * a decoder reads the emissions of observation oₜ as one contiguous vector.
+ * 
+ * In reduced precision the model also holds float copies of log Aᵀ, log Bᵀ and
+ * log π (same layout, float_stride), refreshed by hmm_prepare() as well.
+ * 
+ * A model opened with hmm_binary_load() keeps its arrays in a private,
+ * copy-on-write file mapping instead; free_hmm() releases either kind.
  */
 typedef struct {
     int num_states;       // N = Number of hidden states
     int num_observations; // M = Number of possible observations  
     int sequence_length;  // T = Length of observation sequence
-    double **transition;  // Matrix A (NxN) - transition probabilities A[i][j] = P(state_j | state_i)
-    double **emission;    // Matrix B (NxM) - emission probabilities B[i][j] = P(obs_j | state_i)
+    int transition_stride; // Doubles between rows of A, Aᵀ, log Aᵀ, Bᵀ and log Bᵀ (≥ N, multiple of 8)
+    int emission_stride;   // Doubles between rows of B (≥ M, multiple of 8)
+    int prepared;         // 1 once hmm_prepare() has filled the derived arrays
+    double *transition;   // Matrix A (NxN) - transition probabilities A(i,j) = P(state_j | state_i)
+    double *emission;     // Matrix B (NxM) - emission probabilities B(i,j) = P(obs_j | state_i)
     double *initial;      // Vector π (Nx1) - initial state probabilities π[i] = P(state_i)
+    double *transition_t;     // Aᵀ (NxN) - row i holds column A(·,i) contiguously
+    double *log_transition_t; // log Aᵀ (NxN) - row i holds log A(·,i)
+    double *emission_t;       // Bᵀ (MxN) - row k holds column B(·,k) contiguously
+    double *log_emission_t;   // log Bᵀ (MxN) - row k holds log B(·,k)
+    double *log_initial;      // log π (Nx1)
+    HmmPrecision precision;   // Log-domain decoding arithmetic (hmm_set_precision)
+    int float_stride;         // Floats between rows of the float copies (≥ N, multiple of 16)
+    float *log_transition_t_f; // log Aᵀ in float (NxN), NULL until reduced precision is used
+    float *log_emission_t_f;   // log Bᵀ in float (MxN)
+    float *log_initial_f;      // log π in float (Nx1)
+    HmmDictionary *dictionary; // State and symbol names (hmm_set_names), or NULL
+    void *mapping;            // File mapping backing the arrays (hmm_binary_load), else NULL
+    size_t mapping_size;      // Length of the mapping in bytes
+    Arena *arena;             // Holds this structure, its arrays and names (released by free_hmm)
 } HMM;
 
+// Element accessors (usable as lvalues)
+#define HMM_A(hmm, i, j)     ((hmm)->transition[(size_t)(i) * (hmm)->transition_stride + (j)])
+#define HMM_B(hmm, i, k)     ((hmm)->emission[(size_t)(i) * (hmm)->emission_stride + (k)])
+#define HMM_LOG_A(hmm, i, j) ((hmm)->log_transition_t[(size_t)(j) * (hmm)->transition_stride + (i)])
+#define HMM_LOG_B(hmm, i, k) ((hmm)->log_emission_t[(size_t)(k) * (hmm)->transition_stride + (i)])
+
+// Row accessors: column i of A (i.e. A(·,i)) as a contiguous vector
+#define HMM_A_COLUMN(hmm, i)     ((hmm)->transition_t + (size_t)(i) * (hmm)->transition_stride)
+#define HMM_LOG_A_COLUMN(hmm, i) ((hmm)->log_transition_t + (size_t)(i) * (hmm)->transition_stride)
+
+// Column k of B (i.e. B(·,k), the emission of symbol k by every state)
+#define HMM_B_COLUMN(hmm, k)     ((hmm)->emission_t + (size_t)(k) * (hmm)->transition_stride)
+#define HMM_LOG_B_COLUMN(hmm, k) ((hmm)->log_emission_t + (size_t)(k) * (hmm)->transition_stride)
+
+// The same rows of the float copies (reduced precision only)
+#define HMM_LOG_A_COLUMN_F(hmm, i) ((hmm)->log_transition_t_f + (size_t)(i) * (hmm)->float_stride)
+#define HMM_LOG_B_COLUMN_F(hmm, k) ((hmm)->log_emission_t_f + (size_t)(k) * (hmm)->float_stride)
+
+/**
+ * Names of the states and observation symbols of a model
+ * One allocation owned by the HMM; names are looked up by index directly and
+ * by string through open-addressing hash tables (FNV-1a).
+ */
+struct HmmDictionary {
+    int num_states;        // N
+    int num_symbols;       // M
+    char** state_names;    // N names, or NULL if the states are unnamed
+    char** symbol_names;   // M names, or NULL if the symbols are unnamed
+    int* state_slots;      // Hash table: state index or -1 (state_mask + 1 slots)
+    int* symbol_slots;     // Hash table: symbol index or -1 (symbol_mask + 1 slots)
+    unsigned state_mask;
+    unsigned symbol_mask;
+};
+
 /**
  * Viterbi algorithm result structure
  * Contains all computed matrices and the optimal path
+ * In log-domain mode delta holds log δ and probability is exp(log_probability),
+ * which may underflow to 0.0 for long sequences while log_probability stays finite
+ * 
+ * delta and psi are flat row-major (row t = time step) inside the same aligned
+ * allocation as the structure itself; use VITERBI_DELTA / VITERBI_PSI.
  */
 typedef struct {
-    double **delta;       // Matrix δ (TxN) - maximum probabilities at each time step
-    int **psi;           // Matrix ψ (TxN) - backpointer matrix for path reconstruction
+    int T;               // Sequence length the result holds
+    int N;               // Number of states
+    int delta_stride;    // Doubles between rows of δ (≥ N, multiple of 8)
+    int psi_stride;      // Ints between rows of ψ (≥ N, multiple of 16)
+    double *delta;       // Matrix δ (TxN) - maximum probabilities at each time step
+    int *psi;            // Matrix ψ (TxN) - backpointer matrix for path reconstruction
     int *path;           // Optimal state sequence (Tx1) - most likely hidden states
     double probability;  // Final probability of optimal path P*
+    double log_probability; // log P* - exact in log-domain mode
+    int log_domain;      // 1 if delta holds log δ values, 0 if raw probabilities
 } ViterbiResult;
 
+#define VITERBI_DELTA_ROW(result, t) ((result)->delta + (size_t)(t) * (result)->delta_stride)
+#define VITERBI_PSI_ROW(result, t)   ((result)->psi + (size_t)(t) * (result)->psi_stride)
+#define VITERBI_DELTA(result, t, i)  (VITERBI_DELTA_ROW(result, t)[i])
+#define VITERBI_PSI(result, t, i)    (VITERBI_PSI_ROW(result, t)[i])
+
+/**
+ * Decoding domain selector for viterbi_decode
+ */
+typedef enum {
+    VITERBI_MODE_LINEAR = 0, // Raw probabilities (viterbi_algorithm)
+    VITERBI_MODE_LOG = 1     // Log probabilities (viterbi_algorithm_log)
+} ViterbiMode;
+
+/**
+ * Reusable Viterbi buffers
+ * Holds one ViterbiResult sized for (max_T, N). Decoding through the workspace
+ * reuses those buffers, so steady-state calls perform no heap allocation; the
+ * buffers grow only when a longer sequence (or a different N) arrives.
+ */
+typedef struct {
+    int max_T;              // Capacity in time steps
+    int N;                  // Number of states the buffers are sized for
+    ViterbiResult* result;  // Buffers reused by every decode (result->T = last decoded length)
+} ViterbiWorkspace;
+
 // =============================================================================
 // MEMORY MANAGEMENT FUNCTIONS
 // =============================================================================
 
 /**
  * Allocate memory for HMM structure and initialize matrices
+ * The structure and every matrix are one zero-filled bump allocation in the
+ * model's arena, sized so the arena is a single block; the float copies and
+ * names added later come from the same arena.
  * @param N Number of states
  * @param M Number of possible observations
  * @param T Length of observation sequence
@@ -57,13 +174,15 @@ typedef struct {
 HMM* allocate_hmm(int N, int M, int T);
 
 /**
- * Free all memory allocated for HMM structure
+ * Free all memory allocated for HMM structure (unmapping it if file-backed)
+ * Releases the model's arena in one go.
  * @param hmm Pointer to HMM structure to free
  */
 void free_hmm(HMM* hmm);
 
 /**
  * Allocate memory for Viterbi result structure
+ * The structure, δ, ψ and the path share one aligned allocation.
  * @param T Length of observation sequence
  * @param N Number of states
  * @return Pointer to allocated ViterbiResult structure or NULL on failure
@@ -76,6 +195,70 @@ ViterbiResult* allocate_viterbi_result(int T, int N);
  */
 void free_viterbi_result(ViterbiResult* result);
 
+/**
+ * Kept for source compatibility; equivalent to free_viterbi_result
+ * (the result now records its own dimensions)
+ * @param result Pointer to ViterbiResult structure to free
+ * @param T Ignored
+ */
+void free_viterbi_result_enhanced(ViterbiResult* result, int T);
+
+/**
+ * Create a reusable Viterbi workspace
+ * @param max_T Initial capacity in time steps
+ * @param N Number of states
+ * @return Pointer to workspace or NULL on failure
+ */
+ViterbiWorkspace* viterbi_workspace_create(int max_T, int N);
+
+/**
+ * Make sure the workspace can hold a decode of T steps over N states
+ * Reallocates only if T exceeds the capacity (growing by at least 1.5x) or N changes.
+ * @param workspace Pointer to workspace
+ * @param T Required sequence length
+ * @param N Required number of states
+ * @return 1 on success, 0 on allocation failure (old buffers stay valid)
+ */
+int viterbi_workspace_reserve(ViterbiWorkspace* workspace, int T, int N);
+
+/**
+ * Clear the last decode from the workspace without releasing its buffers
+ * @param workspace Pointer to workspace
+ */
+void viterbi_workspace_reset(ViterbiWorkspace* workspace);
+
+/**
+ * Free a workspace and its buffers
+ * @param workspace Pointer to workspace
+ */
+void viterbi_workspace_free(ViterbiWorkspace* workspace);
+
+/**
+ * Allocate a zero-filled block aligned to HMM_ALIGNMENT bytes
+ * Release it with free().
+ * @param size Number of bytes
+ * @return Pointer to the block or NULL on failure
+ */
+void* hmm_aligned_calloc(size_t size);
+
+/**
+ * Totals of every hmm_aligned_calloc since program start
+ * Every decoding buffer of the library (results, workspaces) is allocated
+ * there, so the difference of two readings counts the heap traffic of the
+ * code in between. Models are counted by their arena (hmm->arena, arena_stats).
+ * @param count Receives the number of allocations (may be NULL)
+ * @param bytes Receives the number of bytes allocated (may be NULL)
+ */
+void hmm_allocation_stats(unsigned long long* count, unsigned long long* bytes);
+
+/**
+ * Round a row length up so that consecutive rows stay HMM_ALIGNMENT-aligned
+ * @param count Number of elements in a row
+ * @param element_size Size of one element in bytes
+ * @return Padded row stride in elements
+ */
+int hmm_padded_stride(int count, size_t element_size);
+
 // =============================================================================
 // FILE I/O FUNCTIONS
 // =============================================================================
@@ -86,16 +269,38 @@ void free_viterbi_result(ViterbiResult* result);
  * Line 1: N (number of states)
  * Line 2: M (number of observations)  
  * Line 3: T (sequence length)
- * Lines 4-6: Transition matrix A (3x3)
- * Lines 7-9: Emission matrix B (3x3)
- * Line 10: Initial probabilities π (1x3)
- * Line 11: Observation sequence (1xT)
+ * Optional: "states: name₁ ... name_N" and/or "symbols: name₁ ... name_M"
+ * Next N lines: Transition matrix A (NxN)
+ * Next N lines: Emission matrix B (NxM)
+ * Next line: Initial probabilities π (1xN)
+ * Last line: Observation sequence (1xT)
  * 
  * @param filename Path to input file
  * @return Pointer to loaded HMM structure or NULL on failure
  */
 HMM* load_hmm(char* filename);
 
+/**
+ * Load HMM parameters and the observation sequence (line 11) in one pass
+ * @param filename Path to input file
+ * @param observations Receives a malloc'd array of T symbols (caller frees),
+ *        or NULL on failure
+ * @return Pointer to loaded HMM structure or NULL on failure
+ */
+HMM* load_hmm_with_observations(char* filename, int** observations);
+
+/**
+ * Write HMM parameters in the format load_hmm reads
+ * Probabilities are written with 17 significant digits, so a model survives
+ * a save/load round trip unchanged; names are written if the model has them.
+ * @param hmm Pointer to HMM structure to save
+ * @param filename Path to output file (overwritten)
+ * @param observations Sequence written as the last line (hmm->sequence_length
+ *        symbols), or NULL to write the parameters only
+ * @return 0 on success, -1 on failure
+ */
+int save_hmm(const HMM* hmm, const char* filename, const int* observations);
+
 // =============================================================================
 // CORE ALGORITHM FUNCTIONS
 // =============================================================================
@@ -115,6 +320,42 @@ HMM* load_hmm(char* filename);
  */
 ViterbiResult* viterbi_algorithm(HMM* hmm, int* observations);
 
+/**
+ * Execute the Viterbi algorithm in the log domain
+ * 
+ * Same recursion as viterbi_algorithm with products replaced by sums:
+ * 1. Initialization: log δ₁(i) = log π(i) + log B(i,o₁)
+ * 2. Recursion: log δₜ(i) = max[log δₜ₋₁(j) + log A(j,i)] + log B(i,oₜ)
+ * 3. Termination: log P* = max[log δₜ(i)]
+ * 
+ * Does not underflow, so it is stable for sequences of millions of steps.
+ * Uses the log parameters precomputed by hmm_prepare() (computed on
+ * first use if the model was built by hand).
+ * 
+ * @param hmm Pointer to HMM structure containing model parameters
+ * @param observations Array of observed symbols (length T)
+ * @return Pointer to ViterbiResult with log_domain set, or NULL on failure
+ */
+ViterbiResult* viterbi_algorithm_log(HMM* hmm, int* observations);
+
+/**
+ * Decode a sequence of any length into a reusable workspace
+ * 
+ * Same algorithm as viterbi_algorithm / viterbi_algorithm_log, but T is taken
+ * from the caller instead of hmm->sequence_length and the result lives in the
+ * workspace, so repeated calls do not touch the heap once the workspace is
+ * large enough.
+ * 
+ * @param hmm Pointer to HMM structure containing model parameters
+ * @param observations Array of observed symbols (length T)
+ * @param T Length of the observation sequence
+ * @param mode VITERBI_MODE_LINEAR or VITERBI_MODE_LOG
+ * @param workspace Workspace that receives the result
+ * @return Pointer to the workspace result (valid until the next decode), or NULL on failure
+ */
+const ViterbiResult* viterbi_decode(HMM* hmm, const int* observations, int T,
+                                    ViterbiMode mode, ViterbiWorkspace* workspace);
+
 // =============================================================================
 // OUTPUT AND DEBUGGING FUNCTIONS
 // =============================================================================
@@ -130,12 +371,13 @@ void print_step_by_step(ViterbiResult* result, HMM* hmm, int* observations, int
 
 /**
  * Print matrix in formatted table with headers
- * @param matrix 2D matrix to print
+ * @param matrix Flat row-major matrix to print
  * @param rows Number of rows
  * @param cols Number of columns
+ * @param stride Elements between consecutive rows
  * @param title Title to display above matrix
  */
-void print_matrices_formatted(double** matrix, int rows, int cols, char* title);
+void print_matrices_formatted(const double* matrix, int rows, int cols, int stride, char* title);
 
 /**
  * Print final results in specified format
@@ -143,6 +385,20 @@ void print_matrices_formatted(double** matrix, int rows, int cols, char* title);
  */
 void print_final_results(ViterbiResult* result);
 
+/**
+ * Print final results, translating the path with the model's state names
+ * @param result Pointer to ViterbiResult structure
+ * @param hmm Model that produced the result (states without names print no translation)
+ */
+void print_final_results_named(ViterbiResult* result, const HMM* hmm);
+
+/**
+ * Kept for source compatibility; equivalent to print_final_results
+ * @param result Pointer to ViterbiResult structure
+ * @param T Ignored (the result records its own length)
+ */
+void print_final_results_enhanced(ViterbiResult* result, int T);
+
 // =============================================================================
 // UTILITY FUNCTIONS
 // =============================================================================
@@ -158,14 +414,96 @@ void print_final_results(ViterbiResult* result);
  */
 int validate_hmm(HMM* hmm);
 
+/**
+ * Refresh the derived parameter layouts from A, B and π:
+ * the transposed matrices Aᵀ, log Aᵀ, Bᵀ, log Bᵀ and log π
+ * Must be called again if the probabilities are modified afterwards
+ * (load_hmm calls it; the decoders call it if it never ran).
+ * Zero probabilities map to -INFINITY.
+ * @param hmm Pointer to HMM structure
+ * @return 1 on success, 0 on NULL model
+ */
+int hmm_prepare(HMM* hmm);
+
 /**
  * Validate observation sequence
- * - Check if all observations are valid symbols (0, 1, 2)
+ * - Check if all observations are valid symbols (0 to num_symbols - 1)
  * @param observations Array of observed symbols
  * @param length Length of observation sequence
+ * @param num_symbols Alphabet size M of the model
  * @return 1 if valid, 0 if invalid
  */
-int validate_observations(int* observations, int length);
+int validate_observations(int* observations, int length, int num_symbols);
+
+/**
+ * Select the arithmetic of log-domain Viterbi decoding for a model
+ * 
+ * Reduced precision affects viterbi_algorithm_log and the log mode of
+ * viterbi_decode / viterbi_batch; other decoders keep using double. Float
+ * parameters halve the bytes read per transition (and double the SIMD lanes
+ * in HMM_PRECISION_FLOAT), which keeps more of a large A in cache. The float
+ * mode subtracts the step maximum from log δ after every step and carries it
+ * in double, so it does not lose precision on long sequences. Paths agree
+ * with double precision except between paths whose scores differ by less
+ * than the float rounding of the parameters.
+ * 
+ * The float copies are allocated from the model's arena on the first switch
+ * to reduced precision and kept until free_hmm(), so later switches are free.
+ * 
+ * @param hmm Pointer to HMM structure
+ * @param precision HMM_PRECISION_DOUBLE, HMM_PRECISION_MIXED or HMM_PRECISION_FLOAT
+ * @return 1 on success, 0 on invalid precision or allocation failure
+ */
+int hmm_set_precision(HMM* hmm, HmmPrecision precision);
+
+// =============================================================================
+// STATE AND SYMBOL NAMES
+// =============================================================================
+
+/**
+ * Attach state and/or symbol names to a model (replacing any previous ones)
+ * The names are copied into the model's arena; the memory of replaced names
+ * is only reclaimed by free_hmm.
+ * @param hmm Pointer to HMM structure
+ * @param state_names N distinct names, or NULL to leave the states unnamed
+ * @param symbol_names M distinct names, or NULL to leave the symbols unnamed
+ * @return 1 on success, 0 on duplicate/empty names or allocation failure
+ */
+int hmm_set_names(HMM* hmm, const char* const* state_names, const char* const* symbol_names);
+
+/**
+ * Name of state i
+ * @return The name, or NULL if the model has no state names or i is out of range
+ */
+const char* hmm_state_name(const HMM* hmm, int i);
+
+/**
+ * Name of observation symbol k
+ * @return The name, or NULL if the model has no symbol names or k is out of range
+ */
+const char* hmm_symbol_name(const HMM* hmm, int k);
+
+/**
+ * Index of the state called name
+ * @return State index, or -1 if there is no such state
+ */
+int hmm_state_index(const HMM* hmm, const char* name);
+
+/**
+ * Index of the observation symbol called name (O(1) hash lookup)
+ * @return Symbol index, or -1 if there is no such symbol
+ */
+int hmm_symbol_index(const HMM* hmm, const char* name);
+
+/**
+ * Translate symbol names into an observation sequence
+ * @param hmm Model with symbol names
+ * @param tokens Symbol names (count)
+ * @param count Number of tokens
+ * @param observations Receives the symbol indices (count)
+ * @return 0 on success, -1 if a token is not in the alphabet
+ */
+int hmm_encode_symbols(const HMM* hmm, const char* const* tokens, int count, int* observations);
 
 /**
  * Run the complete HMM weather prediction example
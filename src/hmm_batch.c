@@ -0,0 +1,368 @@
+#define _POSIX_C_SOURCE 200112L  // For sysconf()
+#include <pthread.h>
+#include <unistd.h>
+#include "hmm_batch.h"
+#include "hmm_parallel.h"
+
+// Sequences at least this long that exceed one thread's share of the batch
+// are decoded with viterbi_parallel instead of on a single worker
+#define BATCH_SPLIT_MIN_LENGTH 65536
+
+// =============================================================================
+// WORK-STEALING SCHEDULER
+// =============================================================================
+
+/**
+ * Per-thread task queue
+ * Holds sequence indices in decreasing length order. The owner takes from the
+ * head (its longest remaining job); thieves take from the tail (the shortest),
+ * which keeps the owner's big jobs local and evens out the end of the batch.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    int* tasks;          // Slice of the shared task array
+    int head;            // Next task for the owner
+    int tail;            // One past the last task
+} TaskDeque;
+
+/**
+ * State shared by all workers of one decode call (read-only except deques)
+ */
+typedef struct {
+    HMM* hmm;
+    const int* const* sequences;
+    const int* lengths;
+    int* const* paths;
+    double* log_probabilities;
+    ViterbiMode mode;
+    TaskDeque* deques;
+    int num_workers;
+} BatchContext;
+
+typedef struct {
+    ViterbiBatchPool* pool;
+    int id;
+    int failures;                 // Sequences this worker failed to decode in the current call
+    ViterbiWorkspace* workspace;  // Kept across calls; grows to the longest sequence seen
+} BatchWorker;
+
+/**
+ * Persistent decoding threads
+ * Workers 1..num_workers-1 wait on `start` between calls; each call bumps
+ * `round`, and the last worker to finish it signals `done`. Worker 0 is the
+ * thread that calls viterbi_batch_pool_decode.
+ */
+struct ViterbiBatchPool {
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned round;               // Calls announced so far
+    int pending;                  // Started workers still busy with the current call
+    int shutdown;                 // Set by viterbi_batch_pool_free
+    int num_workers;
+    int num_started;
+    ViterbiMode mode;
+    int* started;                 // 1 if worker w has a thread of its own
+    pthread_t* threads;
+    BatchWorker* workers;
+    TaskDeque* deques;            // One per worker, locks initialized once
+    BatchContext context;         // The call in progress
+};
+
+typedef struct {
+    int length;
+    int index;
+} SequenceOrder;
+
+// Longest first; equal lengths keep input order
+static int compare_longest_first(const void* a, const void* b) {
+    const SequenceOrder* x = (const SequenceOrder*)a;
+    const SequenceOrder* y = (const SequenceOrder*)b;
+    if (x->length != y->length) return x->length > y->length ? -1 : 1;
+    return x->index - y->index;
+}
+
+// Own deque first, then steal round-robin from the others; -1 when all are empty
+static int next_task(BatchContext* context, int id) {
+    for (int k = 0; k < context->num_workers; k++) {
+        TaskDeque* deque = &context->deques[(id + k) % context->num_workers];
+        int task = -1;
+        
+        pthread_mutex_lock(&deque->lock);
+        if (deque->head < deque->tail) {
+            task = (k == 0) ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+        }
+        pthread_mutex_unlock(&deque->lock);
+        
+        if (task >= 0) return task;
+    }
+    return -1;
+}
+
+// Decode tasks until every deque is empty
+static void batch_drain(BatchWorker* worker) {
+    BatchContext* context = &worker->pool->context;
+    int task;
+    
+    while ((task = next_task(context, worker->id)) >= 0) {
+        int T = context->lengths[task];
+        
+        // The first task is this worker's longest, so the workspace rarely grows
+        if (worker->workspace == NULL) {
+            worker->workspace = viterbi_workspace_create(T, context->hmm->num_states);
+        }
+        
+        const ViterbiResult* result = NULL;
+        if (worker->workspace != NULL) {
+            result = viterbi_decode(context->hmm, context->sequences[task], T, context->mode, worker->workspace);
+        }
+        
+        if (result == NULL) {
+            worker->failures++;
+            if (context->log_probabilities != NULL) {
+                context->log_probabilities[task] = NAN;
+            }
+            continue;
+        }
+        
+        memcpy(context->paths[task], result->path, (size_t)T * sizeof(int));
+        if (context->log_probabilities != NULL) {
+            context->log_probabilities[task] = result->log_probability;
+        }
+    }
+}
+
+// Thread of worker 1..num_workers-1: drain once per round until shutdown
+static void* batch_worker(void* arg) {
+    BatchWorker* worker = (BatchWorker*)arg;
+    ViterbiBatchPool* pool = worker->pool;
+    unsigned seen = 0;
+    
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (pool->round == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen = pool->round;
+        pthread_mutex_unlock(&pool->lock);
+        
+        batch_drain(worker);
+        
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+int hmm_online_cpus(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+ViterbiBatchOptions viterbi_batch_default_options(void) {
+    ViterbiBatchOptions options;
+    options.num_threads = 0;
+    options.mode = VITERBI_MODE_LOG;
+    return options;
+}
+
+ViterbiBatchPool* viterbi_batch_pool_create(const ViterbiBatchOptions* options) {
+    ViterbiBatchOptions settings = options != NULL ? *options : viterbi_batch_default_options();
+    int num_workers = settings.num_threads > 0 ? settings.num_threads : hmm_online_cpus();
+    
+    ViterbiBatchPool* pool = (ViterbiBatchPool*)calloc(1, sizeof(ViterbiBatchPool));
+    if (pool == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for batch thread pool\n");
+        return NULL;
+    }
+    pool->num_workers = num_workers;
+    pool->mode = settings.mode;
+    pool->started = (int*)calloc((size_t)num_workers, sizeof(int));
+    pool->threads = (pthread_t*)malloc((size_t)num_workers * sizeof(pthread_t));
+    pool->workers = (BatchWorker*)calloc((size_t)num_workers, sizeof(BatchWorker));
+    pool->deques = (TaskDeque*)calloc((size_t)num_workers, sizeof(TaskDeque));
+    if (pool->started == NULL || pool->threads == NULL || pool->workers == NULL || pool->deques == NULL
+        || pthread_mutex_init(&pool->lock, NULL) != 0) {
+        fprintf(stderr, "Error: Failed to allocate memory for batch thread pool\n");
+        free(pool->started); free(pool->threads); free(pool->workers); free(pool->deques);
+        free(pool);
+        return NULL;
+    }
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (int w = 0; w < num_workers; w++) {
+        pthread_mutex_init(&pool->deques[w].lock, NULL);
+        pool->workers[w].pool = pool;
+        pool->workers[w].id = w;
+    }
+    
+    // A worker whose thread cannot be started has its deque drained by the
+    // others through stealing
+    for (int w = 1; w < num_workers; w++) {
+        pool->started[w] = pthread_create(&pool->threads[w], NULL, batch_worker, &pool->workers[w]) == 0;
+        pool->num_started += pool->started[w];
+    }
+    return pool;
+}
+
+void viterbi_batch_pool_free(ViterbiBatchPool* pool) {
+    if (pool == NULL) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int w = 1; w < pool->num_workers; w++) {
+        if (pool->started[w]) pthread_join(pool->threads[w], NULL);
+    }
+    
+    for (int w = 0; w < pool->num_workers; w++) {
+        viterbi_workspace_free(pool->workers[w].workspace);
+        pthread_mutex_destroy(&pool->deques[w].lock);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->started);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool->deques);
+    free(pool);
+}
+
+int viterbi_batch_pool_decode(ViterbiBatchPool* pool, HMM* hmm, const int* const* sequences,
+                              const int* lengths, int count, int* const* paths, double* log_probabilities) {
+    if (pool == NULL || hmm == NULL || sequences == NULL || lengths == NULL || paths == NULL || count < 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to viterbi_batch\n");
+        return -1;
+    }
+    if (count == 0) return 0;
+    long long total_steps = 0;
+    for (int k = 0; k < count; k++) {
+        if (sequences[k] == NULL || paths[k] == NULL || lengths[k] < 1) {
+            fprintf(stderr, "Error: Invalid sequence %d passed to viterbi_batch (length %d)\n", k, lengths[k]);
+            return -1;
+        }
+        total_steps += lengths[k];
+    }
+    
+    // Workers only read the model, so derive Aᵀ / log parameters up front
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    int num_workers = pool->num_workers;
+    SequenceOrder* order = (SequenceOrder*)malloc((size_t)count * sizeof(SequenceOrder));
+    int* tasks = (int*)malloc((size_t)count * sizeof(int));
+    if (order == NULL || tasks == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for batch scheduler\n");
+        free(order); free(tasks);
+        return -1;
+    }
+    
+    for (int k = 0; k < count; k++) {
+        order[k].length = lengths[k];
+        order[k].index = k;
+    }
+    qsort(order, (size_t)count, sizeof(SequenceOrder), compare_longest_first);
+    
+    // A sequence longer than one thread's fair share of the batch would keep a
+    // single worker busy long after the others finish: split it over time with
+    // viterbi_parallel on all threads before the rest is dealt out
+    int failures = 0;
+    int first = 0;
+    while (first < count && num_workers > 1 && pool->mode == VITERBI_MODE_LOG
+           && order[first].length >= BATCH_SPLIT_MIN_LENGTH
+           && (long long)order[first].length * num_workers > total_steps) {
+        int k = order[first++].index;
+        double log_probability;
+        if (viterbi_parallel(hmm, sequences[k], lengths[k], num_workers, paths[k], &log_probability, NULL) != 0) {
+            failures++;
+            log_probability = NAN;
+        }
+        if (log_probabilities != NULL) log_probabilities[k] = log_probability;
+    }
+    
+    // Deal the rest round-robin: every deque is itself sorted longest first
+    // and the deques start with roughly equal amounts of work
+    int remaining = count - first;
+    int offset = 0;
+    for (int w = 0; w < num_workers; w++) {
+        int size = remaining / num_workers + (w < remaining % num_workers ? 1 : 0);
+        TaskDeque* deque = &pool->deques[w];
+        deque->tasks = tasks + offset;
+        deque->head = 0;
+        deque->tail = size;
+        for (int k = 0; k < size; k++) {
+            deque->tasks[k] = order[first + w + k * num_workers].index;
+        }
+        offset += size;
+    }
+    free(order);
+    
+    BatchContext* context = &pool->context;
+    context->hmm = hmm;
+    context->sequences = sequences;
+    context->lengths = lengths;
+    context->paths = paths;
+    context->log_probabilities = log_probabilities;
+    context->mode = pool->mode;
+    context->deques = pool->deques;
+    context->num_workers = num_workers;
+    for (int w = 0; w < num_workers; w++) {
+        pool->workers[w].failures = 0;
+    }
+    
+    // Wake the pool, work as worker 0, then wait for the last one to finish
+    if (remaining > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pool->pending = pool->num_started;
+        pool->round++;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+        
+        batch_drain(&pool->workers[0]);
+        
+        pthread_mutex_lock(&pool->lock);
+        while (pool->pending > 0) {
+            pthread_cond_wait(&pool->done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    free(tasks);
+    
+    for (int w = 0; w < num_workers; w++) {
+        failures += pool->workers[w].failures;
+    }
+    if (failures > 0) {
+        fprintf(stderr, "Error: %d of %d sequences failed to decode\n", failures, count);
+        return -1;
+    }
+    return 0;
+}
+
+int viterbi_batch(HMM* hmm, const int* const* sequences, const int* lengths, int count,
+                  int* const* paths, double* log_probabilities, const ViterbiBatchOptions* options) {
+    if (hmm == NULL || sequences == NULL || lengths == NULL || paths == NULL || count < 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to viterbi_batch\n");
+        return -1;
+    }
+    if (count == 0) return 0;
+    
+    // One-shot pool: no more threads than sequences
+    ViterbiBatchOptions settings = options != NULL ? *options : viterbi_batch_default_options();
+    if (settings.num_threads <= 0) settings.num_threads = hmm_online_cpus();
+    if (settings.num_threads > count) settings.num_threads = count;
+    
+    ViterbiBatchPool* pool = viterbi_batch_pool_create(&settings);
+    if (pool == NULL) return -1;
+    int status = viterbi_batch_pool_decode(pool, hmm, sequences, lengths, count, paths, log_probabilities);
+    viterbi_batch_pool_free(pool);
+    return status;
+}
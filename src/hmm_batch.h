@@ -0,0 +1,98 @@
+#ifndef HMM_BATCH_H
+#define HMM_BATCH_H
+
+#include "hmm.h"
+
+// =============================================================================
+// BATCH VITERBI DECODING
+// =============================================================================
+//
+// Decodes many independent, variable-length sequences against one shared model
+// on a pool of threads. Sequences are ordered longest first and dealt to
+// per-thread deques; a thread that runs out of work steals the shortest
+// remaining sequences from the others, so the longest jobs start first and the
+// tail of the batch stays balanced. Each thread decodes through its own
+// ViterbiWorkspace, and results go straight into caller-provided buffers.
+//
+// A sequence that alone exceeds one thread's share of the batch (and is at
+// least 65536 steps long) would still occupy a single thread, so in log mode it
+// is split over time with viterbi_parallel on all threads first; its path and
+// log P* then match viterbi_decode up to rounding rather than bitwise.
+//
+// A ViterbiBatchPool keeps the threads and their workspaces alive between
+// calls, so a caller decoding chunk after chunk pays thread startup once.
+// viterbi_batch is the one-shot form: its pool lives for that call only.
+
+/**
+ * Batch decoding options
+ */
+typedef struct {
+    int num_threads;    // Worker threads (0 = one per online CPU)
+    ViterbiMode mode;   // VITERBI_MODE_LOG is recommended for long sequences
+} ViterbiBatchOptions;
+
+/**
+ * Default options: one thread per CPU, log-domain decoding
+ * @return Options structure with default values
+ */
+ViterbiBatchOptions viterbi_batch_default_options(void);
+
+/**
+ * Persistent batch decoding threads (see viterbi_batch_pool_create)
+ */
+typedef struct ViterbiBatchPool ViterbiBatchPool;
+
+/**
+ * Start a pool of decoding threads
+ * The calling thread is worker 0, so num_threads - 1 threads are created; a
+ * thread that cannot be started is covered by the others.
+ * @param options Thread count and decoding mode (NULL = defaults)
+ * @return Pool, or NULL on allocation failure
+ */
+ViterbiBatchPool* viterbi_batch_pool_create(const ViterbiBatchOptions* options);
+
+/**
+ * Decode a batch on an existing pool
+ * Same contract as viterbi_batch, with the pool's thread count and mode. Calls
+ * on one pool must not overlap.
+ * @return 0 on success, -1 if an argument is invalid, any sequence failed to decode
+ *         or on setup failure
+ */
+int viterbi_batch_pool_decode(ViterbiBatchPool* pool, HMM* hmm, const int* const* sequences,
+                              const int* lengths, int count, int* const* paths, double* log_probabilities);
+
+/**
+ * Stop the pool's threads and free their workspaces
+ * @param pool Pool (may be NULL)
+ */
+void viterbi_batch_pool_free(ViterbiBatchPool* pool);
+
+/**
+ * Decode a batch of sequences in parallel
+ *
+ * The model is prepared (hmm_prepare) before the workers start if needed and
+ * is only read while they run, so it must not be modified during the call.
+ * Creates a pool of at most count threads for this call and frees it before
+ * returning; use a ViterbiBatchPool to decode many batches.
+ *
+ * @param hmm Model shared by every sequence
+ * @param sequences Array of count observation sequences (none NULL)
+ * @param lengths Length of each sequence (≥ 1)
+ * @param count Number of sequences
+ * @param paths Caller buffers (none NULL), paths[k] receives lengths[k] states
+ * @param log_probabilities Receives log P* of each sequence (may be NULL);
+ *        in linear mode this is log of the linear P*
+ * @param options Decoding options (NULL = defaults)
+ * @return 0 on success, -1 if an argument is invalid, any sequence failed to decode
+ *         or on setup failure
+ */
+int viterbi_batch(HMM* hmm, const int* const* sequences, const int* lengths, int count,
+                  int* const* paths, double* log_probabilities, const ViterbiBatchOptions* options);
+
+/**
+ * Number of online CPUs (at least 1)
+ * @return CPU count used when num_threads is 0
+ */
+int hmm_online_cpus(void);
+
+#endif // HMM_BATCH_H
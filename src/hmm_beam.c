@@ -0,0 +1,382 @@
+#include "hmm_beam.h"
+#include "hmm_profile.h"
+
+// =============================================================================
+// MEMORY MANAGEMENT FUNCTIONS
+// =============================================================================
+
+BeamOptions beam_default_options(void) {
+    BeamOptions options;
+    options.beam_width = 0;
+    options.log_margin = INFINITY;
+    return options;
+}
+
+// Carve the per-state arrays out of one aligned block
+static int beam_scratch_allocate(BeamWorkspace* workspace, int N) {
+    size_t doubles = sizeof(double) * (size_t)hmm_padded_stride(N, sizeof(double));
+    size_t ints = sizeof(int) * (size_t)hmm_padded_stride(N, sizeof(int));
+    char* block = (char*)hmm_aligned_calloc(3 * doubles + 3 * ints);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate beam scratch for N=%d\n", N);
+        return 0;
+    }
+    
+    free(workspace->scratch);
+    workspace->scratch = block;
+    workspace->score = (double*)block;              block += doubles;
+    workspace->next_score = (double*)block;         block += doubles;
+    workspace->candidate = (double*)block;          block += doubles;
+    workspace->candidate_back = (int*)block;        block += ints;
+    workspace->heap = (int*)block;                  block += ints;
+    workspace->keep = (unsigned char*)block;
+    workspace->N = N;
+    return 1;
+}
+
+BeamWorkspace* beam_workspace_create(int max_T, int N) {
+    if (max_T <= 0 || N <= 0) {
+        fprintf(stderr, "Error: Invalid beam workspace dimensions (T=%d, N=%d)\n", max_T, N);
+        return NULL;
+    }
+    
+    BeamWorkspace* workspace = (BeamWorkspace*)calloc(1, sizeof(BeamWorkspace));
+    if (workspace == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for BeamWorkspace\n");
+        return NULL;
+    }
+    
+    workspace->step_start = (long long*)malloc(((size_t)max_T + 1) * sizeof(long long));
+    workspace->capacity = (long long)max_T * (N < 16 ? N : 16);
+    workspace->survivor_state = (int*)malloc((size_t)workspace->capacity * sizeof(int));
+    workspace->survivor_back = (int*)malloc((size_t)workspace->capacity * sizeof(int));
+    if (workspace->step_start == NULL || workspace->survivor_state == NULL
+        || workspace->survivor_back == NULL || !beam_scratch_allocate(workspace, N)) {
+        fprintf(stderr, "Error: Failed to allocate beam buffers (T=%d, N=%d)\n", max_T, N);
+        beam_workspace_free(workspace);
+        return NULL;
+    }
+    workspace->max_T = max_T;
+    
+    return workspace;
+}
+
+void beam_workspace_free(BeamWorkspace* workspace) {
+    if (workspace == NULL) return;
+    
+    free(workspace->step_start);
+    free(workspace->survivor_state);
+    free(workspace->survivor_back);
+    free(workspace->scratch);
+    free(workspace);
+}
+
+// Make room for T steps over N states; old buffers stay valid on failure
+static int beam_workspace_reserve(BeamWorkspace* workspace, int T, int N) {
+    if (N != workspace->N && !beam_scratch_allocate(workspace, N)) {
+        return 0;
+    }
+    if (T <= workspace->max_T) {
+        return 1;
+    }
+    
+    // Grow geometrically so a slowly increasing T does not reallocate every call
+    int new_T = T;
+    if (T < workspace->max_T + workspace->max_T / 2) {
+        new_T = workspace->max_T + workspace->max_T / 2;
+    }
+    long long* step_start = (long long*)realloc(workspace->step_start, ((size_t)new_T + 1) * sizeof(long long));
+    if (step_start == NULL) {
+        fprintf(stderr, "Error: Failed to grow beam workspace to T=%d\n", new_T);
+        return 0;
+    }
+    workspace->step_start = step_start;
+    workspace->max_T = new_T;
+    return 1;
+}
+
+// Make room for `needed` survivors in total
+static int beam_reserve_survivors(BeamWorkspace* workspace, long long needed) {
+    if (needed <= workspace->capacity) {
+        return 1;
+    }
+    
+    long long capacity = workspace->capacity + workspace->capacity / 2;
+    if (capacity < needed) capacity = needed;
+    int* states = (int*)realloc(workspace->survivor_state, (size_t)capacity * sizeof(int));
+    if (states == NULL) {
+        fprintf(stderr, "Error: Failed to grow beam survivor list to %lld entries\n", capacity);
+        return 0;
+    }
+    workspace->survivor_state = states;
+    int* back = (int*)realloc(workspace->survivor_back, (size_t)capacity * sizeof(int));
+    if (back == NULL) {
+        fprintf(stderr, "Error: Failed to grow beam survivor list to %lld entries\n", capacity);
+        return 0;
+    }
+    workspace->survivor_back = back;
+    workspace->capacity = capacity;
+    return 1;
+}
+
+// =============================================================================
+// PRUNING
+// =============================================================================
+
+// Heap order: a ranks below b if its score is lower, or equal with a higher
+// state index (so ties at the beam edge keep the lowest index, like Viterbi)
+static int ranks_below(const double* score, int a, int b) {
+    return score[a] < score[b] || (score[a] == score[b] && a > b);
+}
+
+static void heap_sift_down(int* heap, int size, int position, const double* score) {
+    for (;;) {
+        int lowest = position;
+        int left = 2 * position + 1;
+        int right = left + 1;
+        if (left < size && ranks_below(score, heap[left], heap[lowest])) lowest = left;
+        if (right < size && ranks_below(score, heap[right], heap[lowest])) lowest = right;
+        if (lowest == position) return;
+        int swap = heap[position];
+        heap[position] = heap[lowest];
+        heap[lowest] = swap;
+        position = lowest;
+    }
+}
+
+// Flag the survivors among candidate[0..N) in keep[]; returns how many
+static int select_survivors(BeamWorkspace* workspace, int N, const BeamOptions* options) {
+    const double* candidate = workspace->candidate;
+    unsigned char* keep = workspace->keep;
+    
+    double best = -INFINITY;
+    int best_state = 0;
+    for (int i = 0; i < N; i++) {
+        if (candidate[i] > best) {
+            best = candidate[i];
+            best_state = i;
+        }
+    }
+    
+    double limit = best - options->log_margin;
+    int count = 0;
+    for (int i = 0; i < N; i++) {
+        keep[i] = (candidate[i] > -INFINITY && candidate[i] >= limit) || i == best_state;
+        count += keep[i];
+    }
+    
+    if (options->beam_width <= 0 || count <= options->beam_width) {
+        return count;
+    }
+    
+    // Top-K of the flagged states with a min-heap of size K: O(N log K)
+    int* heap = workspace->heap;
+    int width = options->beam_width;
+    int size = 0;
+    for (int i = 0; i < N; i++) {
+        if (!keep[i]) continue;
+        keep[i] = 0;
+        if (size < width) {
+            heap[size++] = i;
+            if (size == width) {
+                for (int p = width / 2 - 1; p >= 0; p--) heap_sift_down(heap, width, p, candidate);
+            }
+        } else if (ranks_below(candidate, heap[0], i)) {
+            heap[0] = i;
+            heap_sift_down(heap, width, 0, candidate);
+        }
+    }
+    for (int k = 0; k < size; k++) {
+        keep[heap[k]] = 1;
+    }
+    return size;
+}
+
+// Append the flagged states (in increasing order) as the survivors of step t
+static int append_survivors(BeamWorkspace* workspace, int t, int N, int count) {
+    long long start = workspace->step_start[t];
+    if (!beam_reserve_survivors(workspace, start + count)) {
+        return 0;
+    }
+    
+    int* states = workspace->survivor_state + start;
+    int* back = workspace->survivor_back + start;
+    int k = 0;
+    for (int i = 0; i < N; i++) {
+        if (workspace->keep[i]) {
+            states[k] = i;
+            back[k] = workspace->candidate_back[i];
+            workspace->next_score[k] = workspace->candidate[i];
+            k++;
+        }
+    }
+    workspace->step_start[t + 1] = start + count;
+    return 1;
+}
+
+// δ of every state from the previous step's survivors: state i gathers
+// log A(sₖ, i) from row i of log Aᵀ, which is contiguous and read in increasing
+// survivor order, so no copy of log A is needed. Strict > keeps the lowest
+// survivor on ties, as in Viterbi.
+static void beam_pull(const HMM* hmm, double* restrict candidate, int* restrict back,
+                      const int* restrict survivors, const double* restrict score, int active, int N) {
+    for (int i = 0; i < N; i++) {
+        const double* log_column = HMM_LOG_A_COLUMN(hmm, i);
+        double best = -INFINITY;
+        int position = 0;
+        for (int k = 0; k < active; k++) {
+            double value = score[k] + log_column[survivors[k]];
+            int better = value > best;
+            best = better ? value : best;
+            position = better ? k : position;
+        }
+        candidate[i] = best;
+        back[i] = position;
+    }
+}
+
+// =============================================================================
+// CORE ALGORITHM FUNCTIONS
+// =============================================================================
+
+int viterbi_beam(HMM* hmm, const int* observations, int T, const BeamOptions* options,
+                 BeamWorkspace* workspace, int* path, double* log_probability, BeamStats* stats) {
+    if (hmm == NULL || observations == NULL || workspace == NULL || path == NULL || T <= 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to viterbi_beam\n");
+        return -1;
+    }
+    HMM_PROFILE_BEGIN_CALL(mark);
+    
+    BeamOptions limits = options != NULL ? *options : beam_default_options();
+    if (limits.beam_width < 0 || !(limits.log_margin >= 0.0)) {
+        fprintf(stderr, "Error: Invalid beam limits (width=%d, margin=%g)\n",
+                limits.beam_width, limits.log_margin);
+        return -1;
+    }
+    
+    for (int t = 0; t < T; t++) {
+        if (observations[t] < 0 || observations[t] >= hmm->num_observations) {
+            fprintf(stderr, "Error: Invalid observation %d at position %d\n", observations[t], t);
+            return -1;
+        }
+    }
+    
+    // log Aᵀ is a derived layout; hand-built models get it here
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    int N = hmm->num_states;
+    if (!beam_workspace_reserve(workspace, T, N)) {
+        return -1;
+    }
+    
+    long long transitions = 0;
+    int max_active = 0;
+    
+    HMM_PROFILE_PHASE(HMM_PHASE_SETUP, mark);
+    
+    // ==========================================================================
+    // INITIALIZATION: log δ₁(i) = log π(i) + log B(i,o₁), then prune
+    // ==========================================================================
+    
+    const double* log_emission = HMM_LOG_B_COLUMN(hmm, observations[0]);
+    for (int i = 0; i < N; i++) {
+        workspace->candidate[i] = hmm->log_initial[i] + log_emission[i];
+        workspace->candidate_back[i] = 0;
+    }
+    workspace->step_start[0] = 0;
+    int active = select_survivors(workspace, N, &limits);
+    if (!append_survivors(workspace, 0, N, active)) {
+        return -1;
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_INITIALIZATION, mark);
+    
+    // ==========================================================================
+    // RECURSION over the previous step's survivors only: O(N·Kₜ₋₁) per step
+    // ==========================================================================
+    
+    for (int t = 1; t < T; t++) {
+        double* swap = workspace->score;
+        workspace->score = workspace->next_score;
+        workspace->next_score = swap;
+        if (active > max_active) max_active = active;
+        transitions += (long long)active * N;
+        
+        const int* survivors = workspace->survivor_state + workspace->step_start[t-1];
+        const double* score = workspace->score;
+        double* candidate = workspace->candidate;
+        int* candidate_back = workspace->candidate_back;
+        log_emission = HMM_LOG_B_COLUMN(hmm, observations[t]);
+        
+        beam_pull(hmm, candidate, candidate_back, survivors, score, active, N);
+        
+        for (int i = 0; i < N; i++) {
+            candidate[i] += log_emission[i];
+        }
+        
+        active = select_survivors(workspace, N, &limits);
+        if (!append_survivors(workspace, t, N, active)) {
+            return -1;
+        }
+    }
+    if (active > max_active) max_active = active;
+    HMM_PROFILE_PHASE(HMM_PHASE_RECURSION, mark);
+    
+    // ==========================================================================
+    // TERMINATION AND BACKTRACKING through the survivor lists
+    // ==========================================================================
+    
+    double best = -INFINITY;
+    int position = 0;
+    for (int k = 0; k < active; k++) {
+        if (workspace->next_score[k] > best) {
+            best = workspace->next_score[k];
+            position = k;
+        }
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_TERMINATION, mark);
+    
+    for (int t = T-1; t >= 0; t--) {
+        long long index = workspace->step_start[t] + position;
+        path[t] = workspace->survivor_state[index];
+        position = workspace->survivor_back[index];
+    }
+    HMM_PROFILE_PHASE(HMM_PHASE_BACKTRACKING, mark);
+    HMM_PROFILE_COUNT(HMM_COUNTER_CELLS, (long long)T * N);
+    HMM_PROFILE_COUNT(HMM_COUNTER_TRANSITIONS, transitions);
+    HMM_PROFILE_COUNT(HMM_COUNTER_PRUNED_STATES, (long long)T * N - workspace->step_start[T]);
+    HMM_PROFILE_END_CALL();
+    
+    if (log_probability != NULL) {
+        *log_probability = best;
+    }
+    if (stats != NULL) {
+        stats->states_scored = (long long)T * N;
+        stats->states_kept = workspace->step_start[T];
+        stats->transitions_evaluated = transitions;
+        stats->transitions_dense = (long long)(T - 1) * N * N;
+        stats->max_active = max_active;
+        stats->mean_active = (double)workspace->step_start[T] / T;
+    }
+    return 0;
+}
+
+// =============================================================================
+// OUTPUT AND DEBUGGING FUNCTIONS
+// =============================================================================
+
+void print_beam_stats(const BeamStats* stats) {
+    if (stats == NULL) {
+        printf("Error: NULL stats in print_beam_stats\n");
+        return;
+    }
+    
+    printf("BEAM PRUNING STATISTICS:\n");
+    printf("States kept: %lld of %lld (%.2f%% pruned)\n", stats->states_kept, stats->states_scored,
+           stats->states_scored > 0 ? 100.0 * (1.0 - (double)stats->states_kept / stats->states_scored) : 0.0);
+    printf("Active states per step: mean %.2f, max %d\n", stats->mean_active, stats->max_active);
+    printf("Transitions evaluated: %lld of %lld (%.2f%%)\n", stats->transitions_evaluated,
+           stats->transitions_dense,
+           stats->transitions_dense > 0 ? 100.0 * stats->transitions_evaluated / stats->transitions_dense : 100.0);
+}
@@ -0,0 +1,105 @@
+#ifndef HMM_BEAM_H
+#define HMM_BEAM_H
+
+#include "hmm.h"
+
+// =============================================================================
+// BEAM-PRUNED VITERBI
+// =============================================================================
+//
+// Approximate log-domain Viterbi for large N. After each step only the states
+// that survive the beam are kept:
+//   - states with log δₜ(i) ≥ max log δₜ - log_margin, and
+//   - of those, at most beam_width states with the highest log δₜ(i).
+// States with δ = 0 are always dropped and the best state is always kept. The
+// next step only looks at survivors as predecessors, so a step costs
+// O(N·Kₜ₋₁) instead of O(N²), and backpointers are stored for survivors only.
+// Each state gathers its predecessors' scores from its own row of log Aᵀ in
+// the model, so the workspace needs no copy of log A: it holds O(N) scratch
+// plus O(T·K) backpointers.
+// With no limits (beam_width 0, log_margin INFINITY) the result is exactly that
+// of viterbi_algorithm_log whenever P* > 0.
+
+/**
+ * Pruning limits (either may be disabled)
+ */
+typedef struct {
+    int beam_width;     // K: at most K survivors per step (0 = no limit)
+    double log_margin;  // Keep states within this log distance of the best (INFINITY = no limit)
+} BeamOptions;
+
+/**
+ * How much a decode pruned
+ */
+typedef struct {
+    long long states_scored;          // T·N states scored before pruning
+    long long states_kept;            // Survivors over all steps (backpointers stored)
+    long long transitions_evaluated;  // Predecessor/successor pairs visited
+    long long transitions_dense;      // Pairs an exact decode would visit: (T-1)·N²
+    int max_active;                   // Largest survivor set
+    double mean_active;               // Average survivors per step
+} BeamStats;
+
+/**
+ * Reusable buffers for viterbi_beam
+ * Per-state scratch sized for N plus survivor lists that grow with the
+ * number of survivors actually kept.
+ */
+typedef struct {
+    int max_T;                 // Capacity of step_start in time steps
+    int N;                     // Number of states the scratch arrays are sized for
+    long long capacity;        // Capacity of the survivor arrays
+    long long* step_start;     // Survivors of step t are [step_start[t], step_start[t+1])
+    int* survivor_state;       // State of each survivor, increasing within a step
+    int* survivor_back;        // Position of its predecessor among the previous step's survivors
+    double* score;             // log δ of the previous step's survivors (N)
+    double* next_score;        // log δ of the current step's survivors (N)
+    double* candidate;         // log δₜ of every state before pruning (N)
+    int* candidate_back;       // Best predecessor position of every state (N)
+    int* heap;                 // Top-K selection heap (N)
+    unsigned char* keep;       // Survivor flags (N)
+    void* scratch;             // Single aligned allocation backing the (N) arrays
+} BeamWorkspace;
+
+/**
+ * Default options: no pruning (exact decoding)
+ * @return Options with beam_width 0 and log_margin INFINITY
+ */
+BeamOptions beam_default_options(void);
+
+/**
+ * Create a workspace for viterbi_beam
+ * @param max_T Initial capacity in time steps
+ * @param N Number of states
+ * @return Workspace or NULL on failure
+ */
+BeamWorkspace* beam_workspace_create(int max_T, int N);
+
+/**
+ * Free a beam workspace
+ * @param workspace Workspace
+ */
+void beam_workspace_free(BeamWorkspace* workspace);
+
+/**
+ * Beam-pruned log-domain Viterbi
+ * @param hmm Model (prepared here if needed)
+ * @param observations Observed symbols (length T)
+ * @param T Sequence length
+ * @param options Pruning limits (NULL = beam_default_options())
+ * @param workspace Buffers (grown if needed)
+ * @param path Receives the T decoded states
+ * @param log_probability Receives log P of the decoded path (may be NULL)
+ * @param stats Receives pruning statistics (may be NULL)
+ * @return 0 on success, -1 on invalid input or allocation failure
+ */
+int viterbi_beam(HMM* hmm, const int* observations, int T, const BeamOptions* options,
+                 BeamWorkspace* workspace, int* path, double* log_probability, BeamStats* stats);
+
+/**
+ * Print pruning statistics
+ * @param stats Statistics from viterbi_beam
+ */
+void print_beam_stats(const BeamStats* stats);
+
+#endif // HMM_BEAM_H
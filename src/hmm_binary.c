@@ -0,0 +1,497 @@
+#define _POSIX_C_SOURCE 200112L  // For mmap(), fstat() and posix_madvise()
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hmm_binary.h"
+#include "hmm_profile.h"
+
+#define BYTE_ORDER_MARK 0x01020304u
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+// =============================================================================
+// INTERNAL HELPERS
+// =============================================================================
+
+// Round a byte count up to the array alignment
+static uint64_t align_up(uint64_t bytes) {
+    return (bytes + HMM_ALIGNMENT - 1) / HMM_ALIGNMENT * HMM_ALIGNMENT;
+}
+
+// FNV-1a over 64-bit words (every hashed region is a multiple of 8 bytes);
+// one multiply per word keeps verification of large blocks cheap
+static uint64_t checksum_update(uint64_t hash, const void* data, uint64_t bytes) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (uint64_t offset = 0; offset < bytes; offset += 8) {
+        uint64_t word;
+        memcpy(&word, p + offset, sizeof(word));
+        hash ^= word;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t header_checksum(const HmmBinaryHeader* header) {
+    HmmBinaryHeader copy = *header;
+    copy.header_checksum = 0;
+    return checksum_update(FNV_OFFSET_BASIS, &copy, sizeof(copy));
+}
+
+// Write bytes and zero padding up to the alignment, folding both into *hash
+static int write_block(FILE* file, const void* data, uint64_t bytes, uint64_t* hash) {
+    static const unsigned char zeros[HMM_ALIGNMENT] = {0};
+    uint64_t padded = align_up(bytes);
+    uint64_t whole = bytes / 8 * 8;
+    
+    if (bytes > 0 && fwrite(data, 1, (size_t)bytes, file) != (size_t)bytes) return 0;
+    if (padded > bytes && fwrite(zeros, 1, (size_t)(padded - bytes), file) != (size_t)(padded - bytes)) return 0;
+    
+    // Hash exactly what was written: whole words, then the last partial word
+    // completed with the zero padding
+    *hash = checksum_update(*hash, data, whole);
+    if (whole < padded) {
+        unsigned char tail[HMM_ALIGNMENT] = {0};
+        memcpy(tail, (const unsigned char*)data + whole, (size_t)(bytes - whole));
+        *hash = checksum_update(*hash, tail, 8);
+        *hash = checksum_update(*hash, zeros, padded - whole - 8);
+    }
+    return 1;
+}
+
+// Structural checks of a mapped header against the file it came from
+static int header_is_valid(const HmmBinaryHeader* header, uint64_t file_size, const char* filename) {
+    if (memcmp(header->magic, HMM_BINARY_MAGIC, sizeof(header->magic)) != 0) {
+        fprintf(stderr, "Error: '%s' is not a binary HMM file\n", filename);
+        return 0;
+    }
+    if (header->byte_order != BYTE_ORDER_MARK) {
+        fprintf(stderr, "Error: '%s' was written with a different byte order\n", filename);
+        return 0;
+    }
+    if (header->version != HMM_BINARY_VERSION) {
+        fprintf(stderr, "Error: '%s' has format version %u (supported: %d)\n",
+                filename, header->version, HMM_BINARY_VERSION);
+        return 0;
+    }
+    if (header->header_checksum != header_checksum(header)) {
+        fprintf(stderr, "Error: Header checksum mismatch in '%s'\n", filename);
+        return 0;
+    }
+    
+    int N = (int)header->num_states;
+    int M = (int)header->num_observations;
+    if (N <= 0 || M <= 0 || header->num_states > INT32_MAX || header->num_observations > INT32_MAX
+        || header->sequence_length == 0 || header->sequence_length > INT32_MAX) {
+        fprintf(stderr, "Error: Invalid dimensions in '%s'\n", filename);
+        return 0;
+    }
+    
+    // Strides must be the ones the accessor macros expect
+    if ((int)header->transition_stride != hmm_padded_stride(N, sizeof(double))
+        || (int)header->emission_stride != hmm_padded_stride(M, sizeof(double))) {
+        fprintf(stderr, "Error: Unexpected row strides in '%s'\n", filename);
+        return 0;
+    }
+    
+    uint64_t transition_bytes = sizeof(double) * (uint64_t)N * header->transition_stride;
+    uint64_t emission_bytes = sizeof(double) * (uint64_t)N * header->emission_stride;
+    uint64_t symbol_bytes = sizeof(double) * (uint64_t)M * header->transition_stride;
+    uint64_t vector_bytes = sizeof(double) * (uint64_t)hmm_padded_stride(N, sizeof(double));
+    const uint64_t offsets[8] = {
+        header->transition_offset, header->transition_t_offset, header->log_transition_t_offset,
+        header->emission_offset, header->emission_t_offset, header->log_emission_t_offset,
+        header->initial_offset, header->log_initial_offset
+    };
+    const uint64_t sizes[8] = {
+        transition_bytes, transition_bytes, transition_bytes,
+        emission_bytes, symbol_bytes, symbol_bytes, vector_bytes, vector_bytes
+    };
+    
+    if (header->file_size != file_size) {
+        fprintf(stderr, "Error: '%s' is truncated (%llu of %llu bytes)\n", filename,
+                (unsigned long long)file_size, (unsigned long long)header->file_size);
+        return 0;
+    }
+    if (header->header_size < sizeof(HmmBinaryHeader)) {
+        fprintf(stderr, "Error: Header of '%s' is too small\n", filename);
+        return 0;
+    }
+    
+    // The parameter checksum covers [transition_offset, end of log π) in one
+    // pass, so the arrays must be in file order and must not overlap
+    uint64_t previous_end = header->header_size;
+    for (int a = 0; a < 8; a++) {
+        if (offsets[a] % HMM_ALIGNMENT != 0 || offsets[a] < previous_end
+            || offsets[a] > file_size || sizes[a] > file_size - offsets[a]) {
+            fprintf(stderr, "Error: Array %d out of bounds or out of order in '%s'\n", a, filename);
+            return 0;
+        }
+        previous_end = offsets[a] + sizes[a];
+    }
+    if ((header->state_name_count != 0 && header->state_name_count != header->num_states)
+        || (header->symbol_name_count != 0 && header->symbol_name_count != header->num_observations)
+        || ((header->state_name_count > 0 || header->symbol_name_count > 0) != (header->names_size > 0))) {
+        fprintf(stderr, "Error: Invalid names block in '%s'\n", filename);
+        return 0;
+    }
+    if (header->names_size > 0) {
+        if (header->names_offset % HMM_ALIGNMENT != 0 || header->names_offset < header->header_size
+            || header->names_offset > file_size || align_up(header->names_size) > file_size - header->names_offset) {
+            fprintf(stderr, "Error: Names block out of bounds in '%s'\n", filename);
+            return 0;
+        }
+    }
+    if (header->observation_count > 0) {
+        uint64_t bytes = sizeof(int32_t) * header->observation_count;
+        if (header->observations_offset % HMM_ALIGNMENT != 0
+            || header->observations_offset > file_size || bytes > file_size - header->observations_offset) {
+            fprintf(stderr, "Error: Observation block out of bounds in '%s'\n", filename);
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+// Pack the model's names into one buffer of NUL-terminated strings (states,
+// then symbols); NULL with *bytes = 0 if the model has no names
+static char* pack_names(const HMM* hmm, uint64_t* bytes, int* ok) {
+    *bytes = 0;
+    *ok = 1;
+    const HmmDictionary* dictionary = hmm->dictionary;
+    if (dictionary == NULL) return NULL;
+    
+    int num_state_names = dictionary->state_names != NULL ? hmm->num_states : 0;
+    int num_symbol_names = dictionary->symbol_names != NULL ? hmm->num_observations : 0;
+    size_t total = 0;
+    for (int i = 0; i < num_state_names; i++) total += strlen(dictionary->state_names[i]) + 1;
+    for (int k = 0; k < num_symbol_names; k++) total += strlen(dictionary->symbol_names[k]) + 1;
+    if (total == 0) return NULL;
+    
+    char* buffer = (char*)malloc(total);
+    if (buffer == NULL) {
+        *ok = 0;
+        return NULL;
+    }
+    char* cursor = buffer;
+    for (int i = 0; i < num_state_names; i++) {
+        size_t length = strlen(dictionary->state_names[i]) + 1;
+        memcpy(cursor, dictionary->state_names[i], length);
+        cursor += length;
+    }
+    for (int k = 0; k < num_symbol_names; k++) {
+        size_t length = strlen(dictionary->symbol_names[k]) + 1;
+        memcpy(cursor, dictionary->symbol_names[k], length);
+        cursor += length;
+    }
+    *bytes = total;
+    return buffer;
+}
+
+// Split a verified names block and copy it into the model's dictionary
+static int load_names(HMM* hmm, const char* block, const HmmBinaryHeader* header, const char* filename) {
+    size_t count = (size_t)header->state_name_count + header->symbol_name_count;
+    const char** names = (const char**)malloc(count * sizeof(char*));
+    if (names == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for %zu names\n", count);
+        return 0;
+    }
+    
+    // Every name must end inside the block, and the last one exactly at its end
+    uint64_t position = 0;
+    size_t found = 0;
+    while (found < count && position < header->names_size) {
+        const char* end = (const char*)memchr(block + position, '\0', (size_t)(header->names_size - position));
+        if (end == NULL) break;
+        names[found++] = block + position;
+        position = (uint64_t)(end - block) + 1;
+    }
+    if (found != count || position != header->names_size) {
+        fprintf(stderr, "Error: Malformed names block in '%s'\n", filename);
+        free(names);
+        return 0;
+    }
+    
+    int ok = hmm_set_names(hmm, header->state_name_count > 0 ? names : NULL,
+                           header->symbol_name_count > 0 ? names + header->state_name_count : NULL);
+    free(names);
+    return ok;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+int hmm_binary_save(HMM* hmm, const int* observations, long long count, const char* filename) {
+    if (hmm == NULL || filename == NULL || (observations != NULL && count < 0)) {
+        fprintf(stderr, "Error: Invalid arguments passed to hmm_binary_save\n");
+        return -1;
+    }
+    if (observations == NULL) {
+        count = 0;
+    }
+    
+    // The derived arrays are part of the file
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    int N = hmm->num_states;
+    uint64_t transition_bytes = sizeof(double) * (uint64_t)N * hmm->transition_stride;
+    uint64_t emission_bytes = sizeof(double) * (uint64_t)N * hmm->emission_stride;
+    uint64_t symbol_bytes = sizeof(double) * (uint64_t)hmm->num_observations * hmm->transition_stride;
+    uint64_t vector_bytes = sizeof(double) * (uint64_t)hmm_padded_stride(N, sizeof(double));
+    uint64_t observation_bytes = sizeof(int32_t) * (uint64_t)count;
+    
+    uint64_t names_bytes = 0;
+    int names_ok = 1;
+    char* names = pack_names(hmm, &names_bytes, &names_ok);
+    if (!names_ok) {
+        fprintf(stderr, "Error: Failed to allocate memory for the names of '%s'\n", filename);
+        return -1;
+    }
+    
+    HmmBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HMM_BINARY_MAGIC, sizeof(header.magic));
+    header.version = HMM_BINARY_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.header_size = (uint32_t)align_up(sizeof(HmmBinaryHeader));
+    header.num_states = (uint32_t)N;
+    header.num_observations = (uint32_t)hmm->num_observations;
+    header.transition_stride = (uint32_t)hmm->transition_stride;
+    header.emission_stride = (uint32_t)hmm->emission_stride;
+    header.sequence_length = (uint32_t)hmm->sequence_length;
+    if (names_bytes > 0) {
+        header.state_name_count = hmm->dictionary->state_names != NULL ? (uint32_t)N : 0;
+        header.symbol_name_count = hmm->dictionary->symbol_names != NULL ? (uint32_t)hmm->num_observations : 0;
+    }
+    
+    // Same order as allocate_hmm
+    uint64_t offset = header.header_size;
+    header.transition_offset = offset;        offset += align_up(transition_bytes);
+    header.transition_t_offset = offset;      offset += align_up(transition_bytes);
+    header.log_transition_t_offset = offset;  offset += align_up(transition_bytes);
+    header.emission_offset = offset;          offset += align_up(emission_bytes);
+    header.emission_t_offset = offset;        offset += align_up(symbol_bytes);
+    header.log_emission_t_offset = offset;    offset += align_up(symbol_bytes);
+    header.initial_offset = offset;           offset += align_up(vector_bytes);
+    header.log_initial_offset = offset;       offset += align_up(vector_bytes);
+    header.names_offset = names_bytes > 0 ? offset : 0;
+    header.names_size = names_bytes;          offset += align_up(names_bytes);
+    header.observations_offset = count > 0 ? offset : 0;
+    header.observation_count = (uint64_t)count;
+    header.file_size = offset + align_up(observation_bytes);
+    
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot open file '%s' for writing\n", filename);
+        free(names);
+        return -1;
+    }
+    
+    // Header placeholder, rewritten once the checksums are known
+    uint64_t ignored = 0;
+    int ok = write_block(file, &header, sizeof(header), &ignored);
+    
+    // The in-memory blocks use the on-disk strides, so each is one write
+    uint64_t parameters = FNV_OFFSET_BASIS;
+    ok = ok && write_block(file, hmm->transition, transition_bytes, &parameters);
+    ok = ok && write_block(file, hmm->transition_t, transition_bytes, &parameters);
+    ok = ok && write_block(file, hmm->log_transition_t, transition_bytes, &parameters);
+    ok = ok && write_block(file, hmm->emission, emission_bytes, &parameters);
+    ok = ok && write_block(file, hmm->emission_t, symbol_bytes, &parameters);
+    ok = ok && write_block(file, hmm->log_emission_t, symbol_bytes, &parameters);
+    ok = ok && write_block(file, hmm->initial, vector_bytes, &parameters);
+    ok = ok && write_block(file, hmm->log_initial, vector_bytes, &parameters);
+    
+    uint64_t dictionary = FNV_OFFSET_BASIS;
+    if (names_bytes > 0) {
+        ok = ok && write_block(file, names, names_bytes, &dictionary);
+    }
+    free(names);
+    
+    uint64_t symbols = FNV_OFFSET_BASIS;
+    if (count > 0) {
+        if (sizeof(int) == sizeof(int32_t)) {
+            ok = ok && write_block(file, observations, observation_bytes, &symbols);
+        } else {
+            // Narrow to int32 first on platforms where int is wider
+            int32_t* narrow = (int32_t*)malloc((size_t)observation_bytes);
+            if (narrow == NULL) {
+                ok = 0;
+            } else {
+                for (long long t = 0; t < count; t++) narrow[t] = (int32_t)observations[t];
+                ok = ok && write_block(file, narrow, observation_bytes, &symbols);
+                free(narrow);
+            }
+        }
+    }
+    
+    header.parameters_checksum = parameters;
+    header.names_checksum = names_bytes > 0 ? dictionary : 0;
+    header.observations_checksum = count > 0 ? symbols : 0;
+    header.header_checksum = header_checksum(&header);
+    ok = ok && fseek(file, 0, SEEK_SET) == 0
+            && fwrite(&header, sizeof(header), 1, file) == 1;
+    
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "Error: Failed to write binary model '%s'\n", filename);
+        remove(filename);
+        return -1;
+    }
+    return 0;
+}
+
+HMM* hmm_binary_load(const char* filename, const int** observations, long long* count, int flags) {
+    if (observations != NULL) *observations = NULL;
+    if (count != NULL) *count = 0;
+    HMM_PROFILE_BEGIN_CALL(mark);
+    
+    if (filename == NULL) {
+        fprintf(stderr, "Error: NULL filename passed to hmm_binary_load\n");
+        return NULL;
+    }
+    if (sizeof(int) != sizeof(int32_t)) {
+        fprintf(stderr, "Error: Zero-copy observation blocks require a 32-bit int\n");
+        return NULL;
+    }
+    
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(HmmBinaryHeader)) {
+        fprintf(stderr, "Error: '%s' is too small to be a binary HMM file\n", filename);
+        close(fd);
+        return NULL;
+    }
+    
+    // Private mapping: the model can still be modified in memory (training,
+    // hmm_prepare) without touching the file; untouched pages are never copied
+    size_t size = (size_t)info.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map file '%s'\n", filename);
+        return NULL;
+    }
+    
+    char* base = (char*)mapping;
+    const HmmBinaryHeader* header = (const HmmBinaryHeader*)base;
+    if (!header_is_valid(header, (uint64_t)size, filename)) {
+        munmap(mapping, size);
+        return NULL;
+    }
+    
+    uint64_t parameters_end = header->log_initial_offset
+                            + sizeof(double) * (uint64_t)hmm_padded_stride((int)header->num_states, sizeof(double));
+    uint64_t parameters = checksum_update(FNV_OFFSET_BASIS, base + header->transition_offset,
+                                          parameters_end - header->transition_offset);
+    if (parameters != header->parameters_checksum) {
+        fprintf(stderr, "Error: Parameter checksum mismatch in '%s'\n", filename);
+        munmap(mapping, size);
+        return NULL;
+    }
+    
+    if (header->names_size > 0
+        && checksum_update(FNV_OFFSET_BASIS, base + header->names_offset, align_up(header->names_size))
+           != header->names_checksum) {
+        fprintf(stderr, "Error: Names checksum mismatch in '%s'\n", filename);
+        munmap(mapping, size);
+        return NULL;
+    }
+    
+    // Only the small structure (and the names) is allocated; the arrays stay in the mapping
+    Arena* arena = arena_create(sizeof(HMM));
+    HMM* hmm = arena != NULL ? (HMM*)arena_alloc_aligned(arena, sizeof(HMM), HMM_ALIGNMENT) : NULL;
+    if (hmm == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for HMM structure\n");
+        arena_destroy(arena);
+        munmap(mapping, size);
+        return NULL;
+    }
+    hmm->arena = arena;
+    hmm->num_states = (int)header->num_states;
+    hmm->num_observations = (int)header->num_observations;
+    hmm->sequence_length = (int)header->sequence_length;
+    hmm->transition_stride = (int)header->transition_stride;
+    hmm->emission_stride = (int)header->emission_stride;
+    hmm->transition = (double*)(base + header->transition_offset);
+    hmm->transition_t = (double*)(base + header->transition_t_offset);
+    hmm->log_transition_t = (double*)(base + header->log_transition_t_offset);
+    hmm->emission = (double*)(base + header->emission_offset);
+    hmm->emission_t = (double*)(base + header->emission_t_offset);
+    hmm->log_emission_t = (double*)(base + header->log_emission_t_offset);
+    hmm->initial = (double*)(base + header->initial_offset);
+    hmm->log_initial = (double*)(base + header->log_initial_offset);
+    hmm->prepared = 1;
+    hmm->mapping = mapping;
+    hmm->mapping_size = size;
+    
+    if (!validate_hmm(hmm)) {
+        fprintf(stderr, "Error: Binary HMM '%s' failed validation\n", filename);
+        free_hmm(hmm);
+        return NULL;
+    }
+    if (header->names_size > 0 && !load_names(hmm, base + header->names_offset, header, filename)) {
+        free_hmm(hmm);
+        return NULL;
+    }
+    
+    if (header->observation_count > 0) {
+        const int* block = (const int*)(base + header->observations_offset);
+        uint64_t observation_count = header->observation_count;
+        uint64_t padded = align_up(sizeof(int32_t) * observation_count);
+        
+        if (flags & HMM_BINARY_VERIFY_OBSERVATIONS) {
+            if (checksum_update(FNV_OFFSET_BASIS, block, padded) != header->observations_checksum) {
+                fprintf(stderr, "Error: Observation checksum mismatch in '%s'\n", filename);
+                free_hmm(hmm);
+                return NULL;
+            }
+            for (uint64_t t = 0; t < observation_count; t++) {
+                if (block[t] < 0 || block[t] >= hmm->num_observations) {
+                    fprintf(stderr, "Error: Invalid observation %d at position %llu in '%s'\n",
+                            block[t], (unsigned long long)t, filename);
+                    free_hmm(hmm);
+                    return NULL;
+                }
+            }
+        }
+        
+        // Decoders stream through the observations once (advice ranges start on a page)
+        long page = sysconf(_SC_PAGESIZE);
+        if (page > 0) {
+            uint64_t start = header->observations_offset / (uint64_t)page * (uint64_t)page;
+            posix_madvise(base + start, (size_t)(header->observations_offset + padded - start),
+                          POSIX_MADV_SEQUENTIAL);
+        }
+        
+        if (observations != NULL) *observations = block;
+        if (count != NULL) *count = (long long)observation_count;
+    }
+    
+    HMM_PROFILE_PHASE(HMM_PHASE_LOAD, mark);
+    HMM_PROFILE_COUNT(HMM_COUNTER_BYTES, size);
+    HMM_PROFILE_END_CALL();
+    return hmm;
+}
+
+int hmm_convert_text_to_binary(const char* text_path, const char* binary_path) {
+    int* observations = NULL;
+    HMM* hmm = load_hmm_with_observations((char*)text_path, &observations);
+    if (hmm == NULL) {
+        return -1;
+    }
+    
+    int status = hmm_binary_save(hmm, observations, hmm->sequence_length, binary_path);
+    
+    free(observations);
+    free_hmm(hmm);
+    return status;
+}
@@ -0,0 +1,106 @@
+#ifndef HMM_BINARY_H
+#define HMM_BINARY_H
+
+#include <stdint.h>
+#include "hmm.h"
+
+// =============================================================================
+// BINARY MODEL FORMAT
+// =============================================================================
+//
+// A model file that is opened with mmap() and used in place: no parsing, no
+// copies. Layout (every array starts on an HMM_ALIGNMENT boundary and uses the
+// same padded strides as allocate_hmm, so HMM_A / HMM_B work directly on the
+// mapping):
+//
+//   HmmBinaryHeader (padded to header_size)
+//   A | Aᵀ | log Aᵀ | B | Bᵀ | log Bᵀ | π | log π parameter block
+//   state names | symbol names                  optional names block
+//   observations (int32, observation_count)     optional observation block
+//
+// The names block holds the model's dictionary as NUL-terminated strings:
+// the N state names (if the states are named), then the M symbol names (if
+// the symbols are). On load they are copied into the model's arena.
+//
+// The derived arrays are stored, so a loaded model is already prepared. The
+// parameter block, names block and header carry FNV-1a checksums that are
+// always verified on load; the observation block (possibly many GB) has its
+// own checksum that is verified only on request, since checking it touches
+// every page.
+// Files are written in the producer's byte order and rejected on a mismatch.
+
+#define HMM_BINARY_MAGIC "PMHMMBIN"
+#define HMM_BINARY_VERSION 3  // 2: symbol-major Bᵀ / log Bᵀ instead of log B; 3: names block
+
+// hmm_binary_load flags
+#define HMM_BINARY_VERIFY_OBSERVATIONS 1  // Check the observation checksum and symbols
+
+/**
+ * On-disk header (fixed-width fields, native byte order)
+ */
+typedef struct {
+    char magic[8];                  // HMM_BINARY_MAGIC
+    uint32_t version;               // HMM_BINARY_VERSION
+    uint32_t byte_order;            // 0x01020304 as written by the producer
+    uint32_t header_size;           // Bytes before the first array
+    uint32_t num_states;            // N
+    uint32_t num_observations;      // M
+    uint32_t transition_stride;     // Doubles between rows of A, Aᵀ, log Aᵀ, Bᵀ, log Bᵀ
+    uint32_t emission_stride;       // Doubles between rows of B
+    uint32_t sequence_length;       // T recorded in the model
+    uint32_t state_name_count;      // N if the names block holds state names, else 0
+    uint32_t symbol_name_count;     // M if the names block holds symbol names, else 0
+    uint64_t transition_offset;     // File offsets of each array
+    uint64_t transition_t_offset;
+    uint64_t log_transition_t_offset;
+    uint64_t emission_offset;
+    uint64_t emission_t_offset;
+    uint64_t log_emission_t_offset;
+    uint64_t initial_offset;
+    uint64_t log_initial_offset;
+    uint64_t names_offset;          // 0 if the model has no names
+    uint64_t names_size;            // Bytes of names (before padding)
+    uint64_t observations_offset;   // 0 if the file has no observation block
+    uint64_t observation_count;     // Symbols in the observation block
+    uint64_t file_size;             // Total bytes
+    uint64_t parameters_checksum;   // FNV-1a of [transition_offset, end of log π)
+    uint64_t names_checksum;        // FNV-1a of the names block
+    uint64_t observations_checksum; // FNV-1a of the observation block
+    uint64_t header_checksum;       // FNV-1a of this header with this field zeroed
+} HmmBinaryHeader;
+
+/**
+ * Write a model (and optionally an observation sequence) in the binary format
+ * @param hmm Model to write (prepared here if needed)
+ * @param observations Observation block to append, or NULL
+ * @param count Number of observations (ignored if observations is NULL)
+ * @param filename Output path (overwritten)
+ * @return 0 on success, -1 on failure
+ */
+int hmm_binary_save(HMM* hmm, const int* observations, long long count, const char* filename);
+
+/**
+ * Map a binary model file
+ *
+ * The returned model's arrays point into a private copy-on-write mapping of
+ * the file, so loading costs O(1) in the model size apart from the checksum
+ * and validation of the parameter block. free_hmm() unmaps it.
+ *
+ * @param filename Path to the binary file
+ * @param observations Receives the mapped observation block (read-only, valid
+ *        until free_hmm), or NULL if the file has none; may be NULL
+ * @param count Receives the number of observations; may be NULL
+ * @param flags 0 or HMM_BINARY_VERIFY_OBSERVATIONS
+ * @return Pointer to the mapped HMM or NULL on failure
+ */
+HMM* hmm_binary_load(const char* filename, const int** observations, long long* count, int flags);
+
+/**
+ * Convert a text model (load_hmm format, with its observation line) to binary
+ * @param text_path Input in the clima_ejemplo.txt format
+ * @param binary_path Output path
+ * @return 0 on success, -1 on failure
+ */
+int hmm_convert_text_to_binary(const char* text_path, const char* binary_path);
+
+#endif // HMM_BINARY_H
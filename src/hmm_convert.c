@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "hmm_binary.h"
+
+// Text-to-binary model converter:
+//     hmm_convert clima_ejemplo.txt clima_ejemplo.hmmb
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Uso: %s <modelo.txt> <modelo.hmmb>\n", argv[0]);
+        return 1;
+    }
+    
+    if (hmm_convert_text_to_binary(argv[1], argv[2]) != 0) {
+        fprintf(stderr, "Error: No se pudo convertir '%s'\n", argv[1]);
+        return 1;
+    }
+    
+    // Reopen to confirm the file is complete and consistent
+    long long count = 0;
+    HMM* hmm = hmm_binary_load(argv[2], NULL, &count, HMM_BINARY_VERIFY_OBSERVATIONS);
+    if (hmm == NULL) {
+        return 1;
+    }
+    printf("%s -> %s: N=%d, M=%d, %lld observaciones\n",
+           argv[1], argv[2], hmm->num_states, hmm->num_observations, count);
+    free_hmm(hmm);
+    return 0;
+}
@@ -0,0 +1,569 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "hmm_kernels.h"
+
+// Every x86 variant is compiled into the same binary through per-function
+// target attributes, independent of the -m flags of the build; the one to run
+// is chosen at startup from CPUID (see KERNEL DISPATCH below).
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HMM_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#define SCALAR_MUL(a, b) ((a) * (b))
+#define SCALAR_ADD(a, b) ((a) + (b))
+
+// =============================================================================
+// SCALAR REFERENCE
+// =============================================================================
+
+double hmm_max_product_scalar(const double* prev, const double* column, int n, int* argmax) {
+    // Products are ≥ 0, so the -1.0 sentinel is always replaced at j = 0
+    double best = -1.0;
+    int best_j = 0;
+    for (int j = 0; j < n; j++) {
+        double value = prev[j] * column[j];
+        if (value > best) {
+            best = value;
+            best_j = j;
+        }
+    }
+    *argmax = best_j;
+    return best;
+}
+
+double hmm_max_sum_scalar(const double* prev, const double* column, int n, int* argmax) {
+    double best = -INFINITY;
+    int best_j = 0;
+    for (int j = 0; j < n; j++) {
+        double value = prev[j] + column[j];
+        if (value > best) {
+            best = value;
+            best_j = j;
+        }
+    }
+    *argmax = best_j;
+    return best;
+}
+
+float hmm_max_sum_float_scalar(const float* prev, const float* column, int n, int* argmax) {
+    float best = -INFINITY;
+    int best_j = 0;
+    for (int j = 0; j < n; j++) {
+        float value = prev[j] + column[j];
+        if (value > best) {
+            best = value;
+            best_j = j;
+        }
+    }
+    *argmax = best_j;
+    return best;
+}
+
+double hmm_max_sum_mixed_scalar(const double* prev, const float* column, int n, int* argmax) {
+    double best = -INFINITY;
+    int best_j = 0;
+    for (int j = 0; j < n; j++) {
+        double value = prev[j] + (double)column[j];
+        if (value > best) {
+            best = value;
+            best_j = j;
+        }
+    }
+    *argmax = best_j;
+    return best;
+}
+
+double hmm_dot_scalar(const double* a, const double* b, int n) {
+    double sum = 0.0;
+    for (int j = 0; j < n; j++) {
+        sum += a[j] * b[j];
+    }
+    return sum;
+}
+
+// =============================================================================
+// VECTOR KERNELS
+// =============================================================================
+//
+// Each lane keeps its own running maximum and the index where it was first
+// reached (strict '>' keeps the earliest index within the lane). The lanes are
+// then merged, preferring the lower index on equal values, and the remaining
+// n % width elements are finished with the scalar loop. Indices are carried as
+// doubles so they can be blended with the same masks as the values.
+
+#if defined(HMM_KERNELS_X86)
+// Merge per-lane maxima into one (value, index) pair, lowest index on ties
+static double merge_lanes(const double* lane_value, const double* lane_index, int lanes, int* argmax) {
+    double best = lane_value[0];
+    int best_j = (int)lane_index[0];
+    for (int l = 1; l < lanes; l++) {
+        int j = (int)lane_index[l];
+        if (lane_value[l] > best || (lane_value[l] == best && j < best_j)) {
+            best = lane_value[l];
+            best_j = j;
+        }
+    }
+    *argmax = best_j;
+    return best;
+}
+
+static float merge_lanes_float(const float* lane_value, const float* lane_index, int lanes, int* argmax) {
+    float best = lane_value[0];
+    int best_j = (int)lane_index[0];
+    for (int l = 1; l < lanes; l++) {
+        int j = (int)lane_index[l];
+        if (lane_value[l] > best || (lane_value[l] == best && j < best_j)) {
+            best = lane_value[l];
+            best_j = j;
+        }
+    }
+    *argmax = best_j;
+    return best;
+}
+#endif
+
+// Scalar tail shared by every vector width
+#define FINISH_TAIL(SCALAR_OP)                                   \
+    for (; j < n; j++) {                                         \
+        double value = SCALAR_OP(prev[j], column[j]);            \
+        if (value > best) {                                      \
+            best = value;                                        \
+            best_j = j;                                          \
+        }                                                        \
+    }                                                            \
+    *argmax = best_j;                                            \
+    return best;
+
+#define FINISH_TAIL_FLOAT                                        \
+    for (; j < n; j++) {                                         \
+        float value = prev[j] + column[j];                       \
+        if (value > best) {                                      \
+            best = value;                                        \
+            best_j = j;                                          \
+        }                                                        \
+    }                                                            \
+    *argmax = best_j;                                            \
+    return best;
+
+// Float lanes hold indices exactly only up to 2²⁴
+#define FLOAT_INDEX_LIMIT (1 << 24)
+
+#if defined(HMM_KERNELS_X86)
+#define DEFINE_SSE2_KERNEL(name, VEC_OP, SCALAR_OP, SCALAR_FALLBACK, COLUMN_TYPE, LOAD_COLUMN) \
+__attribute__((target("sse2")))                                                 \
+static double name(const double* prev, const COLUMN_TYPE* column, int n, int* argmax) { \
+    if (n < 2) return SCALAR_FALLBACK(prev, column, n, argmax);                 \
+    __m128d best_value = VEC_OP(_mm_loadu_pd(prev), LOAD_COLUMN(column));       \
+    __m128d best_index = _mm_set_pd(1.0, 0.0);                                  \
+    __m128d index = best_index;                                                 \
+    const __m128d step = _mm_set1_pd(2.0);                                      \
+    int j;                                                                      \
+    for (j = 2; j + 2 <= n; j += 2) {                                           \
+        index = _mm_add_pd(index, step);                                        \
+        __m128d value = VEC_OP(_mm_loadu_pd(prev + j), LOAD_COLUMN(column + j)); \
+        __m128d greater = _mm_cmpgt_pd(value, best_value);                      \
+        best_value = _mm_or_pd(_mm_and_pd(greater, value),                      \
+                               _mm_andnot_pd(greater, best_value));             \
+        best_index = _mm_or_pd(_mm_and_pd(greater, index),                      \
+                               _mm_andnot_pd(greater, best_index));             \
+    }                                                                           \
+    double lane_value[2], lane_index[2];                                        \
+    _mm_storeu_pd(lane_value, best_value);                                      \
+    _mm_storeu_pd(lane_index, best_index);                                      \
+    int best_j;                                                                 \
+    double best = merge_lanes(lane_value, lane_index, 2, &best_j);              \
+    FINISH_TAIL(SCALAR_OP)                                                      \
+}
+
+#define DEFINE_AVX_KERNEL(name, VEC_OP, SCALAR_OP, SCALAR_FALLBACK, COLUMN_TYPE, LOAD_COLUMN) \
+__attribute__((target("avx")))                                                  \
+static double name(const double* prev, const COLUMN_TYPE* column, int n, int* argmax) { \
+    if (n < 4) return SCALAR_FALLBACK(prev, column, n, argmax);                 \
+    __m256d best_value = VEC_OP(_mm256_loadu_pd(prev), LOAD_COLUMN(column));    \
+    __m256d best_index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);                     \
+    __m256d index = best_index;                                                 \
+    const __m256d step = _mm256_set1_pd(4.0);                                   \
+    int j;                                                                      \
+    for (j = 4; j + 4 <= n; j += 4) {                                           \
+        index = _mm256_add_pd(index, step);                                     \
+        __m256d value = VEC_OP(_mm256_loadu_pd(prev + j), LOAD_COLUMN(column + j)); \
+        __m256d greater = _mm256_cmp_pd(value, best_value, _CMP_GT_OQ);         \
+        best_value = _mm256_blendv_pd(best_value, value, greater);              \
+        best_index = _mm256_blendv_pd(best_index, index, greater);              \
+    }                                                                           \
+    double lane_value[4], lane_index[4];                                        \
+    _mm256_storeu_pd(lane_value, best_value);                                   \
+    _mm256_storeu_pd(lane_index, best_index);                                   \
+    int best_j;                                                                 \
+    double best = merge_lanes(lane_value, lane_index, 4, &best_j);              \
+    FINISH_TAIL(SCALAR_OP)                                                      \
+}
+
+#define DEFINE_AVX512_KERNEL(name, VEC_OP, SCALAR_OP, SCALAR_FALLBACK, COLUMN_TYPE, LOAD_COLUMN) \
+__attribute__((target("avx512f")))                                              \
+static double name(const double* prev, const COLUMN_TYPE* column, int n, int* argmax) { \
+    if (n < 8) return SCALAR_FALLBACK(prev, column, n, argmax);                 \
+    __m512d best_value = VEC_OP(_mm512_loadu_pd(prev), LOAD_COLUMN(column));    \
+    __m512d best_index = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0); \
+    __m512d index = best_index;                                                 \
+    const __m512d step = _mm512_set1_pd(8.0);                                   \
+    int j;                                                                      \
+    for (j = 8; j + 8 <= n; j += 8) {                                           \
+        index = _mm512_add_pd(index, step);                                     \
+        __m512d value = VEC_OP(_mm512_loadu_pd(prev + j), LOAD_COLUMN(column + j)); \
+        __mmask8 greater = _mm512_cmp_pd_mask(value, best_value, _CMP_GT_OQ);   \
+        best_value = _mm512_mask_blend_pd(greater, best_value, value);          \
+        best_index = _mm512_mask_blend_pd(greater, best_index, index);          \
+    }                                                                           \
+    double lane_value[8], lane_index[8];                                        \
+    _mm512_storeu_pd(lane_value, best_value);                                   \
+    _mm512_storeu_pd(lane_index, best_index);                                   \
+    int best_j;                                                                 \
+    double best = merge_lanes(lane_value, lane_index, 8, &best_j);              \
+    FINISH_TAIL(SCALAR_OP)                                                      \
+}
+
+// Single-precision max-sum: twice the lanes of the double kernels
+__attribute__((target("sse2")))
+static float max_sum_float_sse2(const float* prev, const float* column, int n, int* argmax) {
+    if (n < 4 || n > FLOAT_INDEX_LIMIT) return hmm_max_sum_float_scalar(prev, column, n, argmax);
+    __m128 best_value = _mm_add_ps(_mm_loadu_ps(prev), _mm_loadu_ps(column));
+    __m128 best_index = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    __m128 index = best_index;
+    const __m128 step = _mm_set1_ps(4.0f);
+    int j;
+    for (j = 4; j + 4 <= n; j += 4) {
+        index = _mm_add_ps(index, step);
+        __m128 value = _mm_add_ps(_mm_loadu_ps(prev + j), _mm_loadu_ps(column + j));
+        __m128 greater = _mm_cmpgt_ps(value, best_value);
+        best_value = _mm_or_ps(_mm_and_ps(greater, value), _mm_andnot_ps(greater, best_value));
+        best_index = _mm_or_ps(_mm_and_ps(greater, index), _mm_andnot_ps(greater, best_index));
+    }
+    float lane_value[4], lane_index[4];
+    _mm_storeu_ps(lane_value, best_value);
+    _mm_storeu_ps(lane_index, best_index);
+    int best_j;
+    float best = merge_lanes_float(lane_value, lane_index, 4, &best_j);
+    FINISH_TAIL_FLOAT
+}
+
+__attribute__((target("avx")))
+static float max_sum_float_avx(const float* prev, const float* column, int n, int* argmax) {
+    if (n < 8 || n > FLOAT_INDEX_LIMIT) return hmm_max_sum_float_scalar(prev, column, n, argmax);
+    __m256 best_value = _mm256_add_ps(_mm256_loadu_ps(prev), _mm256_loadu_ps(column));
+    __m256 best_index = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    __m256 index = best_index;
+    const __m256 step = _mm256_set1_ps(8.0f);
+    int j;
+    for (j = 8; j + 8 <= n; j += 8) {
+        index = _mm256_add_ps(index, step);
+        __m256 value = _mm256_add_ps(_mm256_loadu_ps(prev + j), _mm256_loadu_ps(column + j));
+        __m256 greater = _mm256_cmp_ps(value, best_value, _CMP_GT_OQ);
+        best_value = _mm256_blendv_ps(best_value, value, greater);
+        best_index = _mm256_blendv_ps(best_index, index, greater);
+    }
+    float lane_value[8], lane_index[8];
+    _mm256_storeu_ps(lane_value, best_value);
+    _mm256_storeu_ps(lane_index, best_index);
+    int best_j;
+    float best = merge_lanes_float(lane_value, lane_index, 8, &best_j);
+    FINISH_TAIL_FLOAT
+}
+
+__attribute__((target("avx512f")))
+static float max_sum_float_avx512(const float* prev, const float* column, int n, int* argmax) {
+    if (n < 16 || n > FLOAT_INDEX_LIMIT) return hmm_max_sum_float_scalar(prev, column, n, argmax);
+    __m512 best_value = _mm512_add_ps(_mm512_loadu_ps(prev), _mm512_loadu_ps(column));
+    __m512 best_index = _mm512_set_ps(15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f,
+                                      7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    __m512 index = best_index;
+    const __m512 step = _mm512_set1_ps(16.0f);
+    int j;
+    for (j = 16; j + 16 <= n; j += 16) {
+        index = _mm512_add_ps(index, step);
+        __m512 value = _mm512_add_ps(_mm512_loadu_ps(prev + j), _mm512_loadu_ps(column + j));
+        __mmask16 greater = _mm512_cmp_ps_mask(value, best_value, _CMP_GT_OQ);
+        best_value = _mm512_mask_blend_ps(greater, best_value, value);
+        best_index = _mm512_mask_blend_ps(greater, best_index, index);
+    }
+    float lane_value[16], lane_index[16];
+    _mm512_storeu_ps(lane_value, best_value);
+    _mm512_storeu_ps(lane_index, best_index);
+    int best_j;
+    float best = merge_lanes_float(lane_value, lane_index, 16, &best_j);
+    FINISH_TAIL_FLOAT
+}
+
+// Float columns widened to double on load (mixed precision)
+#define LOAD_FLOAT2_AS_PD(p) _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)(p))))
+#define LOAD_FLOAT4_AS_PD(p) _mm256_cvtps_pd(_mm_loadu_ps(p))
+#define LOAD_FLOAT8_AS_PD(p) _mm512_cvtps_pd(_mm256_loadu_ps(p))
+
+// Dot products: one vector accumulator, reduced horizontally, scalar tail
+__attribute__((target("sse2")))
+static double dot_sse2(const double* a, const double* b, int n) {
+    __m128d acc = _mm_setzero_pd();
+    int j;
+    for (j = 0; j + 2 <= n; j += 2) {
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    double sum = lanes[0] + lanes[1];
+    for (; j < n; j++) sum += a[j] * b[j];
+    return sum;
+}
+
+__attribute__((target("avx")))
+static double dot_avx(const double* a, const double* b, int n) {
+    __m256d acc = _mm256_setzero_pd();
+    int j;
+    for (j = 0; j + 4 <= n; j += 4) {
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; j < n; j++) sum += a[j] * b[j];
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+static double dot_avx512(const double* a, const double* b, int n) {
+    __m512d acc = _mm512_setzero_pd();
+    int j;
+    for (j = 0; j + 8 <= n; j += 8) {
+        acc = _mm512_add_pd(acc, _mm512_mul_pd(_mm512_loadu_pd(a + j), _mm512_loadu_pd(b + j)));
+    }
+    double sum = _mm512_reduce_add_pd(acc);
+    for (; j < n; j++) sum += a[j] * b[j];
+    return sum;
+}
+
+DEFINE_SSE2_KERNEL(max_product_sse2, _mm_mul_pd, SCALAR_MUL, hmm_max_product_scalar, double, _mm_loadu_pd)
+DEFINE_SSE2_KERNEL(max_sum_sse2, _mm_add_pd, SCALAR_ADD, hmm_max_sum_scalar, double, _mm_loadu_pd)
+DEFINE_SSE2_KERNEL(max_sum_mixed_sse2, _mm_add_pd, SCALAR_ADD, hmm_max_sum_mixed_scalar, float, LOAD_FLOAT2_AS_PD)
+DEFINE_AVX_KERNEL(max_product_avx, _mm256_mul_pd, SCALAR_MUL, hmm_max_product_scalar, double, _mm256_loadu_pd)
+DEFINE_AVX_KERNEL(max_sum_avx, _mm256_add_pd, SCALAR_ADD, hmm_max_sum_scalar, double, _mm256_loadu_pd)
+DEFINE_AVX_KERNEL(max_sum_mixed_avx, _mm256_add_pd, SCALAR_ADD, hmm_max_sum_mixed_scalar, float, LOAD_FLOAT4_AS_PD)
+DEFINE_AVX512_KERNEL(max_product_avx512, _mm512_mul_pd, SCALAR_MUL, hmm_max_product_scalar, double, _mm512_loadu_pd)
+DEFINE_AVX512_KERNEL(max_sum_avx512, _mm512_add_pd, SCALAR_ADD, hmm_max_sum_scalar, double, _mm512_loadu_pd)
+DEFINE_AVX512_KERNEL(max_sum_mixed_avx512, _mm512_add_pd, SCALAR_ADD, hmm_max_sum_mixed_scalar, float,
+                     LOAD_FLOAT8_AS_PD)
+#endif
+
+// =============================================================================
+// KERNEL DISPATCH
+// =============================================================================
+
+// Variants from widest to narrowest; the first one the CPU supports is the default
+static const HmmKernels KERNEL_VARIANTS[] = {
+#if defined(HMM_KERNELS_X86)
+    {"avx512", max_product_avx512, max_sum_avx512, dot_avx512, max_sum_float_avx512, max_sum_mixed_avx512},
+    {"avx",    max_product_avx,    max_sum_avx,    dot_avx,    max_sum_float_avx,    max_sum_mixed_avx},
+    {"sse2",   max_product_sse2,   max_sum_sse2,   dot_sse2,   max_sum_float_sse2,   max_sum_mixed_sse2},
+#endif
+    {"scalar", hmm_max_product_scalar, hmm_max_sum_scalar, hmm_dot_scalar,
+               hmm_max_sum_float_scalar, hmm_max_sum_mixed_scalar},
+};
+
+#define KERNEL_VARIANT_COUNT ((int)(sizeof(KERNEL_VARIANTS) / sizeof(KERNEL_VARIANTS[0])))
+
+static const HmmKernels* active_kernels = NULL;
+static int fixed_recursions = 1;
+
+// CPUID check (GCC's cpu model also verifies OS support for the AVX register state)
+static int cpu_supports(const char* isa) {
+#if defined(HMM_KERNELS_X86)
+    __builtin_cpu_init();
+    if (strcmp(isa, "avx512") == 0) return __builtin_cpu_supports("avx512f");
+    if (strcmp(isa, "avx") == 0) return __builtin_cpu_supports("avx");
+    if (strcmp(isa, "sse2") == 0) return __builtin_cpu_supports("sse2");
+#endif
+    return strcmp(isa, "scalar") == 0;
+}
+
+const HmmKernels* hmm_kernels_find(const char* isa) {
+    if (isa == NULL) return NULL;
+    
+    for (int v = 0; v < KERNEL_VARIANT_COUNT; v++) {
+        if (strcmp(KERNEL_VARIANTS[v].isa, isa) == 0) {
+            return cpu_supports(isa) ? &KERNEL_VARIANTS[v] : NULL;
+        }
+    }
+    return NULL;
+}
+
+int hmm_kernels_select(const char* isa) {
+    const HmmKernels* kernels = hmm_kernels_find(isa);
+    if (kernels == NULL) {
+        return 0;
+    }
+    active_kernels = kernels;
+    return 1;
+}
+
+// Runs once at program startup; HMM_KERNEL_ISA=<name> forces a variant and
+// HMM_FIXED_KERNELS=0 disables the fixed-size recursions
+#if defined(__GNUC__)
+__attribute__((constructor))
+#endif
+static void hmm_kernels_init(void) {
+    const char* fixed = getenv("HMM_FIXED_KERNELS");
+    if (fixed != NULL && strcmp(fixed, "0") == 0) {
+        fixed_recursions = 0;
+    }
+    
+    const char* forced = getenv("HMM_KERNEL_ISA");
+    if (forced != NULL && forced[0] != '\0') {
+        if (hmm_kernels_select(forced)) {
+            return;
+        }
+        fprintf(stderr, "Warning: HMM_KERNEL_ISA=%s is unknown or not supported by this CPU; "
+                        "using automatic selection\n", forced);
+    }
+    
+    for (int v = 0; v < KERNEL_VARIANT_COUNT; v++) {
+        if (cpu_supports(KERNEL_VARIANTS[v].isa)) {
+            active_kernels = &KERNEL_VARIANTS[v];
+            return;
+        }
+    }
+}
+
+const HmmKernels* hmm_kernels(void) {
+    // Compilers without constructor support select on first use
+    if (active_kernels == NULL) {
+        hmm_kernels_init();
+    }
+    return active_kernels;
+}
+
+double hmm_max_product(const double* prev, const double* column, int n, int* argmax) {
+    return hmm_kernels()->max_product(prev, column, n, argmax);
+}
+
+double hmm_max_sum(const double* prev, const double* column, int n, int* argmax) {
+    return hmm_kernels()->max_sum(prev, column, n, argmax);
+}
+
+float hmm_max_sum_float(const float* prev, const float* column, int n, int* argmax) {
+    return hmm_kernels()->max_sum_float(prev, column, n, argmax);
+}
+
+double hmm_max_sum_mixed(const double* prev, const float* column, int n, int* argmax) {
+    return hmm_kernels()->max_sum_mixed(prev, column, n, argmax);
+}
+
+double hmm_dot(const double* a, const double* b, int n) {
+    return hmm_kernels()->dot(a, b, n);
+}
+
+const char* hmm_kernels_isa(void) {
+    return hmm_kernels()->isa;
+}
+
+// =============================================================================
+// FIXED-SIZE RECURSIONS
+// =============================================================================
+
+#define FIXED_MAX_STATES 8
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define UNROLL_FIXED _Pragma("GCC unroll 8")
+#define FIXED_INLINE static inline __attribute__((always_inline))
+#elif defined(__clang__)
+#define UNROLL_FIXED _Pragma("unroll")
+#define FIXED_INLINE static inline __attribute__((always_inline))
+#else
+#define UNROLL_FIXED
+#define FIXED_INLINE static inline
+#endif
+
+// Body shared by every specialization; n and log_domain are constants at each
+// call site, so the loops unroll and the branches on log_domain disappear.
+// The reduction is the scalar reference loop, which every kernel variant matches.
+FIXED_INLINE void fixed_recursion(const HmmRecursionArgs* args, const int n, const int log_domain) {
+    double column[FIXED_MAX_STATES][FIXED_MAX_STATES];
+    double prev[FIXED_MAX_STATES];
+    double next[FIXED_MAX_STATES];
+    
+    UNROLL_FIXED
+    for (int i = 0; i < n; i++) {
+        UNROLL_FIXED
+        for (int j = 0; j < n; j++) {
+            column[i][j] = args->transition_t[(size_t)i * args->stride + j];
+        }
+        prev[i] = args->delta[i];
+    }
+    
+    for (int t = 1; t < args->T; t++) {
+        const double* emission = args->emission_t + (size_t)args->observations[t] * args->stride;
+        double* delta = args->delta + (size_t)t * args->delta_stride;
+        int* psi = args->psi + (size_t)t * args->psi_stride;
+        
+        UNROLL_FIXED
+        for (int i = 0; i < n; i++) {
+            double best = log_domain ? -INFINITY : -1.0;
+            int best_j = 0;
+            UNROLL_FIXED
+            for (int j = 0; j < n; j++) {
+                double value = log_domain ? SCALAR_ADD(prev[j], column[i][j])
+                                          : SCALAR_MUL(prev[j], column[i][j]);
+                if (value > best) {
+                    best = value;
+                    best_j = j;
+                }
+            }
+            next[i] = log_domain ? SCALAR_ADD(best, emission[i]) : SCALAR_MUL(best, emission[i]);
+            psi[i] = best_j;
+        }
+        
+        UNROLL_FIXED
+        for (int i = 0; i < n; i++) {
+            delta[i] = next[i];
+            prev[i] = next[i];
+        }
+    }
+}
+
+#define DEFINE_FIXED_RECURSIONS(n)                                             \
+static void recursion_product_##n(const HmmRecursionArgs* args) {              \
+    fixed_recursion(args, n, 0);                                               \
+}                                                                              \
+static void recursion_sum_##n(const HmmRecursionArgs* args) {                  \
+    fixed_recursion(args, n, 1);                                               \
+}
+
+DEFINE_FIXED_RECURSIONS(2)
+DEFINE_FIXED_RECURSIONS(3)
+DEFINE_FIXED_RECURSIONS(4)
+DEFINE_FIXED_RECURSIONS(8)
+
+HmmRecursionKernel hmm_fixed_recursion(int n, int log_domain) {
+    hmm_kernels();  // Reads HMM_FIXED_KERNELS if the constructor did not run
+    if (!fixed_recursions) {
+        return NULL;
+    }
+    
+    switch (n) {
+        case 2: return log_domain ? recursion_sum_2 : recursion_product_2;
+        case 3: return log_domain ? recursion_sum_3 : recursion_product_3;
+        case 4: return log_domain ? recursion_sum_4 : recursion_product_4;
+        case 8: return log_domain ? recursion_sum_8 : recursion_product_8;
+        default: return NULL;
+    }
+}
+
+void hmm_fixed_recursions_enable(int enabled) {
+    hmm_kernels();
+    fixed_recursions = enabled != 0;
+}
+
+int hmm_fixed_recursions_enabled(void) {
+    hmm_kernels();
+    return fixed_recursions;
+}
@@ -0,0 +1,210 @@
+#ifndef HMM_KERNELS_H
+#define HMM_KERNELS_H
+
+// =============================================================================
+// VITERBI RECURSION KERNELS
+// =============================================================================
+//
+// The recursion step of the Viterbi algorithm reduces, for every state i,
+//     δₜ₋₁(j) × A(j,i)      (linear domain)   or
+//     log δₜ₋₁(j) + log A(j,i)  (log domain)
+// over all predecessors j to a maximum and its argmax. With the transposed
+// transition matrix Aᵀ both operands are contiguous vectors, so the reduction
+// is vectorized here (SSE2 / AVX / AVX-512, scalar fallback).
+//
+// All variants are built into the binary and one is selected once at startup
+// from CPUID; set HMM_KERNEL_ISA=avx512|avx|sse2|scalar in the environment to
+// force a variant (e.g. for benchmarking). Hot loops should fetch the table
+// once with hmm_kernels() and call through it.
+//
+// Every variant returns exactly the value and index the scalar reference loop
+// returns: multiplication/addition and max are exact per element, and ties are
+// resolved to the lowest index j just like the scalar strict '>' comparison.
+//
+// Models decoded in reduced precision (hmm_set_precision) use two more max-sum
+// reductions: float log δ with float log A (twice the lanes of the double
+// kernels), and double log δ with float log A widened on load (half the
+// transition bandwidth). They give the same guarantees against their own
+// scalar reference loops.
+//
+// The forward / backward recursions (hmm_posterior.h) reduce the same operands
+// with a sum instead of a max; that dot product is vectorized as well. Its
+// vector variants add in a different order than the scalar loop, so they agree
+// with it only to rounding.
+
+/**
+ * Signature shared by the max-product and max-sum reductions
+ */
+typedef double (*HmmMaxKernel)(const double* prev, const double* column, int n, int* argmax);
+
+/**
+ * Max-sum over float log δ and float log A
+ */
+typedef float (*HmmMaxKernelFloat)(const float* prev, const float* column, int n, int* argmax);
+
+/**
+ * Max-sum over double log δ and float log A
+ */
+typedef double (*HmmMaxKernelMixed)(const double* prev, const float* column, int n, int* argmax);
+
+/**
+ * Signature of the sum-product reduction
+ */
+typedef double (*HmmDotKernel)(const double* a, const double* b, int n);
+
+/**
+ * One instruction-set variant of every kernel
+ */
+typedef struct {
+    const char* isa;           // "avx512", "avx", "sse2" or "scalar"
+    HmmMaxKernel max_product;  // See hmm_max_product
+    HmmMaxKernel max_sum;      // See hmm_max_sum
+    HmmDotKernel dot;          // See hmm_dot
+    HmmMaxKernelFloat max_sum_float;  // See hmm_max_sum_float
+    HmmMaxKernelMixed max_sum_mixed;  // See hmm_max_sum_mixed
+} HmmKernels;
+
+/**
+ * Active kernel table (selected at startup, see above)
+ * @return Pointer to the active variant, never NULL
+ */
+const HmmKernels* hmm_kernels(void);
+
+/**
+ * Look up a variant by name
+ * @param isa "avx512", "avx", "sse2" or "scalar"
+ * @return The variant, or NULL if it is not built in or the CPU lacks support
+ */
+const HmmKernels* hmm_kernels_find(const char* isa);
+
+/**
+ * Force the active variant at runtime (overrides HMM_KERNEL_ISA)
+ * Not thread-safe with respect to decodes running concurrently.
+ * @param isa Variant name
+ * @return 1 on success, 0 if the variant is unavailable (selection unchanged)
+ */
+int hmm_kernels_select(const char* isa);
+
+/**
+ * Max-product reduction: max_j prev[j] × column[j]
+ * @param prev Previous δ row (length n)
+ * @param column Transition column A(·,i) (length n)
+ * @param n Number of states (n ≥ 1)
+ * @param argmax Receives the lowest j attaining the maximum
+ * @return The maximum product
+ */
+double hmm_max_product(const double* prev, const double* column, int n, int* argmax);
+
+/**
+ * Max-sum reduction (log domain): max_j prev[j] + column[j]
+ * If every term is -INFINITY the result is -INFINITY with argmax 0.
+ * @param prev Previous log δ row (length n)
+ * @param column Log transition column log A(·,i) (length n)
+ * @param n Number of states (n ≥ 1)
+ * @param argmax Receives the lowest j attaining the maximum
+ * @return The maximum sum
+ */
+double hmm_max_sum(const double* prev, const double* column, int n, int* argmax);
+
+/**
+ * Single-precision max-sum: max_j prev[j] + column[j] in float
+ * Indices are carried in float lanes, so vector variants handle n ≤ 2²⁴ and
+ * larger n falls back to the scalar loop.
+ * @param prev Previous log δ row (length n)
+ * @param column Log transition column (length n)
+ * @param n Number of states (n ≥ 1)
+ * @param argmax Receives the lowest j attaining the maximum
+ * @return The maximum sum
+ */
+float hmm_max_sum_float(const float* prev, const float* column, int n, int* argmax);
+
+/**
+ * Mixed-precision max-sum: max_j prev[j] + (double)column[j]
+ * @param prev Previous log δ row in double (length n)
+ * @param column Log transition column in float (length n)
+ * @param n Number of states (n ≥ 1)
+ * @param argmax Receives the lowest j attaining the maximum
+ * @return The maximum sum
+ */
+double hmm_max_sum_mixed(const double* prev, const float* column, int n, int* argmax);
+
+/**
+ * Sum-product reduction: Σ_j a[j] × b[j]
+ * @param a First vector (length n)
+ * @param b Second vector (length n)
+ * @param n Length (n ≥ 0)
+ * @return The dot product (0.0 for n = 0)
+ */
+double hmm_dot(const double* a, const double* b, int n);
+
+/**
+ * Scalar reference implementations (same contract as above)
+ */
+double hmm_max_product_scalar(const double* prev, const double* column, int n, int* argmax);
+double hmm_max_sum_scalar(const double* prev, const double* column, int n, int* argmax);
+double hmm_dot_scalar(const double* a, const double* b, int n);
+float hmm_max_sum_float_scalar(const float* prev, const float* column, int n, int* argmax);
+double hmm_max_sum_mixed_scalar(const double* prev, const float* column, int n, int* argmax);
+
+/**
+ * Name of the active variant
+ * @return "avx512", "avx", "sse2" or "scalar"
+ */
+const char* hmm_kernels_isa(void);
+
+// =============================================================================
+// FIXED-SIZE RECURSIONS
+// =============================================================================
+//
+// For the tiny models most deployments use (N = 2, 3, 4, 8) a call per state
+// and step into the reductions above costs more than the arithmetic. These
+// kernels run the whole recursion for one compile-time N instead: A is loaded
+// once, δₜ₋₁ stays in registers, and every loop is fully unrolled. Results are
+// bit-identical to the generic loop (same operations, same strict '>' ties).
+//
+// The Viterbi decoders pick them up automatically through
+// hmm_fixed_recursion(); set HMM_FIXED_KERNELS=0 in the environment (or call
+// hmm_fixed_recursions_enable(0)) to force the generic path, e.g. to compare.
+
+/**
+ * Operands of a recursion (row 0 of delta must already hold δ₁)
+ */
+typedef struct {
+    const double* transition_t;  // Aᵀ or log Aᵀ: row i is column A(·,i)
+    const double* emission_t;    // Bᵀ or log Bᵀ: row k is column B(·,k)
+    int stride;                  // Doubles between rows of both matrices
+    const int* observations;     // o₁ ... o_T
+    int T;                       // Sequence length
+    double* delta;               // δ rows 0 .. T-1
+    int delta_stride;            // Doubles between rows of delta
+    int* psi;                    // ψ rows 0 .. T-1 (row 0 is left untouched)
+    int psi_stride;              // Ints between rows of psi
+} HmmRecursionArgs;
+
+/**
+ * Fills rows 1 .. T-1 of delta and psi
+ */
+typedef void (*HmmRecursionKernel)(const HmmRecursionArgs* args);
+
+/**
+ * Specialized recursion for a state count
+ * @param n Number of states
+ * @param log_domain 1 for max-sum (log δ), 0 for max-product (δ)
+ * @return The kernel, or NULL if n has none or they are disabled
+ */
+HmmRecursionKernel hmm_fixed_recursion(int n, int log_domain);
+
+/**
+ * Enable or disable the fixed-size recursions (overrides HMM_FIXED_KERNELS)
+ * Not thread-safe with respect to decodes running concurrently.
+ * @param enabled 1 to use them when available, 0 for the generic path
+ */
+void hmm_fixed_recursions_enable(int enabled);
+
+/**
+ * Whether the fixed-size recursions are in use
+ * @return 1 if enabled, 0 otherwise
+ */
+int hmm_fixed_recursions_enabled(void);
+
+#endif // HMM_KERNELS_H
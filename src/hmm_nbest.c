@@ -0,0 +1,287 @@
+#include <limits.h>
+#include "hmm_nbest.h"
+
+// =============================================================================
+// MEMORY MANAGEMENT FUNCTIONS
+// =============================================================================
+
+// Carve the per-step arrays out of one aligned block
+static int nbest_scratch_allocate(NBestWorkspace* workspace, int N, int K) {
+    int stride = hmm_padded_stride(N, sizeof(double));
+    size_t scores = sizeof(double) * (size_t)stride * K;
+    size_t merged = sizeof(double) * (size_t)hmm_padded_stride(K, sizeof(double));
+    size_t chosen = sizeof(unsigned int) * (size_t)hmm_padded_stride(K, sizeof(unsigned int));
+    size_t heap = sizeof(NBestCandidate) * (size_t)(N < K ? N : K);
+    char* block = (char*)hmm_aligned_calloc(2 * scores + merged + chosen + heap);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate N-best scratch for N=%d, K=%d\n", N, K);
+        return 0;
+    }
+    
+    free(workspace->scratch);
+    workspace->scratch = block;
+    workspace->score = (double*)block;              block += scores;
+    workspace->next_score = (double*)block;         block += scores;
+    workspace->merged = (double*)block;             block += merged;
+    workspace->chosen = (unsigned int*)block;       block += chosen;
+    workspace->heap = (NBestCandidate*)block;
+    workspace->stride = stride;
+    workspace->N = N;
+    workspace->K = K;
+    return 1;
+}
+
+// Backpointers for T steps; old buffer stays valid on failure
+static int nbest_back_allocate(NBestWorkspace* workspace, int T, int N, int K) {
+    unsigned int* back = (unsigned int*)realloc(workspace->back, (size_t)T * N * K * sizeof(unsigned int));
+    if (back == NULL) {
+        fprintf(stderr, "Error: Failed to allocate N-best backpointers (T=%d, N=%d, K=%d)\n", T, N, K);
+        return 0;
+    }
+    workspace->back = back;
+    workspace->max_T = T;
+    return 1;
+}
+
+NBestWorkspace* nbest_workspace_create(int max_T, int N, int K) {
+    if (max_T <= 0 || N <= 0 || K <= 0 || (long long)N * K > INT_MAX) {
+        fprintf(stderr, "Error: Invalid N-best workspace dimensions (T=%d, N=%d, K=%d)\n", max_T, N, K);
+        return NULL;
+    }
+    
+    NBestWorkspace* workspace = (NBestWorkspace*)calloc(1, sizeof(NBestWorkspace));
+    if (workspace == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for NBestWorkspace\n");
+        return NULL;
+    }
+    
+    if (!nbest_scratch_allocate(workspace, N, K) || !nbest_back_allocate(workspace, max_T, N, K)) {
+        nbest_workspace_free(workspace);
+        return NULL;
+    }
+    
+    return workspace;
+}
+
+void nbest_workspace_free(NBestWorkspace* workspace) {
+    if (workspace == NULL) return;
+    
+    free(workspace->back);
+    free(workspace->scratch);
+    free(workspace);
+}
+
+// Make room for T steps of N x K hypotheses
+static int nbest_workspace_reserve(NBestWorkspace* workspace, int T, int N, int K) {
+    if (N != workspace->N || K != workspace->K) {
+        // A step of backpointers changes size with N·K: resize to exactly T
+        workspace->max_T = 0;
+        return nbest_scratch_allocate(workspace, N, K) && nbest_back_allocate(workspace, T, N, K);
+    }
+    if (T <= workspace->max_T) {
+        return 1;
+    }
+    
+    // Grow geometrically so a slowly increasing T does not reallocate every call
+    int new_T = T;
+    if (T < workspace->max_T + workspace->max_T / 2) {
+        new_T = workspace->max_T + workspace->max_T / 2;
+    }
+    return nbest_back_allocate(workspace, new_T, N, K);
+}
+
+// =============================================================================
+// K-WAY MERGE
+// =============================================================================
+
+// Heap order: a comes out before b if its value is higher, or equal with a
+// lower predecessor state, then a lower rank (Viterbi's tie-breaking)
+static int comes_before(const NBestCandidate* a, const NBestCandidate* b) {
+    if (a->value != b->value) return a->value > b->value;
+    if (a->state != b->state) return a->state < b->state;
+    return a->rank < b->rank;
+}
+
+// Restore heap order below position: the root comes out first
+static void merge_sift_down(NBestCandidate* heap, int size, int position) {
+    NBestCandidate moving = heap[position];
+    for (;;) {
+        int child = 2 * position + 1;
+        if (child >= size) break;
+        if (child + 1 < size && comes_before(&heap[child + 1], &heap[child])) child++;
+        if (!comes_before(&heap[child], &moving)) break;
+        heap[position] = heap[child];
+        position = child;
+    }
+    heap[position] = moving;
+}
+
+// Same for the screening heap, whose root is the candidate that comes out last
+static void screen_sift_down(NBestCandidate* heap, int size, int position) {
+    NBestCandidate moving = heap[position];
+    for (;;) {
+        int child = 2 * position + 1;
+        if (child >= size) break;
+        if (child + 1 < size && comes_before(&heap[child], &heap[child + 1])) child++;
+        if (!comes_before(&moving, &heap[child])) break;
+        heap[position] = heap[child];
+        position = child;
+    }
+    heap[position] = moving;
+}
+
+// Merge the sorted lists score[s·stride + j] + offset[j] (rank s, ending at
+// the first -inf) and emit the K largest values, best first, into value[] and
+// back[] (j·K + s). offset may be NULL (all zero). Returns how many were emitted.
+static int merge_top(NBestCandidate* heap, const double* score, int stride, const double* offset,
+                     int N, int K, double* value, unsigned int* back) {
+    // A list whose head is not among the K best heads cannot contribute: its
+    // head alone comes after K other candidates. The K best heads are kept in a
+    // worst-first heap, so most lists cost one comparison against its root.
+    // States are visited in increasing order, so a head equal to the root
+    // comes after it and is skipped too.
+    int size = 0;
+    double worst = -INFINITY;  // Value of heap[0] once the heap is full
+    for (int j = 0; j < N; j++) {
+        double candidate = score[j] + (offset != NULL ? offset[j] : 0.0);
+        if (candidate <= worst) continue;
+        NBestCandidate head = {candidate, j, 0};
+        if (size < K) {
+            int position = size++;
+            while (position > 0 && comes_before(&heap[(position - 1) / 2], &head)) {
+                heap[position] = heap[(position - 1) / 2];
+                position = (position - 1) / 2;
+            }
+            heap[position] = head;
+        } else {
+            heap[0] = head;
+            screen_sift_down(heap, size, 0);
+        }
+        if (size == K) worst = heap[0].value;
+    }
+    for (int p = size / 2 - 1; p >= 0; p--) {
+        merge_sift_down(heap, size, p);
+    }
+    
+    int emitted = 0;
+    while (emitted < K && size > 0) {
+        NBestCandidate* top = &heap[0];
+        value[emitted] = top->value;
+        back[emitted] = (unsigned int)top->state * (unsigned int)K + (unsigned int)top->rank;
+        emitted++;
+        
+        // Replace the head by the next entry of the same list, or drop the list
+        int j = top->state;
+        double next = top->rank + 1 < K ? score[(size_t)(top->rank + 1) * stride + j] : -INFINITY;
+        if (next > -INFINITY) {
+            top->rank++;
+            top->value = next + (offset != NULL ? offset[j] : 0.0);
+        } else {
+            heap[0] = heap[--size];
+        }
+        merge_sift_down(heap, size, 0);
+    }
+    return emitted;
+}
+
+// =============================================================================
+// CORE ALGORITHM FUNCTIONS
+// =============================================================================
+
+int viterbi_nbest(HMM* hmm, const int* observations, int T, int K, NBestWorkspace* workspace,
+                  int* paths, double* log_probabilities, int* num_paths) {
+    if (hmm == NULL || observations == NULL || workspace == NULL || paths == NULL
+        || num_paths == NULL || T <= 0 || K <= 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to viterbi_nbest\n");
+        return -1;
+    }
+    
+    int N = hmm->num_states;
+    if ((long long)N * K > INT_MAX) {
+        fprintf(stderr, "Error: N-best with N=%d and K=%d exceeds the backpointer range\n", N, K);
+        return -1;
+    }
+    if (!validate_observations((int*)observations, T, hmm->num_observations)) {
+        fprintf(stderr, "Error: Invalid observation sequence\n");
+        return -1;
+    }
+    
+    // log Aᵀ is a derived layout; hand-built models get it here
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    if (!nbest_workspace_reserve(workspace, T, N, K)) {
+        return -1;
+    }
+    
+    // ==========================================================================
+    // INITIALIZATION: one hypothesis per reachable state
+    // log δ₁(i, 0) = log π(i) + log B(i,o₁)
+    // ==========================================================================
+    
+    int stride = workspace->stride;
+    const double* log_emission = HMM_LOG_B_COLUMN(hmm, observations[0]);
+    for (int i = 0; i < N; i++) {
+        workspace->next_score[i] = hmm->log_initial[i] + log_emission[i];
+        workspace->back[(size_t)i * K] = 0;
+    }
+    for (int r = 1; r < K; r++) {
+        for (int i = 0; i < N; i++) {
+            workspace->next_score[(size_t)r * stride + i] = -INFINITY;
+        }
+    }
+    
+    // ==========================================================================
+    // RECURSION: K-way merge of the predecessors' lists for every state
+    // ==========================================================================
+    
+    double* merged = workspace->merged;
+    for (int t = 1; t < T; t++) {
+        double* swap = workspace->score;
+        workspace->score = workspace->next_score;
+        workspace->next_score = swap;
+        
+        log_emission = HMM_LOG_B_COLUMN(hmm, observations[t]);
+        unsigned int* back = workspace->back + (size_t)t * N * K;
+        
+        for (int i = 0; i < N; i++) {
+            int found = 0;
+            if (log_emission[i] > -INFINITY) {
+                found = merge_top(workspace->heap, workspace->score, stride, HMM_LOG_A_COLUMN(hmm, i),
+                                  N, K, merged, back + (size_t)i * K);
+            }
+            for (int r = 0; r < found; r++) {
+                workspace->next_score[(size_t)r * stride + i] = merged[r] + log_emission[i];
+            }
+            for (int r = found; r < K; r++) {
+                workspace->next_score[(size_t)r * stride + i] = -INFINITY;
+            }
+        }
+    }
+    
+    // ==========================================================================
+    // TERMINATION: K best hypotheses over all final states, then backtrack
+    // ==========================================================================
+    
+    int found = merge_top(workspace->heap, workspace->next_score, stride, NULL, N, K,
+                          merged, workspace->chosen);
+    
+    for (int k = 0; k < found; k++) {
+        int* path = paths + (size_t)k * T;
+        unsigned int hypothesis = workspace->chosen[k];
+        for (int t = T-1; t >= 0; t--) {
+            int state = (int)(hypothesis / (unsigned int)K);
+            path[t] = state;
+            if (t > 0) {
+                hypothesis = workspace->back[((size_t)t * N + state) * K + hypothesis % (unsigned int)K];
+            }
+        }
+        if (log_probabilities != NULL) {
+            log_probabilities[k] = merged[k];
+        }
+    }
+    
+    *num_paths = found;
+    return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef HMM_NBEST_H
+#define HMM_NBEST_H
+
+#include "hmm.h"
+
+// =============================================================================
+// N-BEST (LIST) VITERBI
+// =============================================================================
+//
+// Finds the K most likely state sequences instead of only the best one
+// (parallel list Viterbi). Every state keeps its K best partial hypotheses per
+// step, sorted by log δ:
+//   log δₜ(i, r) = r-th largest of log δₜ₋₁(j, s) + log A(j,i)  over all (j, s)
+//                  + log B(i, oₜ)
+// Each predecessor's list is already sorted, and a list whose head is not
+// among the K best heads cannot contribute (its head alone comes after K other
+// candidates). The heads are screened against the K-th best seen so far, then
+// a K-way merge over the surviving lists pops the K largest candidates, each
+// pop replacing the head by the next entry of its list: O(N + K log K) per
+// state and step. Scores are stored rank-major (row s holds every state's
+// s-th best, -inf past the end of a list), so the screen reads two contiguous
+// rows like the ordinary Viterbi max. A hypothesis stores one 4-byte
+// backpointer j·K + s; the score lists are kept for two steps only.
+//
+// Ties are broken toward the lower predecessor state, then the lower rank, so
+// with K = 1 the result is exactly that of viterbi_algorithm_log. Paths with
+// probability 0 are never returned.
+
+/**
+ * Head of one predecessor list during the merge
+ */
+typedef struct {
+    double value;  // log δₜ₋₁(state, rank) + log A(state, i)
+    int state;     // Predecessor state j
+    int rank;      // Position s in its list
+} NBestCandidate;
+
+/**
+ * Reusable buffers for viterbi_nbest
+ * Backpointers for max_T x N x K hypotheses (grown 1.5x as needed) plus two
+ * steps of N x K scores and the merge heap in one aligned block, so repeated
+ * decodes do not touch the heap once the workspace is large enough.
+ */
+typedef struct {
+    int max_T;                 // Capacity of back in time steps
+    int N;                     // Number of states the scratch is sized for
+    int K;                     // Hypotheses per state the scratch is sized for
+    int stride;                // Row stride of score and next_score (N padded)
+    unsigned int* back;        // Backpointer j·K + s of every hypothesis (max_T x N x K)
+    double* score;             // log δ of the previous step (K rows x stride, row s = rank s)
+    double* next_score;        // log δ of the current step (K rows x stride)
+    double* merged;            // Values of one merge, best first (K)
+    unsigned int* chosen;      // Final hypotheses j·K + s of the K best paths (K)
+    NBestCandidate* heap;      // Merge heap (min(N, K))
+    void* scratch;             // Single aligned allocation backing the arrays above
+} NBestWorkspace;
+
+/**
+ * Create a workspace for viterbi_nbest
+ * @param max_T Initial capacity in time steps
+ * @param N Number of states
+ * @param K Number of paths
+ * @return Workspace or NULL on failure
+ */
+NBestWorkspace* nbest_workspace_create(int max_T, int N, int K);
+
+/**
+ * Free an N-best workspace
+ * @param workspace Workspace
+ */
+void nbest_workspace_free(NBestWorkspace* workspace);
+
+/**
+ * K most likely state sequences in the log domain
+ * @param hmm Model (prepared here if needed)
+ * @param observations Observed symbols (length T)
+ * @param T Sequence length
+ * @param K Number of paths wanted (N·K must fit in an int)
+ * @param workspace Buffers (grown if needed)
+ * @param paths Receives the paths, best first: path k is paths[k·T .. k·T + T-1]
+ * @param log_probabilities Receives log P of each path (K, may be NULL)
+ * @param num_paths Receives the number of paths found: K, or fewer if fewer
+ *        sequences have nonzero probability
+ * @return 0 on success, -1 on invalid input or allocation failure
+ */
+int viterbi_nbest(HMM* hmm, const int* observations, int T, int K, NBestWorkspace* workspace,
+                  int* paths, double* log_probabilities, int* num_paths);
+
+#endif // HMM_NBEST_H
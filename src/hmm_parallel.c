@@ -0,0 +1,306 @@
+#include <pthread.h>
+#include "hmm_parallel.h"
+#include "hmm_kernels.h"
+#include "hmm_batch.h"
+
+// Shortest chunk worth a thread of its own; shorter sequences use fewer chunks
+#ifndef VITERBI_PARALLEL_MIN_CHUNK
+#define VITERBI_PARALLEL_MIN_CHUNK 4096
+#endif
+
+// Relative error allowed between the per-state offsets of a converged checkpoint
+#define OFFSET_TOLERANCE 1e-13
+
+// Checkpoints r = 2ᵏ - 1 of a chunk of at most INT_MAX steps
+#define MAX_CHECKPOINTS 32
+
+// =============================================================================
+// INTERNAL STRUCTURES
+// =============================================================================
+
+typedef struct {
+    const HMM* hmm;
+    const int* observations;
+    HmmMaxKernel max_sum;
+    unsigned char* psi;     // Backpointers (T x N entries of psi_bytes each)
+    int psi_bytes;          // 1, 2 or 4
+} ParallelContext;
+
+typedef struct {
+    ParallelContext* context;
+    int start;              // First time step of the chunk
+    int end;                // One past its last time step
+    double* delta;          // Two δ rows (2 x stride)
+    double* checkpoint;     // Speculative δ after r = 0, 1, 3, 7, ... steps (MAX_CHECKPOINTS x stride)
+    double* final;          // δ at time end - 1 (one of the delta rows)
+} ParallelChunk;
+
+// =============================================================================
+// RECURSION
+// =============================================================================
+
+static unsigned char* psi_row(const ParallelContext* context, int t) {
+    return context->psi + (size_t)t * context->hmm->num_states * context->psi_bytes;
+}
+
+static void store_psi(unsigned char* row, int i, int state, int bytes) {
+    switch (bytes) {
+        case 1: ((unsigned char*)row)[i] = (unsigned char)state; break;
+        case 2: ((unsigned short*)row)[i] = (unsigned short)state; break;
+        default: ((int*)row)[i] = state; break;
+    }
+}
+
+static int load_psi(const unsigned char* row, int i, int bytes) {
+    switch (bytes) {
+        case 1: return ((const unsigned char*)row)[i];
+        case 2: return ((const unsigned short*)row)[i];
+        default: return ((const int*)row)[i];
+    }
+}
+
+// One step of the log recursion into next and ψₜ, exactly as viterbi_run_log
+static void advance(const ParallelContext* context, const double* prev, double* next, int t) {
+    const HMM* hmm = context->hmm;
+    const double* log_emission = HMM_LOG_B_COLUMN(hmm, context->observations[t]);
+    unsigned char* psi = psi_row(context, t);
+    
+    for (int i = 0; i < hmm->num_states; i++) {
+        int best_prev_state;
+        double max_score = context->max_sum(prev, HMM_LOG_A_COLUMN(hmm, i), hmm->num_states, &best_prev_state);
+        next[i] = max_score + log_emission[i];
+        store_psi(psi, i, best_prev_state, context->psi_bytes);
+    }
+}
+
+// r steps into a chunk is a checkpoint when r + 1 is a power of two
+static int is_checkpoint(int r) {
+    return ((r + 1) & r) == 0;
+}
+
+// True δ = speculative δ + offset: same reachable states and, for those, the
+// same difference up to rounding. At least one state must be reachable.
+static int same_up_to_offset(const double* truth, const double* speculative, int N, double* offset) {
+    int found = 0;
+    
+    for (int i = 0; i < N; i++) {
+        if (truth[i] == -INFINITY || speculative[i] == -INFINITY) {
+            if (truth[i] != speculative[i]) return 0;
+            continue;
+        }
+        double difference = truth[i] - speculative[i];
+        if (!found) {
+            *offset = difference;
+            found = 1;
+        } else if (fabs(difference - *offset) > OFFSET_TOLERANCE * (1.0 + fabs(truth[i]))) {
+            return 0;
+        }
+    }
+    return found;
+}
+
+// Pass 1: chunk 0 from π, the others from log δ = 0 at time start - 1
+static void* chunk_worker(void* arg) {
+    ParallelChunk* chunk = (ParallelChunk*)arg;
+    const ParallelContext* context = chunk->context;
+    const HMM* hmm = context->hmm;
+    int N = hmm->num_states;
+    int stride = hmm->transition_stride;
+    double* prev = chunk->delta;
+    double* next = chunk->delta + stride;
+    int t = chunk->start;
+    int stored = 0;
+    
+    if (t == 0) {
+        const double* log_emission = HMM_LOG_B_COLUMN(hmm, context->observations[0]);
+        unsigned char* psi = psi_row(context, 0);
+        for (int i = 0; i < N; i++) {
+            prev[i] = hmm->log_initial[i] + log_emission[i];
+            store_psi(psi, i, 0, context->psi_bytes);
+        }
+        t = 1;
+    } else {
+        memset(prev, 0, (size_t)N * sizeof(double));
+    }
+    
+    for (; t < chunk->end; t++) {
+        advance(context, prev, next, t);
+        if (chunk->start > 0 && is_checkpoint(t - chunk->start)) {
+            memcpy(chunk->checkpoint + (size_t)stored * stride, next, (size_t)N * sizeof(double));
+            stored++;
+        }
+        double* swap = prev;
+        prev = next;
+        next = swap;
+    }
+    
+    chunk->final = prev;
+    return NULL;
+}
+
+// Pass 2: re-run a chunk from its true incoming δ until a checkpoint matches.
+// Returns the number of steps recomputed; *converged tells whether one matched.
+static long long fix_chunk(ParallelChunk* chunk, const double* incoming, double* scratch, int* converged) {
+    const ParallelContext* context = chunk->context;
+    int N = context->hmm->num_states;
+    int stride = context->hmm->transition_stride;
+    double* prev = scratch;
+    double* next = scratch + stride;
+    int stored = 0;
+    
+    memcpy(prev, incoming, (size_t)N * sizeof(double));
+    
+    for (int t = chunk->start; t < chunk->end; t++) {
+        int r = t - chunk->start;
+        advance(context, prev, next, t);
+        
+        if (is_checkpoint(r)) {
+            double offset = 0.0;
+            const double* speculative = chunk->checkpoint + (size_t)stored * stride;
+            stored++;
+            if (same_up_to_offset(next, speculative, N, &offset)) {
+                for (int i = 0; i < N; i++) {
+                    chunk->final[i] += offset;
+                }
+                *converged = 1;
+                return r + 1;
+            }
+        }
+        
+        double* swap = prev;
+        prev = next;
+        next = swap;
+    }
+    
+    memcpy(chunk->final, prev, (size_t)N * sizeof(double));
+    *converged = 0;
+    return chunk->end - chunk->start;
+}
+
+static int checkpoint_count(int length) {
+    int count = 0;
+    while (count < MAX_CHECKPOINTS && ((1LL << count) - 1) < length) {
+        count++;
+    }
+    return count;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+int viterbi_parallel(HMM* hmm, const int* observations, int T, int num_threads,
+                     int* path, double* log_probability, ParallelViterbiStats* stats) {
+    if (hmm == NULL || observations == NULL || path == NULL || T < 1) {
+        fprintf(stderr, "Error: Invalid arguments passed to viterbi_parallel\n");
+        return -1;
+    }
+    if (!validate_observations((int*)observations, T, hmm->num_observations)) {
+        fprintf(stderr, "Error: Invalid observation sequence\n");
+        return -1;
+    }
+    
+    // Workers only read the model, so derive the log parameters up front
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    int N = hmm->num_states;
+    int stride = hmm->transition_stride;
+    int num_chunks = num_threads > 0 ? num_threads : hmm_online_cpus();
+    if (num_chunks > T / VITERBI_PARALLEL_MIN_CHUNK) num_chunks = T / VITERBI_PARALLEL_MIN_CHUNK;
+    if (num_chunks < 1) num_chunks = 1;
+    
+    ParallelContext context;
+    context.hmm = hmm;
+    context.observations = observations;
+    context.max_sum = hmm_kernels()->max_sum;
+    context.psi_bytes = N <= 256 ? 1 : (N <= 65536 ? 2 : 4);
+    
+    // Per chunk: two δ rows and its checkpoints; plus two scratch rows for pass 2
+    int checkpoints = checkpoint_count(T / num_chunks + 1);
+    size_t rows = (size_t)num_chunks * (2 + checkpoints) + 2;
+    size_t psi_size = (size_t)T * N * context.psi_bytes;
+    
+    context.psi = (unsigned char*)hmm_aligned_calloc(psi_size);
+    double* block = (double*)hmm_aligned_calloc(rows * stride * sizeof(double));
+    ParallelChunk* chunks = (ParallelChunk*)malloc((size_t)num_chunks * sizeof(ParallelChunk));
+    pthread_t* threads = (pthread_t*)malloc((size_t)num_chunks * sizeof(pthread_t));
+    int* started = (int*)calloc((size_t)num_chunks, sizeof(int));
+    if (context.psi == NULL || block == NULL || chunks == NULL || threads == NULL || started == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for parallel Viterbi (%zu bytes of backpointers)\n",
+                psi_size);
+        free(context.psi); free(block); free(chunks); free(threads); free(started);
+        return -1;
+    }
+    
+    double* row = block;
+    for (int p = 0; p < num_chunks; p++) {
+        chunks[p].context = &context;
+        chunks[p].start = (int)((long long)T * p / num_chunks);
+        chunks[p].end = (int)((long long)T * (p + 1) / num_chunks);
+        chunks[p].delta = row;
+        chunks[p].checkpoint = row + (size_t)2 * stride;
+        chunks[p].final = NULL;
+        row += (size_t)(2 + checkpoints) * stride;
+    }
+    double* scratch = row;
+    
+    // ==========================================================================
+    // PASS 1: every chunk in parallel (chunk 0 on the calling thread; a chunk
+    // whose thread cannot be started runs here after it)
+    // ==========================================================================
+    
+    for (int p = 1; p < num_chunks; p++) {
+        started[p] = pthread_create(&threads[p], NULL, chunk_worker, &chunks[p]) == 0;
+    }
+    chunk_worker(&chunks[0]);
+    for (int p = 1; p < num_chunks; p++) {
+        if (started[p]) {
+            pthread_join(threads[p], NULL);
+        } else {
+            chunk_worker(&chunks[p]);
+        }
+    }
+    
+    // ==========================================================================
+    // PASS 2: carry the true δ across chunk boundaries
+    // ==========================================================================
+    
+    long long fixup_steps = 0;
+    int unconverged = 0;
+    for (int p = 1; p < num_chunks; p++) {
+        int converged;
+        fixup_steps += fix_chunk(&chunks[p], chunks[p - 1].final, scratch, &converged);
+        if (!converged) unconverged++;
+    }
+    
+    // ==========================================================================
+    // TERMINATION AND BACKTRACKING
+    // ==========================================================================
+    
+    const double* last = chunks[num_chunks - 1].final;
+    double max_final_score = -INFINITY;
+    int best_final_state = 0;
+    for (int i = 0; i < N; i++) {
+        if (last[i] > max_final_score) {
+            max_final_score = last[i];
+            best_final_state = i;
+        }
+    }
+    
+    path[T - 1] = best_final_state;
+    for (int t = T - 2; t >= 0; t--) {
+        path[t] = load_psi(psi_row(&context, t + 1), path[t + 1], context.psi_bytes);
+    }
+    
+    if (log_probability != NULL) *log_probability = max_final_score;
+    if (stats != NULL) {
+        stats->chunks = num_chunks;
+        stats->unconverged_chunks = unconverged;
+        stats->fixup_steps = fixup_steps;
+    }
+    
+    free(context.psi); free(block); free(chunks); free(threads); free(started);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#ifndef HMM_PARALLEL_H
+#define HMM_PARALLEL_H
+
+#include "hmm.h"
+
+// =============================================================================
+// PARALLEL-IN-TIME VITERBI
+// =============================================================================
+//
+// Decodes one very long sequence on several threads. The sequence is cut into
+// P contiguous chunks and decoding runs in two passes:
+//   1. Every chunk runs the log recursion at the same time. Chunk 0 starts from
+//      π; the others do not know their incoming δ yet and start from log δ = 0
+//      for every state. They keep their backpointers, their final δ and a copy
+//      of δ at the checkpoints r = 0, 1, 3, 7, ... (2ᵏ - 1 steps in).
+//   2. Chunk by chunk, the recursion is re-run from the true incoming δ. Once
+//      the true δ equals the speculative δ of a checkpoint plus a constant (the
+//      same states reachable, every difference the same), every later max and
+//      argmax of the chunk is unchanged, so the speculative backpointers are
+//      kept and the true final δ is the speculative one plus that constant.
+//      Otherwise the recursion continues to the end of the chunk.
+// Survivor paths of an ergodic model merge within a few dozen steps, so the
+// second pass costs a small fraction of the first and the work is spread over
+// all threads. A full max-plus scan of N x N transfer matrices would also be
+// exact but costs O(N³) per step instead of O(N²).
+//
+// Backpointers are stored in 1, 2 or 4 bytes depending on N (T x N), without
+// keeping δ per step.
+
+/**
+ * What a parallel decode did
+ */
+typedef struct {
+    int chunks;                 // P: chunks decoded in parallel (≤ threads)
+    int unconverged_chunks;     // Chunks whose second pass ran to their end
+    long long fixup_steps;      // Steps recomputed in the second pass
+} ParallelViterbiStats;
+
+/**
+ * Log-domain Viterbi split over time
+ *
+ * Returns the path and log P* of viterbi_algorithm_log (same lowest-index
+ * tie-breaking) up to rounding: a checkpoint is accepted when the differences
+ * agree to within floating-point error, and later chunks add their scores at
+ * a smaller magnitude than the sequential decoder does. Paths can therefore
+ * differ only where two paths score the same to within the rounding of log δ,
+ * which grows with t (about 1e-9 at t = 10⁷). Short sequences use fewer
+ * chunks; with a single chunk the result is bitwise identical to the
+ * sequential decoder.
+ *
+ * @param hmm Model (prepared here if needed; only read while threads run)
+ * @param observations Observed symbols (length T)
+ * @param T Sequence length
+ * @param num_threads Worker threads (0 = one per online CPU)
+ * @param path Receives the T most likely states
+ * @param log_probability Receives log P* (may be NULL)
+ * @param stats Receives decode statistics (may be NULL)
+ * @return 0 on success, -1 on invalid input or allocation failure
+ */
+int viterbi_parallel(HMM* hmm, const int* observations, int T, int num_threads,
+                     int* path, double* log_probability, ParallelViterbiStats* stats);
+
+#endif // HMM_PARALLEL_H
@@ -0,0 +1,298 @@
+#include "hmm_posterior.h"
+#include "hmm_kernels.h"
+
+// =============================================================================
+// MEMORY MANAGEMENT FUNCTIONS
+// =============================================================================
+
+PosteriorResult* allocate_posterior_result(int T, int N) {
+    if (T <= 0 || N <= 0) {
+        fprintf(stderr, "Error: Invalid posterior result dimensions (T=%d, N=%d)\n", T, N);
+        return NULL;
+    }
+    
+    int stride = hmm_padded_stride(N, sizeof(double));
+    
+    // Layout of the single block: [PosteriorResult | α̂ | β̂ | γ (TxN each) | c (T) | path (T)]
+    size_t header = (sizeof(PosteriorResult) + HMM_ALIGNMENT - 1) / HMM_ALIGNMENT * HMM_ALIGNMENT;
+    size_t matrix_bytes = sizeof(double) * (size_t)T * stride;
+    size_t scale_bytes = sizeof(double) * (size_t)hmm_padded_stride(T, sizeof(double));
+    size_t total = header + 3 * matrix_bytes + scale_bytes + sizeof(int) * (size_t)T;
+    
+    char* block = (char*)hmm_aligned_calloc(total);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for PosteriorResult (%zu bytes)\n", total);
+        return NULL;
+    }
+    
+    PosteriorResult* result = (PosteriorResult*)block;
+    result->T = T;
+    result->N = N;
+    result->stride = stride;
+    result->alpha = (double*)(block + header);
+    result->beta = (double*)(block + header + matrix_bytes);
+    result->gamma = (double*)(block + header + 2 * matrix_bytes);
+    result->scale = (double*)(block + header + 3 * matrix_bytes);
+    result->path = (int*)(block + header + 3 * matrix_bytes + scale_bytes);
+    result->log_likelihood = -INFINITY;
+    result->has_posteriors = 0;
+    
+    return result;
+}
+
+void free_posterior_result(PosteriorResult* result) {
+    // Structure, matrices and path share one allocation
+    free(result);
+}
+
+PosteriorWorkspace* posterior_workspace_create(int max_T, int N) {
+    PosteriorWorkspace* workspace = (PosteriorWorkspace*)malloc(sizeof(PosteriorWorkspace));
+    if (workspace == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for PosteriorWorkspace\n");
+        return NULL;
+    }
+    
+    workspace->result = allocate_posterior_result(max_T, N);
+    workspace->scratch = (double*)hmm_aligned_calloc(sizeof(double) * hmm_padded_stride(N, sizeof(double)));
+    if (workspace->result == NULL || workspace->scratch == NULL) {
+        free_posterior_result(workspace->result);
+        free(workspace->scratch);
+        free(workspace);
+        return NULL;
+    }
+    workspace->max_T = max_T;
+    workspace->N = N;
+    workspace->result->T = 0;
+    
+    return workspace;
+}
+
+int posterior_workspace_reserve(PosteriorWorkspace* workspace, int T, int N) {
+    if (workspace == NULL) {
+        fprintf(stderr, "Error: NULL workspace passed to posterior_workspace_reserve\n");
+        return 0;
+    }
+    
+    if (T <= workspace->max_T && N == workspace->N) {
+        return 1; // Steady state: buffers already large enough
+    }
+    
+    // Grow geometrically so a slowly increasing T does not reallocate every call
+    int new_T = T;
+    if (N == workspace->N && T < workspace->max_T + workspace->max_T / 2) {
+        new_T = workspace->max_T + workspace->max_T / 2;
+    }
+    
+    PosteriorResult* grown = allocate_posterior_result(new_T, N);
+    if (grown == NULL) {
+        return 0; // Old buffers stay valid
+    }
+    
+    if (N != workspace->N) {
+        double* scratch = (double*)hmm_aligned_calloc(sizeof(double) * hmm_padded_stride(N, sizeof(double)));
+        if (scratch == NULL) {
+            free_posterior_result(grown);
+            return 0;
+        }
+        free(workspace->scratch);
+        workspace->scratch = scratch;
+    }
+    
+    free_posterior_result(workspace->result);
+    workspace->result = grown;
+    workspace->max_T = new_T;
+    workspace->N = N;
+    workspace->result->T = 0;
+    
+    return 1;
+}
+
+void posterior_workspace_free(PosteriorWorkspace* workspace) {
+    if (workspace == NULL) return;
+    
+    free_posterior_result(workspace->result);
+    free(workspace->scratch);
+    free(workspace);
+}
+
+// =============================================================================
+// CORE ALGORITHM FUNCTIONS
+// =============================================================================
+
+// Shared argument checks; prepares the model and sizes the workspace
+static int posterior_setup(HMM* hmm, const int* observations, int T,
+                           PosteriorWorkspace* workspace, const char* caller) {
+    if (hmm == NULL || observations == NULL || workspace == NULL || T <= 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to %s\n", caller);
+        return 0;
+    }
+    
+    for (int t = 0; t < T; t++) {
+        if (observations[t] < 0 || observations[t] >= hmm->num_observations) {
+            fprintf(stderr, "Error: Invalid observation %d at position %d\n", observations[t], t);
+            return 0;
+        }
+    }
+    
+    // Aᵀ is a derived layout; hand-built models get it here
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    return posterior_workspace_reserve(workspace, T, hmm->num_states);
+}
+
+// Scaled forward recursion; returns log P(O | λ) or -INFINITY if some cₜ = 0
+static double forward_pass(const HMM* hmm, const int* observations, int T, PosteriorResult* result) {
+    int N = hmm->num_states;
+    HmmDotKernel dot = hmm_kernels()->dot;
+    double log_likelihood = 0.0;
+    
+    result->T = T;
+    result->has_posteriors = 0;
+    
+    for (int t = 0; t < T; t++) {
+        double* alpha = POSTERIOR_ALPHA_ROW(result, t);
+        double scale = 0.0;
+        
+        if (t == 0) {
+            // α₁(i) = π(i) × B(i,o₁)
+            const double* emission = HMM_B_COLUMN(hmm, observations[0]);
+            for (int i = 0; i < N; i++) {
+                alpha[i] = hmm->initial[i] * emission[i];
+                scale += alpha[i];
+            }
+        } else {
+            // αₜ(i) = [Σⱼ α̂ₜ₋₁(j) × A(j,i)] × B(i,oₜ); column A(·,i) is contiguous in Aᵀ
+            const double* prev = POSTERIOR_ALPHA_ROW(result, t-1);
+            const double* emission = HMM_B_COLUMN(hmm, observations[t]);
+            for (int i = 0; i < N; i++) {
+                alpha[i] = dot(prev, HMM_A_COLUMN(hmm, i), N) * emission[i];
+                scale += alpha[i];
+            }
+        }
+        
+        result->scale[t] = scale;
+        if (scale <= 0.0) {
+            // Observation impossible under the model: P(O | λ) = 0
+            result->log_likelihood = -INFINITY;
+            return -INFINITY;
+        }
+        
+        // α̂ₜ(i) = αₜ(i) / cₜ
+        double inverse = 1.0 / scale;
+        for (int i = 0; i < N; i++) {
+            alpha[i] *= inverse;
+        }
+        log_likelihood += log(scale);
+    }
+    
+    result->log_likelihood = log_likelihood;
+    return log_likelihood;
+}
+
+int hmm_forward(HMM* hmm, const int* observations, int T, PosteriorWorkspace* workspace,
+                double* log_likelihood) {
+    if (!posterior_setup(hmm, observations, T, workspace, "hmm_forward")) {
+        return -1;
+    }
+    
+    double value = forward_pass(hmm, observations, T, workspace->result);
+    if (log_likelihood != NULL) {
+        *log_likelihood = value;
+    }
+    return 0;
+}
+
+const PosteriorResult* hmm_forward_backward(HMM* hmm, const int* observations, int T,
+                                            PosteriorWorkspace* workspace) {
+    if (!posterior_setup(hmm, observations, T, workspace, "hmm_forward_backward")) {
+        return NULL;
+    }
+    
+    PosteriorResult* result = workspace->result;
+    int N = hmm->num_states;
+    HmmDotKernel dot = hmm_kernels()->dot;
+    
+    // ==========================================================================
+    // FORWARD PASS
+    // ==========================================================================
+    
+    if (forward_pass(hmm, observations, T, result) == -INFINITY) {
+        fprintf(stderr, "Error: Observation sequence has zero probability under the model\n");
+        return NULL;
+    }
+    
+    // ==========================================================================
+    // BACKWARD PASS
+    // β̂ₜ(i) = 1
+    // β̂ₜ(i) = [Σⱼ A(i,j) × B(j,oₜ₊₁) × β̂ₜ₊₁(j)] / cₜ₊₁
+    // ==========================================================================
+    
+    double* beta_last = POSTERIOR_BETA_ROW(result, T-1);
+    for (int i = 0; i < N; i++) {
+        beta_last[i] = 1.0;
+    }
+    
+    double* weighted = workspace->scratch;
+    for (int t = T-2; t >= 0; t--) {
+        const double* next = POSTERIOR_BETA_ROW(result, t+1);
+        double* beta = POSTERIOR_BETA_ROW(result, t);
+        double inverse = 1.0 / result->scale[t+1];
+        
+        // B(j,oₜ₊₁) × β̂ₜ₊₁(j) once per step, then one dot product per state
+        // against row A(i,·), which is contiguous in the row-major A
+        const double* emission = HMM_B_COLUMN(hmm, observations[t+1]);
+        for (int j = 0; j < N; j++) {
+            weighted[j] = emission[j] * next[j];
+        }
+        for (int i = 0; i < N; i++) {
+            beta[i] = dot(&HMM_A(hmm, i, 0), weighted, N) * inverse;
+        }
+    }
+    
+    // ==========================================================================
+    // POSTERIORS AND POSTERIOR DECODING
+    // γₜ(i) = α̂ₜ(i) × β̂ₜ(i)
+    // q̂ₜ = argmax_i γₜ(i)
+    // ==========================================================================
+    
+    for (int t = 0; t < T; t++) {
+        const double* alpha = POSTERIOR_ALPHA_ROW(result, t);
+        const double* beta = POSTERIOR_BETA_ROW(result, t);
+        double* gamma = POSTERIOR_GAMMA_ROW(result, t);
+        int best = 0;
+        
+        for (int i = 0; i < N; i++) {
+            gamma[i] = alpha[i] * beta[i];
+            if (gamma[i] > gamma[best]) best = i;
+        }
+        result->path[t] = best;
+    }
+    
+    result->has_posteriors = 1;
+    return result;
+}
+
+// =============================================================================
+// OUTPUT FUNCTIONS
+// =============================================================================
+
+void print_posterior_results(const PosteriorResult* result) {
+    if (result == NULL || !result->has_posteriors) {
+        printf("Error: No posteriors in print_posterior_results\n");
+        return;
+    }
+    
+    printf("POSTERIOR PROBABILITIES γₜ(i):\n");
+    print_matrices_formatted(result->gamma, result->T, result->N, result->stride, "γ (rows = time)");
+    
+    printf("Posterior-decoded sequence: [");
+    for (int t = 0; t < result->T; t++) {
+        printf("%d", result->path[t]);
+        if (t < result->T - 1) printf(", ");
+    }
+    printf("]\n");
+    
+    printf("Log-likelihood log P(O|λ): %.10f\n", result->log_likelihood);
+}
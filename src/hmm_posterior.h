@@ -0,0 +1,142 @@
+#ifndef HMM_POSTERIOR_H
+#define HMM_POSTERIOR_H
+
+#include "hmm.h"
+
+// =============================================================================
+// FORWARD-BACKWARD AND POSTERIOR DECODING
+// =============================================================================
+//
+// Sequence likelihood P(O | λ) and per-step state posteriors
+//     γₜ(i) = P(qₜ = i | O, λ)
+// with Rabiner's per-step scaling: every forward row is normalized to sum 1
+// and the normalizers cₜ are kept, so nothing underflows at large T and
+//     log P(O | λ) = Σₜ log cₜ
+// The backward rows are scaled with the same cₜ, which makes γₜ(i) simply
+// α̂ₜ(i) × β̂ₜ(i). Results use the same flat, padded, single-allocation layout
+// as ViterbiResult and are decoded into a reusable workspace.
+//
+// Posterior decoding returns q̂ₜ = argmax_i γₜ(i): the individually most likely
+// state at every step (maximizes the expected number of correct states; unlike
+// the Viterbi path it may contain transitions with A(i,j) = 0).
+
+/**
+ * Forward-backward result
+ * alpha, beta and gamma are flat row-major (row t = time step).
+ */
+typedef struct {
+    int T;                  // Sequence length the result holds
+    int N;                  // Number of states
+    int stride;             // Doubles between rows of α̂, β̂ and γ (≥ N, multiple of 8)
+    double *alpha;          // Scaled forward variables α̂ (TxN), each row sums to 1
+    double *beta;           // Scaled backward variables β̂ (TxN)
+    double *gamma;          // Posteriors γ (TxN), each row sums to 1
+    double *scale;          // Forward normalizers cₜ (T)
+    int *path;              // Posterior-decoded states argmax_i γₜ(i) (T)
+    double log_likelihood;  // log P(O | λ)
+    int has_posteriors;     // 1 if beta, gamma and path are filled (0 after a forward-only pass)
+} PosteriorResult;
+
+#define POSTERIOR_ALPHA_ROW(result, t) ((result)->alpha + (size_t)(t) * (result)->stride)
+#define POSTERIOR_BETA_ROW(result, t)  ((result)->beta + (size_t)(t) * (result)->stride)
+#define POSTERIOR_GAMMA_ROW(result, t) ((result)->gamma + (size_t)(t) * (result)->stride)
+#define POSTERIOR_GAMMA(result, t, i)  (POSTERIOR_GAMMA_ROW(result, t)[i])
+
+/**
+ * Reusable forward-backward buffers (same growth policy as ViterbiWorkspace)
+ */
+typedef struct {
+    int max_T;                // Capacity in time steps
+    int N;                    // Number of states the buffers are sized for
+    double* scratch;          // One aligned row for the backward recursion
+    PosteriorResult* result;  // Buffers reused by every call
+} PosteriorWorkspace;
+
+// =============================================================================
+// MEMORY MANAGEMENT FUNCTIONS
+// =============================================================================
+
+/**
+ * Allocate a forward-backward result
+ * The structure, α̂, β̂, γ, c and the path share one aligned allocation.
+ * @param T Length of observation sequence
+ * @param N Number of states
+ * @return Pointer to allocated PosteriorResult or NULL on failure
+ */
+PosteriorResult* allocate_posterior_result(int T, int N);
+
+/**
+ * Free a forward-backward result
+ * @param result Pointer to PosteriorResult to free
+ */
+void free_posterior_result(PosteriorResult* result);
+
+/**
+ * Create a reusable forward-backward workspace
+ * @param max_T Initial capacity in time steps
+ * @param N Number of states
+ * @return Pointer to workspace or NULL on failure
+ */
+PosteriorWorkspace* posterior_workspace_create(int max_T, int N);
+
+/**
+ * Make sure the workspace can hold T steps over N states
+ * @param workspace Pointer to workspace
+ * @param T Required sequence length
+ * @param N Required number of states
+ * @return 1 on success, 0 on allocation failure (old buffers stay valid)
+ */
+int posterior_workspace_reserve(PosteriorWorkspace* workspace, int T, int N);
+
+/**
+ * Free a workspace and its buffers
+ * @param workspace Pointer to workspace
+ */
+void posterior_workspace_free(PosteriorWorkspace* workspace);
+
+// =============================================================================
+// CORE ALGORITHM FUNCTIONS
+// =============================================================================
+
+/**
+ * Scaled forward pass only
+ *
+ * 1. Initialization: α₁(i) = π(i) × B(i,o₁)
+ * 2. Recursion: αₜ(i) = [Σⱼ α̂ₜ₋₁(j) × A(j,i)] × B(i,oₜ)
+ * 3. Scaling: cₜ = Σᵢ αₜ(i), α̂ₜ(i) = αₜ(i) / cₜ
+ *
+ * @param hmm Pointer to HMM structure containing model parameters
+ * @param observations Array of observed symbols (length T)
+ * @param T Length of the observation sequence
+ * @param workspace Workspace that receives α̂ and c (has_posteriors = 0)
+ * @param log_likelihood Receives log P(O | λ); -INFINITY if the sequence is impossible
+ * @return 0 on success, -1 on invalid input or allocation failure
+ */
+int hmm_forward(HMM* hmm, const int* observations, int T, PosteriorWorkspace* workspace,
+                double* log_likelihood);
+
+/**
+ * Forward-backward pass, posteriors and posterior decoding
+ *
+ * Forward as in hmm_forward, then
+ * 4. Backward: β̂ₜ(i) = [Σⱼ A(i,j) × B(j,oₜ₊₁) × β̂ₜ₊₁(j)] / cₜ₊₁, β̂ₜ(i) = 1
+ * 5. Posteriors: γₜ(i) = α̂ₜ(i) × β̂ₜ(i)
+ * 6. Decoding: q̂ₜ = argmax_i γₜ(i) (lowest i on ties)
+ *
+ * @param hmm Pointer to HMM structure containing model parameters
+ * @param observations Array of observed symbols (length T)
+ * @param T Length of the observation sequence
+ * @param workspace Workspace that receives the result
+ * @return Pointer to the workspace result (valid until the next call), or NULL
+ *         on invalid input, allocation failure or an impossible sequence
+ */
+const PosteriorResult* hmm_forward_backward(HMM* hmm, const int* observations, int T,
+                                            PosteriorWorkspace* workspace);
+
+/**
+ * Print the posterior table and the posterior-decoded path
+ * @param result Pointer to PosteriorResult with posteriors
+ */
+void print_posterior_results(const PosteriorResult* result);
+
+#endif // HMM_POSTERIOR_H
@@ -0,0 +1,186 @@
+#define _POSIX_C_SOURCE 200112L  // For clock_gettime()
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "hmm_profile.h"
+
+#if defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL  // Without thread-local storage all threads share one record
+#endif
+
+// =============================================================================
+// INTERNAL STRUCTURES
+// =============================================================================
+
+// One per thread that recorded; kept after the thread exits so its work still
+// counts in hmm_profile_total
+typedef struct ProfileRecord {
+    HmmProfile total;               // Everything this thread recorded
+    HmmProfile at_begin;            // total when the current call began
+    HmmProfile last;                // Last completed call
+    struct ProfileRecord* next;
+} ProfileRecord;
+
+static pthread_mutex_t records_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProfileRecord* records = NULL;
+static THREAD_LOCAL ProfileRecord* thread_record = NULL;
+
+// The calling thread's record, created on first use (NULL if out of memory,
+// in which case the hooks record nothing)
+static ProfileRecord* own_record(void) {
+    if (thread_record == NULL) {
+        ProfileRecord* record = (ProfileRecord*)calloc(1, sizeof(ProfileRecord));
+        if (record == NULL) return NULL;
+        pthread_mutex_lock(&records_lock);
+        record->next = records;
+        records = record;
+        pthread_mutex_unlock(&records_lock);
+        thread_record = record;
+    }
+    return thread_record;
+}
+
+static void profile_add(HmmProfile* sum, const HmmProfile* profile) {
+    sum->calls += profile->calls;
+    for (int p = 0; p < HMM_PHASE_COUNT; p++) sum->seconds[p] += profile->seconds[p];
+    for (int c = 0; c < HMM_COUNTER_COUNT; c++) sum->counters[c] += profile->counters[c];
+}
+
+// =============================================================================
+// HOOKS
+// =============================================================================
+
+double hmm_profile_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+double hmm_profile_begin_call(void) {
+    ProfileRecord* record = own_record();
+    if (record != NULL) {
+        record->at_begin = record->total;
+    }
+    return hmm_profile_now();
+}
+
+void hmm_profile_end_call(void) {
+    ProfileRecord* record = own_record();
+    if (record == NULL) return;
+    
+    record->total.calls++;
+    record->last.calls = 1;
+    for (int p = 0; p < HMM_PHASE_COUNT; p++) {
+        record->last.seconds[p] = record->total.seconds[p] - record->at_begin.seconds[p];
+    }
+    for (int c = 0; c < HMM_COUNTER_COUNT; c++) {
+        record->last.counters[c] = record->total.counters[c] - record->at_begin.counters[c];
+    }
+}
+
+double hmm_profile_phase(HmmPhase phase, double mark) {
+    double now = hmm_profile_now();
+    ProfileRecord* record = own_record();
+    if (record != NULL && phase >= 0 && phase < HMM_PHASE_COUNT) {
+        record->total.seconds[phase] += now - mark;
+    }
+    return now;
+}
+
+void hmm_profile_add(HmmCounter counter, unsigned long long value) {
+    ProfileRecord* record = own_record();
+    if (record != NULL && counter >= 0 && counter < HMM_COUNTER_COUNT) {
+        record->total.counters[counter] += value;
+    }
+}
+
+// =============================================================================
+// READING
+// =============================================================================
+
+int hmm_profile_enabled(void) {
+#ifdef HMM_INSTRUMENTATION
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void hmm_profile_thread(HmmProfile* profile) {
+    if (profile == NULL) return;
+    
+    memset(profile, 0, sizeof(HmmProfile));
+    if (thread_record != NULL) {
+        *profile = thread_record->total;
+    }
+}
+
+void hmm_profile_last_call(HmmProfile* profile) {
+    if (profile == NULL) return;
+    
+    memset(profile, 0, sizeof(HmmProfile));
+    if (thread_record != NULL) {
+        *profile = thread_record->last;
+    }
+}
+
+void hmm_profile_total(HmmProfile* profile) {
+    if (profile == NULL) return;
+    
+    memset(profile, 0, sizeof(HmmProfile));
+    pthread_mutex_lock(&records_lock);
+    for (const ProfileRecord* record = records; record != NULL; record = record->next) {
+        profile_add(profile, &record->total);
+    }
+    pthread_mutex_unlock(&records_lock);
+}
+
+void hmm_profile_reset(void) {
+    pthread_mutex_lock(&records_lock);
+    for (ProfileRecord* record = records; record != NULL; record = record->next) {
+        memset(&record->total, 0, sizeof(HmmProfile));
+        memset(&record->at_begin, 0, sizeof(HmmProfile));
+        memset(&record->last, 0, sizeof(HmmProfile));
+    }
+    pthread_mutex_unlock(&records_lock);
+}
+
+const char* hmm_profile_phase_name(HmmPhase phase) {
+    static const char* const names[HMM_PHASE_COUNT] = {
+        "load", "setup", "initialization", "recursion", "termination", "backtracking"
+    };
+    return phase >= 0 && phase < HMM_PHASE_COUNT ? names[phase] : "unknown";
+}
+
+const char* hmm_profile_counter_name(HmmCounter counter) {
+    static const char* const names[HMM_COUNTER_COUNT] = {
+        "cells", "transitions", "bytes", "allocations", "pruned_states"
+    };
+    return counter >= 0 && counter < HMM_COUNTER_COUNT ? names[counter] : "unknown";
+}
+
+int hmm_profile_write_json(FILE* out, const HmmProfile* profile) {
+    if (out == NULL || profile == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to hmm_profile_write_json\n");
+        return -1;
+    }
+    
+    double total_seconds = 0.0;
+    fprintf(out, "{\"enabled\": %s, \"calls\": %llu, \"seconds\": {",
+            hmm_profile_enabled() ? "true" : "false", profile->calls);
+    for (int p = 0; p < HMM_PHASE_COUNT; p++) {
+        fprintf(out, "%s\"%s\": %.9g", p > 0 ? ", " : "", hmm_profile_phase_name((HmmPhase)p),
+                profile->seconds[p]);
+        total_seconds += profile->seconds[p];
+    }
+    fprintf(out, ", \"total\": %.9g}, \"counters\": {", total_seconds);
+    for (int c = 0; c < HMM_COUNTER_COUNT; c++) {
+        fprintf(out, "%s\"%s\": %llu", c > 0 ? ", " : "", hmm_profile_counter_name((HmmCounter)c),
+                profile->counters[c]);
+    }
+    fprintf(out, "}}\n");
+    return ferror(out) ? -1 : 0;
+}
@@ -0,0 +1,139 @@
+#ifndef HMM_PROFILE_H
+#define HMM_PROFILE_H
+
+#include <stdio.h>
+
+// =============================================================================
+// PER-PHASE INSTRUMENTATION
+// =============================================================================
+//
+// Opt-in timers and counters for model loading and Viterbi decoding. Build
+// the whole library with -DHMM_INSTRUMENTATION to enable them; otherwise the
+// HMM_PROFILE_* hooks below expand to nothing and cost nothing. The read
+// functions exist in both builds (hmm_profile_enabled tells which one is
+// running) and report zeros when instrumentation is compiled out.
+//
+// Every thread accumulates into its own record, so hooks never contend and
+// never lock. A call (one decode or one model load) is bracketed by
+// HMM_PROFILE_BEGIN_CALL / HMM_PROFILE_END_CALL, which keeps its own
+// counters as the thread's "last call" in addition to the running totals.
+// Timers read CLOCK_MONOTONIC once per phase boundary, never per step.
+
+/**
+ * Phases timed by the hooks
+ */
+typedef enum {
+    HMM_PHASE_LOAD = 0,          // Parsing or mapping a model file
+    HMM_PHASE_SETUP,             // Validation, preparation and buffers before decoding
+    HMM_PHASE_INITIALIZATION,    // δ₁
+    HMM_PHASE_RECURSION,         // δₜ and ψₜ for t = 2..T
+    HMM_PHASE_TERMINATION,       // max over δ_T
+    HMM_PHASE_BACKTRACKING,      // Path from ψ
+    HMM_PHASE_COUNT
+} HmmPhase;
+
+/**
+ * Quantities counted by the hooks
+ */
+typedef enum {
+    HMM_COUNTER_CELLS = 0,       // δ entries computed (N per step)
+    HMM_COUNTER_TRANSITIONS,     // δₜ₋₁(j) ⊗ A(j,i) terms evaluated
+    HMM_COUNTER_BYTES,           // Estimated bytes of parameters and trellis touched
+    HMM_COUNTER_ALLOCATIONS,     // hmm_aligned_calloc calls
+    HMM_COUNTER_PRUNED_STATES,   // States discarded by beam pruning
+    HMM_COUNTER_COUNT
+} HmmCounter;
+
+/**
+ * Accumulated timers and counters
+ */
+typedef struct {
+    unsigned long long calls;                          // Calls completed (HMM_PROFILE_END_CALL)
+    double seconds[HMM_PHASE_COUNT];                   // Wall time per phase
+    unsigned long long counters[HMM_COUNTER_COUNT];    // Indexed by HmmCounter
+} HmmProfile;
+
+// =============================================================================
+// HOOKS
+// =============================================================================
+
+#ifdef HMM_INSTRUMENTATION
+// Start a call; declares `mark` as the time the first phase starts
+#define HMM_PROFILE_BEGIN_CALL(mark) double mark = hmm_profile_begin_call()
+#define HMM_PROFILE_END_CALL() hmm_profile_end_call()
+// Declare `mark` as the current time
+#define HMM_PROFILE_MARK(mark) double mark = hmm_profile_now()
+// Charge the time since `mark` to phase and move `mark` to now
+#define HMM_PROFILE_PHASE(phase, mark) ((mark) = hmm_profile_phase((phase), (mark)))
+#define HMM_PROFILE_COUNT(counter, value) hmm_profile_add((counter), (unsigned long long)(value))
+#else
+#define HMM_PROFILE_BEGIN_CALL(mark)
+#define HMM_PROFILE_END_CALL() ((void)0)
+#define HMM_PROFILE_MARK(mark)
+#define HMM_PROFILE_PHASE(phase, mark) ((void)0)
+#define HMM_PROFILE_COUNT(counter, value) ((void)0)
+#endif
+
+// Targets of the hooks (call through the macros so disabled builds drop them)
+double hmm_profile_begin_call(void);
+void hmm_profile_end_call(void);
+double hmm_profile_now(void);
+double hmm_profile_phase(HmmPhase phase, double mark);
+void hmm_profile_add(HmmCounter counter, unsigned long long value);
+
+// =============================================================================
+// READING
+// =============================================================================
+
+/**
+ * Whether the library was built with HMM_INSTRUMENTATION
+ * @return 1 if the hooks record, 0 if they are compiled out
+ */
+int hmm_profile_enabled(void);
+
+/**
+ * Totals of the calling thread since it started (or the last reset)
+ * @param profile Receives the totals
+ */
+void hmm_profile_thread(HmmProfile* profile);
+
+/**
+ * Timers and counters of the calling thread's last completed call
+ * @param profile Receives them (calls = 1, or 0 if no call completed yet)
+ */
+void hmm_profile_last_call(HmmProfile* profile);
+
+/**
+ * Totals of every thread that ever recorded
+ * Threads still recording may be read mid-update; read after joining them.
+ * @param profile Receives the totals
+ */
+void hmm_profile_total(HmmProfile* profile);
+
+/**
+ * Zero the records of every thread
+ * Call while no instrumented call is running.
+ */
+void hmm_profile_reset(void);
+
+/**
+ * Write a profile as one JSON object
+ * @param out Output stream
+ * @param profile Profile to write
+ * @return 0 on success, -1 on write error
+ */
+int hmm_profile_write_json(FILE* out, const HmmProfile* profile);
+
+/**
+ * Name of a phase as used in the JSON output
+ * @return "load", "setup", "initialization", "recursion", "termination" or "backtracking"
+ */
+const char* hmm_profile_phase_name(HmmPhase phase);
+
+/**
+ * Name of a counter as used in the JSON output
+ * @return "cells", "transitions", "bytes", "allocations" or "pruned_states"
+ */
+const char* hmm_profile_counter_name(HmmCounter counter);
+
+#endif // HMM_PROFILE_H
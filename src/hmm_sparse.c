@@ -0,0 +1,501 @@
+#include "hmm_sparse.h"
+
+// =============================================================================
+// MEMORY MANAGEMENT FUNCTIONS
+// =============================================================================
+
+// One aligned block: [SparseHMM | column_start | predecessor | A | log A | B | log B | π | log π]
+static SparseHMM* allocate_sparse_hmm(int N, int M, int T, int nnz) {
+    if (N <= 0 || M <= 0 || T <= 0 || nnz < 0) {
+        fprintf(stderr, "Error: Invalid sparse HMM dimensions (N=%d, M=%d, T=%d, nnz=%d)\n", N, M, T, nnz);
+        return NULL;
+    }
+    
+    int emission_stride = hmm_padded_stride(M, sizeof(double));
+    size_t header = (sizeof(SparseHMM) + HMM_ALIGNMENT - 1) / HMM_ALIGNMENT * HMM_ALIGNMENT;
+    size_t starts_bytes = sizeof(int) * (size_t)hmm_padded_stride(N + 1, sizeof(int));
+    size_t index_bytes = sizeof(int) * (size_t)hmm_padded_stride(nnz > 0 ? nnz : 1, sizeof(int));
+    size_t value_bytes = sizeof(double) * (size_t)hmm_padded_stride(nnz > 0 ? nnz : 1, sizeof(double));
+    size_t emission_bytes = sizeof(double) * (size_t)N * emission_stride;
+    size_t vector_bytes = sizeof(double) * (size_t)hmm_padded_stride(N, sizeof(double));
+    size_t total = header + starts_bytes + index_bytes + 2 * value_bytes + 2 * emission_bytes + 2 * vector_bytes;
+    
+    char* block = (char*)hmm_aligned_calloc(total);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for sparse HMM (%zu bytes)\n", total);
+        return NULL;
+    }
+    
+    SparseHMM* hmm = (SparseHMM*)block;
+    char* data = block + header;
+    hmm->num_states = N;
+    hmm->num_observations = M;
+    hmm->sequence_length = T;
+    hmm->emission_stride = emission_stride;
+    hmm->nnz = nnz;
+    hmm->column_start = (int*)data;         data += starts_bytes;
+    hmm->predecessor = (int*)data;          data += index_bytes;
+    hmm->transition = (double*)data;        data += value_bytes;
+    hmm->log_transition = (double*)data;    data += value_bytes;
+    hmm->emission = (double*)data;          data += emission_bytes;
+    hmm->log_emission = (double*)data;      data += emission_bytes;
+    hmm->initial = (double*)data;           data += vector_bytes;
+    hmm->log_initial = (double*)data;
+    
+    return hmm;
+}
+
+void free_sparse_hmm(SparseHMM* hmm) {
+    // Structure and arrays share one allocation
+    free(hmm);
+}
+
+SparseHMM* sparse_hmm_from_triplets(int N, int M, int T, int nnz,
+                                    const int* from, const int* to, const double* probability) {
+    if (nnz > 0 && (from == NULL || to == NULL || probability == NULL)) {
+        fprintf(stderr, "Error: NULL pointer passed to sparse_hmm_from_triplets\n");
+        return NULL;
+    }
+    for (int k = 0; k < nnz; k++) {
+        if (from[k] < 0 || from[k] >= N || to[k] < 0 || to[k] >= N) {
+            fprintf(stderr, "Error: Transition %d (%d -> %d) is out of range\n", k, from[k], to[k]);
+            return NULL;
+        }
+    }
+    
+    SparseHMM* hmm = allocate_sparse_hmm(N, M, T, nnz);
+    int* row_start = (int*)calloc((size_t)N + 1, sizeof(int));
+    int* by_row = (int*)malloc((size_t)(nnz > 0 ? nnz : 1) * sizeof(int));
+    if (hmm == NULL || row_start == NULL || by_row == NULL) {
+        free_sparse_hmm(hmm);
+        free(row_start);
+        free(by_row);
+        return NULL;
+    }
+    
+    // Counting sort by source state, then scatter into the destination
+    // columns in that order: every column ends up sorted by predecessor
+    for (int k = 0; k < nnz; k++) {
+        row_start[from[k] + 1]++;
+        hmm->column_start[to[k] + 1]++;
+    }
+    for (int i = 0; i < N; i++) {
+        row_start[i + 1] += row_start[i];
+        hmm->column_start[i + 1] += hmm->column_start[i];
+    }
+    for (int k = 0; k < nnz; k++) {
+        by_row[row_start[from[k]]++] = k;
+    }
+    
+    // row_start now holds the row ends; reuse it as the column fill cursor
+    memcpy(row_start, hmm->column_start, (size_t)N * sizeof(int));
+    for (int r = 0; r < nnz; r++) {
+        int k = by_row[r];
+        int slot = row_start[to[k]]++;
+        hmm->predecessor[slot] = from[k];
+        hmm->transition[slot] = probability[k];
+    }
+    free(row_start);
+    free(by_row);
+    
+    for (int i = 0; i < N; i++) {
+        for (int k = hmm->column_start[i] + 1; k < hmm->column_start[i + 1]; k++) {
+            if (hmm->predecessor[k] == hmm->predecessor[k - 1]) {
+                fprintf(stderr, "Error: Duplicate transition %d -> %d\n", hmm->predecessor[k], i);
+                free_sparse_hmm(hmm);
+                return NULL;
+            }
+        }
+    }
+    
+    return hmm;
+}
+
+SparseHMM* sparse_hmm_from_dense(const HMM* hmm, double threshold) {
+    if (hmm == NULL) {
+        fprintf(stderr, "Error: NULL pointer passed to sparse_hmm_from_dense\n");
+        return NULL;
+    }
+    
+    int N = hmm->num_states;
+    int M = hmm->num_observations;
+    int nnz = 0;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            if (HMM_A(hmm, i, j) > threshold) nnz++;
+        }
+    }
+    
+    int* from = (int*)calloc((size_t)(nnz > 0 ? nnz : 1), sizeof(int));
+    int* to = (int*)calloc((size_t)(nnz > 0 ? nnz : 1), sizeof(int));
+    double* probability = (double*)calloc((size_t)(nnz > 0 ? nnz : 1), sizeof(double));
+    SparseHMM* sparse = NULL;
+    if (from != NULL && to != NULL && probability != NULL) {
+        int k = 0;
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) {
+                if (HMM_A(hmm, i, j) > threshold) {
+                    from[k] = i;
+                    to[k] = j;
+                    probability[k] = HMM_A(hmm, i, j);
+                    k++;
+                }
+            }
+        }
+        sparse = sparse_hmm_from_triplets(N, M, hmm->sequence_length, nnz, from, to, probability);
+    }
+    free(from);
+    free(to);
+    free(probability);
+    if (sparse == NULL) return NULL;
+    
+    for (int i = 0; i < N; i++) {
+        for (int k = 0; k < M; k++) {
+            SPARSE_HMM_B(sparse, i, k) = HMM_B(hmm, i, k);
+        }
+        sparse->initial[i] = hmm->initial[i];
+    }
+    sparse_hmm_prepare(sparse);
+    return sparse;
+}
+
+void sparse_hmm_prepare(SparseHMM* hmm) {
+    if (hmm == NULL) return;
+    
+    for (int k = 0; k < hmm->nnz; k++) {
+        hmm->log_transition[k] = log(hmm->transition[k]);
+    }
+    for (int i = 0; i < hmm->num_states; i++) {
+        for (int k = 0; k < hmm->num_observations; k++) {
+            SPARSE_HMM_LOG_B(hmm, i, k) = log(SPARSE_HMM_B(hmm, i, k));
+        }
+        hmm->log_initial[i] = log(hmm->initial[i]);
+    }
+}
+
+int validate_sparse_hmm(const SparseHMM* hmm) {
+    if (hmm == NULL) {
+        fprintf(stderr, "Validation error: Sparse HMM is NULL\n");
+        return 0;
+    }
+    
+    const double TOLERANCE = 1e-6;
+    int N = hmm->num_states;
+    int valid = 1;
+    
+    // Rows of A are scattered over the columns; sum them per source state
+    double* row_sum = (double*)calloc((size_t)N, sizeof(double));
+    if (row_sum == NULL) {
+        fprintf(stderr, "Validation error: Out of memory\n");
+        return 0;
+    }
+    for (int i = 0; i < N && valid; i++) {
+        for (int k = hmm->column_start[i]; k < hmm->column_start[i + 1]; k++) {
+            if (hmm->transition[k] < 0.0 || hmm->transition[k] > 1.0) {
+                fprintf(stderr, "Validation error: Transition probability [%d][%d] = %.6f is not in [0,1]\n",
+                        hmm->predecessor[k], i, hmm->transition[k]);
+                valid = 0;
+                break;
+            }
+            row_sum[hmm->predecessor[k]] += hmm->transition[k];
+        }
+    }
+    for (int i = 0; i < N && valid; i++) {
+        if (fabs(row_sum[i] - 1.0) > TOLERANCE) {
+            fprintf(stderr, "Validation error: Transition matrix row %d sums to %.6f instead of 1.0\n",
+                    i, row_sum[i]);
+            valid = 0;
+        }
+    }
+    free(row_sum);
+    
+    double initial_sum = 0.0;
+    for (int i = 0; i < N && valid; i++) {
+        double emission_sum = 0.0;
+        for (int k = 0; k < hmm->num_observations; k++) {
+            if (SPARSE_HMM_B(hmm, i, k) < 0.0 || SPARSE_HMM_B(hmm, i, k) > 1.0) {
+                fprintf(stderr, "Validation error: Emission probability [%d][%d] = %.6f is not in [0,1]\n",
+                        i, k, SPARSE_HMM_B(hmm, i, k));
+                return 0;
+            }
+            emission_sum += SPARSE_HMM_B(hmm, i, k);
+        }
+        if (fabs(emission_sum - 1.0) > TOLERANCE) {
+            fprintf(stderr, "Validation error: Emission matrix row %d sums to %.6f instead of 1.0\n",
+                    i, emission_sum);
+            return 0;
+        }
+        if (hmm->initial[i] < 0.0 || hmm->initial[i] > 1.0) {
+            fprintf(stderr, "Validation error: Initial probability [%d] = %.6f is not in [0,1]\n",
+                    i, hmm->initial[i]);
+            return 0;
+        }
+        initial_sum += hmm->initial[i];
+    }
+    if (valid && fabs(initial_sum - 1.0) > TOLERANCE) {
+        fprintf(stderr, "Validation error: Initial probabilities sum to %.6f instead of 1.0\n", initial_sum);
+        return 0;
+    }
+    
+    return valid;
+}
+
+// =============================================================================
+// FILE I/O FUNCTIONS
+// =============================================================================
+
+SparseHMM* load_sparse_hmm(const char* filename, int** observations) {
+    if (observations != NULL) {
+        *observations = NULL;
+    }
+    
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        return NULL;
+    }
+    
+    char marker[16];
+    int N, M, T, nnz;
+    if (fscanf(file, "%15s", marker) != 1 || strcmp(marker, "sparse") != 0) {
+        fprintf(stderr, "Error: '%s' is not a sparse model file (missing 'sparse' marker)\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    if (fscanf(file, "%d %d %d %d", &N, &M, &T, &nnz) != 4 || N <= 0 || M <= 0 || T <= 0 || nnz < 0) {
+        fprintf(stderr, "Error: Invalid sparse model dimensions in file\n");
+        fclose(file);
+        return NULL;
+    }
+    
+    // Transition triplets
+    int* from = (int*)malloc((size_t)(nnz > 0 ? nnz : 1) * sizeof(int));
+    int* to = (int*)malloc((size_t)(nnz > 0 ? nnz : 1) * sizeof(int));
+    double* probability = (double*)malloc((size_t)(nnz > 0 ? nnz : 1) * sizeof(double));
+    if (from == NULL || to == NULL || probability == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for %d transitions\n", nnz);
+        free(from); free(to); free(probability);
+        fclose(file);
+        return NULL;
+    }
+    for (int k = 0; k < nnz; k++) {
+        if (fscanf(file, "%d %d %lf", &from[k], &to[k], &probability[k]) != 3) {
+            fprintf(stderr, "Error: Failed to read transition %d\n", k);
+            free(from); free(to); free(probability);
+            fclose(file);
+            return NULL;
+        }
+    }
+    
+    SparseHMM* hmm = sparse_hmm_from_triplets(N, M, T, nnz, from, to, probability);
+    free(from);
+    free(to);
+    free(probability);
+    if (hmm == NULL) {
+        fclose(file);
+        return NULL;
+    }
+    
+    // Emission matrix B (NxM)
+    for (int i = 0; i < N; i++) {
+        for (int k = 0; k < M; k++) {
+            if (fscanf(file, "%lf", &SPARSE_HMM_B(hmm, i, k)) != 1) {
+                fprintf(stderr, "Error: Failed to read emission matrix element [%d][%d]\n", i, k);
+                free_sparse_hmm(hmm);
+                fclose(file);
+                return NULL;
+            }
+        }
+    }
+    
+    // Initial probabilities π
+    for (int i = 0; i < N; i++) {
+        if (fscanf(file, "%lf", &hmm->initial[i]) != 1) {
+            fprintf(stderr, "Error: Failed to read initial probability for state %d\n", i);
+            free_sparse_hmm(hmm);
+            fclose(file);
+            return NULL;
+        }
+    }
+    
+    // Optional observation sequence
+    if (observations != NULL) {
+        int* sequence = (int*)malloc((size_t)T * sizeof(int));
+        int read = 0;
+        while (sequence != NULL && read < T && fscanf(file, "%d", &sequence[read]) == 1) {
+            read++;
+        }
+        if (read == T) {
+            *observations = sequence;
+        } else {
+            free(sequence);
+            if (read > 0) {
+                fprintf(stderr, "Error: Failed to read observation %d\n", read);
+                free_sparse_hmm(hmm);
+                fclose(file);
+                return NULL;
+            }
+        }
+    }
+    
+    fclose(file);
+    
+    if (!validate_sparse_hmm(hmm)) {
+        fprintf(stderr, "Error: Loaded sparse HMM failed validation\n");
+        if (observations != NULL) {
+            free(*observations);
+            *observations = NULL;
+        }
+        free_sparse_hmm(hmm);
+        return NULL;
+    }
+    
+    sparse_hmm_prepare(hmm);
+    return hmm;
+}
+
+// =============================================================================
+// DECODING
+// =============================================================================
+
+SparseViterbiWorkspace* sparse_viterbi_workspace_create(int max_T, int N) {
+    if (max_T <= 0 || N <= 0) {
+        fprintf(stderr, "Error: Invalid sparse workspace dimensions (T=%d, N=%d)\n", max_T, N);
+        return NULL;
+    }
+    
+    SparseViterbiWorkspace* workspace = (SparseViterbiWorkspace*)malloc(sizeof(SparseViterbiWorkspace));
+    if (workspace == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for SparseViterbiWorkspace\n");
+        return NULL;
+    }
+    
+    int stride = hmm_padded_stride(N, sizeof(double));
+    workspace->delta = (double*)hmm_aligned_calloc(2 * sizeof(double) * (size_t)stride);
+    workspace->psi = (int*)hmm_aligned_calloc(sizeof(int) * (size_t)max_T * N);
+    if (workspace->delta == NULL || workspace->psi == NULL) {
+        fprintf(stderr, "Error: Failed to allocate sparse Viterbi buffers (T=%d, N=%d)\n", max_T, N);
+        free(workspace->delta);
+        free(workspace->psi);
+        free(workspace);
+        return NULL;
+    }
+    workspace->max_T = max_T;
+    workspace->N = N;
+    return workspace;
+}
+
+void sparse_viterbi_workspace_free(SparseViterbiWorkspace* workspace) {
+    if (workspace == NULL) return;
+    
+    free(workspace->delta);
+    free(workspace->psi);
+    free(workspace);
+}
+
+// Grow the workspace (at least 1.5x in T) if it cannot hold T steps over N states
+static int sparse_workspace_reserve(SparseViterbiWorkspace* workspace, int T, int N) {
+    if (T <= workspace->max_T && N == workspace->N) {
+        return 1;
+    }
+    
+    int new_T = T;
+    if (N == workspace->N && T < workspace->max_T + workspace->max_T / 2) {
+        new_T = workspace->max_T + workspace->max_T / 2;
+    }
+    
+    SparseViterbiWorkspace* grown = sparse_viterbi_workspace_create(new_T, N);
+    if (grown == NULL) {
+        return 0; // Old buffers stay valid
+    }
+    
+    free(workspace->delta);
+    free(workspace->psi);
+    *workspace = *grown;
+    free(grown);
+    return 1;
+}
+
+int viterbi_sparse(const SparseHMM* hmm, const int* observations, int T,
+                   SparseViterbiWorkspace* workspace, int* path, double* log_probability) {
+    if (hmm == NULL || observations == NULL || workspace == NULL || path == NULL || T <= 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to viterbi_sparse\n");
+        return -1;
+    }
+    for (int t = 0; t < T; t++) {
+        if (observations[t] < 0 || observations[t] >= hmm->num_observations) {
+            fprintf(stderr, "Error: Invalid observation %d at position %d\n", observations[t], t);
+            return -1;
+        }
+    }
+    
+    int N = hmm->num_states;
+    if (!sparse_workspace_reserve(workspace, T, N)) {
+        return -1;
+    }
+    
+    double* prev = workspace->delta;
+    double* current = workspace->delta + hmm_padded_stride(N, sizeof(double));
+    const int* column_start = hmm->column_start;
+    const int* predecessor = hmm->predecessor;
+    const double* log_transition = hmm->log_transition;
+    
+    // ==========================================================================
+    // INITIALIZATION: log δ₁(i) = log π(i) + log B(i,o₁)
+    // ==========================================================================
+    
+    for (int i = 0; i < N; i++) {
+        prev[i] = hmm->log_initial[i] + SPARSE_HMM_LOG_B(hmm, i, observations[0]);
+        workspace->psi[i] = 0;
+    }
+    
+    // ==========================================================================
+    // RECURSION over the nonzero predecessors of each state: O(nnz) per step
+    // ==========================================================================
+    
+    for (int t = 1; t < T; t++) {
+        int* psi = workspace->psi + (size_t)t * N;
+        int symbol = observations[t];
+        
+        for (int i = 0; i < N; i++) {
+            double best = -INFINITY;
+            int best_prev_state = 0;
+            for (int k = column_start[i]; k < column_start[i + 1]; k++) {
+                double score = prev[predecessor[k]] + log_transition[k];
+                if (score > best) {
+                    best = score;
+                    best_prev_state = predecessor[k];
+                }
+            }
+            current[i] = best + SPARSE_HMM_LOG_B(hmm, i, symbol);
+            psi[i] = best_prev_state;
+        }
+        
+        double* swap = prev;
+        prev = current;
+        current = swap;
+    }
+    
+    // ==========================================================================
+    // TERMINATION AND BACKTRACKING
+    // ==========================================================================
+    
+    double best = -INFINITY;
+    int best_final_state = 0;
+    for (int i = 0; i < N; i++) {
+        if (prev[i] > best) {
+            best = prev[i];
+            best_final_state = i;
+        }
+    }
+    
+    path[T-1] = best_final_state;
+    for (int t = T-2; t >= 0; t--) {
+        path[t] = workspace->psi[(size_t)(t+1) * N + path[t+1]];
+    }
+    
+    if (log_probability != NULL) {
+        *log_probability = best;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#ifndef HMM_SPARSE_H
+#define HMM_SPARSE_H
+
+#include "hmm.h"
+
+// =============================================================================
+// SPARSE-TRANSITION HMM
+// =============================================================================
+//
+// For large models in which every state has only a few successors. The
+// transition matrix is stored in compressed sparse column (CSC) form: for each
+// state i the list of its predecessors j with A(j,i) > 0, in increasing j,
+// together with log A(j,i). The Viterbi recursion then visits only those
+// entries, so a decode costs O(T·nnz) instead of O(T·N²) and the model takes
+// O(nnz + N·M) memory. Emissions and π stay dense.
+//
+// Sparse model file format (whitespace separated, like load_hmm's format):
+//   sparse                 marker on the first line
+//   N M T nnz              dimensions and number of nonzero transitions
+//   i j A(i,j)             nnz lines, 0-based source and destination state
+//   B                      N rows of M emission probabilities
+//   π                      N initial probabilities
+//   o₁ ... o_T             optional observation sequence
+
+/**
+ * Sparse-transition HMM (one aligned allocation; see above)
+ */
+typedef struct {
+    int num_states;          // N
+    int num_observations;    // M
+    int sequence_length;     // T recorded in the model
+    int emission_stride;     // Doubles between rows of B and log B
+    int nnz;                 // Nonzero transitions
+    int* column_start;       // N + 1 offsets: predecessors of i are [column_start[i], column_start[i+1])
+    int* predecessor;        // Source state j of each nonzero (nnz), increasing within a column
+    double* transition;      // A(j,i) of each nonzero (nnz)
+    double* log_transition;  // log A(j,i) of each nonzero (nnz)
+    double* emission;        // B (N x emission_stride)
+    double* log_emission;    // log B (N x emission_stride)
+    double* initial;         // π (N)
+    double* log_initial;     // log π (N)
+} SparseHMM;
+
+#define SPARSE_HMM_B(hmm, i, k)     ((hmm)->emission[(size_t)(i) * (hmm)->emission_stride + (k)])
+#define SPARSE_HMM_LOG_B(hmm, i, k) ((hmm)->log_emission[(size_t)(i) * (hmm)->emission_stride + (k)])
+
+/**
+ * Reusable buffers for viterbi_sparse
+ * Two δ rows and the ψ matrix (T x N); δ is not kept for every step, which
+ * halves the memory of a dense decode.
+ */
+typedef struct {
+    int max_T;         // Capacity in time steps
+    int N;             // Number of states the buffers are sized for
+    double* delta;     // Current and previous log δ rows (2 x N)
+    int* psi;          // Backpointers (max_T x N)
+} SparseViterbiWorkspace;
+
+// =============================================================================
+// CONSTRUCTION AND FILE I/O
+// =============================================================================
+
+/**
+ * Build a sparse model from transition triplets
+ * @param N Number of states
+ * @param M Number of observations
+ * @param T Sequence length recorded in the model
+ * @param nnz Number of triplets
+ * @param from Source states (nnz)
+ * @param to Destination states (nnz)
+ * @param probability A(from, to) of each triplet (nnz); duplicates are rejected
+ * @return Sparse model with emissions and π zeroed (caller fills them and calls
+ *         sparse_hmm_prepare), or NULL on failure
+ */
+SparseHMM* sparse_hmm_from_triplets(int N, int M, int T, int nnz,
+                                    const int* from, const int* to, const double* probability);
+
+/**
+ * Convert a dense model, keeping the transitions with A(i,j) > threshold
+ * @param hmm Dense model
+ * @param threshold 0.0 keeps every nonzero (exact conversion)
+ * @return Prepared sparse model or NULL on failure
+ */
+SparseHMM* sparse_hmm_from_dense(const HMM* hmm, double threshold);
+
+/**
+ * Load a sparse model file (format above)
+ * @param filename Path to input file
+ * @param observations Receives a malloc'd sequence of T symbols if the file has
+ *        one (NULL otherwise); may be NULL to skip it
+ * @return Validated, prepared sparse model or NULL on failure
+ */
+SparseHMM* load_sparse_hmm(const char* filename, int** observations);
+
+/**
+ * Recompute log A, log B and log π from the probabilities
+ * @param hmm Sparse model
+ */
+void sparse_hmm_prepare(SparseHMM* hmm);
+
+/**
+ * Check probabilities: every row of A, every row of B and π sum to 1
+ * @param hmm Sparse model
+ * @return 1 if valid, 0 if invalid
+ */
+int validate_sparse_hmm(const SparseHMM* hmm);
+
+/**
+ * Free a sparse model
+ * @param hmm Sparse model
+ */
+void free_sparse_hmm(SparseHMM* hmm);
+
+// =============================================================================
+// DECODING
+// =============================================================================
+
+/**
+ * Create a workspace for viterbi_sparse
+ * @param max_T Initial capacity in time steps
+ * @param N Number of states
+ * @return Workspace or NULL on failure
+ */
+SparseViterbiWorkspace* sparse_viterbi_workspace_create(int max_T, int N);
+
+/**
+ * Free a sparse Viterbi workspace
+ * @param workspace Workspace
+ */
+void sparse_viterbi_workspace_free(SparseViterbiWorkspace* workspace);
+
+/**
+ * Log-domain Viterbi over the nonzero predecessors only
+ *
+ * log δₜ(i) = max over j with A(j,i) > 0 of [log δₜ₋₁(j) + log A(j,i)] + log B(i,oₜ)
+ *
+ * Returns the same path and log P* as viterbi_algorithm_log on the equivalent
+ * dense model (same lowest-index tie-breaking).
+ *
+ * @param hmm Sparse model
+ * @param observations Observed symbols (length T)
+ * @param T Sequence length
+ * @param workspace Buffers (grown if needed)
+ * @param path Receives the T most likely states
+ * @param log_probability Receives log P* (may be NULL)
+ * @return 0 on success, -1 on invalid input or allocation failure
+ */
+int viterbi_sparse(const SparseHMM* hmm, const int* observations, int T,
+                   SparseViterbiWorkspace* workspace, int* path, double* log_probability);
+
+#endif // HMM_SPARSE_H
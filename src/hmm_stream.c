@@ -0,0 +1,242 @@
+#include <limits.h>
+#include "hmm_stream.h"
+#include "hmm_kernels.h"
+
+// =============================================================================
+// INTERNAL HELPERS
+// =============================================================================
+
+static int* psi_row(const ViterbiStream* stream, long long time) {
+    return stream->psi_ring + (size_t)(time % stream->window) * stream->psi_stride;
+}
+
+// First index of the maximum of the current δ
+static int best_state(const ViterbiStream* stream) {
+    int best = 0;
+    for (int i = 1; i < stream->N; i++) {
+        if (stream->delta[i] > stream->delta[best]) best = i;
+    }
+    return best;
+}
+
+// Write the states of times [stream->committed, time] that lead to `state` at
+// `time` into committed[0 .. time - stream->committed] and advance the frontier
+static int commit_through(ViterbiStream* stream, int state, long long time, int* committed) {
+    int count = (int)(time - stream->committed + 1);
+    
+    committed[count - 1] = state;
+    for (long long tau = time; tau > stream->committed; tau--) {
+        state = psi_row(stream, tau)[state];
+        committed[tau - stream->committed - 1] = state;
+    }
+    
+    stream->committed = time + 1;
+    return count;
+}
+
+// Survivor convergence: follow every state's backpointers until all surviving
+// paths pass through a single state. Everything up to that point is final.
+// 
+// The ancestors at time τ of the current states are a subset of those found by
+// the previous check, so once a level has as many ancestors as last time the
+// sets are equal from there back and nothing new can converge. Each level's
+// count only shrinks, so it is walked past at most N times: O(N²) amortized per
+// push in the worst case (survivors that never merge) instead of O(N·L).
+static int commit_converged(ViterbiStream* stream, int* committed) {
+    int N = stream->N;
+    int count = N;
+    long long tau = stream->t - 1;
+    
+    for (int i = 0; i < N; i++) {
+        stream->survivors[i] = i;
+    }
+    
+    while (count > 1 && tau > stream->committed) {
+        if (stream->generation == INT_MAX) {
+            memset(stream->seen, 0, (size_t)N * sizeof(int));
+            stream->generation = 0;
+        }
+        stream->generation++;
+        
+        // Distinct predecessors of the current survivor set
+        const int* psi = psi_row(stream, tau);
+        int distinct = 0;
+        for (int k = 0; k < count; k++) {
+            int prev = psi[stream->survivors[k]];
+            if (stream->seen[prev] != stream->generation) {
+                stream->seen[prev] = stream->generation;
+                stream->survivors[distinct++] = prev;
+            }
+        }
+        count = distinct;
+        tau--;
+        
+        int* known = &stream->survivor_counts[tau % stream->window];
+        if (count == *known) {
+            return 0;
+        }
+        *known = count;
+    }
+    
+    if (count != 1) {
+        return 0;
+    }
+    return commit_through(stream, stream->survivors[0], tau, committed);
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+ViterbiStream* viterbi_stream_create(HMM* hmm, int lag) {
+    if (hmm == NULL || lag < 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to viterbi_stream_create\n");
+        return NULL;
+    }
+    
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    ViterbiStream* stream = (ViterbiStream*)malloc(sizeof(ViterbiStream));
+    if (stream == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for ViterbiStream\n");
+        return NULL;
+    }
+    
+    int N = hmm->num_states;
+    int delta_stride = hmm_padded_stride(N, sizeof(double));
+    int int_stride = hmm_padded_stride(N, sizeof(int));
+    int window = lag + 1;
+    
+    int window_stride = hmm_padded_stride(window, sizeof(int));
+    
+    // One aligned block: [δ | δ scratch | ψ ring | survivors | seen | survivor counts]
+    size_t bytes = sizeof(double) * 2 * (size_t)delta_stride
+                 + sizeof(int) * (((size_t)window + 2) * int_stride + window_stride);
+    char* block = (char*)hmm_aligned_calloc(bytes);
+    if (block == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for stream buffers (%zu bytes)\n", bytes);
+        free(stream);
+        return NULL;
+    }
+    
+    stream->hmm = hmm;
+    stream->N = N;
+    stream->lag = lag;
+    stream->window = window;
+    stream->psi_stride = int_stride;
+    stream->check_convergence = 1;
+    stream->t = 0;
+    stream->committed = 0;
+    stream->log_offset = 0.0;
+    stream->generation = 0;
+    stream->buffers = block;
+    stream->delta = (double*)block;
+    stream->next_delta = stream->delta + delta_stride;
+    stream->psi_ring = (int*)(stream->next_delta + delta_stride);
+    stream->survivors = stream->psi_ring + (size_t)window * int_stride;
+    stream->seen = stream->survivors + int_stride;
+    stream->survivor_counts = stream->seen + int_stride;
+    
+    return stream;
+}
+
+int viterbi_stream_push(ViterbiStream* stream, int observation, int* committed) {
+    const HMM* hmm = stream->hmm;
+    int N = stream->N;
+    
+    if (observation < 0 || observation >= hmm->num_observations) {
+        fprintf(stderr, "Error: Observation %d is not a valid symbol (0 to %d)\n",
+                observation, hmm->num_observations - 1);
+        return -1;
+    }
+    
+    const double* log_emission = HMM_LOG_B_COLUMN(hmm, observation);
+    if (stream->t == 0) {
+        // log δ₁(i) = log π(i) + log B(i, o₁)
+        for (int i = 0; i < N; i++) {
+            stream->delta[i] = hmm->log_initial[i] + log_emission[i];
+        }
+    } else {
+        // log δₜ(i) = max[log δₜ₋₁(j) + log A(j,i)] + log B(i,oₜ), ψ into the ring
+        HmmMaxKernel max_sum = hmm_kernels()->max_sum;
+        int* psi = psi_row(stream, stream->t);
+        for (int i = 0; i < N; i++) {
+            double best = max_sum(stream->delta, HMM_LOG_A_COLUMN(hmm, i), N, &psi[i]);
+            stream->next_delta[i] = best + log_emission[i];
+        }
+        double* swap = stream->delta;
+        stream->delta = stream->next_delta;
+        stream->next_delta = swap;
+    }
+    
+    // Shift δ back to a maximum of 0 once it drifts far below it; the shift does
+    // not change any argmax, and doing it rarely keeps the rounding (and thus
+    // near-ties) identical to the offline decoder for ordinary stream lengths
+    double max_value = stream->delta[best_state(stream)];
+    if (isfinite(max_value) && fabs(max_value) > VITERBI_STREAM_RENORMALIZE) {
+        for (int i = 0; i < N; i++) {
+            stream->delta[i] -= max_value;
+        }
+        stream->log_offset += max_value;
+    }
+    stream->t++;
+    
+    // Every state at the newest time is its own survivor
+    stream->survivor_counts[(stream->t - 1) % stream->window] = N;
+    
+    int written = 0;
+    if (stream->check_convergence && stream->t - stream->committed > 1) {
+        written += commit_converged(stream, committed);
+    }
+    
+    // Fixed-lag bound: at most L observations may stay undecided
+    if (stream->t - stream->committed > stream->lag) {
+        // Trace the best current path back to the oldest pending time
+        int state = best_state(stream);
+        for (long long tau = stream->t - 1; tau > stream->committed; tau--) {
+            state = psi_row(stream, tau)[state];
+        }
+        written += commit_through(stream, state, stream->committed, committed + written);
+    }
+    
+    return written;
+}
+
+int viterbi_stream_push_block(ViterbiStream* stream, const int* observations, int count, int* committed) {
+    int written = 0;
+    for (int k = 0; k < count; k++) {
+        int n = viterbi_stream_push(stream, observations[k], committed + written);
+        if (n < 0) return -1;
+        written += n;
+    }
+    return written;
+}
+
+int viterbi_stream_flush(ViterbiStream* stream, int* committed) {
+    int written = 0;
+    if (stream->t > stream->committed) {
+        written = commit_through(stream, best_state(stream), stream->t - 1, committed);
+    }
+    
+    // Ready for a new stream
+    stream->t = 0;
+    stream->committed = 0;
+    stream->log_offset = 0.0;
+    return written;
+}
+
+double viterbi_stream_log_probability(const ViterbiStream* stream) {
+    if (stream->t == 0) {
+        return -INFINITY;
+    }
+    return stream->delta[best_state(stream)] + stream->log_offset;
+}
+
+void viterbi_stream_free(ViterbiStream* stream) {
+    if (stream == NULL) return;
+    
+    free(stream->buffers);
+    free(stream);
+}
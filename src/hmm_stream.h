@@ -0,0 +1,106 @@
+#ifndef HMM_STREAM_H
+#define HMM_STREAM_H
+
+#include "hmm.h"
+
+// =============================================================================
+// STREAMING FIXED-LAG VITERBI DECODER
+// =============================================================================
+//
+// Online log-domain Viterbi for unbounded observation streams. Only the
+// current δ vector and a ring of the last L+1 rows of ψ are kept, so memory is
+// O(N·L) regardless of how long the stream runs. States are committed (emitted)
+// in time order:
+//   - as soon as every surviving path agrees on them (survivor convergence),
+//     which is exactly the state the offline Viterbi path would have there;
+//   - at the latest L steps after their observation, by tracing back from the
+//     currently best state (fixed-lag decision; may differ from the offline
+//     path when the evidence is still ambiguous after L steps).
+// Each push costs O(N²) for the recursion. The convergence check walks back only
+// while the survivor sets keep shrinking compared with the previous push, which
+// adds O(N²) amortized in the worst case and usually far less, rather than
+// O(N·L) per observation.
+// δ is shifted back to max 0 whenever it drifts below -VITERBI_STREAM_RENORMALIZE,
+// so it never underflows however long the stream runs; below that threshold the
+// arithmetic is identical to viterbi_algorithm_log.
+
+// Magnitude of log δ that triggers a renormalization
+#ifndef VITERBI_STREAM_RENORMALIZE
+#define VITERBI_STREAM_RENORMALIZE 1e6
+#endif
+
+/**
+ * Streaming decoder state
+ */
+typedef struct {
+    HMM* hmm;               // Prepared model, only read
+    int N;                  // Number of states
+    int lag;                // L: maximum steps between an observation and its committed state
+    int window;             // Rows in the ψ ring (L + 1)
+    int psi_stride;         // Ints between ring rows
+    int check_convergence;  // 1 to commit early when survivors converge (default)
+    long long t;            // Observations consumed
+    long long committed;    // States emitted so far (times [0, committed))
+    double log_offset;      // Sum of the applied shifts: log δ = delta + log_offset
+    double* delta;          // Current log δ (N), relative to log_offset
+    double* next_delta;     // Scratch row (N)
+    int* psi_ring;          // ψ for the last `window` steps, row (time % window)
+    int* survivors;         // Scratch for the convergence check (N)
+    int* seen;              // Scratch stamps for the convergence check (N)
+    int* survivor_counts;   // Ancestors found at each pending time by the last check, row (time % window)
+    int generation;         // Current stamp value for seen[]
+    void* buffers;          // Single aligned allocation backing every array above
+} ViterbiStream;
+
+/**
+ * Create a streaming decoder
+ * @param hmm Model (prepared here if needed; must not change while streaming)
+ * @param lag Maximum decision delay L in steps (0 = commit every state immediately)
+ * @return Decoder or NULL on failure
+ */
+ViterbiStream* viterbi_stream_create(HMM* hmm, int lag);
+
+/**
+ * Push one observation
+ * @param stream Decoder
+ * @param observation Observed symbol in [0, M)
+ * @param committed Receives newly committed states in time order
+ *        (capacity ≥ lag + 1 is always enough)
+ * @return Number of states written to committed, or -1 on an invalid symbol
+ */
+int viterbi_stream_push(ViterbiStream* stream, int observation, int* committed);
+
+/**
+ * Push a block of observations
+ * @param stream Decoder
+ * @param observations Observed symbols
+ * @param count Number of observations
+ * @param committed Receives newly committed states (capacity ≥ count + lag + 1)
+ * @return Number of states written, or -1 on an invalid symbol (earlier
+ *         observations of the block stay consumed)
+ */
+int viterbi_stream_push_block(ViterbiStream* stream, const int* observations, int count, int* committed);
+
+/**
+ * End of stream: commit every pending state from the best final state and
+ * reset the decoder so it can start a new stream
+ * @param stream Decoder
+ * @param committed Receives the remaining states (capacity ≥ lag + 1)
+ * @return Number of states written
+ */
+int viterbi_stream_flush(ViterbiStream* stream, int* committed);
+
+/**
+ * Log probability of the best path over everything pushed so far
+ * @param stream Decoder
+ * @return max_i log δₜ(i), or -INFINITY before the first observation
+ */
+double viterbi_stream_log_probability(const ViterbiStream* stream);
+
+/**
+ * Free a streaming decoder
+ * @param stream Decoder
+ */
+void viterbi_stream_free(ViterbiStream* stream);
+
+#endif // HMM_STREAM_H
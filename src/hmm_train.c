@@ -0,0 +1,416 @@
+#include <pthread.h>
+#include "hmm_train.h"
+#include "hmm_posterior.h"
+#include "hmm_batch.h"
+
+// =============================================================================
+// EXPECTED-COUNT ACCUMULATORS
+// =============================================================================
+
+/**
+ * Expected counts gathered by one thread during an E-step
+ * All arrays live in one aligned block; rows use the model's strides.
+ */
+typedef struct {
+    double* transitions;   // Σₜ ξₜ(i,j) (N x transition_stride)
+    double* emissions;     // Σ_{oₜ=k} γₜ(i) (N x emission_stride)
+    double* starts;        // Σ γ₁(i) (N)
+    double* visits;        // Σₜ γₜ(i) (N)
+    double* weighted;      // Scratch row B(j,oₜ₊₁) β̂ₜ₊₁(j) / cₜ₊₁ (N)
+    double log_likelihood; // Σ log P(O | λ) over this thread's sequences
+    void* block;
+} ExpectedCounts;
+
+typedef struct {
+    HMM* hmm;
+    const int* const* sequences;
+    const int* lengths;
+    const int* order;      // Sequence indices, longest first
+    int count;
+    int num_workers;
+} TrainContext;
+
+typedef struct {
+    TrainContext* context;
+    int id;
+    int failed;            // Set if a sequence could not be processed
+    PosteriorWorkspace* workspace;
+    ExpectedCounts counts;
+} TrainWorker;
+
+typedef struct {
+    int length;
+    int index;
+} SequenceOrder;
+
+// Longest first; equal lengths keep input order (same order as viterbi_batch)
+static int compare_longest_first(const void* a, const void* b) {
+    const SequenceOrder* x = (const SequenceOrder*)a;
+    const SequenceOrder* y = (const SequenceOrder*)b;
+    if (x->length != y->length) return x->length > y->length ? -1 : 1;
+    return x->index - y->index;
+}
+
+static int counts_init(ExpectedCounts* counts, const HMM* hmm) {
+    int N = hmm->num_states;
+    int vector_stride = hmm_padded_stride(N, sizeof(double));
+    size_t transition_size = (size_t)N * hmm->transition_stride;
+    size_t emission_size = (size_t)N * hmm->emission_stride;
+    
+    char* block = (char*)hmm_aligned_calloc(sizeof(double) * (transition_size + emission_size
+                                                               + 3 * (size_t)vector_stride));
+    if (block == NULL) {
+        return 0;
+    }
+    
+    counts->block = block;
+    counts->transitions = (double*)block;
+    counts->emissions = counts->transitions + transition_size;
+    counts->starts = counts->emissions + emission_size;
+    counts->visits = counts->starts + vector_stride;
+    counts->weighted = counts->visits + vector_stride;
+    counts->log_likelihood = 0.0;
+    return 1;
+}
+
+static void counts_clear(ExpectedCounts* counts, const HMM* hmm) {
+    int N = hmm->num_states;
+    memset(counts->transitions, 0, sizeof(double) * (size_t)N * hmm->transition_stride);
+    memset(counts->emissions, 0, sizeof(double) * (size_t)N * hmm->emission_stride);
+    memset(counts->starts, 0, sizeof(double) * (size_t)N);
+    memset(counts->visits, 0, sizeof(double) * (size_t)N);
+    counts->log_likelihood = 0.0;
+}
+
+// target += source, element by element
+static void counts_add(ExpectedCounts* target, const ExpectedCounts* source, const HMM* hmm) {
+    int N = hmm->num_states;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            target->transitions[(size_t)i * hmm->transition_stride + j] +=
+                source->transitions[(size_t)i * hmm->transition_stride + j];
+        }
+        for (int k = 0; k < hmm->num_observations; k++) {
+            target->emissions[(size_t)i * hmm->emission_stride + k] +=
+                source->emissions[(size_t)i * hmm->emission_stride + k];
+        }
+        target->starts[i] += source->starts[i];
+        target->visits[i] += source->visits[i];
+    }
+    target->log_likelihood += source->log_likelihood;
+}
+
+// =============================================================================
+// E-STEP
+// =============================================================================
+
+// Add the expected counts of one sequence; returns 0 if it has zero probability
+static int accumulate_sequence(const HMM* hmm, const int* observations, int T,
+                               PosteriorWorkspace* workspace, ExpectedCounts* counts) {
+    const PosteriorResult* result = hmm_forward_backward((HMM*)hmm, observations, T, workspace);
+    if (result == NULL) {
+        return 0;
+    }
+    
+    int N = hmm->num_states;
+    counts->log_likelihood += result->log_likelihood;
+    
+    // γ: starts, visits and per-symbol emissions
+    for (int i = 0; i < N; i++) {
+        counts->starts[i] += POSTERIOR_GAMMA(result, 0, i);
+    }
+    for (int t = 0; t < T; t++) {
+        const double* gamma = POSTERIOR_GAMMA_ROW(result, t);
+        double* emissions = counts->emissions + observations[t];
+        for (int i = 0; i < N; i++) {
+            counts->visits[i] += gamma[i];
+            emissions[(size_t)i * hmm->emission_stride] += gamma[i];
+        }
+    }
+    
+    // ξₜ(i,j) = α̂ₜ(i) × A(i,j) × B(j,oₜ₊₁) × β̂ₜ₊₁(j) / cₜ₊₁
+    double* weighted = counts->weighted;
+    for (int t = 0; t < T-1; t++) {
+        const double* alpha = POSTERIOR_ALPHA_ROW(result, t);
+        const double* beta = POSTERIOR_BETA_ROW(result, t+1);
+        double inverse = 1.0 / result->scale[t+1];
+        
+        const double* emission = HMM_B_COLUMN(hmm, observations[t+1]);
+        for (int j = 0; j < N; j++) {
+            weighted[j] = emission[j] * beta[j] * inverse;
+        }
+        for (int i = 0; i < N; i++) {
+            const double* a_row = &HMM_A(hmm, i, 0);
+            double* xi_row = counts->transitions + (size_t)i * hmm->transition_stride;
+            double a = alpha[i];
+            for (int j = 0; j < N; j++) {
+                xi_row[j] += a * a_row[j] * weighted[j];
+            }
+        }
+    }
+    
+    return 1;
+}
+
+// Worker w takes sequences w, w + W, w + 2W, ... of the longest-first order
+static void* train_worker(void* arg) {
+    TrainWorker* worker = (TrainWorker*)arg;
+    TrainContext* context = worker->context;
+    
+    counts_clear(&worker->counts, context->hmm);
+    for (int k = worker->id; k < context->count; k += context->num_workers) {
+        int s = context->order[k];
+        if (!accumulate_sequence(context->hmm, context->sequences[s], context->lengths[s],
+                                 worker->workspace, &worker->counts)) {
+            worker->failed = 1;
+            break;
+        }
+    }
+    return NULL;
+}
+
+// One E-step over the corpus; the reduced counts end up in workers[0].counts
+static int expectation_step(TrainWorker* workers, int num_workers, pthread_t* threads) {
+    int* started = (int*)calloc((size_t)num_workers, sizeof(int));
+    
+    for (int w = 0; w < num_workers; w++) {
+        workers[w].failed = 0;
+    }
+    for (int w = 1; w < num_workers; w++) {
+        if (started != NULL) {
+            started[w] = pthread_create(&threads[w], NULL, train_worker, &workers[w]) == 0;
+        }
+    }
+    train_worker(&workers[0]);
+    
+    // Join in thread order and reduce; a thread that failed to start runs here
+    int failed = workers[0].failed;
+    for (int w = 1; w < num_workers; w++) {
+        if (started != NULL && started[w]) {
+            pthread_join(threads[w], NULL);
+        } else {
+            train_worker(&workers[w]);
+        }
+        failed |= workers[w].failed;
+        counts_add(&workers[0].counts, &workers[w].counts, workers[0].context->hmm);
+    }
+    
+    free(started);
+    return failed ? 0 : 1;
+}
+
+// =============================================================================
+// M-STEP
+// =============================================================================
+
+static void maximization_step(HMM* hmm, const ExpectedCounts* counts, int count) {
+    int N = hmm->num_states;
+    int M = hmm->num_observations;
+    
+    for (int i = 0; i < N; i++) {
+        // A(i,j) = Σξ(i,j) / Σⱼ Σξ(i,j)
+        const double* xi_row = counts->transitions + (size_t)i * hmm->transition_stride;
+        double leaving = 0.0;
+        for (int j = 0; j < N; j++) leaving += xi_row[j];
+        if (leaving > 0.0) {
+            for (int j = 0; j < N; j++) {
+                HMM_A(hmm, i, j) = xi_row[j] / leaving;
+            }
+        }
+        
+        // B(i,k) = Σ_{oₜ=k} γₜ(i) / Σₜ γₜ(i)
+        const double* emission_row = counts->emissions + (size_t)i * hmm->emission_stride;
+        if (counts->visits[i] > 0.0) {
+            for (int k = 0; k < M; k++) {
+                HMM_B(hmm, i, k) = emission_row[k] / counts->visits[i];
+            }
+        }
+        
+        // π(i) = Σ γ₁(i) / number of sequences
+        hmm->initial[i] = counts->starts[i] / count;
+    }
+    
+    hmm_prepare(hmm);
+}
+
+// xorshift64*, local to the caller: the process-wide rand() state is never touched
+static unsigned long long random_seed(unsigned int seed) {
+    unsigned long long state = 0x9e3779b97f4a7c15ull ^ ((unsigned long long)seed * 0xbf58476d1ce4e5b9ull);
+    return state != 0 ? state : 0x9e3779b97f4a7c15ull;
+}
+
+static double next_uniform(unsigned long long* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (double)((*state * 0x2545f4914f6cdd1dull) >> 11) / 9007199254740992.0;
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+BaumWelchOptions baum_welch_default_options(void) {
+    BaumWelchOptions options;
+    options.max_iterations = 100;
+    options.tolerance = 1e-6;
+    options.num_threads = 0;
+    options.verbose = 0;
+    return options;
+}
+
+void hmm_randomize(HMM* hmm, unsigned int seed) {
+    if (hmm == NULL) return;
+    
+    int N = hmm->num_states;
+    int M = hmm->num_observations;
+    unsigned long long state = random_seed(seed);
+    
+    for (int i = 0; i < N; i++) {
+        double row_sum = 0.0;
+        for (int j = 0; j < N; j++) {
+            HMM_A(hmm, i, j) = 0.5 + next_uniform(&state);
+            row_sum += HMM_A(hmm, i, j);
+        }
+        for (int j = 0; j < N; j++) HMM_A(hmm, i, j) /= row_sum;
+        
+        row_sum = 0.0;
+        for (int k = 0; k < M; k++) {
+            HMM_B(hmm, i, k) = 0.5 + next_uniform(&state);
+            row_sum += HMM_B(hmm, i, k);
+        }
+        for (int k = 0; k < M; k++) HMM_B(hmm, i, k) /= row_sum;
+    }
+    
+    double initial_sum = 0.0;
+    for (int i = 0; i < N; i++) {
+        hmm->initial[i] = 0.5 + next_uniform(&state);
+        initial_sum += hmm->initial[i];
+    }
+    for (int i = 0; i < N; i++) hmm->initial[i] /= initial_sum;
+    
+    hmm_prepare(hmm);
+}
+
+int baum_welch_train(HMM* hmm, const int* const* sequences, const int* lengths, int count,
+                     const BaumWelchOptions* options, BaumWelchReport* report) {
+    if (hmm == NULL || sequences == NULL || lengths == NULL || count <= 0) {
+        fprintf(stderr, "Error: Invalid arguments passed to baum_welch_train\n");
+        return -1;
+    }
+    
+    // Bad input must be reported as such, not as a zero-probability sequence
+    for (int k = 0; k < count; k++) {
+        if (sequences[k] == NULL || lengths[k] < 1) {
+            fprintf(stderr, "Error: Invalid training sequence %d (length %d)\n", k, lengths[k]);
+            return -1;
+        }
+        for (int t = 0; t < lengths[k]; t++) {
+            if (sequences[k][t] < 0 || sequences[k][t] >= hmm->num_observations) {
+                fprintf(stderr, "Error: Training sequence %d has invalid symbol %d at position %d (0 to %d)\n",
+                        k, sequences[k][t], t, hmm->num_observations - 1);
+                return -1;
+            }
+        }
+    }
+    
+    BaumWelchOptions settings = options != NULL ? *options : baum_welch_default_options();
+    int num_workers = settings.num_threads > 0 ? settings.num_threads : hmm_online_cpus();
+    if (num_workers > count) num_workers = count;
+    
+    if (!hmm->prepared) {
+        hmm_prepare(hmm);
+    }
+    
+    // Longest first, so the static round-robin deal starts every thread with
+    // a similar amount of work
+    int* order = (int*)malloc((size_t)count * sizeof(int));
+    SequenceOrder* sorted = (SequenceOrder*)malloc((size_t)count * sizeof(SequenceOrder));
+    TrainWorker* workers = (TrainWorker*)calloc((size_t)num_workers, sizeof(TrainWorker));
+    pthread_t* threads = (pthread_t*)malloc((size_t)num_workers * sizeof(pthread_t));
+    if (order == NULL || sorted == NULL || workers == NULL || threads == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for Baum-Welch training\n");
+        free(order); free(sorted); free(workers); free(threads);
+        return -1;
+    }
+    
+    int longest = 1;
+    for (int k = 0; k < count; k++) {
+        sorted[k].length = lengths[k];
+        sorted[k].index = k;
+        if (lengths[k] > longest) longest = lengths[k];
+    }
+    qsort(sorted, (size_t)count, sizeof(SequenceOrder), compare_longest_first);
+    for (int k = 0; k < count; k++) order[k] = sorted[k].index;
+    free(sorted);
+    
+    TrainContext context;
+    context.hmm = hmm;
+    context.sequences = sequences;
+    context.lengths = lengths;
+    context.order = order;
+    context.count = count;
+    context.num_workers = num_workers;
+    
+    int status = 0;
+    for (int w = 0; w < num_workers; w++) {
+        workers[w].context = &context;
+        workers[w].id = w;
+        workers[w].workspace = posterior_workspace_create(longest, hmm->num_states);
+        if (workers[w].workspace == NULL || !counts_init(&workers[w].counts, hmm)) {
+            fprintf(stderr, "Error: Failed to allocate memory for training thread %d\n", w);
+            status = -1;
+        }
+    }
+    
+    BaumWelchReport outcome = {0, 0, -INFINITY, -INFINITY};
+    double previous = -INFINITY;
+    
+    while (status == 0 && outcome.iterations < settings.max_iterations) {
+        if (!expectation_step(workers, num_workers, threads)) {
+            fprintf(stderr, "Error: Training sequence has zero probability under the current model\n");
+            status = -1;
+            break;
+        }
+        
+        // Log-likelihood of the model the E-step just used
+        double log_likelihood = workers[0].counts.log_likelihood;
+        if (outcome.iterations == 0) {
+            outcome.initial_log_likelihood = log_likelihood;
+        }
+        outcome.log_likelihood = log_likelihood;
+        if (settings.verbose) {
+            printf("Iteration %3d: log-likelihood = %.10f\n", outcome.iterations, log_likelihood);
+        }
+        
+        if (outcome.iterations > 0
+            && log_likelihood - previous <= settings.tolerance * fabs(previous)) {
+            outcome.converged = 1;
+            break;
+        }
+        previous = log_likelihood;
+        
+        maximization_step(hmm, &workers[0].counts, count);
+        outcome.iterations++;
+    }
+    
+    // Report the likelihood of the model actually returned
+    if (status == 0 && !outcome.converged && outcome.iterations > 0) {
+        if (expectation_step(workers, num_workers, threads)) {
+            outcome.log_likelihood = workers[0].counts.log_likelihood;
+        }
+    }
+    
+    for (int w = 0; w < num_workers; w++) {
+        posterior_workspace_free(workers[w].workspace);
+        free(workers[w].counts.block);
+    }
+    free(threads);
+    free(workers);
+    free(order);
+    
+    if (report != NULL) {
+        *report = outcome;
+    }
+    return status;
+}
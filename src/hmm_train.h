@@ -0,0 +1,79 @@
+#ifndef HMM_TRAIN_H
+#define HMM_TRAIN_H
+
+#include "hmm.h"
+
+// =============================================================================
+// BAUM-WELCH TRAINING
+// =============================================================================
+//
+// Expectation-maximization for A, B and π over a corpus of independent
+// observation sequences. Each iteration:
+//   E-step: scaled forward-backward on every sequence (hmm_posterior.h),
+//           accumulating the expected counts
+//               Σₜ ξₜ(i,j)   expected transitions i → j
+//               Σₜ γₜ(i)     expected visits to i (per emitted symbol)
+//               γ₁(i)        expected starts in i
+//   M-step: A(i,j) = Σξ(i,j) / Σξ(i,·),  B(i,k) = Σ_{oₜ=k} γₜ(i) / Σγₜ(i),
+//           π(i) = Σ γ₁(i) / number of sequences
+// The E-step runs on a pool of threads. Each thread owns its expected-count
+// accumulators and forward-backward workspace; the accumulators are reduced in
+// thread order after the step, so a given thread count always reproduces the
+// same model bit for bit.
+
+/**
+ * Training controls
+ */
+typedef struct {
+    int max_iterations;   // Upper bound on EM iterations
+    double tolerance;     // Stop when the relative log-likelihood gain is below this
+    int num_threads;      // E-step threads (0 = one per online CPU)
+    int verbose;          // 1 to print the log-likelihood of every iteration
+} BaumWelchOptions;
+
+/**
+ * Training outcome
+ */
+typedef struct {
+    int iterations;           // EM iterations performed
+    int converged;            // 1 if the tolerance was reached before max_iterations
+    double log_likelihood;    // Corpus log-likelihood under the final model
+    double initial_log_likelihood; // Corpus log-likelihood under the starting model
+} BaumWelchReport;
+
+/**
+ * Default options: 100 iterations, tolerance 1e-6, one thread per CPU, quiet
+ * @return Options structure with default values
+ */
+BaumWelchOptions baum_welch_default_options(void);
+
+/**
+ * Fill A, B and π with random row-stochastic values (a starting point for EM)
+ * Entries are kept away from zero so no parameter starts out impossible.
+ * @param hmm Pointer to HMM structure (dimensions already set)
+ * @param seed Seed of a private generator (the same seed gives the same model;
+ *        the process-wide rand() state is left alone, so calls are thread-safe)
+ */
+void hmm_randomize(HMM* hmm, unsigned int seed);
+
+/**
+ * Train a model with Baum-Welch
+ *
+ * hmm holds the starting parameters and is updated in place (and re-prepared)
+ * after every M-step. A row whose expected count is zero (a state never
+ * visited, or never left) keeps its previous values.
+ *
+ * @param hmm Model to train
+ * @param sequences Array of count observation sequences with symbols in [0, M)
+ * @param lengths Length of each sequence (≥ 1)
+ * @param count Number of sequences
+ * @param options Training controls (NULL = defaults)
+ * @param report Receives the outcome (may be NULL)
+ * @return 0 on success, -1 on invalid input (including a NULL or empty sequence
+ *         or a symbol outside 0..M-1), allocation failure or a sequence with
+ *         zero probability under the starting model
+ */
+int baum_welch_train(HMM* hmm, const int* const* sequences, const int* lengths, int count,
+                     const BaumWelchOptions* options, BaumWelchReport* report);
+
+#endif // HMM_TRAIN_H
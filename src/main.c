@@ -1,10 +1,18 @@
-#define _POSIX_C_SOURCE 200112L  // For fileno()
+#define _POSIX_C_SOURCE 200809L  // For fileno(), getline() and clock_gettime()
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>  // For isatty() and fileno()
 #include "bayesian.h"
 #include "hmm.h"
+#include "hmm_batch.h"
+#include "hmm_binary.h"
+
+// =============================================================================
+// MENU MODE (no arguments)
+// =============================================================================
 
 void print_menu(void) {
     printf("\n=== MODELOS PROBABILISTAS ===\n");
@@ -15,7 +23,7 @@ void print_menu(void) {
     printf("Seleccione una opción: ");
 }
 
-int main() {
+static int run_menu(void) {
     int opcion;
     int continuar = 1;
     
@@ -65,7 +73,7 @@ int main() {
                     printf("\n=== Error al ejecutar Red Bayesiana ===\n");
                 }
                 break;
-                
+            
             case 2:
                 printf("\n=== EJECUTANDO HMM - PREDICCIÓN DEL CLIMA (MODO BÁSICO) ===\n");
                 printf("Este ejemplo utiliza el algoritmo de Viterbi para predecir\n");
@@ -78,7 +86,7 @@ int main() {
                     printf("\n=== Error al ejecutar HMM ===\n");
                 }
                 break;
-                
+            
             case 3:
                 printf("\n=== EJECUTANDO HMM - PREDICCIÓN DEL CLIMA (MODO DETALLADO) ===\n");
                 printf("Este ejemplo muestra todos los cálculos paso a paso del\n");
@@ -91,13 +99,13 @@ int main() {
                     printf("\n=== Error al ejecutar HMM ===\n");
                 }
                 break;
-                
+            
             case 4:
                 printf("\nGracias por usar el programa de Modelos Probabilistas.\n");
                 printf("¡Hasta la vista!\n");
                 continuar = 0;
                 break;
-                
+            
             default:
                 printf("\nOpción inválida. Por favor seleccione una opción entre 1 y 4.\n");
                 break;
@@ -117,3 +125,411 @@ int main() {
     
     return 0;
 }
+
+// =============================================================================
+// BATCH MODE (command-line arguments)
+// =============================================================================
+//
+//     modelos_probabilistas --model clima_ejemplo.txt obs1.txt obs2.txt
+//     cat observaciones.txt | modelos_probabilistas --model clima_ejemplo.hmmb
+//
+// Every non-empty line of the observation files (or stdin) is one sequence of
+// symbol indices, or of symbol names if the model has them; '#' starts a
+// comment. The model is loaded once and the sequences are decoded in chunks
+// on one ViterbiBatchPool, so memory stays bounded however long the input is
+// and the decoding threads are started only once. One
+// line is written per sequence: source:line, log P* and the state path.
+
+#define CLI_CHUNK_STEPS ((size_t)1 << 22)   // Decode once this many symbols are queued
+#define CLI_CHUNK_SEQUENCES 65536           // ... or this many sequences
+#define CLI_OUTPUT_BUFFER (1 << 20)         // Bytes of output buffered between writes
+
+typedef struct {
+    const char* model;
+    const char* output;           // NULL = stdout
+    ViterbiBatchOptions batch;
+    int quiet;                    // Skip the throughput summary
+} CliOptions;
+
+// Sequences read but not decoded yet
+typedef struct {
+    int* symbols;                 // Queued sequences back to back
+    int* path_buffer;             // Their paths, same layout
+    size_t num_symbols;
+    size_t capacity;              // Of symbols and path_buffer
+    size_t starts[CLI_CHUNK_SEQUENCES];
+    int lengths[CLI_CHUNK_SEQUENCES];
+    const char* sources[CLI_CHUNK_SEQUENCES];
+    long lines[CLI_CHUNK_SEQUENCES];
+    const int* sequences[CLI_CHUNK_SEQUENCES];
+    int* paths[CLI_CHUNK_SEQUENCES];
+    double log_probabilities[CLI_CHUNK_SEQUENCES];
+    int count;
+    ViterbiBatchPool* pool;       // Decoding threads, kept for every chunk and file
+} CliQueue;
+
+typedef struct {
+    long long sequences;
+    long long steps;
+    long long failures;           // Lines skipped or sequences not decoded
+    double decode_seconds;
+} CliTotals;
+
+static double cli_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void print_usage(const char* program) {
+    fprintf(stderr,
+            "Uso: %s                       (menú interactivo)\n"
+            "     %s --model MODELO [opciones] [OBSERVACIONES...]\n"
+            "\n"
+            "Decodifica con Viterbi cada línea de los archivos de observaciones\n"
+            "(o de la entrada estándar si no se indica ninguno o se indica '-').\n"
+            "Cada línea es una secuencia de índices o nombres de símbolos.\n"
+            "\n"
+            "  --model FILE       Modelo en texto (clima_ejemplo.txt) o binario (.hmmb)\n"
+            "  --threads N        Hilos de decodificación (por defecto uno por CPU)\n"
+            "  --linear           Viterbi en el dominio lineal (por defecto logarítmico)\n"
+            "  --output FILE      Escribir los caminos en FILE (por defecto stdout)\n"
+            "  --quiet            No mostrar el resumen de rendimiento\n"
+            "\n"
+            "Salida: una línea por secuencia con origen:línea, log P* y los estados.\n",
+            program, program);
+}
+
+static int parse_cli_options(int argc, char** argv, CliOptions* options, int* first_file) {
+    memset(options, 0, sizeof(*options));
+    options->batch = viterbi_batch_default_options();
+    
+    int a = 1;
+    for (; a < argc; a++) {
+        const char* arg = argv[a];
+        const char* value = (a + 1 < argc) ? argv[a + 1] : NULL;
+        
+        if (strcmp(arg, "--") == 0) {
+            a++;
+            break;
+        } else if (arg[0] != '-' || strcmp(arg, "-") == 0) {
+            break;
+        } else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage(argv[0]);
+            exit(0);
+        } else if (strcmp(arg, "--linear") == 0) {
+            options->batch.mode = VITERBI_MODE_LINEAR;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            options->quiet = 1;
+        } else if (value == NULL) {
+            fprintf(stderr, "Error: Falta el valor de %s\n", arg);
+            return -1;
+        } else if (strcmp(arg, "--model") == 0) {
+            options->model = value;
+            a++;
+        } else if (strcmp(arg, "--threads") == 0) {
+            options->batch.num_threads = atoi(value);
+            a++;
+        } else if (strcmp(arg, "--output") == 0) {
+            options->output = value;
+            a++;
+        } else {
+            fprintf(stderr, "Error: Opción desconocida %s\n", arg);
+            return -1;
+        }
+    }
+    
+    if (options->model == NULL) {
+        fprintf(stderr, "Error: Falta --model\n");
+        return -1;
+    }
+    if (options->batch.num_threads < 0) {
+        fprintf(stderr, "Error: --threads debe ser >= 0\n");
+        return -1;
+    }
+    *first_file = a;
+    return 0;
+}
+
+// Binary models are recognized by their magic, anything else is read as text
+static HMM* cli_load_model(const char* path) {
+    char magic[sizeof(HMM_BINARY_MAGIC) - 1];
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Error: No se puede abrir el modelo '%s'\n", path);
+        return NULL;
+    }
+    int binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+                 && memcmp(magic, HMM_BINARY_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    
+    if (binary) {
+        return hmm_binary_load(path, NULL, NULL, 0);
+    }
+    return load_hmm((char*)path);
+}
+
+// Symbol names take precedence over indices when the model has them
+static int parse_symbol(const HMM* hmm, const char* token, int* symbol) {
+    if (hmm_symbol_name(hmm, 0) != NULL) {
+        int k = hmm_symbol_index(hmm, token);
+        if (k >= 0) {
+            *symbol = k;
+            return 1;
+        }
+    }
+    long value = 0;
+    const char* digit = token;
+    for (; *digit >= '0' && *digit <= '9' && value < hmm->num_observations; digit++) {
+        value = value * 10 + (*digit - '0');
+    }
+    if (digit == token || *digit != '\0' || value >= hmm->num_observations) {
+        return 0;
+    }
+    *symbol = (int)value;
+    return 1;
+}
+
+static int queue_reserve(CliQueue* queue, size_t symbols) {
+    if (symbols <= queue->capacity) return 1;
+    
+    size_t capacity = queue->capacity + queue->capacity / 2;
+    if (capacity < symbols) capacity = symbols;
+    int* grown_symbols = (int*)realloc(queue->symbols, capacity * sizeof(int));
+    if (grown_symbols == NULL) return 0;
+    queue->symbols = grown_symbols;
+    int* grown_paths = (int*)realloc(queue->path_buffer, capacity * sizeof(int));
+    if (grown_paths == NULL) return 0;
+    queue->path_buffer = grown_paths;
+    queue->capacity = capacity;
+    return 1;
+}
+
+// Parse one input line and queue it; 1 if queued, 0 if blank, -1 if invalid
+static int queue_line(const HMM* hmm, CliQueue* queue, char* line, const char* source, long number) {
+    char* comment = strchr(line, '#');
+    if (comment != NULL) *comment = '\0';
+    
+    size_t start = queue->num_symbols;
+    size_t end = start;
+    for (char* token = strtok(line, " \t\r\n,"); token != NULL; token = strtok(NULL, " \t\r\n,")) {
+        if (end - start >= (size_t)2147483647) {
+            fprintf(stderr, "Error: %s:%ld: secuencia demasiado larga\n", source, number);
+            return -1;
+        }
+        if (!queue_reserve(queue, end + 1)) {
+            fprintf(stderr, "Error: Sin memoria leyendo %s:%ld\n", source, number);
+            return -1;
+        }
+        if (!parse_symbol(hmm, token, &queue->symbols[end])) {
+            fprintf(stderr, "Error: %s:%ld: símbolo '%s' no válido\n", source, number, token);
+            return -1;
+        }
+        end++;
+    }
+    if (end == start) return 0;
+    
+    int k = queue->count++;
+    queue->starts[k] = start;
+    queue->lengths[k] = (int)(end - start);
+    queue->sources[k] = source;
+    queue->lines[k] = number;
+    queue->num_symbols = end;
+    return 1;
+}
+
+// Paths are formatted into a local buffer and written in blocks: a stdio call
+// per state costs several times more than decoding it
+static void write_path(FILE* out, const HMM* hmm, const char* source, long number,
+                       double log_probability, const int* path, int length) {
+    char text[4096];
+    size_t used = 0;
+    
+    fprintf(out, "%s:%ld\t%.10g\t", source, number, log_probability);
+    for (int t = 0; t < length; t++) {
+        char digits[16];
+        const char* name = hmm_state_name(hmm, path[t]);
+        if (name == NULL) {
+            char* end = digits + sizeof(digits) - 1;
+            unsigned int value = (unsigned int)path[t];
+            *end = '\0';
+            do {
+                *--end = (char)('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            name = end;
+        }
+        
+        size_t name_length = strlen(name);
+        if (used + name_length + 2 > sizeof(text)) {
+            fwrite(text, 1, used, out);
+            used = 0;
+        }
+        if (t > 0) text[used++] = ' ';
+        if (name_length + 2 > sizeof(text)) {
+            fwrite(text, 1, used, out);
+            fputs(name, out);
+            used = 0;
+        } else {
+            memcpy(text + used, name, name_length);
+            used += name_length;
+        }
+    }
+    text[used++] = '\n';
+    fwrite(text, 1, used, out);
+}
+
+// Decode every queued sequence, write the paths and empty the queue
+static int queue_flush(HMM* hmm, CliQueue* queue, FILE* out, CliTotals* totals) {
+    if (queue->count == 0) return 0;
+    
+    // The buffers may have moved while the queue grew
+    for (int k = 0; k < queue->count; k++) {
+        queue->sequences[k] = queue->symbols + queue->starts[k];
+        queue->paths[k] = queue->path_buffer + queue->starts[k];
+    }
+    
+    // A batch that fails before its workers run writes nothing: start from NaN
+    // so every sequence it did not decode is reported as failed
+    for (int k = 0; k < queue->count; k++) queue->log_probabilities[k] = NAN;
+    
+    double start = cli_now();
+    int status = viterbi_batch_pool_decode(queue->pool, hmm, queue->sequences, queue->lengths, queue->count,
+                                           queue->paths, queue->log_probabilities);
+    totals->decode_seconds += cli_now() - start;
+    
+    for (int k = 0; k < queue->count; k++) {
+        // Failed sequences keep a NaN log P*
+        if (queue->log_probabilities[k] != queue->log_probabilities[k]) {
+            fprintf(stderr, "Error: %s:%ld: no se pudo decodificar\n", queue->sources[k], queue->lines[k]);
+            totals->failures++;
+            continue;
+        }
+        write_path(out, hmm, queue->sources[k], queue->lines[k], queue->log_probabilities[k],
+                   queue->paths[k], queue->lengths[k]);
+        totals->sequences++;
+        totals->steps += queue->lengths[k];
+    }
+    
+    queue->count = 0;
+    queue->num_symbols = 0;
+    return status;
+}
+
+static int decode_stream(HMM* hmm, CliQueue* queue, FILE* input, const char* source,
+                         FILE* out, CliTotals* totals) {
+    char* line = NULL;
+    size_t line_capacity = 0;
+    long number = 0;
+    int status = 0;
+    
+    while (getline(&line, &line_capacity, input) != -1) {
+        number++;
+        if (queue_line(hmm, queue, line, source, number) < 0) {
+            totals->failures++;
+            continue;
+        }
+        if (queue->count == CLI_CHUNK_SEQUENCES || queue->num_symbols >= CLI_CHUNK_STEPS) {
+            status |= queue_flush(hmm, queue, out, totals);
+        }
+    }
+    
+    if (ferror(input)) {
+        fprintf(stderr, "Error: Fallo de lectura en '%s'\n", source);
+        status = -1;
+    }
+    free(line);
+    return status;
+}
+
+static int run_batch(int argc, char** argv) {
+    CliOptions options;
+    int first_file;
+    if (parse_cli_options(argc, argv, &options, &first_file) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    double start = cli_now();
+    HMM* hmm = cli_load_model(options.model);
+    if (hmm == NULL) {
+        fprintf(stderr, "Error: No se pudo cargar el modelo '%s'\n", options.model);
+        return 1;
+    }
+    
+    FILE* out = stdout;
+    if (options.output != NULL && (out = fopen(options.output, "w")) == NULL) {
+        fprintf(stderr, "Error: No se puede abrir '%s' para escritura\n", options.output);
+        free_hmm(hmm);
+        return 1;
+    }
+    setvbuf(out, NULL, _IOFBF, CLI_OUTPUT_BUFFER);
+    
+    CliQueue* queue = (CliQueue*)calloc(1, sizeof(CliQueue));
+    if (queue != NULL && (queue->pool = viterbi_batch_pool_create(&options.batch)) == NULL) {
+        free(queue);
+        queue = NULL;
+    }
+    if (queue == NULL) {
+        fprintf(stderr, "Error: Sin memoria\n");
+        if (out != stdout) fclose(out);
+        free_hmm(hmm);
+        return 1;
+    }
+    
+    CliTotals totals = {0, 0, 0, 0.0};
+    int status = 0;
+    int num_files = argc - first_file;
+    for (int f = 0; f < (num_files > 0 ? num_files : 1); f++) {
+        const char* source = num_files > 0 ? argv[first_file + f] : "-";
+        if (strcmp(source, "-") == 0) {
+            status |= decode_stream(hmm, queue, stdin, "-", out, &totals);
+            continue;
+        }
+        
+        FILE* input = fopen(source, "r");
+        if (input == NULL) {
+            fprintf(stderr, "Error: No se puede abrir '%s'\n", source);
+            status = -1;
+            continue;
+        }
+        status |= decode_stream(hmm, queue, input, source, out, &totals);
+        // Flush before closing: the queue still points at this file's name
+        status |= queue_flush(hmm, queue, out, &totals);
+        fclose(input);
+    }
+    status |= queue_flush(hmm, queue, out, &totals);
+    
+    if (fflush(out) != 0 || ferror(out)) {
+        fprintf(stderr, "Error: Fallo de escritura\n");
+        status = -1;
+    }
+    if (out != stdout) fclose(out);
+    double elapsed = cli_now() - start;
+    
+    if (!options.quiet) {
+        int threads = options.batch.num_threads > 0 ? options.batch.num_threads : hmm_online_cpus();
+        double decode = totals.decode_seconds > 0.0 ? totals.decode_seconds : 1e-9;
+        fprintf(stderr, "Secuencias: %lld, pasos: %lld, errores: %lld (%d hilos, modo %s)\n",
+                totals.sequences, totals.steps, totals.failures, threads,
+                options.batch.mode == VITERBI_MODE_LINEAR ? "lineal" : "logarítmico");
+        fprintf(stderr, "Decodificación: %.3f s, %.0f secuencias/s, %.0f pasos/s\n",
+                totals.decode_seconds, totals.sequences / decode, totals.steps / decode);
+        fprintf(stderr, "Total (carga, lectura y escritura): %.3f s, %.0f secuencias/s, %.0f pasos/s\n",
+                elapsed, totals.sequences / elapsed, totals.steps / elapsed);
+    }
+    
+    viterbi_batch_pool_free(queue->pool);
+    free(queue->symbols);
+    free(queue->path_buffer);
+    free(queue);
+    free_hmm(hmm);
+    return status != 0 || totals.failures > 0 ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return run_batch(argc, argv);
+    }
+    return run_menu();
+}
@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "arena.h"
+#include "hmm.h"
+#include "bayesian.h"
+
+#define SMALL_ALLOCATIONS 100000
+
+static int all_zero(const unsigned char* bytes, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (bytes[i] != 0) return 0;
+    }
+    return 1;
+}
+
+// Many small objects: aligned, zero-filled, disjoint, and few blocks
+static int check_small(Arena* arena) {
+    int failures = 0;
+    unsigned char* previous = NULL;
+    size_t requested = 0;
+    
+    for (int i = 0; i < SMALL_ALLOCATIONS; i++) {
+        size_t size = 1 + (size_t)(i % 40);
+        unsigned char* bytes = (unsigned char*)arena_alloc(arena, size);
+        if (bytes == NULL || (uintptr_t)bytes % ARENA_DEFAULT_ALIGNMENT != 0 || !all_zero(bytes, size)) {
+            printf("Small allocation %d is NULL, misaligned or not zero-filled\n", i);
+            return failures + 1;
+        }
+        if (previous != NULL && bytes == previous) failures++;
+        memset(bytes, 0xAB, size);
+        previous = bytes;
+        requested += size;
+    }
+    
+    ArenaStats stats;
+    arena_stats(arena, &stats);
+    if (stats.allocations != SMALL_ALLOCATIONS || stats.requested_bytes != requested
+        || stats.used_bytes < requested || stats.reserved_bytes < stats.used_bytes) {
+        printf("Arena counters do not add up\n");
+        failures++;
+    }
+    // 1.5x growth from 1 KiB: about 20 blocks for ~3 MB
+    if (stats.blocks > 32) {
+        printf("Arena used %zu blocks for %d allocations\n", stats.blocks, SMALL_ALLOCATIONS);
+        failures++;
+    }
+    arena_print_stats(arena, "small objects");
+    return failures;
+}
+
+static int check_aligned(Arena* arena) {
+    int failures = 0;
+    
+    arena_alloc(arena, 3);
+    double* row = (double*)arena_alloc_aligned(arena, 100 * sizeof(double), 64);
+    if (row == NULL || (uintptr_t)row % 64 != 0) failures++;
+    
+    // Larger than any block so far: gets a block of its own
+    size_t large = 8u << 20;
+    unsigned char* bytes = (unsigned char*)arena_alloc_aligned(arena, large, 64);
+    if (bytes == NULL || (uintptr_t)bytes % 64 != 0 || !all_zero(bytes, large)) failures++;
+    
+    // Zero-byte requests still get pointers of their own
+    void* empty = arena_alloc(arena, 0);
+    void* after = arena_alloc(arena, 0);
+    if (empty == NULL || after == NULL || empty == after) {
+        printf("Zero-byte allocations share a pointer\n");
+        failures++;
+    }
+    
+    char* copy = arena_strdup(arena, "nublado");
+    if (copy == NULL || strcmp(copy, "nublado") != 0) failures++;
+    
+    if (arena_alloc_aligned(arena, 8, 3) != NULL || arena_alloc_aligned(arena, 8, 128) != NULL) {
+        printf("Invalid alignments were accepted\n");
+        failures++;
+    }
+    return failures;
+}
+
+// Reset keeps the first block and hands it out again zero-filled
+static int check_reset(Arena* arena) {
+    arena_reset(arena);
+    
+    ArenaStats stats;
+    arena_stats(arena, &stats);
+    if (stats.blocks != 1 || stats.allocations != 0 || stats.used_bytes != 0) {
+        printf("Reset left %zu blocks, %zu allocations\n", stats.blocks, stats.allocations);
+        return 1;
+    }
+    unsigned char* bytes = (unsigned char*)arena_alloc(arena, 512);
+    if (bytes == NULL || !all_zero(bytes, 512)) return 1;
+    
+    // Refilling after each reset reserves the same memory every cycle
+    size_t reserved = 0;
+    for (int cycle = 0; cycle < 50; cycle++) {
+        arena_reset(arena);
+        for (int i = 0; i < 64; i++) {
+            if (arena_alloc(arena, 1000) == NULL) return 1;
+        }
+        arena_stats(arena, &stats);
+        if (cycle == 0) reserved = stats.reserved_bytes;
+        if (stats.reserved_bytes != reserved) {
+            printf("Reset cycle %d reserved %zu bytes, the first one %zu\n", cycle, stats.reserved_bytes, reserved);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// A model and everything attached to it come from one arena
+static int check_hmm(void) {
+    int failures = 0;
+    HMM* hmm = allocate_hmm(64, 5, 10);
+    if (hmm == NULL || hmm->arena == NULL) return 1;
+    
+    ArenaStats stats;
+    arena_stats(hmm->arena, &stats);
+    if (stats.blocks != 1 || stats.allocations != 1) {
+        printf("allocate_hmm took %zu blocks and %zu allocations\n", stats.blocks, stats.allocations);
+        failures++;
+    }
+    
+    const char* states[64];
+    char names[64][8];
+    for (int i = 0; i < 64; i++) {
+        snprintf(names[i], sizeof(names[i]), "s%d", i);
+        states[i] = names[i];
+    }
+    if (!hmm_set_names(hmm, states, NULL) || !hmm_set_precision(hmm, HMM_PRECISION_FLOAT)
+        || strcmp(hmm_state_name(hmm, 17), "s17") != 0) {
+        failures++;
+    }
+    arena_stats(hmm->arena, &stats);
+    if (stats.allocations != 3) failures++;
+    
+    free_hmm(hmm);
+    return failures;
+}
+
+static int check_bayesian(void) {
+    Arena* memoria = arena_create(0);
+    struct nodo* lista = NULL;
+    char nombre[16];
+    
+    for (int i = 0; i < 50; i++) {
+        snprintf(nombre, sizeof(nombre), "v%d", i);
+        insertar_nodo(&lista, crear_nodo(memoria, i, nombre));
+    }
+    insertar_hijos(&lista, crear_nodo(memoria, 0, "v7"), buscar_padre(&lista, "v3"));
+    insertar_probabilidad(&lista, 3, crear_nodo_probabilidad(memoria, "v7", 0.8f, 0.1f));
+    
+    int failures = buscar_padre(&lista, "v42") != 42 || lista->sig->sig->sig->hijos == NULL
+                || lista->sig->sig->sig->tabla->prob_v != 0.8f;
+    arena_destroy(memoria);
+    return failures;
+}
+
+int main() {
+    printf("=== TESTING ARENA ALLOCATOR ===\n");
+    
+    int failures = 0;
+    Arena* arena = arena_create(1024);
+    if (arena == NULL) {
+        printf("\n=== Arena - FAILED ===\n");
+        return -1;
+    }
+    
+    failures += check_small(arena);
+    failures += check_aligned(arena);
+    failures += check_reset(arena);
+    arena_destroy(arena);
+    arena_destroy(NULL);
+    
+    failures += check_hmm();
+    failures += check_bayesian();
+    
+    if (failures == 0) {
+        printf("\n=== Arena - SUCCESS ===\n");
+        return 0;
+    }
+    printf("\n=== Arena - FAILED (%d) ===\n", failures);
+    return -1;
+}
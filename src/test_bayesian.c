@@ -0,0 +1,634 @@
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+#include "bayesian.h"
+#include "bayesian_red.h"
+#include "bayesian_eliminacion.h"
+#include "bayesian_arbol.h"
+
+#define LARGE_NODES 100000
+#define RANDOM_NODES 9
+#define CHAIN_NODES 20000
+#define TREE_NODES 5000
+
+static unsigned semilla_global = 2024;
+
+static double next_uniform(void) {
+    semilla_global = semilla_global * 1103515245u + 12345u;
+    return ((semilla_global >> 8) & 0xFFFFFF) / 16777216.0;
+}
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Small network: lookups, duplicate edges, CSR order and topological order
+static int check_indexed_network(void) {
+    int failures = 0;
+    RedBayesiana *red = red_crear(0);
+    if (red == NULL) return 1;
+    
+    const char *nombres[] = {"lluvia", "aspersor", "cesped_mojado", "nublado", "resbalon"};
+    for (int i = 0; i < 5; i++) {
+        if (red_agregar_nodo(red, nombres[i]) != i) failures++;
+    }
+    if (red_agregar_nodo(red, "lluvia") != -1 || red_agregar_nodo(red, "dos palabras") != -1) {
+        printf("Duplicate or invalid names were accepted\n");
+        failures++;
+    }
+    for (int i = 0; i < 5; i++) {
+        if (red_buscar(red, nombres[i]) != i || strcmp(red_nombre(red, i), nombres[i]) != 0) failures++;
+    }
+    if (red_buscar(red, "granizo") != -1) failures++;
+    
+    int nublado = red_buscar(red, "nublado");
+    int lluvia = red_buscar(red, "lluvia");
+    int aspersor = red_buscar(red, "aspersor");
+    int cesped = red_buscar(red, "cesped_mojado");
+    red_agregar_arista(red, nublado, lluvia);
+    red_agregar_arista(red, nublado, aspersor);
+    red_agregar_arista(red, lluvia, cesped);
+    red_agregar_arista(red, aspersor, cesped);
+    red_agregar_arista(red, lluvia, cesped);              // Repeated
+    red_agregar_arista(red, cesped, red_buscar(red, "resbalon"));
+    if (red_agregar_arista(red, lluvia, lluvia) || red_agregar_arista(red, 0, 99)) failures++;
+    if (red_padres(red, cesped, NULL) != NULL) failures++;  // Not compiled yet
+    
+    if (!red_compilar(red) || red->num_aristas != 5) {
+        printf("Compilation failed or kept a repeated edge\n");
+        red_destruir(red);
+        return failures + 1;
+    }
+    
+    int cantidad;
+    const int *padres = red_padres(red, cesped, &cantidad);
+    if (cantidad != 2 || padres[0] != lluvia || padres[1] != aspersor) failures++;
+    const int *hijos = red_hijos(red, nublado, &cantidad);
+    if (cantidad != 2 || hijos[0] != lluvia || hijos[1] != aspersor) failures++;
+    
+    int posicion[5];
+    for (int k = 0; k < 5; k++) posicion[red->orden[k]] = k;
+    for (int e = 0; e < red->num_aristas; e++) {
+        if (posicion[red->arista_padre[e]] >= posicion[red->arista_hijo[e]]) failures++;
+    }
+    
+    // A cycle is rejected
+    red_agregar_arista(red, red_buscar(red, "resbalon"), nublado);
+    if (red_compilar(red) || red_padres(red, cesped, NULL) != NULL) {
+        printf("A cycle was not detected\n");
+        failures++;
+    }
+    red_destruir(red);
+    return failures;
+}
+
+// The example's linked list converts to the same graph
+static int check_from_list(void) {
+    Arena *memoria = arena_create(0);
+    struct nodo *lista = NULL;
+    insertar_nodo(&lista, crear_nodo(memoria, 0, "a"));
+    insertar_nodo(&lista, crear_nodo(memoria, 1, "b"));
+    insertar_nodo(&lista, crear_nodo(memoria, 2, "c"));
+    insertar_hijos(&lista, crear_nodo(memoria, 0, "c"), 0);
+    insertar_hijos(&lista, crear_nodo(memoria, 0, "c"), 1);
+    insertar_hijos(&lista, crear_nodo(memoria, 0, "d"), 2);  // Not declared: added
+    
+    int failures = 0;
+    RedBayesiana *red = red_desde_lista(lista);
+    int cantidad = 0;
+    if (red == NULL || red->num_nodos != 4 || red->num_aristas != 3
+        || red_padres(red, red_buscar(red, "c"), &cantidad) == NULL || cantidad != 2
+        || red_padres(red, red_buscar(red, "d"), &cantidad)[0] != red_buscar(red, "c")) {
+        printf("red_desde_lista built a different graph\n");
+        failures++;
+    }
+    // Single-parent children take their table from the V/F pair
+    insertar_probabilidad(&lista, 2, crear_nodo_probabilidad(memoria, "d", 0.9f, 0.2f));
+    RedBayesiana *con_tablas = red_desde_lista(lista);
+    const double *tabla = con_tablas != NULL ? red_tabla(con_tablas, red_buscar(con_tablas, "d"), NULL) : NULL;
+    if (tabla == NULL || fabs(tabla[1] - 0.2) > 1e-6 || fabs(tabla[3] - 0.9) > 1e-6
+        || fabs(tabla[0] + tabla[1] - 1.0) > 1e-12) {
+        printf("red_desde_lista did not convert the V/F probabilities\n");
+        failures++;
+    }
+    red_destruir(con_tablas);
+    red_destruir(red);
+    arena_destroy(memoria);
+    return failures;
+}
+
+// Multi-valued variables with several parents: strides, row access and a
+// joint distribution that sums to 1
+static int check_tables(void) {
+    int failures = 0;
+    RedBayesiana *red = red_crear(0);
+    int estacion = red_agregar_nodo(red, "estacion");    // 4 states
+    int lluvia = red_agregar_nodo(red, "lluvia");        // 3 states
+    int aspersor = red_agregar_nodo(red, "aspersor");    // 2 states
+    int cesped = red_agregar_nodo(red, "cesped");        // 2 states, parents lluvia and aspersor
+    red_fijar_estados(red, estacion, 4);
+    red_fijar_estados(red, lluvia, 3);
+    if (red_fijar_estados(red, lluvia, 1)) failures++;
+    red_agregar_arista(red, estacion, lluvia);
+    red_agregar_arista(red, estacion, aspersor);
+    red_agregar_arista(red, lluvia, cesped);
+    red_agregar_arista(red, aspersor, cesped);
+    if (!red_compilar(red)) {
+        red_destruir(red);
+        return failures + 1;
+    }
+    
+    size_t filas;
+    const double *tabla = red_tabla(red, cesped, &filas);
+    if (tabla == NULL || filas != 6 || tabla[0] != 0.5) failures++;
+    red_tabla(red, lluvia, &filas);
+    if (filas != 4) failures++;
+    red_tabla(red, estacion, &filas);
+    if (filas != 1) failures++;
+    
+    double prior[4] = {0.1, 0.2, 0.3, 0.4};
+    double lluvia_tabla[12] = {0.6, 0.3, 0.1,  0.2, 0.5, 0.3,  0.1, 0.1, 0.8,  0.7, 0.2, 0.1};
+    double aspersor_tabla[8] = {0.9, 0.1,  0.5, 0.5,  0.2, 0.8,  0.95, 0.05};
+    double malo[2] = {0.5, 0.6};
+    red_fijar_tabla(red, estacion, prior);
+    red_fijar_tabla(red, lluvia, lluvia_tabla);
+    red_fijar_tabla(red, aspersor, aspersor_tabla);
+    if (red_fijar_tabla(red, aspersor, lluvia_tabla + 1)) failures++;  // Rows do not sum to 1
+    for (int l = 0; l < 3; l++) {
+        for (int a = 0; a < 2; a++) {
+            int padres[2] = {l, a};
+            double mojado = 0.1 * l + 0.3 * a + 0.05;
+            double fila[2] = {1.0 - mojado, mojado};
+            if (!red_fijar_fila(red, cesped, padres, fila)) failures++;
+        }
+    }
+    int fuera[2] = {3, 0};
+    int dentro[2] = {0, 0};
+    double fila_valida[2] = {0.5, 0.5};
+    if (red_fijar_fila(red, cesped, fuera, fila_valida) || red_fijar_fila(red, cesped, dentro, malo)) failures++;
+    
+    // Row (lluvia = 2, aspersor = 1) sits at 2 * 2 + 1
+    if (fabs(red_tabla(red, cesped, NULL)[5 * 2 + 1] - 0.55) > 1e-12) failures++;
+    
+    double suma = 0.0;
+    int asignacion[4];
+    for (int e = 0; e < 4; e++) {
+        for (int l = 0; l < 3; l++) {
+            for (int a = 0; a < 2; a++) {
+                for (int c = 0; c < 2; c++) {
+                    asignacion[estacion] = e;
+                    asignacion[lluvia] = l;
+                    asignacion[aspersor] = a;
+                    asignacion[cesped] = c;
+                    double esperado = prior[e] * lluvia_tabla[e * 3 + l] * aspersor_tabla[e * 2 + a]
+                                    * (c ? 0.1 * l + 0.3 * a + 0.05 : 0.95 - 0.1 * l - 0.3 * a);
+                    double p = red_probabilidad_conjunta(red, asignacion);
+                    if (fabs(p - esperado) > 1e-12) failures++;
+                    suma += p;
+                }
+            }
+        }
+    }
+    if (fabs(suma - 1.0) > 1e-12) {
+        printf("Joint distribution sums to %.15f\n", suma);
+        failures++;
+    }
+    
+    // Changing the number of states reshapes the tables on the next compilation
+    red_fijar_estados(red, aspersor, 3);
+    if (red_tabla(red, cesped, NULL) != NULL || !red_compilar(red)) failures++;
+    red_tabla(red, cesped, &filas);
+    if (filas != 9) failures++;
+    red_destruir(red);
+    return failures;
+}
+
+// Random multi-valued DAG with random tables
+static RedBayesiana *random_network(int nodos) {
+    char nombre[16];
+    RedBayesiana *red = red_crear(nodos);
+    for (int v = 0; v < nodos; v++) {
+        snprintf(nombre, sizeof(nombre), "x%d", v);
+        red_agregar_nodo(red, nombre);
+        red_fijar_estados(red, v, 2 + (int)(next_uniform() * 2));
+        for (int p = 0; p < v; p++) {
+            if (next_uniform() < 0.35) red_agregar_arista(red, p, v);
+        }
+    }
+    if (!red_compilar(red)) {
+        red_destruir(red);
+        return NULL;
+    }
+    for (int v = 0; v < nodos; v++) {
+        size_t filas;
+        int estados = red->estados[v];
+        red_tabla(red, v, &filas);
+        double *tabla = (double *)malloc(filas * estados * sizeof(double));
+        for (size_t f = 0; f < filas; f++) {
+            double suma = 0.0;
+            for (int e = 0; e < estados; e++) suma += (tabla[f * estados + e] = 0.05 + next_uniform());
+            for (int e = 0; e < estados; e++) tabla[f * estados + e] /= suma;
+        }
+        red_fijar_tabla(red, v, tabla);
+        free(tabla);
+    }
+    return red;
+}
+
+// P(consulta | evidencia) and P(evidencia) by enumerating every assignment
+static double brute_force(const RedBayesiana *red, int consulta, const int *evidencia, double *distribucion) {
+    int asignacion[RANDOM_NODES] = {0};
+    double evidencia_total = 0.0;
+    for (int e = 0; e < red->estados[consulta]; e++) distribucion[e] = 0.0;
+    for (;;) {
+        int compatible = 1;
+        for (int v = 0; v < red->num_nodos; v++) {
+            if (evidencia[v] >= 0 && asignacion[v] != evidencia[v]) compatible = 0;
+        }
+        if (compatible) {
+            double p = red_probabilidad_conjunta(red, asignacion);
+            distribucion[asignacion[consulta]] += p;
+            evidencia_total += p;
+        }
+        int v = red->num_nodos - 1;
+        while (v >= 0 && ++asignacion[v] == red->estados[v]) asignacion[v--] = 0;
+        if (v < 0) break;
+    }
+    for (int e = 0; e < red->estados[consulta]; e++) distribucion[e] /= evidencia_total;
+    return evidencia_total;
+}
+
+// Variable elimination agrees with enumeration; the order is computed once
+static int check_elimination(void) {
+    int failures = 0;
+    for (int caso = 0; caso < 20; caso++) {
+        RedBayesiana *red = random_network(RANDOM_NODES);
+        Eliminacion *motor = eliminacion_crear(red, caso % 2 == 0 ? ORDEN_MIN_RELLENO : ORDEN_MIN_PESO);
+        if (motor == NULL) {
+            red_destruir(red);
+            return failures + 1;
+        }
+        
+        for (int q = 0; q < 10; q++) {
+            int evidencia[RANDOM_NODES];
+            int consulta = (int)(next_uniform() * RANDOM_NODES);
+            for (int v = 0; v < RANDOM_NODES; v++) {
+                evidencia[v] = next_uniform() < 0.3 ? (int)(next_uniform() * red->estados[v]) : -1;
+            }
+            double esperada[3], obtenida[3], log_evidencia;
+            double p_evidencia = brute_force(red, consulta, evidencia, esperada);
+            if (eliminacion_consultar(motor, consulta, evidencia, obtenida, &log_evidencia) != 0
+                || fabs(log_evidencia - log(p_evidencia)) > 1e-9) {
+                printf("Case %d query %d: P(e) differs\n", caso, q);
+                failures++;
+                continue;
+            }
+            for (int e = 0; e < red->estados[consulta]; e++) {
+                if (fabs(obtenida[e] - esperada[e]) > 1e-9) {
+                    printf("Case %d query %d: P(x%d=%d | e) = %.12f, expected %.12f\n",
+                           caso, q, consulta, e, obtenida[e], esperada[e]);
+                    failures++;
+                }
+            }
+        }
+        if (motor->calculos_orden != 1) failures++;
+        
+        // Recompiling invalidates the cached order
+        red_agregar_nodo(red, "extra");
+        red_agregar_arista(red, 0, RANDOM_NODES);
+        red_compilar(red);
+        double distribucion[2];
+        if (eliminacion_consultar(motor, RANDOM_NODES, NULL, distribucion, NULL) != 0
+            || motor->calculos_orden != 2 || fabs(distribucion[0] - 0.5) > 1e-12) {
+            printf("The elimination order was not refreshed after recompiling\n");
+            failures++;
+        }
+        eliminacion_destruir(motor);
+        red_destruir(red);
+    }
+    
+    // Impossible evidence is reported
+    RedBayesiana *red = red_crear(0);
+    red_agregar_nodo(red, "a");
+    red_agregar_nodo(red, "b");
+    red_agregar_arista(red, 0, 1);
+    red_compilar(red);
+    double determinista[4] = {1.0, 0.0, 0.0, 1.0};
+    red_fijar_tabla(red, 1, determinista);
+    Eliminacion *motor = eliminacion_crear(red, ORDEN_MIN_RELLENO);
+    int evidencia[2] = {0, 1};
+    double distribucion[2];
+    if (eliminacion_consultar(motor, 0, evidencia, distribucion, NULL) != -1) failures++;
+    eliminacion_destruir(motor);
+    red_destruir(red);
+    return failures;
+}
+
+// Long chain with evidence at the end: P(e) would underflow without rescaling,
+// and the posterior of the first variable has a closed form
+static int check_elimination_chain(void) {
+    int failures = 0;
+    char nombre[32];
+    RedBayesiana *red = red_crear(CHAIN_NODES);
+    for (int v = 0; v < CHAIN_NODES; v++) {
+        snprintf(nombre, sizeof(nombre), "c%d", v);
+        red_agregar_nodo(red, nombre);
+        if (v > 0) red_agregar_arista(red, v - 1, v);
+    }
+    red_compilar(red);
+    double prior[2] = {0.3, 0.7};
+    double transicion[4] = {0.99, 0.01, 0.02, 0.98};
+    red_fijar_tabla(red, 0, prior);
+    for (int v = 1; v < CHAIN_NODES; v++) red_fijar_tabla(red, v, transicion);
+    
+    // (Tⁿ)[x][1] by repeated multiplication
+    double a = 0.0, b = 1.0;  // P(último = 1 | actual = 0), P(último = 1 | actual = 1)
+    for (int v = 1; v < CHAIN_NODES; v++) {
+        double a2 = transicion[0] * a + transicion[1] * b;
+        double b2 = transicion[2] * a + transicion[3] * b;
+        a = a2;
+        b = b2;
+    }
+    double esperado = prior[1] * b / (prior[0] * a + prior[1] * b);
+    
+    int *evidencia = (int *)malloc(CHAIN_NODES * sizeof(int));
+    for (int v = 0; v < CHAIN_NODES; v++) evidencia[v] = v % 100 == 99 ? 1 : -1;
+    evidencia[CHAIN_NODES - 1] = 1;
+    
+    clock_t start = clock();
+    Eliminacion *motor = eliminacion_crear(red, ORDEN_MIN_RELLENO);
+    double distribucion[2], log_evidencia;
+    int estado = eliminacion_consultar(motor, 0, evidencia, distribucion, &log_evidencia);
+    if (estado != 0 || !isfinite(log_evidencia) || log_evidencia > -10.0 || motor->ancho > 2) {
+        printf("Chain: status %d, log P(e) = %g, width %d\n", estado, log_evidencia, motor->ancho);
+        failures++;
+    }
+    
+    // Only the last observation matters for the first variable given evidence
+    // at the last one alone
+    for (int v = 0; v < CHAIN_NODES - 1; v++) evidencia[v] = -1;
+    if (eliminacion_consultar(motor, 0, evidencia, distribucion, NULL) != 0
+        || fabs(distribucion[1] - esperado) > 1e-9) {
+        printf("Chain: P(c0 = 1 | last = 1) = %.12f, expected %.12f\n", distribucion[1], esperado);
+        failures++;
+    }
+    printf("Chain of %d variables: order width %d, two queries in %.3f s\n",
+           CHAIN_NODES, motor->ancho, seconds_since(start));
+    eliminacion_destruir(motor);
+    free(evidencia);
+    red_destruir(red);
+    return failures;
+}
+
+// One calibration gives every marginal and P(e), equal to enumeration, with
+// any number of threads; networks with several components make a forest
+static int check_junction_tree(void) {
+    int failures = 0;
+    for (int caso = 0; caso < 24; caso++) {
+        RedBayesiana *red = random_network(RANDOM_NODES);
+        ArbolUniones *arbol = arbol_crear(red, 1 + caso % 4);
+        if (arbol == NULL) {
+            red_destruir(red);
+            return failures + 1;
+        }
+        
+        for (int q = 0; q < 10; q++) {
+            int evidencia[RANDOM_NODES];
+            for (int v = 0; v < RANDOM_NODES; v++) {
+                evidencia[v] = next_uniform() < 0.3 ? (int)(next_uniform() * red->estados[v]) : -1;
+            }
+            double log_evidencia;
+            if (arbol_calibrar(arbol, q == 0 ? NULL : evidencia, &log_evidencia) != 0) {
+                printf("Case %d calibration %d failed\n", caso, q);
+                failures++;
+                continue;
+            }
+            if (q == 0) {
+                for (int v = 0; v < RANDOM_NODES; v++) evidencia[v] = -1;
+            }
+            for (int v = 0; v < RANDOM_NODES; v++) {
+                double esperada[3], obtenida[3];
+                double p_evidencia = brute_force(red, v, evidencia, esperada);
+                if (v == 0 && fabs(log_evidencia - log(p_evidencia)) > 1e-9) {
+                    printf("Case %d calibration %d: log P(e) = %.12f, expected %.12f\n",
+                           caso, q, log_evidencia, log(p_evidencia));
+                    failures++;
+                }
+                if (arbol_marginal(arbol, v, obtenida) != 0) failures++;
+                for (int e = 0; e < red->estados[v]; e++) {
+                    if (fabs(obtenida[e] - esperada[e]) > 1e-9) {
+                        printf("Case %d calibration %d: P(x%d=%d | e) = %.12f, expected %.12f\n",
+                               caso, q, v, e, obtenida[e], esperada[e]);
+                        failures++;
+                    }
+                }
+            }
+        }
+        
+        // New tables are loaded without rebuilding the tree
+        double nueva[3];
+        int sin_evidencia[RANDOM_NODES];
+        for (int e = 0; e < red->estados[0]; e++) nueva[e] = e == 0 ? 0.6 : 0.4 / (red->estados[0] - 1);
+        for (int v = 0; v < RANDOM_NODES; v++) sin_evidencia[v] = -1;
+        red_fijar_tabla(red, 0, nueva);
+        if (!arbol_cargar_tablas(arbol) || arbol_calibrar(arbol, NULL, NULL) != 0) failures++;
+        for (int v = 0; v < RANDOM_NODES; v++) {
+            double esperada[3], obtenida[3];
+            brute_force(red, v, sin_evidencia, esperada);
+            arbol_marginal(arbol, v, obtenida);
+            for (int e = 0; e < red->estados[v]; e++) {
+                if (fabs(obtenida[e] - esperada[e]) > 1e-9) {
+                    printf("Case %d: P(x%d=%d) = %.12f after reloading the tables, expected %.12f\n",
+                           caso, v, e, obtenida[e], esperada[e]);
+                    failures++;
+                }
+            }
+        }
+        
+        // Recompiling the network invalidates the tree
+        red_agregar_nodo(red, "extra");
+        red_compilar(red);
+        double distribucion[2];
+        if (arbol_calibrar(arbol, NULL, NULL) != -1 || arbol_marginal(arbol, 0, distribucion) != -1
+            || arbol_cargar_tablas(arbol) != 0) {
+            printf("The junction tree accepted a recompiled network\n");
+            failures++;
+        }
+        arbol_destruir(arbol);
+        red_destruir(red);
+    }
+    
+    // Impossible evidence is reported
+    RedBayesiana *red = red_crear(0);
+    red_agregar_nodo(red, "a");
+    red_agregar_nodo(red, "b");
+    red_agregar_nodo(red, "suelto");
+    red_agregar_arista(red, 0, 1);
+    red_compilar(red);
+    double determinista[4] = {1.0, 0.0, 0.0, 1.0};
+    red_fijar_tabla(red, 1, determinista);
+    ArbolUniones *arbol = arbol_crear(red, 2);
+    int evidencia[3] = {0, 1, -1};
+    double distribucion[2];
+    if (arbol == NULL || arbol->num_cliques != 2 || arbol_calibrar(arbol, evidencia, NULL) != -1
+        || arbol_marginal(arbol, 0, distribucion) != -1) {
+        printf("Impossible evidence was not reported by the junction tree\n");
+        failures++;
+    }
+    evidencia[1] = 0;
+    if (arbol == NULL || arbol_calibrar(arbol, evidencia, NULL) != 0
+        || arbol_marginal(arbol, 2, distribucion) != 0 || fabs(distribucion[0] - 0.5) > 1e-12) {
+        failures++;
+    }
+    arbol_destruir(arbol);
+    red_destruir(red);
+    return failures;
+}
+
+// Thousands of variables with local parents: a wide, bushy tree calibrated in
+// parallel agrees with variable elimination and is fast per evidence set
+static int check_junction_tree_large(void) {
+    int failures = 0;
+    char nombre[32];
+    RedBayesiana *red = red_crear(TREE_NODES);
+    for (int v = 0; v < TREE_NODES; v++) {
+        snprintf(nombre, sizeof(nombre), "t%d", v);
+        red_agregar_nodo(red, nombre);
+        red_fijar_estados(red, v, 2 + v % 2);
+        // Parents among the previous ones in the same half: a forest of two trees
+        for (int k = 0; k < 2 && v % 2500 > 0; k++) {
+            int atras = 1 + (int)(next_uniform() * 6);
+            if (atras <= v % 2500) red_agregar_arista(red, v - atras, v);
+        }
+    }
+    red_compilar(red);
+    for (int v = 0; v < TREE_NODES; v++) {
+        size_t filas;
+        int estados = red->estados[v];
+        red_tabla(red, v, &filas);
+        double *tabla = (double *)malloc(filas * estados * sizeof(double));
+        for (size_t f = 0; f < filas; f++) {
+            double suma = 0.0;
+            for (int e = 0; e < estados; e++) suma += (tabla[f * estados + e] = 0.05 + next_uniform());
+            for (int e = 0; e < estados; e++) tabla[f * estados + e] /= suma;
+        }
+        red_fijar_tabla(red, v, tabla);
+        free(tabla);
+    }
+    
+    clock_t start = clock();
+    ArbolUniones *arbol = arbol_crear(red, 4);
+    Eliminacion *motor = eliminacion_crear(red, ORDEN_MIN_RELLENO);
+    if (arbol == NULL || motor == NULL) {
+        arbol_destruir(arbol);
+        eliminacion_destruir(motor);
+        red_destruir(red);
+        return 1;
+    }
+    printf("Junction tree: %d cliques, width %d, %.0f entries, %d subtrees on %d threads "
+           "(%d cliques above them), compiled in %.3f s\n",
+           arbol->num_cliques, arbol->ancho, arbol->entradas, arbol->num_subarboles, arbol->num_hilos,
+           arbol->num_cima, seconds_since(start));
+    if (arbol->num_cima == 0) failures++;
+    
+    int *evidencia = (int *)malloc(TREE_NODES * sizeof(int));
+    for (int caso = 0; caso < 3; caso++) {
+        for (int v = 0; v < TREE_NODES; v++) {
+            evidencia[v] = next_uniform() < 0.1 ? (int)(next_uniform() * red->estados[v]) : -1;
+        }
+        double log_arbol, log_eliminacion;
+        if (arbol_calibrar(arbol, evidencia, &log_arbol) != 0) {
+            failures++;
+            continue;
+        }
+        for (int i = 0; i < 40; i++) {
+            int v = (int)(next_uniform() * TREE_NODES);
+            double esperada[3], obtenida[3];
+            if (eliminacion_consultar(motor, v, evidencia, esperada, &log_eliminacion) != 0
+                || arbol_marginal(arbol, v, obtenida) != 0
+                || fabs(log_arbol - log_eliminacion) > 1e-7 * fabs(log_eliminacion)) {
+                printf("Large tree: query on t%d failed (log P(e) %.9f vs %.9f)\n",
+                       v, log_arbol, log_eliminacion);
+                failures++;
+                continue;
+            }
+            for (int e = 0; e < red->estados[v]; e++) {
+                if (fabs(obtenida[e] - esperada[e]) > 1e-9) {
+                    printf("Large tree: P(t%d=%d | e) = %.12f, expected %.12f\n", v, e, obtenida[e], esperada[e]);
+                    failures++;
+                }
+            }
+        }
+    }
+    
+    start = clock();
+    double distribucion[3];
+    for (int caso = 0; caso < 100; caso++) {
+        evidencia[(int)(next_uniform() * TREE_NODES)] = -1;
+        if (arbol_calibrar(arbol, evidencia, NULL) != 0) failures++;
+        for (int v = 0; v < TREE_NODES; v++) arbol_marginal(arbol, v, distribucion);
+    }
+    printf("100 calibrations with all %d marginals in %.3f s (CPU time)\n", TREE_NODES, seconds_since(start));
+    
+    free(evidencia);
+    eliminacion_destruir(motor);
+    arbol_destruir(arbol);
+    red_destruir(red);
+    return failures;
+}
+
+// 10^5 variables, each with up to three parents among the previous ones:
+// construction must stay linear
+static int check_large_network(void) {
+    int failures = 0;
+    char nombre[32];
+    clock_t start = clock();
+    
+    RedBayesiana *red = red_crear(0);
+    for (int i = 0; i < LARGE_NODES; i++) {
+        snprintf(nombre, sizeof(nombre), "variable_%d", i);
+        if (red_agregar_nodo(red, nombre) != i) failures++;
+    }
+    unsigned semilla = 12345;
+    for (int i = 1; i < LARGE_NODES; i++) {
+        for (int k = 0; k < 3; k++) {
+            semilla = semilla * 1103515245u + 12345u;
+            int padre = (int)((semilla >> 8) % (unsigned)i);
+            red_agregar_arista(red, padre, i);
+        }
+    }
+    if (!red_compilar(red)) failures++;
+    for (int i = 0; i < LARGE_NODES; i += 997) {
+        snprintf(nombre, sizeof(nombre), "variable_%d", i);
+        if (red_buscar(red, nombre) != i) failures++;
+    }
+    double elapsed = seconds_since(start);
+    printf("Large network: %d variables, %d edges in %.3f s\n", red->num_nodos, red->num_aristas, elapsed);
+    if (elapsed > 2.0) {
+        printf("Construction too slow\n");
+        failures++;
+    }
+    red_destruir(red);
+    return failures;
+}
+
+int main() {
+    printf("=== TESTING BAYESIAN NETWORKS ===\n");
+    
+    int failures = 0;
+    failures += check_indexed_network();
+    failures += check_from_list();
+    failures += check_tables();
+    failures += check_elimination();
+    failures += check_elimination_chain();
+    failures += check_junction_tree();
+    failures += check_junction_tree_large();
+    failures += check_large_network();
+    
+    if (failures == 0) {
+        printf("\n=== Bayesian - SUCCESS ===\n");
+        return 0;
+    }
+    printf("\n=== Bayesian - FAILED (%d) ===\n", failures);
+    return -1;
+}
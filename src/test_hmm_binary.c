@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "hmm.h"
+#include "hmm_binary.h"
+
+// Binary model format: the text example converted to binary must decode to
+// the same path, a named model must keep its names, a large observation block
+// must map without copies, and any corruption must be rejected.
+
+static int same_parameters(const HMM* a, const HMM* b) {
+    if (a->num_states != b->num_states || a->num_observations != b->num_observations) return 0;
+    for (int i = 0; i < a->num_states; i++) {
+        for (int j = 0; j < a->num_states; j++) {
+            if (HMM_A(a, i, j) != HMM_A(b, i, j) || HMM_LOG_A(a, i, j) != HMM_LOG_A(b, i, j)) return 0;
+        }
+        for (int k = 0; k < a->num_observations; k++) {
+            if (HMM_B(a, i, k) != HMM_B(b, i, k)) return 0;
+        }
+        if (a->initial[i] != b->initial[i]) return 0;
+    }
+    return 1;
+}
+
+// Header checksum as hmm_binary_save computes it, to forge valid headers
+static uint64_t fnv1a_header(const HmmBinaryHeader* header) {
+    HmmBinaryHeader copy = *header;
+    copy.header_checksum = 0;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t offset = 0; offset < sizeof(copy); offset += 8) {
+        uint64_t word;
+        memcpy(&word, (const unsigned char*)&copy + offset, sizeof(word));
+        hash ^= word;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+int main() {
+    printf("=== TESTING BINARY MODEL FORMAT ===\n");
+    
+    int failures = 0;
+    const char* path = "test_hmm_binary.hmmb";
+    
+    // Weather example: text -> binary -> same parameters and Viterbi path
+    int* text_observations = NULL;
+    HMM* text = load_hmm_with_observations("clima_ejemplo.txt", &text_observations);
+    if (text == NULL || hmm_convert_text_to_binary("clima_ejemplo.txt", path) != 0) {
+        printf("Conversion of clima_ejemplo.txt failed\n");
+        return -1;
+    }
+    
+    const int* mapped_observations = NULL;
+    long long count = 0;
+    HMM* mapped = hmm_binary_load(path, &mapped_observations, &count, HMM_BINARY_VERIFY_OBSERVATIONS);
+    if (mapped == NULL || !same_parameters(text, mapped) || count != text->sequence_length) {
+        printf("Weather model differs after conversion\n");
+        failures++;
+    } else {
+        ViterbiResult* expected = viterbi_algorithm(text, text_observations);
+        ViterbiResult* decoded = viterbi_algorithm(mapped, (int*)mapped_observations);
+        for (int t = 0; t < count; t++) {
+            if (mapped_observations[t] != text_observations[t] || expected->path[t] != decoded->path[t]) {
+                printf("Weather example differs at t=%d\n", t);
+                failures++;
+                break;
+            }
+        }
+        printf("Weather example: %lld observations, P* = %.10f (text %.10f)\n",
+               count, decoded->probability, expected->probability);
+        free_viterbi_result(expected);
+        free_viterbi_result(decoded);
+    }
+    free_hmm(mapped);
+    free(text_observations);
+    
+    // Named model: the dictionary survives the round trip and is checksummed
+    const char* state_names[3] = {"SUNNY", "CLOUDY", "RAINY"};
+    const char* symbol_names[3] = {"UMBRELLA", "SUNGLASSES", "STAY_HOME"};
+    if (!hmm_set_names(text, state_names, symbol_names) || hmm_binary_save(text, NULL, 0, path) != 0) {
+        printf("Saving the named weather model failed\n");
+        failures++;
+    }
+    mapped = hmm_binary_load(path, NULL, NULL, 0);
+    if (mapped == NULL || !same_parameters(text, mapped)) {
+        printf("Named model differs after a round trip\n");
+        failures++;
+    } else {
+        for (int i = 0; i < 3; i++) {
+            if (hmm_state_name(mapped, i) == NULL || strcmp(hmm_state_name(mapped, i), state_names[i]) != 0
+                || hmm_symbol_index(mapped, symbol_names[i]) != i) {
+                printf("Name %d lost in the round trip\n", i);
+                failures++;
+                break;
+            }
+        }
+        printf("Named model: states %s %s %s\n", hmm_state_name(mapped, 0),
+               hmm_state_name(mapped, 1), hmm_state_name(mapped, 2));
+    }
+    free_hmm(mapped);
+    
+    HmmBinaryHeader header;
+    FILE* named_file = fopen(path, "r+b");
+    int has_names = named_file != NULL && fread(&header, sizeof(header), 1, named_file) == 1
+                    && header.names_offset != 0;
+    if (has_names) {
+        fseek(named_file, (long)header.names_offset, SEEK_SET);
+        fputc('X', named_file);
+    }
+    if (named_file != NULL) fclose(named_file);
+    if (!has_names) {
+        printf("Named model has no names block\n");
+        failures++;
+    } else {
+        printf("Expecting a checksum error:\n");
+        mapped = hmm_binary_load(path, NULL, NULL, 0);
+        if (mapped != NULL) {
+            printf("Corrupted names block was accepted\n");
+            free_hmm(mapped);
+            failures++;
+        }
+    }
+    
+    // Larger model with a long observation block
+    int N = 37, M = 5, T = 200000;
+    HMM* model = allocate_hmm(N, M, T);
+    srand(3);
+    for (int i = 0; i < N; i++) {
+        double row_sum = 0.0;
+        for (int j = 0; j < N; j++) row_sum += (HMM_A(model, i, j) = 0.1 + (double)rand() / RAND_MAX);
+        for (int j = 0; j < N; j++) HMM_A(model, i, j) /= row_sum;
+        row_sum = 0.0;
+        for (int k = 0; k < M; k++) row_sum += (HMM_B(model, i, k) = 0.1 + (double)rand() / RAND_MAX);
+        for (int k = 0; k < M; k++) HMM_B(model, i, k) /= row_sum;
+        model->initial[i] = 1.0 / N;
+    }
+    int* observations = (int*)malloc(T * sizeof(int));
+    for (int t = 0; t < T; t++) observations[t] = rand() % M;
+    
+    if (hmm_binary_save(model, observations, T, path) != 0) {
+        failures++;
+    }
+    mapped = hmm_binary_load(path, &mapped_observations, &count, HMM_BINARY_VERIFY_OBSERVATIONS);
+    if (mapped == NULL || !same_parameters(model, mapped) || count != T
+        || memcmp(mapped_observations, observations, T * sizeof(int)) != 0) {
+        printf("Large model differs after a round trip\n");
+        failures++;
+    }
+    free_hmm(mapped);
+    
+    // Corruption: one flipped byte in the parameters, then in the observations
+    long offsets[2] = {4096 + 8, -16};
+    for (int c = 0; c < 2; c++) {
+        FILE* file = fopen(path, "r+b");
+        fseek(file, offsets[c], offsets[c] < 0 ? SEEK_END : SEEK_SET);
+        int byte = fgetc(file);
+        fseek(file, -1, SEEK_CUR);
+        fputc(byte ^ 0x40, file);
+        fclose(file);
+        
+        printf("Expecting a checksum error:\n");
+        mapped = hmm_binary_load(path, NULL, NULL, HMM_BINARY_VERIFY_OBSERVATIONS);
+        if (mapped != NULL) {
+            printf("Corrupted file %d was accepted\n", c);
+            free_hmm(mapped);
+            failures++;
+        }
+        
+        // Repair for the next case
+        file = fopen(path, "r+b");
+        fseek(file, offsets[c], offsets[c] < 0 ? SEEK_END : SEEK_SET);
+        fputc(byte, file);
+        fclose(file);
+    }
+    
+    // Out-of-order arrays behind a valid header checksum: must be rejected,
+    // not checksummed past the end of the mapping
+    HmmBinaryHeader crafted;
+    FILE* crafted_file = fopen(path, "r+b");
+    if (crafted_file == NULL || fread(&crafted, sizeof(crafted), 1, crafted_file) != 1) {
+        printf("Cannot read back the header\n");
+        failures++;
+    } else {
+        uint64_t swap = crafted.transition_offset;
+        crafted.transition_offset = crafted.log_initial_offset;
+        crafted.log_initial_offset = swap;
+        crafted.header_checksum = fnv1a_header(&crafted);
+        fseek(crafted_file, 0, SEEK_SET);
+        fwrite(&crafted, sizeof(crafted), 1, crafted_file);
+    }
+    if (crafted_file != NULL) fclose(crafted_file);
+    printf("Expecting an out-of-order error:\n");
+    mapped = hmm_binary_load(path, NULL, NULL, 0);
+    if (mapped != NULL) {
+        printf("Out-of-order arrays were accepted\n");
+        free_hmm(mapped);
+        failures++;
+    }
+    
+    remove(path);
+    free(observations);
+    free_hmm(model);
+    free_hmm(text);
+    
+    if (failures == 0) {
+        printf("\n=== Binary Model Format - SUCCESS ===\n");
+    } else {
+        printf("\n=== Binary Model Format - FAILED (%d) ===\n", failures);
+    }
+    
+    return failures == 0 ? 0 : -1;
+}
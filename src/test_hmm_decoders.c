@@ -0,0 +1,1039 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hmm.h"
+#include "hmm_kernels.h"
+#include "hmm_batch.h"
+#include "hmm_stream.h"
+#include "hmm_posterior.h"
+#include "hmm_sparse.h"
+#include "hmm_beam.h"
+#include "hmm_parallel.h"
+#include "hmm_nbest.h"
+#include "hmm_profile.h"
+
+// Cross-checks every decoding entry point against the reference
+// viterbi_algorithm / viterbi_algorithm_log on random models.
+
+static HMM* random_hmm(int N, int M, int T, unsigned int seed) {
+    HMM* hmm = allocate_hmm(N, M, T);
+    if (hmm == NULL) return NULL;
+    
+    srand(seed);
+    for (int i = 0; i < N; i++) {
+        double row_sum = 0.0;
+        for (int j = 0; j < N; j++) {
+            HMM_A(hmm, i, j) = 0.05 + (double)rand() / RAND_MAX;
+            row_sum += HMM_A(hmm, i, j);
+        }
+        for (int j = 0; j < N; j++) HMM_A(hmm, i, j) /= row_sum;
+        
+        row_sum = 0.0;
+        for (int k = 0; k < M; k++) {
+            HMM_B(hmm, i, k) = 0.05 + (double)rand() / RAND_MAX;
+            row_sum += HMM_B(hmm, i, k);
+        }
+        for (int k = 0; k < M; k++) HMM_B(hmm, i, k) /= row_sum;
+        
+        hmm->initial[i] = 1.0 / N;
+    }
+    hmm_prepare(hmm);
+    return hmm;
+}
+
+static int* random_observations(int T, int M) {
+    int* observations = (int*)malloc(T * sizeof(int));
+    for (int t = 0; t < T; t++) {
+        observations[t] = rand() % M;
+    }
+    return observations;
+}
+
+static int same_path(const int* a, const int* b, int T, const char* label) {
+    for (int t = 0; t < T; t++) {
+        if (a[t] != b[t]) {
+            printf("%s: path mismatch at t=%d (%d vs %d)\n", label, t, a[t], b[t]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Workspace decoding must match the allocating entry points for every length,
+// including after the workspace has grown and gone back to short sequences
+static int check_workspace(void) {
+    int failures = 0;
+    int lengths[] = {5, 40, 17, 300, 1, 299, 64};
+    int count = (int)(sizeof(lengths) / sizeof(lengths[0]));
+    
+    HMM* hmm = random_hmm(3, 3, 300, 7);
+    ViterbiWorkspace* workspace = viterbi_workspace_create(8, 3);
+    
+    for (int s = 0; s < count; s++) {
+        int T = lengths[s];
+        int* observations = random_observations(T, 3);
+        hmm->sequence_length = T;
+        
+        ViterbiResult* reference = viterbi_algorithm_log(hmm, observations);
+        const ViterbiResult* decoded = viterbi_decode(hmm, observations, T, VITERBI_MODE_LOG, workspace);
+        if (reference == NULL || decoded == NULL || decoded->T != T
+            || !same_path(reference->path, decoded->path, T, "workspace log")
+            || reference->log_probability != decoded->log_probability) {
+            failures++;
+        }
+        free_viterbi_result(reference);
+        
+        reference = viterbi_algorithm(hmm, observations);
+        decoded = viterbi_decode(hmm, observations, T, VITERBI_MODE_LINEAR, workspace);
+        if (reference == NULL || decoded == NULL
+            || !same_path(reference->path, decoded->path, T, "workspace linear")
+            || reference->probability != decoded->probability) {
+            failures++;
+        }
+        free_viterbi_result(reference);
+        free(observations);
+    }
+    
+    // Empty and negative lengths are rejected before touching the workspace
+    int observation = 0;
+    if (viterbi_decode(hmm, &observation, 0, VITERBI_MODE_LOG, workspace) != NULL
+        || viterbi_decode(hmm, &observation, 0, VITERBI_MODE_LINEAR, workspace) != NULL
+        || viterbi_decode(hmm, &observation, -3, VITERBI_MODE_LOG, workspace) != NULL) {
+        printf("workspace: viterbi_decode accepted T <= 0\n");
+        failures++;
+    }
+    
+    // Capacity only grows
+    if (workspace->max_T < 300) {
+        printf("workspace: capacity %d after decoding T=300\n", workspace->max_T);
+        failures++;
+    }
+    
+    viterbi_workspace_free(workspace);
+    free_hmm(hmm);
+    return failures;
+}
+
+// Every kernel variant the CPU supports must return bit-identical values and
+// the same (lowest) argmax as the scalar reference, including ties, zeros and
+// -INFINITY entries
+static int check_kernel_variant(const HmmKernels* kernels) {
+    int failures = 0;
+    double prev[80], column[80];
+    
+    srand(99);
+    for (int trial = 0; trial < 2000; trial++) {
+        int n = 1 + trial % 77;
+        for (int j = 0; j < n; j++) {
+            // Few distinct values so ties are frequent
+            prev[j] = (double)(rand() % 4) / 4.0;
+            column[j] = (double)(rand() % 3) / 2.0;
+        }
+        
+        int scalar_j, vector_j;
+        double scalar = hmm_max_product_scalar(prev, column, n, &scalar_j);
+        double vector = kernels->max_product(prev, column, n, &vector_j);
+        if (scalar != vector || scalar_j != vector_j) {
+            printf("max_product (%s) n=%d: %.17g@%d vs %.17g@%d\n",
+                   kernels->isa, n, scalar, scalar_j, vector, vector_j);
+            failures++;
+        }
+        
+        for (int j = 0; j < n; j++) {
+            prev[j] = (rand() % 5 == 0) ? -INFINITY : log(prev[j] + 0.25);
+            column[j] = (rand() % 5 == 0) ? -INFINITY : log(column[j] + 0.5);
+        }
+        if (trial % 10 == 0) {
+            for (int j = 0; j < n; j++) prev[j] = -INFINITY;
+        }
+        scalar = hmm_max_sum_scalar(prev, column, n, &scalar_j);
+        vector = kernels->max_sum(prev, column, n, &vector_j);
+        if (scalar != vector || scalar_j != vector_j) {
+            printf("max_sum (%s) n=%d: %.17g@%d vs %.17g@%d\n",
+                   kernels->isa, n, scalar, scalar_j, vector, vector_j);
+            failures++;
+        }
+        
+        // Reduced-precision max-sums against their own scalar references
+        float prev_f[80], column_f[80];
+        for (int j = 0; j < n; j++) {
+            prev_f[j] = (float)prev[j];
+            column_f[j] = (float)column[j];
+        }
+        float scalar_f = hmm_max_sum_float_scalar(prev_f, column_f, n, &scalar_j);
+        float vector_f = kernels->max_sum_float(prev_f, column_f, n, &vector_j);
+        if (scalar_f != vector_f || scalar_j != vector_j) {
+            printf("max_sum_float (%s) n=%d: %.9g@%d vs %.9g@%d\n",
+                   kernels->isa, n, scalar_f, scalar_j, vector_f, vector_j);
+            failures++;
+        }
+        scalar = hmm_max_sum_mixed_scalar(prev, column_f, n, &scalar_j);
+        vector = kernels->max_sum_mixed(prev, column_f, n, &vector_j);
+        if (scalar != vector || scalar_j != vector_j) {
+            printf("max_sum_mixed (%s) n=%d: %.17g@%d vs %.17g@%d\n",
+                   kernels->isa, n, scalar, scalar_j, vector, vector_j);
+            failures++;
+        }
+        
+        // Dot products only agree to rounding (different summation order)
+        for (int j = 0; j < n; j++) {
+            prev[j] = (double)rand() / RAND_MAX;
+            column[j] = (double)rand() / RAND_MAX;
+        }
+        scalar = hmm_dot_scalar(prev, column, n);
+        vector = kernels->dot(prev, column, n);
+        if (fabs(scalar - vector) > 1e-13 * n) {
+            printf("dot (%s) n=%d: %.17g vs %.17g\n", kernels->isa, n, scalar, vector);
+            failures++;
+        }
+    }
+    
+    return failures;
+}
+
+static int check_kernels(void) {
+    const char* variants[] = {"avx512", "avx", "sse2", "scalar"};
+    int failures = 0;
+    
+    printf("Active kernels: %s\n", hmm_kernels_isa());
+    for (int v = 0; v < 4; v++) {
+        const HmmKernels* kernels = hmm_kernels_find(variants[v]);
+        if (kernels == NULL) {
+            printf("Kernel variant %s: not available on this CPU\n", variants[v]);
+            continue;
+        }
+        int variant_failures = check_kernel_variant(kernels);
+        printf("Kernel variant %s: %s\n", variants[v], variant_failures == 0 ? "ok" : "MISMATCH");
+        failures += variant_failures;
+    }
+    
+    return failures;
+}
+
+// Batch decoding on several threads must reproduce viterbi_decode exactly
+static int check_batch(void) {
+    int failures = 0;
+    int count = 200;
+    HMM* hmm = random_hmm(12, 3, 1, 21);
+    
+    int** sequences = (int**)malloc(count * sizeof(int*));
+    int** paths = (int**)malloc(count * sizeof(int*));
+    int* lengths = (int*)malloc(count * sizeof(int));
+    double* log_probabilities = (double*)malloc(count * sizeof(double));
+    for (int k = 0; k < count; k++) {
+        lengths[k] = 1 + rand() % (k % 10 == 0 ? 2000 : 80);
+        sequences[k] = random_observations(lengths[k], 3);
+        paths[k] = (int*)malloc(lengths[k] * sizeof(int));
+    }
+    
+    ViterbiBatchOptions options = viterbi_batch_default_options();
+    options.num_threads = 4;
+    if (viterbi_batch(hmm, (const int* const*)sequences, lengths, count, paths, log_probabilities, &options) != 0) {
+        failures++;
+    }
+    
+    ViterbiWorkspace* workspace = viterbi_workspace_create(1, 12);
+    for (int k = 0; k < count && failures == 0; k++) {
+        const ViterbiResult* expected = viterbi_decode(hmm, sequences[k], lengths[k], VITERBI_MODE_LOG, workspace);
+        if (!same_path(expected->path, paths[k], lengths[k], "batch")
+            || expected->log_probability != log_probabilities[k]) {
+            failures++;
+        }
+    }
+    viterbi_workspace_free(workspace);
+    
+    // An empty or missing sequence is rejected before any decoding
+    int saved = lengths[count / 2];
+    lengths[count / 2] = 0;
+    if (viterbi_batch(hmm, (const int* const*)sequences, lengths, count, paths, log_probabilities, &options) != -1) {
+        printf("batch: accepted a sequence of length 0\n");
+        failures++;
+    }
+    lengths[count / 2] = saved;
+    int* missing = paths[count - 1];
+    paths[count - 1] = NULL;
+    if (viterbi_batch(hmm, (const int* const*)sequences, lengths, count, paths, log_probabilities, &options) != -1) {
+        printf("batch: accepted a NULL path buffer\n");
+        failures++;
+    }
+    paths[count - 1] = missing;
+    
+    // A pool decodes batch after batch with the same threads and workspaces;
+    // in a batch dominated by one long sequence, that one is split over time
+    ViterbiBatchPool* pool = viterbi_batch_pool_create(&options);
+    double* again = (double*)malloc(count * sizeof(double));
+    for (int round = 0; round < 3 && pool != NULL; round++) {
+        if (viterbi_batch_pool_decode(pool, hmm, (const int* const*)sequences, lengths, count, paths, again) != 0
+            || memcmp(again, log_probabilities, count * sizeof(double)) != 0) {
+            printf("batch pool: round %d differs from viterbi_batch\n", round);
+            failures++;
+        }
+    }
+    int long_lengths[4] = {300000, 50, 70, 20};
+    int* long_sequences[4];
+    int* long_paths[4];
+    double long_log_probabilities[4];
+    for (int k = 0; k < 4; k++) {
+        long_sequences[k] = random_observations(long_lengths[k], 3);
+        long_paths[k] = (int*)malloc(long_lengths[k] * sizeof(int));
+    }
+    if (pool == NULL || viterbi_batch_pool_decode(pool, hmm, (const int* const*)long_sequences, long_lengths, 4,
+                                                  long_paths, long_log_probabilities) != 0) {
+        printf("batch pool: long batch failed\n");
+        failures++;
+    } else {
+        workspace = viterbi_workspace_create(1, 12);
+        for (int k = 0; k < 4; k++) {
+            const ViterbiResult* expected = viterbi_decode(hmm, long_sequences[k], long_lengths[k],
+                                                           VITERBI_MODE_LOG, workspace);
+            if (!same_path(expected->path, long_paths[k], long_lengths[k], "batch pool")
+                || fabs(expected->log_probability - long_log_probabilities[k])
+                   > 1e-9 * fabs(expected->log_probability)) {
+                failures++;
+            }
+        }
+        viterbi_workspace_free(workspace);
+    }
+    for (int k = 0; k < 4; k++) {
+        free(long_sequences[k]);
+        free(long_paths[k]);
+    }
+    free(again);
+    viterbi_batch_pool_free(pool);
+    
+    for (int k = 0; k < count; k++) {
+        free(sequences[k]);
+        free(paths[k]);
+    }
+    free(sequences);
+    free(paths);
+    free(lengths);
+    free(log_probabilities);
+    free_hmm(hmm);
+    return failures;
+}
+
+// Streaming decoder: with a lag longer than the stream every state is decided
+// by survivor convergence or the final flush, which must give the offline path;
+// with a short lag the output must still cover every observation exactly once
+static int check_stream(void) {
+    int failures = 0;
+    int T = 3000;
+    HMM* hmm = random_hmm(6, 3, T, 33);
+    int* observations = random_observations(T, 3);
+    int* committed = (int*)malloc((T + 64) * sizeof(int));
+    
+    ViterbiResult* reference = viterbi_algorithm_log(hmm, observations);
+    
+    ViterbiStream* stream = viterbi_stream_create(hmm, T);
+    int count = 0;
+    for (int t = 0; t < T; t += 100) {
+        count += viterbi_stream_push_block(stream, observations + t, 100, committed + count);
+    }
+    printf("Stream (lag %d): %d of %d states committed by convergence\n", T, count, T);
+    double stream_log_probability = viterbi_stream_log_probability(stream);
+    count += viterbi_stream_flush(stream, committed + count);
+    if (count != T || !same_path(reference->path, committed, T, "stream")
+        || fabs(stream_log_probability - reference->log_probability) > 1e-9 * fabs(reference->log_probability)) {
+        failures++;
+    }
+    viterbi_stream_free(stream);
+    
+    // Short lag: never more than lag states pending
+    int lag = 8;
+    stream = viterbi_stream_create(hmm, lag);
+    count = 0;
+    for (int t = 0; t < T; t++) {
+        count += viterbi_stream_push(stream, observations[t], committed + count);
+        if (t + 1 - count > lag) {
+            printf("Stream (lag %d): %d states pending at t=%d\n", lag, t + 1 - count, t);
+            failures++;
+            break;
+        }
+    }
+    count += viterbi_stream_flush(stream, committed + count);
+    if (count != T) {
+        printf("Stream (lag %d): %d states committed for %d observations\n", lag, count, T);
+        failures++;
+    }
+    viterbi_stream_free(stream);
+    
+    free_viterbi_result(reference);
+    free(committed);
+    free(observations);
+    free_hmm(hmm);
+    return failures;
+}
+
+// Forward-backward against brute-force enumeration of every state path on a
+// short sequence, then stability and normalization on a long one
+static int check_posterior(void) {
+    int failures = 0;
+    int N = 3, T = 8;
+    HMM* hmm = random_hmm(N, 4, T, 41);
+    int* observations = random_observations(T, 4);
+    PosteriorWorkspace* workspace = posterior_workspace_create(4, N);
+    
+    // Σ over all Nᵀ paths of π(q₁)B(q₁,o₁)Πₜ A(qₜ₋₁,qₜ)B(qₜ,oₜ)
+    double total = 0.0;
+    double marginal[8][3] = {{0.0}};
+    int paths = 1;
+    for (int t = 0; t < T; t++) paths *= N;
+    for (int code = 0; code < paths; code++) {
+        int q[8];
+        int rest = code;
+        for (int t = 0; t < T; t++) {
+            q[t] = rest % N;
+            rest /= N;
+        }
+        double p = hmm->initial[q[0]] * HMM_B(hmm, q[0], observations[0]);
+        for (int t = 1; t < T; t++) {
+            p *= HMM_A(hmm, q[t-1], q[t]) * HMM_B(hmm, q[t], observations[t]);
+        }
+        total += p;
+        for (int t = 0; t < T; t++) marginal[t][q[t]] += p;
+    }
+    
+    const PosteriorResult* result = hmm_forward_backward(hmm, observations, T, workspace);
+    if (result == NULL || fabs(result->log_likelihood - log(total)) > 1e-12) {
+        printf("posterior: log-likelihood %.17g, brute force %.17g\n",
+               result != NULL ? result->log_likelihood : NAN, log(total));
+        failures++;
+    }
+    for (int t = 0; t < T && result != NULL; t++) {
+        for (int i = 0; i < N; i++) {
+            if (fabs(POSTERIOR_GAMMA(result, t, i) - marginal[t][i] / total) > 1e-12) {
+                printf("posterior: γ(%d,%d) = %.17g, brute force %.17g\n",
+                       t, i, POSTERIOR_GAMMA(result, t, i), marginal[t][i] / total);
+                failures++;
+            }
+        }
+    }
+    free(observations);
+    free_hmm(hmm);
+    
+    // Long sequence: the unscaled forward would underflow after a few hundred steps
+    T = 100000;
+    hmm = random_hmm(5, 3, T, 43);
+    observations = random_observations(T, 3);
+    double forward_only;
+    if (hmm_forward(hmm, observations, T, workspace, &forward_only) != 0 || !isfinite(forward_only)) {
+        failures++;
+    }
+    result = hmm_forward_backward(hmm, observations, T, workspace);
+    if (result == NULL || result->log_likelihood != forward_only) {
+        failures++;
+    } else {
+        for (int t = 0; t < T; t += 997) {
+            double row_sum = 0.0;
+            for (int i = 0; i < 5; i++) row_sum += POSTERIOR_GAMMA(result, t, i);
+            if (fabs(row_sum - 1.0) > 1e-9) {
+                printf("posterior: γ row %d sums to %.17g\n", t, row_sum);
+                failures++;
+                break;
+            }
+        }
+        printf("Posterior (T=%d): log P(O) = %.6f\n", T, result->log_likelihood);
+    }
+    
+    posterior_workspace_free(workspace);
+    free(observations);
+    free_hmm(hmm);
+    return failures;
+}
+
+// Sparse decoding must reproduce the dense log-domain decoder: on a full
+// model converted exactly, and on a banded model written in the sparse file format
+static int check_sparse(void) {
+    int failures = 0;
+    int T = 2000;
+    int* observations = random_observations(T, 3);
+    int* path = (int*)malloc(T * sizeof(int));
+    SparseViterbiWorkspace* workspace = sparse_viterbi_workspace_create(16, 1);
+    double log_probability;
+    
+    HMM* hmm = random_hmm(9, 3, T, 51);
+    SparseHMM* sparse = sparse_hmm_from_dense(hmm, 0.0);
+    ViterbiResult* reference = viterbi_algorithm_log(hmm, observations);
+    if (sparse == NULL || sparse->nnz != 81
+        || viterbi_sparse(sparse, observations, T, workspace, path, &log_probability) != 0
+        || !same_path(reference->path, path, T, "sparse (dense model)")
+        || log_probability != reference->log_probability) {
+        failures++;
+    }
+    free_viterbi_result(reference);
+    free_sparse_hmm(sparse);
+    free_hmm(hmm);
+    
+    // Banded chain: state i only moves to i, i+1, i+2 (mod N)
+    int N = 40;
+    hmm = random_hmm(N, 3, T, 53);
+    const char* file_path = "test_hmm_sparse_model.txt";
+    FILE* file = fopen(file_path, "w");
+    if (file == NULL) {
+        failures++;
+    } else {
+        fprintf(file, "sparse\n%d 3 %d %d\n", N, T, 3 * N);
+        for (int i = 0; i < N; i++) {
+            double row_sum = 0.0;
+            for (int j = 0; j < N; j++) {
+                if ((j - i + N) % N > 2) HMM_A(hmm, i, j) = 0.0;
+                row_sum += HMM_A(hmm, i, j);
+            }
+            for (int d = 2; d >= 0; d--) {
+                int j = (i + d) % N;
+                HMM_A(hmm, i, j) /= row_sum;
+                fprintf(file, "%d %d %.17g\n", i, j, HMM_A(hmm, i, j));
+            }
+        }
+        for (int i = 0; i < N; i++) {
+            fprintf(file, "%.17g %.17g %.17g\n", HMM_B(hmm, i, 0), HMM_B(hmm, i, 1), HMM_B(hmm, i, 2));
+        }
+        for (int i = 0; i < N; i++) fprintf(file, "%.17g ", hmm->initial[i]);
+        fprintf(file, "\n");
+        for (int t = 0; t < T; t++) fprintf(file, "%d ", observations[t]);
+        fprintf(file, "\n");
+        fclose(file);
+        hmm_prepare(hmm);
+        
+        int* loaded_observations = NULL;
+        sparse = load_sparse_hmm(file_path, &loaded_observations);
+        reference = viterbi_algorithm_log(hmm, observations);
+        if (sparse == NULL || loaded_observations == NULL
+            || viterbi_sparse(sparse, loaded_observations, T, workspace, path, &log_probability) != 0
+            || !same_path(reference->path, path, T, "sparse (banded)")
+            || fabs(log_probability - reference->log_probability) > 1e-9 * fabs(reference->log_probability)) {
+            failures++;
+        } else {
+            printf("Sparse (N=%d, nnz=%d): log P* = %.6f\n", N, sparse->nnz, log_probability);
+        }
+        
+        // Out-of-range symbols are rejected
+        observations[T / 2] = 3;
+        if (sparse != NULL && viterbi_sparse(sparse, observations, T, workspace, path, NULL) != -1) {
+            failures++;
+        }
+        free_viterbi_result(reference);
+        free_sparse_hmm(sparse);
+        free(loaded_observations);
+        remove(file_path);
+    }
+    
+    sparse_viterbi_workspace_free(workspace);
+    free_hmm(hmm);
+    free(path);
+    free(observations);
+    return failures;
+}
+
+// Beam decoding without limits is exact; with limits it stays close and the
+// reported survivor counts respect the beam
+static int check_beam(void) {
+    int failures = 0;
+    int N = 64, T = 1500;
+    HMM* hmm = random_hmm(N, 3, T, 61);
+    int* observations = random_observations(T, 3);
+    int* path = (int*)malloc(T * sizeof(int));
+    BeamWorkspace* workspace = beam_workspace_create(10, 4);
+    BeamStats stats;
+    double log_probability;
+    
+    ViterbiResult* reference = viterbi_algorithm_log(hmm, observations);
+    if (viterbi_beam(hmm, observations, T, NULL, workspace, path, &log_probability, &stats) != 0
+        || !same_path(reference->path, path, T, "beam (unlimited)")
+        || log_probability != reference->log_probability
+        || stats.states_kept != stats.states_scored) {
+        failures++;
+    }
+    
+    BeamOptions options = beam_default_options();
+    options.beam_width = 8;
+    options.log_margin = 12.0;
+    if (viterbi_beam(hmm, observations, T, &options, workspace, path, &log_probability, &stats) != 0
+        || stats.max_active > 8 || log_probability > reference->log_probability) {
+        failures++;
+    } else {
+        // The decoded path must score exactly what the decoder reported
+        double path_score = hmm->log_initial[path[0]] + HMM_LOG_B(hmm, path[0], observations[0]);
+        int differences = path[0] != reference->path[0];
+        for (int t = 1; t < T; t++) {
+            path_score += HMM_LOG_A(hmm, path[t-1], path[t]) + HMM_LOG_B(hmm, path[t], observations[t]);
+            differences += path[t] != reference->path[t];
+        }
+        if (fabs(path_score - log_probability) > 1e-9 * fabs(log_probability)) {
+            printf("beam: path scores %.17g, decoder reported %.17g\n", path_score, log_probability);
+            failures++;
+        }
+        printf("Beam (K=%d, margin=%.0f): log P = %.6f vs exact %.6f, %d of %d states differ\n",
+               options.beam_width, options.log_margin, log_probability, reference->log_probability,
+               differences, T);
+        print_beam_stats(&stats);
+    }
+    
+    options.log_margin = -1.0;
+    if (viterbi_beam(hmm, observations, T, &options, workspace, path, NULL, NULL) != -1) {
+        failures++;
+    }
+    
+    free_viterbi_result(reference);
+    beam_workspace_free(workspace);
+    free(path);
+    free(observations);
+    free_hmm(hmm);
+    return failures;
+}
+
+// Fixed-size recursions must reproduce the generic loop bit for bit in both
+// domains, including impossible transitions (zeros / -INFINITY)
+static int same_result(const ViterbiResult* a, const ViterbiResult* b, const char* label) {
+    for (int t = 0; t < a->T; t++) {
+        if (memcmp(VITERBI_DELTA_ROW(a, t), VITERBI_DELTA_ROW(b, t), (size_t)a->N * sizeof(double)) != 0
+            || memcmp(VITERBI_PSI_ROW(a, t), VITERBI_PSI_ROW(b, t), (size_t)a->N * sizeof(int)) != 0) {
+            printf("%s: δ/ψ differ at t=%d\n", label, t);
+            return 0;
+        }
+    }
+    return same_path(a->path, b->path, a->T, label);
+}
+
+static int check_fixed(void) {
+    const int sizes[] = {2, 3, 4, 8, 5};
+    int failures = 0;
+    int T = 800;
+    
+    for (int s = 0; s < 5; s++) {
+        int N = sizes[s];
+        HMM* hmm = random_hmm(N, 3, T, 91 + s);
+        HMM_A(hmm, 0, N - 1) = 0.0;
+        HMM_A(hmm, N - 1, 0) = 0.0;
+        hmm_prepare(hmm);
+        int* observations = random_observations(T, 3);
+        
+        // Every size but 5 has a specialization
+        int expected = N != 5;
+        if ((hmm_fixed_recursion(N, 1) != NULL) != expected || (hmm_fixed_recursion(N, 0) != NULL) != expected) {
+            printf("Fixed recursion N=%d: unexpected availability\n", N);
+            failures++;
+        }
+        
+        ViterbiResult* fixed_linear = viterbi_algorithm(hmm, observations);
+        ViterbiResult* fixed_log = viterbi_algorithm_log(hmm, observations);
+        hmm_fixed_recursions_enable(0);
+        if (hmm_fixed_recursion(N, 1) != NULL) failures++;
+        ViterbiResult* generic_linear = viterbi_algorithm(hmm, observations);
+        ViterbiResult* generic_log = viterbi_algorithm_log(hmm, observations);
+        hmm_fixed_recursions_enable(1);
+        
+        if (!same_result(fixed_linear, generic_linear, "fixed (linear)")
+            || !same_result(fixed_log, generic_log, "fixed (log)")
+            || fixed_log->log_probability != generic_log->log_probability) {
+            printf("Fixed recursion N=%d: MISMATCH\n", N);
+            failures++;
+        }
+        
+        free_viterbi_result(fixed_linear);
+        free_viterbi_result(fixed_log);
+        free_viterbi_result(generic_linear);
+        free_viterbi_result(generic_log);
+        free(observations);
+        free_hmm(hmm);
+    }
+    
+    printf("Fixed-size recursions (N=2,3,4,8): %s\n", failures == 0 ? "ok" : "MISMATCH");
+    return failures;
+}
+
+// Reduced precision: the decoded path must score (in double) within float
+// rounding of the exact optimum, and log P* must match to that tolerance,
+// also over a sequence long enough to break an unnormalized float log δ
+static double path_score(const HMM* hmm, const int* observations, const int* path, int T) {
+    double score = hmm->log_initial[path[0]] + HMM_LOG_B(hmm, path[0], observations[0]);
+    for (int t = 1; t < T; t++) {
+        score += HMM_LOG_A(hmm, path[t-1], path[t]) + HMM_LOG_B(hmm, path[t], observations[t]);
+    }
+    return score;
+}
+
+static int check_precision_model(HMM* hmm, const int* observations, int T, const char* label) {
+    const HmmPrecision modes[] = {HMM_PRECISION_MIXED, HMM_PRECISION_FLOAT};
+    const char* names[] = {"mixed", "float"};
+    int failures = 0;
+    
+    hmm->sequence_length = T;
+    ViterbiResult* reference = viterbi_algorithm_log(hmm, (int*)observations);
+    for (int m = 0; m < 2; m++) {
+        if (!hmm_set_precision(hmm, modes[m])) {
+            failures++;
+            continue;
+        }
+        ViterbiResult* result = viterbi_algorithm_log(hmm, (int*)observations);
+        double tolerance = 1e-5 * fabs(reference->log_probability);
+        double score = path_score(hmm, observations, result->path, T);
+        int differences = 0;
+        for (int t = 0; t < T; t++) differences += result->path[t] != reference->path[t];
+        
+        printf("%s (%s): log P = %.6f vs %.6f, %d of %d states differ\n", label, names[m],
+               result->log_probability, reference->log_probability, differences, T);
+        if (fabs(result->log_probability - reference->log_probability) > tolerance
+            || reference->log_probability - score > tolerance) {
+            printf("%s (%s): path scores %.9f\n", label, names[m], score);
+            failures++;
+        }
+        free_viterbi_result(result);
+    }
+    
+    // Back to double: bit-identical to the reference again
+    hmm_set_precision(hmm, HMM_PRECISION_DOUBLE);
+    ViterbiResult* result = viterbi_algorithm_log(hmm, (int*)observations);
+    if (result->log_probability != reference->log_probability
+        || !same_path(result->path, reference->path, T, label)) {
+        failures++;
+    }
+    
+    free_viterbi_result(result);
+    free_viterbi_result(reference);
+    return failures;
+}
+
+static int check_precision(void) {
+    int failures = 0;
+    int T = 200000;
+    int* observations = random_observations(T, 8);
+    
+    HMM* hmm = random_hmm(64, 8, 3000, 101);
+    failures += check_precision_model(hmm, observations, 3000, "Precision N=64");
+    free_hmm(hmm);
+    
+    hmm = random_hmm(3, 8, T, 103);
+    failures += check_precision_model(hmm, observations, T, "Precision N=3");
+    free_hmm(hmm);
+    
+    hmm = random_hmm(4, 2, 10, 105);
+    if (hmm_set_precision(hmm, (HmmPrecision)7)) failures++;
+    free_hmm(hmm);
+    
+    free(observations);
+    return failures;
+}
+
+// Instrumentation: exact counters per call when built with -DHMM_INSTRUMENTATION,
+// all zeros otherwise
+static int check_profile(void) {
+    int failures = 0;
+    int N = 20, M = 4, T = 500;
+    HMM* hmm = random_hmm(N, M, T, 121);
+    int* observations = random_observations(T, M);
+    ViterbiWorkspace* workspace = viterbi_workspace_create(1, N);
+    HmmProfile last, thread, total;
+    
+    hmm_profile_reset();
+    viterbi_decode(hmm, observations, T, VITERBI_MODE_LOG, workspace);
+    hmm_profile_last_call(&last);
+    
+    BeamOptions options = beam_default_options();
+    options.beam_width = 5;
+    BeamWorkspace* beam = beam_workspace_create(1, N);
+    BeamStats stats;
+    int* path = (int*)malloc(T * sizeof(int));
+    viterbi_beam(hmm, observations, T, &options, beam, path, NULL, &stats);
+    hmm_profile_thread(&thread);
+    hmm_profile_total(&total);
+    
+    if (hmm_profile_enabled()) {
+        if (last.calls != 1 || last.counters[HMM_COUNTER_CELLS] != (unsigned long long)N * T
+            || last.counters[HMM_COUNTER_TRANSITIONS] != (unsigned long long)N * N * (T - 1)
+            || last.counters[HMM_COUNTER_ALLOCATIONS] != 1 || last.seconds[HMM_PHASE_RECURSION] <= 0.0) {
+            printf("Profile of viterbi_decode is wrong\n");
+            failures++;
+        }
+        hmm_profile_last_call(&last);
+        if (thread.calls != 2 || total.calls < thread.calls
+            || last.counters[HMM_COUNTER_PRUNED_STATES] != (unsigned long long)(stats.states_scored - stats.states_kept)
+            || last.counters[HMM_COUNTER_TRANSITIONS] != (unsigned long long)stats.transitions_evaluated) {
+            printf("Profile of viterbi_beam is wrong\n");
+            failures++;
+        }
+        printf("Profile: ");
+        hmm_profile_write_json(stdout, &thread);
+    } else {
+        HmmProfile zero;
+        memset(&zero, 0, sizeof(zero));
+        if (memcmp(&last, &zero, sizeof(zero)) != 0 || memcmp(&thread, &zero, sizeof(zero)) != 0) {
+            printf("Instrumentation compiled out but recorded something\n");
+            failures++;
+        }
+    }
+    
+    free(path);
+    beam_workspace_free(beam);
+    viterbi_workspace_free(workspace);
+    free(observations);
+    free_hmm(hmm);
+    return failures;
+}
+
+// N-best: K = 1 is Viterbi, and on a model small enough to enumerate every
+// path the K results are exactly the K highest-scoring sequences
+static int compare_descending(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x < y) - (x > y);
+}
+
+static int check_nbest(void) {
+    int failures = 0;
+    int N = 3, M = 2, T = 7, K = 40;
+    HMM* hmm = random_hmm(N, M, T, 111);
+    HMM_A(hmm, 1, 2) = 0.0;  // Some sequences are impossible
+    hmm_prepare(hmm);
+    int* observations = random_observations(T, M);
+    int* paths = (int*)malloc((size_t)K * T * sizeof(int));
+    double log_probabilities[40];
+    int found;
+    NBestWorkspace* workspace = nbest_workspace_create(2, 1, 1);
+    
+    // Every sequence by brute force
+    int total = 1;
+    for (int t = 0; t < T; t++) total *= N;
+    double* all = (double*)malloc((size_t)total * sizeof(double));
+    int possible = 0;
+    int sequence[7];
+    for (int code = 0; code < total; code++) {
+        for (int t = 0, rest = code; t < T; t++, rest /= N) sequence[t] = rest % N;
+        double score = path_score(hmm, observations, sequence, T);
+        if (score > -INFINITY) all[possible++] = score;
+    }
+    qsort(all, (size_t)possible, sizeof(double), compare_descending);
+    
+    ViterbiResult* reference = viterbi_algorithm_log(hmm, observations);
+    if (viterbi_nbest(hmm, observations, T, 1, workspace, paths, log_probabilities, &found) != 0
+        || found != 1 || log_probabilities[0] != reference->log_probability
+        || !same_path(paths, reference->path, T, "nbest (K=1)")) {
+        failures++;
+    }
+    
+    if (viterbi_nbest(hmm, observations, T, K, workspace, paths, log_probabilities, &found) != 0
+        || found != K) {
+        failures++;
+    } else {
+        for (int k = 0; k < K; k++) {
+            double score = path_score(hmm, observations, paths + (size_t)k * T, T);
+            if (fabs(log_probabilities[k] - all[k]) > 1e-12 * fabs(all[k])
+                || fabs(score - log_probabilities[k]) > 1e-12 * fabs(score)) {
+                printf("nbest: rank %d scores %.17g, reported %.17g, expected %.17g\n",
+                       k, score, log_probabilities[k], all[k]);
+                failures++;
+            }
+            for (int other = 0; other < k; other++) {
+                if (memcmp(paths + (size_t)k * T, paths + (size_t)other * T, T * sizeof(int)) == 0) {
+                    printf("nbest: paths %d and %d are identical\n", other, k);
+                    failures++;
+                }
+            }
+        }
+    }
+    
+    // Asking for more sequences than have nonzero probability
+    if (viterbi_nbest(hmm, observations, 2, K, workspace, paths, log_probabilities, &found) != 0
+        || found >= N * N || found < 1) {
+        failures++;
+    }
+    
+    // Large N and K: best path still matches Viterbi, scores never increase
+    free_viterbi_result(reference);
+    free_hmm(hmm);
+    free(observations);
+    N = 200; T = 60; K = 100;
+    hmm = random_hmm(N, 4, T, 113);
+    observations = random_observations(T, 4);
+    free(paths);
+    paths = (int*)malloc((size_t)K * T * sizeof(int));
+    double* scores = (double*)malloc((size_t)K * sizeof(double));
+    reference = viterbi_algorithm_log(hmm, observations);
+    if (viterbi_nbest(hmm, observations, T, K, workspace, paths, scores, &found) != 0 || found != K
+        || scores[0] != reference->log_probability || !same_path(paths, reference->path, T, "nbest (N=200)")) {
+        failures++;
+    } else {
+        for (int k = 1; k < K; k++) {
+            if (scores[k] > scores[k-1]) failures++;
+        }
+        printf("N-best (N=%d, K=%d): log P from %.6f to %.6f\n", N, K, scores[0], scores[K-1]);
+    }
+    
+    free(scores);
+    free(all);
+    free_viterbi_result(reference);
+    nbest_workspace_free(workspace);
+    free(paths);
+    free(observations);
+    free_hmm(hmm);
+    return failures;
+}
+
+// Parallel-in-time decoding must reproduce the sequential log decoder for any
+// thread count, including chunks that never converge and 2-byte backpointers
+static int check_parallel_model(HMM* hmm, const int* observations, int T, int num_threads,
+                                int expect_unconverged, const char* label) {
+    int* path = (int*)malloc(T * sizeof(int));
+    ParallelViterbiStats stats;
+    double log_probability;
+    int failures = 0;
+    
+    hmm->sequence_length = T;
+    ViterbiResult* reference = viterbi_algorithm_log(hmm, (int*)observations);
+    if (viterbi_parallel(hmm, observations, T, num_threads, path, &log_probability, &stats) != 0
+        || !same_path(reference->path, path, T, label)
+        || fabs(log_probability - reference->log_probability) > 1e-9 * fabs(reference->log_probability)
+        || (num_threads == 1 && log_probability != reference->log_probability)
+        || (expect_unconverged && stats.unconverged_chunks != stats.chunks - 1)) {
+        printf("%s: log P = %.17g vs %.17g\n", label, log_probability, reference->log_probability);
+        failures++;
+    } else {
+        printf("%s: %d chunks, %lld steps recomputed, %d unconverged\n",
+               label, stats.chunks, stats.fixup_steps, stats.unconverged_chunks);
+    }
+    
+    free_viterbi_result(reference);
+    free(path);
+    return failures;
+}
+
+static int check_parallel(void) {
+    int failures = 0;
+    int T = 100000;
+    HMM* hmm = random_hmm(6, 4, T, 81);
+    int* observations = random_observations(T, 4);
+    
+    failures += check_parallel_model(hmm, observations, T, 1, 0, "parallel (1 thread)");
+    failures += check_parallel_model(hmm, observations, T, 3, 0, "parallel (3 threads)");
+    failures += check_parallel_model(hmm, observations, T, 8, 0, "parallel (8 threads)");
+    failures += check_parallel_model(hmm, observations, 100, 8, 0, "parallel (short)");
+    free_hmm(hmm);
+    
+    // N > 256 stores backpointers in 2 bytes
+    hmm = random_hmm(300, 4, 20000, 83);
+    failures += check_parallel_model(hmm, observations, 20000, 4, 0, "parallel (N=300)");
+    free_hmm(hmm);
+    
+    // Deterministic cycle started in state 0: only one state is reachable at a
+    // time while the speculative start reaches all of them, so no chunk converges
+    int N = 5;
+    hmm = allocate_hmm(N, 2, T);
+    for (int i = 0; i < N; i++) {
+        HMM_A(hmm, i, (i + 1) % N) = 1.0;
+        HMM_B(hmm, i, 0) = 0.5;
+        HMM_B(hmm, i, 1) = 0.5;
+    }
+    hmm->initial[0] = 1.0;
+    for (int t = 0; t < T; t++) observations[t] %= 2;
+    hmm_prepare(hmm);
+    failures += check_parallel_model(hmm, observations, 20000, 4, 1, "parallel (cycle)");
+    free_hmm(hmm);
+    
+    if (viterbi_parallel(NULL, observations, T, 2, NULL, NULL, NULL) != -1) {
+        failures++;
+    }
+    
+    free(observations);
+    return failures;
+}
+
+// Large named alphabet: names survive save/load, symbols are looked up by
+// name, and every decoder accepts any symbol below M (and nothing else)
+static int check_alphabet(void) {
+    int failures = 0;
+    int N = 4, M = 50000, T = 300;
+    HMM* hmm = random_hmm(N, M, T, 71);
+    
+    const char* state_names[] = {"inicio", "medio", "final", "ruido"};
+    char* symbol_text = (char*)malloc((size_t)M * 16);
+    const char** symbol_names = (const char**)malloc((size_t)M * sizeof(char*));
+    for (int k = 0; k < M; k++) {
+        snprintf(symbol_text + (size_t)k * 16, 16, "w%d", k);
+        symbol_names[k] = symbol_text + (size_t)k * 16;
+    }
+    if (!hmm_set_names(hmm, state_names, symbol_names)) {
+        failures++;
+    }
+    
+    int* observations = random_observations(T, M);
+    const char* path = "test_hmm_alphabet_model.txt";
+    int* loaded_observations = NULL;
+    HMM* loaded = save_hmm(hmm, path, observations) == 0
+                ? load_hmm_with_observations((char*)path, &loaded_observations) : NULL;
+    remove(path);
+    if (loaded == NULL || loaded->num_observations != M
+        || strcmp(hmm_state_name(loaded, 2), "final") != 0 || hmm_state_index(loaded, "ruido") != 3) {
+        printf("alphabet: names lost in the save/load round trip\n");
+        failures++;
+    } else {
+        const char** tokens = (const char**)malloc((size_t)T * sizeof(char*));
+        int* encoded = (int*)malloc((size_t)T * sizeof(int));
+        for (int t = 0; t < T; t++) tokens[t] = hmm_symbol_name(loaded, loaded_observations[t]);
+        if (hmm_encode_symbols(loaded, tokens, T, encoded) != 0 || !same_path(observations, encoded, T, "encode")
+            || hmm_symbol_index(loaded, "w50000") != -1) {
+            failures++;
+        }
+        free(tokens);
+        free(encoded);
+        
+        ViterbiResult* original = viterbi_algorithm_log(hmm, observations);
+        ViterbiResult* reloaded = viterbi_algorithm_log(loaded, loaded_observations);
+        if (original == NULL || reloaded == NULL || !same_path(original->path, reloaded->path, T, "alphabet")
+            || original->log_probability != reloaded->log_probability) {
+            failures++;
+        }
+        free_viterbi_result(original);
+        free_viterbi_result(reloaded);
+    }
+    
+    // Symbol M is one past the alphabet
+    observations[T - 1] = M;
+    ViterbiResult* rejected = viterbi_algorithm(hmm, observations);
+    if (rejected != NULL) {
+        failures++;
+    }
+    free_viterbi_result(rejected);
+    
+    // Names must be unique
+    HMM* small = random_hmm(2, 2, 1, 73);
+    const char* duplicates[] = {"a", "a"};
+    if (hmm_set_names(small, NULL, duplicates) != 0 || hmm_symbol_name(small, 0) != NULL) {
+        failures++;
+    }
+    free_hmm(small);
+    
+    free(loaded_observations);
+    free_hmm(loaded);
+    free(observations);
+    free(symbol_names);
+    free(symbol_text);
+    free_hmm(hmm);
+    return failures;
+}
+
+int main() {
+    printf("=== TESTING HMM DECODERS ===\n");
+    
+    int failures = 0;
+    failures += check_workspace();
+    failures += check_kernels();
+    failures += check_fixed();
+    failures += check_precision();
+    failures += check_batch();
+    failures += check_stream();
+    failures += check_posterior();
+    failures += check_sparse();
+    failures += check_beam();
+    failures += check_alphabet();
+    failures += check_parallel();
+    failures += check_nbest();
+    failures += check_profile();
+    
+    if (failures == 0) {
+        printf("\n=== HMM Decoders - SUCCESS ===\n");
+    } else {
+        printf("\n=== HMM Decoders - FAILED (%d) ===\n", failures);
+    }
+    
+    return failures == 0 ? 0 : -1;
+}
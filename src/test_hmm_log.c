@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "hmm.h"
+
+// Long enough that the linear-domain δ underflows to 0.0
+#define LONG_T 200000
+
+int main() {
+    printf("=== TESTING HMM LOG-DOMAIN VITERBI ===\n");
+    
+    int failures = 0;
+    
+    // Weather example: both modes must agree on the path and probability
+    HMM* hmm = load_hmm("clima_ejemplo.txt");
+    if (hmm == NULL) {
+        printf("\n=== HMM Log Domain - FAILED ===\n");
+        return -1;
+    }
+    int weather[7] = {SUNGLASSES, SUNGLASSES, UMBRELLA, STAY_HOME, UMBRELLA, UMBRELLA, SUNGLASSES};
+    ViterbiResult* linear = viterbi_algorithm(hmm, weather);
+    ViterbiResult* logres = viterbi_algorithm_log(hmm, weather);
+    if (linear == NULL || logres == NULL) {
+        failures++;
+    } else {
+        for (int t = 0; t < 7; t++) {
+            if (linear->path[t] != logres->path[t]) {
+                printf("Path mismatch at t=%d: linear=%d log=%d\n", t+1, linear->path[t], logres->path[t]);
+                failures++;
+            }
+        }
+        if (fabs(logres->log_probability - log(linear->probability)) > 1e-9) {
+            printf("Log probability mismatch: %.12f vs %.12f\n",
+                   logres->log_probability, log(linear->probability));
+            failures++;
+        }
+    }
+    free_viterbi_result_enhanced(linear, 7);
+    free_viterbi_result_enhanced(logres, 7);
+    free_hmm(hmm);
+    
+    // Long sequence: log P* must stay finite and match the score of the returned path
+    hmm = allocate_hmm(3, 3, LONG_T);
+    double A[3][3] = {{0.7, 0.2, 0.1}, {0.3, 0.4, 0.3}, {0.2, 0.3, 0.5}};
+    double B[3][3] = {{0.1, 0.8, 0.1}, {0.3, 0.4, 0.3}, {0.8, 0.1, 0.1}};
+    double pi[3] = {0.6, 0.3, 0.1};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            HMM_A(hmm, i, j) = A[i][j];
+            HMM_B(hmm, i, j) = B[i][j];
+        }
+        hmm->initial[i] = pi[i];
+    }
+    
+    int* observations = (int*)malloc(LONG_T * sizeof(int));
+    srand(12345);
+    for (int t = 0; t < LONG_T; t++) {
+        observations[t] = rand() % 3;
+    }
+    
+    logres = viterbi_algorithm_log(hmm, observations);
+    if (logres == NULL || !isfinite(logres->log_probability)) {
+        printf("Log-domain Viterbi did not produce a finite log probability\n");
+        failures++;
+    } else {
+        double score = log(pi[logres->path[0]]) + log(B[logres->path[0]][observations[0]]);
+        for (int t = 1; t < LONG_T; t++) {
+            score += log(A[logres->path[t-1]][logres->path[t]]) + log(B[logres->path[t]][observations[t]]);
+        }
+        printf("T=%d: log P* = %.6f, path score = %.6f\n", LONG_T, logres->log_probability, score);
+        if (fabs(score - logres->log_probability) > 1e-6 * fabs(score)) {
+            failures++;
+        }
+    }
+    free_viterbi_result_enhanced(logres, LONG_T);
+    free(observations);
+    free_hmm(hmm);
+    
+    if (failures == 0) {
+        printf("\n=== HMM Log Domain - SUCCESS ===\n");
+    } else {
+        printf("\n=== HMM Log Domain - FAILED ===\n");
+    }
+    
+    return failures == 0 ? 0 : -1;
+}
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "hmm.h"
+#include "hmm_train.h"
+
+// Baum-Welch on a corpus sampled from the weather model: the likelihood must
+// never decrease, the thread count must not change the result beyond rounding,
+// invalid sequences must be rejected before training, and save_hmm must write
+// a file load_hmm reads back unchanged.
+
+static int sample(const double* probabilities, int n, int stride) {
+    double u = (double)rand() / ((double)RAND_MAX + 1.0);
+    double cumulative = 0.0;
+    for (int k = 0; k < n - 1; k++) {
+        cumulative += probabilities[(size_t)k * stride];
+        if (u < cumulative) return k;
+    }
+    return n - 1;
+}
+
+static HMM* weather_model(void) {
+    const double A[3][3] = {{0.7, 0.2, 0.1}, {0.3, 0.4, 0.3}, {0.2, 0.3, 0.5}};
+    const double B[3][3] = {{0.1, 0.8, 0.1}, {0.3, 0.4, 0.3}, {0.8, 0.1, 0.1}};
+    const double pi[3] = {0.6, 0.3, 0.1};
+    
+    HMM* hmm = allocate_hmm(3, 3, 1);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            HMM_A(hmm, i, j) = A[i][j];
+            HMM_B(hmm, i, j) = B[i][j];
+        }
+        hmm->initial[i] = pi[i];
+    }
+    hmm_prepare(hmm);
+    return hmm;
+}
+
+int main() {
+    printf("=== TESTING BAUM-WELCH TRAINING ===\n");
+    
+    int failures = 0;
+    int count = 64;
+    HMM* truth = weather_model();
+    
+    // Sample the corpus
+    srand(5);
+    int** sequences = (int**)malloc(count * sizeof(int*));
+    int* lengths = (int*)malloc(count * sizeof(int));
+    for (int s = 0; s < count; s++) {
+        lengths[s] = 50 + rand() % 400;
+        sequences[s] = (int*)malloc(lengths[s] * sizeof(int));
+        int state = sample(truth->initial, 3, 1);
+        for (int t = 0; t < lengths[s]; t++) {
+            if (t > 0) state = sample(&HMM_A(truth, state, 0), 3, 1);
+            sequences[s][t] = sample(&HMM_B(truth, state, 0), 3, 1);
+        }
+    }
+    
+    // Monotonicity: one EM iteration at a time
+    HMM* model = allocate_hmm(3, 3, 1);
+    hmm_randomize(model, 11);
+    BaumWelchOptions options = baum_welch_default_options();
+    options.max_iterations = 1;
+    options.num_threads = 3;
+    BaumWelchReport report;
+    double previous = -INFINITY;
+    for (int iteration = 0; iteration < 20; iteration++) {
+        if (baum_welch_train(model, (const int* const*)sequences, lengths, count, &options, &report) != 0
+            || report.log_likelihood < report.initial_log_likelihood - 1e-9
+            || report.initial_log_likelihood < previous - 1e-9) {
+            printf("Iteration %d: log-likelihood %.10f -> %.10f\n",
+                   iteration, report.initial_log_likelihood, report.log_likelihood);
+            failures++;
+            break;
+        }
+        previous = report.log_likelihood;
+    }
+    printf("After 20 single iterations: %.6f\n", previous);
+    
+    // Full training with 1 and 4 threads from the same start
+    HMM* single = allocate_hmm(3, 3, 1);
+    HMM* threaded = allocate_hmm(3, 3, 1);
+    srand(77);
+    int expected = rand();
+    srand(77);
+    hmm_randomize(single, 11);
+    hmm_randomize(threaded, 11);
+    if (rand() != expected) {
+        printf("hmm_randomize consumed the rand() state\n");
+        failures++;
+    }
+    
+    options = baum_welch_default_options();
+    options.max_iterations = 200;
+    options.num_threads = 1;
+    BaumWelchReport single_report, threaded_report;
+    failures += baum_welch_train(single, (const int* const*)sequences, lengths, count, &options, &single_report) != 0;
+    options.num_threads = 4;
+    failures += baum_welch_train(threaded, (const int* const*)sequences, lengths, count, &options, &threaded_report) != 0;
+    
+    printf("1 thread:  %d iterations, log-likelihood %.6f -> %.6f%s\n", single_report.iterations,
+           single_report.initial_log_likelihood, single_report.log_likelihood,
+           single_report.converged ? " (converged)" : "");
+    printf("4 threads: %d iterations, log-likelihood %.6f -> %.6f%s\n", threaded_report.iterations,
+           threaded_report.initial_log_likelihood, threaded_report.log_likelihood,
+           threaded_report.converged ? " (converged)" : "");
+    
+    if (single_report.log_likelihood <= single_report.initial_log_likelihood
+        || fabs(single_report.log_likelihood - threaded_report.log_likelihood) > 1e-6 * fabs(single_report.log_likelihood)) {
+        failures++;
+    }
+    if (!validate_hmm(single)) {
+        failures++;
+    }
+    
+    // Invalid input is rejected up front: an empty sequence, then a bad symbol
+    printf("Expecting two invalid-sequence errors:\n");
+    int saved_length = lengths[7];
+    lengths[7] = 0;
+    failures += baum_welch_train(single, (const int* const*)sequences, lengths, count, &options, NULL) != -1;
+    lengths[7] = saved_length;
+    int saved_symbol = sequences[9][3];
+    sequences[9][3] = 3;
+    failures += baum_welch_train(single, (const int* const*)sequences, lengths, count, &options, NULL) != -1;
+    sequences[9][3] = saved_symbol;
+    
+    // Round trip through the text format
+    const char* path = "test_hmm_train_model.txt";
+    single->sequence_length = lengths[0];
+    if (save_hmm(single, path, sequences[0]) != 0) {
+        failures++;
+    } else {
+        HMM* loaded = load_hmm((char*)path);
+        if (loaded == NULL) {
+            failures++;
+        } else {
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    if (HMM_A(loaded, i, j) != HMM_A(single, i, j) || HMM_B(loaded, i, j) != HMM_B(single, i, j)) {
+                        printf("Round trip: parameter (%d,%d) changed\n", i, j);
+                        failures++;
+                    }
+                }
+                if (loaded->initial[i] != single->initial[i]) failures++;
+            }
+            free_hmm(loaded);
+        }
+        remove(path);
+    }
+    
+    for (int s = 0; s < count; s++) free(sequences[s]);
+    free(sequences);
+    free(lengths);
+    free_hmm(model);
+    free_hmm(single);
+    free_hmm(threaded);
+    free_hmm(truth);
+    
+    if (failures == 0) {
+        printf("\n=== Baum-Welch Training - SUCCESS ===\n");
+    } else {
+        printf("\n=== Baum-Welch Training - FAILED (%d) ===\n", failures);
+    }
+    
+    return failures == 0 ? 0 : -1;
+}